@@ -43,5 +43,7 @@ extern EventGroupHandle_t common_event_group;
 #define EVENT_RX_READY                  (1 << 0)
 #define EVENT_TX_DONE                   (1 << 1)
 #define EVENT_TX_EMPTY                  (1 << 2)
+#define EVENT_CAMERA_PICTURE_TAKEN      (1 << 3)
+#define EVENT_CAMERA_DMA_COMPLETE       (1 << 4)
 
 #endif /* COMMON_EVENTS_H_ */
@@ -497,6 +497,40 @@ arm_cmsis_nn_status arm_nn_vec_mat_mult_t_svdf_s8(const q7_t *lhs,
                                                   const int32_t activation_min,
                                                   const int32_t activation_max);
 
+/**
+ * @brief s8 Vector by Matrix (transposed) multiplication with s32 bias and s16 output
+ *
+ * @param[in]      lhs             Input left-hand side vector
+ * @param[in]      rhs             Input right-hand side matrix (transposed)
+ * @param[in]      bias            Input bias. Can be NULL
+ * @param[out]     dst             Output vector
+ * @param[in]      lhs_offset      Offset to be added to the input values of the left-hand side
+ *                                 vector. Range: -127 to 128
+ * @param[in]      dst_multiplier  Output multiplier
+ * @param[in]      dst_shift       Output shift
+ * @param[in]      rhs_cols        Number of columns in the right-hand side input matrix
+ * @param[in]      rhs_rows        Number of rows in the right-hand side input matrix
+ * @param[in]      activation_min  Minimum value to clamp the output to. Range: int16
+ * @param[in]      activation_max  Maximum value to clamp the output to. Range: int16
+ *
+ * @return         The function returns <code>ARM_CMSIS_NN_SUCCESS</code>
+ *
+ * @details        Used by the integer LSTM gates, where an int8 activation is projected to the int16 gate
+ *                 domain. The rhs (weights) are symmetric, so no rhs offset is applied.
+ *
+ */
+arm_cmsis_nn_status arm_nn_vec_mat_mult_t_s8_s16(const q7_t *lhs,
+                                                 const q7_t *rhs,
+                                                 const q31_t *bias,
+                                                 q15_t *dst,
+                                                 const int32_t lhs_offset,
+                                                 const int32_t dst_multiplier,
+                                                 const int32_t dst_shift,
+                                                 const int32_t rhs_cols,
+                                                 const int32_t rhs_rows,
+                                                 const int32_t activation_min,
+                                                 const int32_t activation_max);
+
 /**
  * @brief Depthwise convolution of transposed rhs matrix with 4 lhs matrices. To be used in padded cases where
  *        the padding is -lhs_offset(Range: int8). Dimensions are the same for lhs and rhs.
@@ -0,0 +1,210 @@
+#include "edge-impulse-sdk/classifier/ei_classifier_config.h"
+#if EI_CLASSIFIER_TFLITE_LOAD_CMSIS_NN_SOURCES
+/*
+ * Copyright (C) 2021-2022 Arm Limited or its affiliates.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* ----------------------------------------------------------------------
+ * Project:      CMSIS NN Library
+ * Title:        arm_nn_vec_mat_mult_t_s8_s16
+ * Description:  s8 vector by matrix (transposed) multiplication with
+ *               s32 bias and s16 output. Targetted at the LSTM gates.
+ *
+ * $Date:        16 October 2026
+ * $Revision:    V.1.0.0
+ *
+ * Target Processor:  Cortex-M
+ *
+ * -------------------------------------------------------------------- */
+
+#include "edge-impulse-sdk/CMSIS/NN/Include/arm_nnsupportfunctions.h"
+
+/**
+ * @ingroup groupSupport
+ */
+
+/**
+ * @addtogroup NNBasicMath
+ * @{
+ */
+
+/*
+ * s8 vector(lhs) by matrix (transposed) multiplication with s16 output
+ *
+ * Refer header file for details.
+ *
+ */
+arm_cmsis_nn_status arm_nn_vec_mat_mult_t_s8_s16(const q7_t *lhs,
+                                                 const q7_t *rhs,
+                                                 const q31_t *bias,
+                                                 q15_t *dst,
+                                                 const int32_t lhs_offset,
+                                                 const int32_t dst_multiplier,
+                                                 const int32_t dst_shift,
+                                                 const int32_t rhs_cols,
+                                                 const int32_t rhs_rows,
+                                                 const int32_t activation_min,
+                                                 const int32_t activation_max)
+{
+    if (rhs_cols < 0 || rhs_rows < 0)
+    {
+        return ARM_CMSIS_NN_ARG_ERROR;
+    }
+
+#if defined(ARM_MATH_DSP)
+    const int32_t row_loop_cnt = rhs_rows / 2;
+
+    const int16_t lhs_offset_s16 = (int16_t)lhs_offset;
+    const uint32_t lhs_offset_s16x2 = __PKHBT(lhs_offset_s16, lhs_offset_s16, 16);
+
+    for (int32_t i = 0; i < row_loop_cnt; i++)
+    {
+        int32_t acc_0 = 0;
+        int32_t acc_1 = 0;
+        if (bias)
+        {
+            acc_0 = *bias++;
+            acc_1 = *bias++;
+        }
+
+        const int32_t col_loop_cnt = rhs_cols / 4;
+        const int8_t *lhs_vec = lhs;
+        const int8_t *rhs_0 = rhs;
+        const int8_t *rhs_1 = rhs + rhs_cols;
+        rhs += 2 * rhs_cols;
+
+        for (int j = col_loop_cnt; j != 0; j--)
+        {
+            int32_t vec_0 = arm_nn_read_q7x4_ia(&lhs_vec);
+            int32_t vec_1 = __SXTAB16(lhs_offset_s16x2, __ROR((uint32_t)vec_0, 8));
+            vec_0 = __SXTAB16(lhs_offset_s16x2, vec_0);
+
+            int32_t ker_0 = arm_nn_read_q7x4_ia(&rhs_0);
+            int32_t ker_1 = __SXTB16(__ROR((uint32_t)ker_0, 8));
+            ker_0 = __SXTB16(ker_0);
+            acc_0 = __SMLAD(ker_1, vec_1, acc_0);
+            acc_0 = __SMLAD(ker_0, vec_0, acc_0);
+
+            ker_0 = arm_nn_read_q7x4_ia(&rhs_1);
+            ker_1 = __SXTB16(__ROR((uint32_t)ker_0, 8));
+            ker_0 = __SXTB16(ker_0);
+            acc_1 = __SMLAD(ker_1, vec_1, acc_1);
+            acc_1 = __SMLAD(ker_0, vec_0, acc_1);
+        }
+
+        for (int k = col_loop_cnt * 4; k < rhs_cols; k++)
+        {
+            const int32_t lhs_temp = (*lhs_vec + lhs_offset);
+            lhs_vec++;
+            acc_0 += lhs_temp * (*rhs_0);
+            rhs_0++;
+            acc_1 += lhs_temp * (*rhs_1);
+            rhs_1++;
+        }
+
+        acc_0 = arm_nn_requantize(acc_0, dst_multiplier, dst_shift);
+        acc_1 = arm_nn_requantize(acc_1, dst_multiplier, dst_shift);
+
+        // Clamp the result
+        acc_0 = MAX(acc_0, activation_min);
+        acc_0 = MIN(acc_0, activation_max);
+        acc_1 = MAX(acc_1, activation_min);
+        acc_1 = MIN(acc_1, activation_max);
+        *dst++ = (q15_t)acc_0;
+        *dst++ = (q15_t)acc_1;
+    }
+
+    if (rhs_rows & 0x1)
+    {
+        int32_t acc_0 = 0;
+        if (bias)
+        {
+            acc_0 = *bias++;
+        }
+
+        const int32_t col_loop_cnt = rhs_cols / 4;
+        const int8_t *lhs_vec = lhs;
+        const int8_t *rhs_0 = rhs;
+
+        for (int i = col_loop_cnt; i != 0; i--)
+        {
+            int32_t vec_0 = arm_nn_read_q7x4_ia(&lhs_vec);
+            int32_t vec_1 = __SXTAB16(lhs_offset_s16x2, __ROR((uint32_t)vec_0, 8));
+            vec_0 = __SXTAB16(lhs_offset_s16x2, vec_0);
+
+            int32_t ker_0 = arm_nn_read_q7x4_ia(&rhs_0);
+            int32_t ker_1 = __SXTB16(__ROR((uint32_t)ker_0, 8));
+            ker_0 = __SXTB16(ker_0);
+            acc_0 = __SMLAD(ker_1, vec_1, acc_0);
+            acc_0 = __SMLAD(ker_0, vec_0, acc_0);
+        }
+
+        for (int j = col_loop_cnt * 4; j < rhs_cols; j++)
+        {
+            const int32_t lhs_temp = (*lhs_vec + lhs_offset);
+            lhs_vec++;
+            acc_0 += lhs_temp * (*rhs_0);
+            rhs_0++;
+        }
+
+        acc_0 = arm_nn_requantize(acc_0, dst_multiplier, dst_shift);
+
+        // Clamp the result
+        acc_0 = MAX(acc_0, activation_min);
+        acc_0 = MIN(acc_0, activation_max);
+        *dst = (q15_t)acc_0;
+    }
+
+#else
+
+    for (int32_t i_row = 0; i_row < rhs_rows; i_row++)
+    {
+        const q7_t *lhs_ptr = lhs;
+
+        q31_t res00 = 0;
+        if (bias)
+        {
+            res00 = *bias++;
+        }
+
+        for (int32_t rhs_cols_idx = 0; rhs_cols_idx < rhs_cols; ++rhs_cols_idx)
+        {
+            const q31_t rhs_value0 = (int8_t)*rhs++;
+            const q31_t lhs_value = (int8_t)*lhs_ptr++ + lhs_offset;
+
+            res00 += lhs_value * rhs_value0;
+        }
+
+        // Quantize down
+        res00 = arm_nn_requantize(res00, dst_multiplier, dst_shift);
+
+        // Clamp the result
+        res00 = MAX(res00, activation_min);
+        res00 = MIN(res00, activation_max);
+
+        *dst++ = (q15_t)res00;
+    }
+#endif
+
+    return ARM_CMSIS_NN_SUCCESS;
+}
+
+/**
+ * @} end of NNBasicMath group
+ */
+
+#endif // EI_CLASSIFIER_TFLITE_LOAD_CMSIS_NN_SOURCES
@@ -0,0 +1,151 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _EDGE_IMPULSE_ANOMALY_KMEANS_H_
+#define _EDGE_IMPULSE_ANOMALY_KMEANS_H_
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "edge-impulse-sdk/dsp/config.hpp"
+#if EIDSP_USE_CMSIS_DSP
+#include "edge-impulse-sdk/CMSIS/DSP/Include/arm_math.h"
+#endif
+
+// Features summed between two checks of the early exit of the distance
+#ifndef EI_ANOMALY_KMEANS_BLOCK_SIZE
+#define EI_ANOMALY_KMEANS_BLOCK_SIZE    16
+#endif
+
+/**
+ * Standard scaler, scales all values in the input vector
+ * Note that this *modifies* the array in place!
+ * The subtraction runs on the CMSIS-DSP kernel (Helium on MVE cores), the
+ * division stays a division to keep the features of the Python scaler.
+ * @param input Array of input values
+ * @param scale Array of scale values (obtain from StandardScaler in Python)
+ * @param mean Array of mean values (obtain from StandardScaler in Python)
+ * @param input_size Size of input, scale and mean arrays
+ */
+static inline void ei_anomaly_standard_scaler(float *input, const float *scale, const float *mean, size_t input_size)
+{
+#if EIDSP_USE_CMSIS_DSP
+    arm_sub_f32(input, mean, input, input_size);
+    for (size_t ix = 0; ix < input_size; ix++) {
+        input[ix] /= scale[ix];
+    }
+#else
+    for (size_t ix = 0; ix < input_size; ix++) {
+        input[ix] = (input[ix] - mean[ix]) / scale[ix];
+    }
+#endif
+}
+
+/**
+ * Squared euclidean distance between the input and a centroid, summed per
+ * block of EI_ANOMALY_KMEANS_BLOCK_SIZE features. Returns as soon as the
+ * sum is over bound: the caller only needs to know the centroid is too far.
+ * The sum is kept in double, like the pow() of the scorer it replaces, so
+ * wide models don't drift from the scores of the Python model.
+ * @param input Array of input values (already scaled)
+ * @param centroid Centroid, input_size values
+ * @param input_size Size of the input array
+ * @param bound Squared distance past which the sum can stop
+ * @return Squared distance, or a partial sum over bound
+ */
+static inline double ei_anomaly_squared_distance(const float *input, const float *centroid, size_t input_size, double bound)
+{
+    double dist = 0.0;
+
+    for (size_t start = 0; start < input_size; start += EI_ANOMALY_KMEANS_BLOCK_SIZE) {
+        size_t block_size = input_size - start < EI_ANOMALY_KMEANS_BLOCK_SIZE ?
+            input_size - start : EI_ANOMALY_KMEANS_BLOCK_SIZE;
+#if EIDSP_USE_CMSIS_DSP
+        float32_t diff[EI_ANOMALY_KMEANS_BLOCK_SIZE];
+        float32_t block_dist;
+        arm_sub_f32(input + start, centroid + start, diff, block_size);
+        arm_dot_prod_f32(diff, diff, block_size, &block_dist);
+        dist += block_dist;
+#else
+        for (size_t ix = start; ix < start + block_size; ix++) {
+            double diff = input[ix] - centroid[ix];
+            dist += diff * diff;
+        }
+#endif
+        if (dist > bound) {
+            break;
+        }
+    }
+
+    return dist;
+}
+
+/**
+ * Smallest distance from the input to the edge of a cluster, the anomaly
+ * score: sqrt(squared distance to the centroid) - max_error. A cluster stops
+ * being summed once it can't beat the smallest distance so far.
+ * @param input Array of input values (already scaled)
+ * @param input_size Size of the input array
+ * @param clusters Array of clusters, with centroid and max_error members
+ * @param cluster_count Size of cluster array
+ * @param max_distance Returned when no cluster is closer
+ */
+template<typename cluster_t>
+static inline float ei_anomaly_min_cluster_distance(const float *input, size_t input_size,
+    const cluster_t *clusters, size_t cluster_count, float max_distance)
+{
+    float min = max_distance;
+
+    for (size_t ix = 0; ix < cluster_count; ix++) {
+        // sqrt(dist) - max_error < min needs dist < reach^2
+        double reach = (double)min + clusters[ix].max_error;
+        if (reach <= 0.0) {
+            continue;
+        }
+        double bound = reach * reach;
+
+        double dist = ei_anomaly_squared_distance(input, clusters[ix].centroid, input_size, bound);
+        if (dist > bound) {
+            continue;
+        }
+        float score = (float)(sqrt(dist) - clusters[ix].max_error);
+        if (score < min) {
+            min = score;
+        }
+    }
+    return min;
+}
+
+#endif // _EDGE_IMPULSE_ANOMALY_KMEANS_H_
@@ -126,6 +126,7 @@
 
 struct ei_impulse;
 class ei_impulse_handle_t;
+struct ei_impulse_workspace;
 
 typedef struct {
     uint16_t implementation_version;
@@ -503,6 +504,7 @@ public:
         , freeform_outputs(nullptr)
 #endif //EI_CLASSIFIER_FREEFORM_OUTPUT
         , input_params(nullptr)
+        , workspace(nullptr)
         { /* ei_impulse_handle_t ctor */};
 
     ei_impulse_state_t state;
@@ -512,6 +514,8 @@ public:
     ei::matrix_t *freeform_outputs;
 #endif // EI_CLASSIFIER_FREEFORM_OUTPUT
     ei_input_params* input_params;
+    // scratch memory for run_classifier_continuous, see ei_impulse_workspace_init
+    ei_impulse_workspace* workspace;
 };
 
 typedef struct {
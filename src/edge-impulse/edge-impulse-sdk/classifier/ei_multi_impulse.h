@@ -0,0 +1,419 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _EDGE_IMPULSE_MULTI_IMPULSE_H_
+#define _EDGE_IMPULSE_MULTI_IMPULSE_H_
+
+/**
+ * Several impulses on one device, e.g. a cheap keyword model running all the
+ * time and a larger command model only run when the keyword is heard.
+ *
+ * The impulses time-share the tensor arena: with EI_CLASSIFIER_ALLOCATION_STATIC
+ * there is a single static arena, sized at build time
+ * (EI_CLASSIFIER_TFLITE_LARGEST_ARENA_SIZE, or EI_TENSOR_ARENA_SIZE), and an
+ * impulse that doesn't fit can't be registered. Otherwise one arena is
+ * allocated on the heap at registration, grown to the largest graph of the
+ * registered impulses. With
+ * EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER the interpreter of the impulse
+ * run last is kept, switching to another impulse sets its graph up again: the
+ * setups are counted per impulse.
+ *
+ * Only one impulse can run continuously (run_classifier_continuous keeps its
+ * slice count and the audio state of the DSP blocks in globals), the others
+ * are run one-shot.
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+// Impulses that can be registered
+#ifndef EI_MULTI_IMPULSE_MAX
+#define EI_MULTI_IMPULSE_MAX            4
+#endif
+
+/**
+ * Latency and memory of a registered impulse
+ */
+typedef struct {
+    ei_impulse_handle_t *handle;
+    size_t arena_size;          // largest arena planned for its graphs
+    size_t arena_used;          // arena used after its last setup
+    uint32_t runs;
+    uint32_t setups;            // interpreter setups done by its runs
+    uint32_t last_us;           // DSP, setup and inference of the last run
+    uint32_t max_us;
+    uint64_t total_us;
+    int64_t last_dsp_us;
+    int64_t last_classification_us;
+} ei_multi_impulse_stats_t;
+
+/**
+ * Cascade gate, returns true when stage 2 runs on the result of stage 1
+ */
+typedef bool (*ei_cascade_gate_t)(ei_impulse_handle_t *handle, const ei_impulse_result_t *result, void *ctx);
+
+/**
+ * Two impulses where the result of the first gates the second
+ */
+typedef struct {
+    ei_impulse_handle_t *stage1;
+    ei_impulse_handle_t *stage2;
+    ei_cascade_gate_t gate;
+    void *gate_ctx;
+    bool stage1_continuous;     // stage 1 takes slices (run_classifier_continuous)
+} ei_cascade_t;
+
+/**
+ * Context of ei_cascade_gate_label: stage 2 runs when the label scores at
+ * least the threshold
+ */
+typedef struct {
+    const char *label;
+    float threshold;
+} ei_cascade_label_gate_t;
+
+static ei_multi_impulse_stats_t ei_multi_impulses[EI_MULTI_IMPULSE_MAX];
+static size_t ei_multi_impulse_count = 0;
+
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1) && !defined(EI_CLASSIFIER_ALLOCATION_STATIC)
+// arena on the heap shared by the registered impulses
+static uint8_t *ei_multi_impulse_arena = nullptr;
+static size_t ei_multi_impulse_arena_allocated = 0;
+#endif
+
+/**
+ * Largest tensor arena the graphs of an impulse need, 0 without TFLite graphs
+ */
+__attribute__((unused)) static size_t ei_multi_impulse_graph_arena(const ei_impulse_t *impulse)
+{
+    size_t arena_size = 0;
+
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+    for (size_t ix = 0; ix < impulse->learning_blocks_size; ix++) {
+        const ei_learning_block_t *block = &impulse->learning_blocks[ix];
+        if (block->infer_fn != &run_nn_inference) {
+            continue;
+        }
+        ei_learning_block_config_tflite_graph_t *block_config = (ei_learning_block_config_tflite_graph_t*)block->config;
+        ei_config_tflite_graph_t *graph_config = (ei_config_tflite_graph_t*)block_config->graph_config;
+        (void)graph_config; // not read with EI_TENSOR_ARENA_SIZE
+        if (EI_TFLITE_ARENA_SIZE(graph_config) > arena_size) {
+            arena_size = EI_TFLITE_ARENA_SIZE(graph_config);
+        }
+    }
+#else
+    (void)impulse;
+#endif
+
+    return arena_size;
+}
+
+static ei_multi_impulse_stats_t *ei_multi_impulse_find(ei_impulse_handle_t *handle)
+{
+    for (size_t ix = 0; ix < ei_multi_impulse_count; ix++) {
+        if (ei_multi_impulses[ix].handle == handle) {
+            return &ei_multi_impulses[ix];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Register an impulse, it must be registered before it's run through
+ * ei_multi_impulse_run or a cascade. Registering it again resets its stats.
+ *
+ * @param      handle  Impulse handle, e.g. &ei_default_impulse
+ *
+ * @return     EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED when a graph doesn't fit
+ *             the static arena, or the shared arena can't grow to it,
+ *             EI_IMPULSE_INVALID_SIZE when its labels don't
+ *             fit the classification array of the results, EI_IMPULSE_OUT_OF_MEMORY
+ *             when all EI_MULTI_IMPULSE_MAX slots are taken
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR ei_multi_impulse_register(ei_impulse_handle_t *handle)
+{
+    if ((handle == nullptr) || (handle->impulse == nullptr)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    ei_multi_impulse_stats_t *stats = ei_multi_impulse_find(handle);
+    if (stats == nullptr) {
+        if (ei_multi_impulse_count == EI_MULTI_IMPULSE_MAX) {
+            ei_printf("ERR: More than %d impulses registered (EI_MULTI_IMPULSE_MAX)\n", EI_MULTI_IMPULSE_MAX);
+            return EI_IMPULSE_OUT_OF_MEMORY;
+        }
+        stats = &ei_multi_impulses[ei_multi_impulse_count];
+    }
+
+#if EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 1
+    // the results are sized for the labels of the default impulse
+    const size_t max_labels = sizeof(ei_impulse_result_t::classification) / sizeof(ei_impulse_result_classification_t);
+    if (handle->impulse->label_count > max_labels) {
+        ei_printf("ERR: %s has %u labels, the results hold %u (EI_CLASSIFIER_LABEL_COUNT)\n",
+            handle->impulse->impulse_name, (unsigned)handle->impulse->label_count, (unsigned)max_labels);
+        return EI_IMPULSE_INVALID_SIZE;
+    }
+#endif
+
+    size_t arena_size = ei_multi_impulse_graph_arena(handle->impulse);
+
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+    // the shared arena holds the largest graph of all registered impulses
+    size_t required_size = arena_size;
+    for (size_t ix = 0; ix < ei_multi_impulse_count; ix++) {
+        if ((&ei_multi_impulses[ix] != stats) && (ei_multi_impulses[ix].arena_size > required_size)) {
+            required_size = ei_multi_impulses[ix].arena_size;
+        }
+    }
+
+#ifdef EI_CLASSIFIER_ALLOCATION_STATIC
+    if (required_size > (size_t)(EI_TFLITE_STATIC_ARENA_SIZE)) {
+        ei_printf("ERR: %s needs a %u bytes arena, the static arena has %u bytes, build with EI_TENSOR_ARENA_SIZE=%u\n",
+            handle->impulse->impulse_name, (unsigned)arena_size, (unsigned)(EI_TFLITE_STATIC_ARENA_SIZE),
+            (unsigned)required_size);
+        return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+    }
+#else
+    if (required_size > ei_multi_impulse_arena_allocated) {
+        // the new arena first, the impulses keep the old one if it fails
+        uint8_t *arena = (uint8_t*)ei_aligned_calloc(16, required_size);
+        if (arena == nullptr) {
+            ei_printf("ERR: %s needs the shared arena to grow from %lu to %lu bytes, out of memory\n",
+                handle->impulse->impulse_name, (unsigned long)ei_multi_impulse_arena_allocated,
+                (unsigned long)required_size);
+            return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+        }
+        inference_tflite_set_shared_arena(arena, required_size);
+        if (ei_multi_impulse_arena != nullptr) {
+            ei_aligned_free(ei_multi_impulse_arena);
+        }
+        ei_multi_impulse_arena = arena;
+        ei_multi_impulse_arena_allocated = required_size;
+    }
+#endif
+#endif
+
+    if (stats == &ei_multi_impulses[ei_multi_impulse_count]) {
+        ei_multi_impulse_count++;
+    }
+    memset(stats, 0, sizeof(ei_multi_impulse_stats_t));
+    stats->handle = handle;
+    stats->arena_size = arena_size;
+
+    return EI_IMPULSE_OK;
+}
+
+/**
+ * Arena shared by the registered impulses: the largest they need
+ */
+__attribute__((unused)) static size_t ei_multi_impulse_arena_size(void)
+{
+    size_t arena_size = 0;
+
+    for (size_t ix = 0; ix < ei_multi_impulse_count; ix++) {
+        if (ei_multi_impulses[ix].arena_size > arena_size) {
+            arena_size = ei_multi_impulses[ix].arena_size;
+        }
+    }
+    return arena_size;
+}
+
+/**
+ * Stats of a registered impulse, nullptr if it isn't registered
+ */
+__attribute__((unused)) static const ei_multi_impulse_stats_t *ei_multi_impulse_stats(ei_impulse_handle_t *handle)
+{
+    return ei_multi_impulse_find(handle);
+}
+
+/**
+ * Run a registered impulse and update its stats
+ *
+ * @param      handle      Registered impulse handle
+ * @param      signal      Sample data, a slice when continuous is set
+ * @param      result      Output classifier results
+ * @param      continuous  Run it with run_classifier_continuous (call
+ *                         run_classifier_init(handle) first)
+ * @param      debug       Debug output enable
+ *
+ * @return     The ei impulse error.
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR ei_multi_impulse_run(ei_impulse_handle_t *handle,
+                                                                     signal_t *signal,
+                                                                     ei_impulse_result_t *result,
+                                                                     bool continuous = false,
+                                                                     bool debug = false)
+{
+    ei_multi_impulse_stats_t *stats = ei_multi_impulse_find(handle);
+    if (stats == nullptr) {
+        ei_printf("ERR: Impulse not registered with ei_multi_impulse_register\n");
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+    const uint32_t setup_count = inference_tflite_setup_count();
+#endif
+    const uint64_t start_us = ei_read_timer_us();
+
+    EI_IMPULSE_ERROR res = continuous ?
+        process_impulse_continuous(handle, signal, result, debug) :
+        process_impulse(handle, signal, result, debug);
+
+    const uint32_t elapsed_us = (uint32_t)(ei_read_timer_us() - start_us);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+    if (inference_tflite_setup_count() != setup_count) {
+        stats->setups += inference_tflite_setup_count() - setup_count;
+        stats->arena_used = inference_tflite_arena_usage().used;
+    }
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER != 1
+    // set up on every run, no setup count
+    stats->setups++;
+    stats->arena_used = inference_tflite_arena_usage().used;
+#endif
+#endif
+
+    stats->runs++;
+    stats->last_us = elapsed_us;
+    stats->total_us += elapsed_us;
+    if (elapsed_us > stats->max_us) {
+        stats->max_us = elapsed_us;
+    }
+    stats->last_dsp_us = result->timing.dsp_us;
+    stats->last_classification_us = result->timing.classification_us;
+
+    return EI_IMPULSE_OK;
+}
+
+/**
+ * Run stage 1 of a cascade and, when its gate opens, stage 2. The gate reads
+ * the result of stage 1 before stage 2 runs: a one-shot run of stage 2
+ * reuses the classification array of a one-shot stage 1.
+ *
+ * @param      cascade         The two registered impulses and the gate
+ * @param      stage1_signal   Sample data of stage 1 (a slice when continuous)
+ * @param      stage2_signal   Sample data of stage 2, e.g. the window around the keyword
+ * @param      stage1_result   Output results of stage 1
+ * @param      stage2_result   Output results of stage 2, only set when triggered
+ * @param      triggered       Set when stage 2 ran
+ * @param      debug           Debug output enable
+ *
+ * @return     The ei impulse error of the stage that failed
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR ei_multi_impulse_cascade(const ei_cascade_t *cascade,
+                                                                         signal_t *stage1_signal,
+                                                                         signal_t *stage2_signal,
+                                                                         ei_impulse_result_t *stage1_result,
+                                                                         ei_impulse_result_t *stage2_result,
+                                                                         bool *triggered,
+                                                                         bool debug = false)
+{
+    *triggered = false;
+
+    EI_IMPULSE_ERROR res = ei_multi_impulse_run(cascade->stage1, stage1_signal, stage1_result,
+        cascade->stage1_continuous, debug);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+
+    if (!cascade->gate(cascade->stage1, stage1_result, cascade->gate_ctx)) {
+        return EI_IMPULSE_OK;
+    }
+
+    *triggered = true;
+    return ei_multi_impulse_run(cascade->stage2, stage2_signal, stage2_result, false, debug);
+}
+
+/**
+ * Cascade gate on the score of one label, ctx is an ei_cascade_label_gate_t
+ */
+__attribute__((unused)) static bool ei_cascade_gate_label(ei_impulse_handle_t *handle, const ei_impulse_result_t *result, void *ctx)
+{
+    const ei_cascade_label_gate_t *gate = (const ei_cascade_label_gate_t*)ctx;
+
+    if (handle->impulse->results_type != EI_CLASSIFIER_TYPE_CLASSIFICATION) {
+        return false;
+    }
+    for (size_t ix = 0; ix < handle->impulse->label_count; ix++) {
+        if (strcmp(handle->impulse->categories[ix], gate->label) == 0) {
+            return result->classification[ix].value >= gate->threshold;
+        }
+    }
+    return false;
+}
+
+/**
+ * Print the latency and memory of the registered impulses
+ */
+__attribute__((unused)) static void ei_multi_impulse_print_stats(void)
+{
+    ei_printf("Shared arena: %u bytes\n", (unsigned)ei_multi_impulse_arena_size());
+
+    for (size_t ix = 0; ix < ei_multi_impulse_count; ix++) {
+        const ei_multi_impulse_stats_t *stats = &ei_multi_impulses[ix];
+        uint32_t avg_us = stats->runs ? (uint32_t)(stats->total_us / stats->runs) : 0;
+
+        ei_printf("%s: %u runs, last %u us (DSP %d us, inference %d us), avg %u us, max %u us, "
+            "%u setups, arena %u/%u bytes\n",
+            stats->handle->impulse->impulse_name, (unsigned)stats->runs, (unsigned)stats->last_us,
+            (int)stats->last_dsp_us, (int)stats->last_classification_us, (unsigned)avg_us,
+            (unsigned)stats->max_us, (unsigned)stats->setups, (unsigned)stats->arena_used,
+            (unsigned)stats->arena_size);
+    }
+}
+
+/**
+ * Release the impulses (run_classifier_deinit) and their shared arena, and
+ * forget them
+ */
+__attribute__((unused)) static void ei_multi_impulse_deinit(void)
+{
+    for (size_t ix = 0; ix < ei_multi_impulse_count; ix++) {
+        run_classifier_deinit(ei_multi_impulses[ix].handle);
+    }
+    ei_multi_impulse_count = 0;
+
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1) && !defined(EI_CLASSIFIER_ALLOCATION_STATIC)
+    inference_tflite_set_shared_arena(nullptr, 0);
+    if (ei_multi_impulse_arena != nullptr) {
+        ei_aligned_free(ei_multi_impulse_arena);
+    }
+    ei_multi_impulse_arena = nullptr;
+    ei_multi_impulse_arena_allocated = 0;
+#endif
+}
+
+#endif // _EDGE_IMPULSE_MULTI_IMPULSE_H_
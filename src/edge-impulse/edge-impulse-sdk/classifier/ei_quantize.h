@@ -37,8 +37,15 @@
 
 #include <algorithm>
 #include <cmath>
+#include <stdint.h>
 
-static int32_t pre_cast_quantize(float value, float scale, int32_t zero_point, bool is_signed) {
+// Models with int16 activations and int8 weights (16x8 quantization): int16
+// input and output tensors in the TFLite glue and the quantized audio features
+#ifndef EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS
+#define EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS 0
+#endif
+
+static inline int32_t pre_cast_quantize(float value, float scale, int32_t zero_point, bool is_signed) {
 
     int32_t max_value = is_signed ? 127 : 255;
     int32_t min_value = is_signed ? -128 : 0;
@@ -46,4 +53,24 @@ static int32_t pre_cast_quantize(float value, float scale, int32_t zero_point, b
     return std::min( std::max( static_cast<int32_t>(round(value / scale)) + zero_point, min_value), max_value);
 }
 
+static inline int32_t pre_cast_quantize_i16(float value, float scale, int32_t zero_point) {
+
+    // Saturate/clip any overflows post scaling
+    return std::min( std::max( static_cast<int32_t>(round(value / scale)) + zero_point, (int32_t)INT16_MIN), (int32_t)INT16_MAX);
+}
+
+/**
+ * Quantize to the type T (int8_t or int16_t), for code shared between int8
+ * and int16 tensors
+ */
+template<typename T> T quantize_as(float value, float scale, int32_t zero_point);
+
+template<> inline int8_t quantize_as<int8_t>(float value, float scale, int32_t zero_point) {
+    return static_cast<int8_t>(pre_cast_quantize(value, scale, zero_point, true));
+}
+
+template<> inline int16_t quantize_as<int16_t>(float value, float scale, int32_t zero_point) {
+    return static_cast<int16_t>(pre_cast_quantize_i16(value, scale, zero_point));
+}
+
 #endif  //!__EI_QUANTIZE__H__
\ No newline at end of file
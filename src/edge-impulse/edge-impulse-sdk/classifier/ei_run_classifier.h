@@ -96,6 +96,25 @@
 // This file has an implicit dependency on ei_run_dsp.h, so must come after that include!
 #include "model-parameters/model_variables.h"
 
+/**
+ * Scratch memory of process_impulse_continuous(). It's sized once from the
+ * impulse metadata (in run_classifier_init) and reused on every slice, so a
+ * slice doesn't touch the heap from this layer.
+ */
+struct ei_impulse_workspace {
+    float *features_buffer;             // sliding window of DSP features
+    float *norm_buffer;                 // copy of the window for CMVN
+    ei::matrix_t *matrices;             // view of features_buffer, then a view of norm_buffer per DSP block
+    ei_feature_t *features;             // dsp_blocks_size + learning_blocks_size
+    size_t features_size;
+    ei_feature_t *raw_outputs;
+    size_t raw_outputs_size;
+#if EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 0
+    ei_impulse_result_classification_t *classification;
+    size_t classification_size;
+#endif
+};
+
 #ifdef __cplusplus
 namespace {
 #endif // __cplusplus
@@ -103,7 +122,10 @@ namespace {
 /* Function prototypes ----------------------------------------------------- */
 extern "C" EI_IMPULSE_ERROR run_inference(ei_impulse_handle_t *handle, ei_feature_t *fmatrix, ei_impulse_result_t *result, bool debug);
 extern "C" EI_IMPULSE_ERROR run_classifier_image_quantized(const ei_impulse_t *impulse, signal_t *signal, ei_impulse_result_t *result, bool debug);
+EI_IMPULSE_ERROR run_classifier_image_quantized(const ei_impulse_t *impulse, image_signal_t *image, ei_impulse_result_t *result, bool debug);
 static EI_IMPULSE_ERROR can_run_classifier_image_quantized(const ei_impulse_t *impulse, ei_learning_block_t block_ptr);
+static EI_IMPULSE_ERROR can_run_classifier_features_quantized(const ei_impulse_t *impulse, ei_learning_block_t block_ptr);
+EI_IMPULSE_ERROR run_classifier_features_quantized(const ei_impulse_t *impulse, signal_t *signal, ei_impulse_result_t *result, bool debug);
 static void ei_result_struct_timing_us_to_ms(ei_impulse_result_t *result);
 
 #if EI_CLASSIFIER_LOAD_IMAGE_SCALING
@@ -197,20 +219,22 @@ extern "C" EI_IMPULSE_ERROR run_inference(
 }
 
 /**
- * @brief      Process a complete impulse
+ * @brief      Process a complete impulse, see process_impulse
  *
- * @param      impulse  struct with information about model and DSP
+ * @param      handle   Handle from open_impulse
  * @param      signal   Sample data
+ * @param      image    Same sample as native 8 bit image, or nullptr. Used
+ *                      instead of signal by the quantized image shortcut.
  * @param      result   Output classifier results
- * @param      handle   Handle from open_impulse. nullptr for backward compatibility
  * @param[in]  debug    Debug output enable
  *
  * @return     The ei impulse error.
  */
-extern "C" EI_IMPULSE_ERROR process_impulse(ei_impulse_handle_t *handle,
-                                            signal_t *signal,
-                                            ei_impulse_result_t *result,
-                                            bool debug = false)
+static EI_IMPULSE_ERROR process_impulse_impl(ei_impulse_handle_t *handle,
+                                             signal_t *signal,
+                                             image_signal_t *image,
+                                             ei_impulse_result_t *result,
+                                             bool debug)
 {
     if ((handle == nullptr) || (handle->impulse  == nullptr) || (result  == nullptr) || (signal  == nullptr)) {
         return EI_IMPULSE_INFERENCE_ERROR;
@@ -269,7 +293,15 @@ extern "C" EI_IMPULSE_ERROR process_impulse(ei_impulse_handle_t *handle,
     // Shortcut for quantized image models
     ei_learning_block_t block = handle->impulse->learning_blocks[0];
     if (can_run_classifier_image_quantized(handle->impulse, block) == EI_IMPULSE_OK) {
-        res = run_classifier_image_quantized(handle->impulse, signal, result, debug);
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE)
+        if (image != nullptr) {
+            res = run_classifier_image_quantized(handle->impulse, image, result, debug);
+        }
+        else
+#endif // EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE
+        {
+            res = run_classifier_image_quantized(handle->impulse, signal, result, debug);
+        }
         if (res != EI_IMPULSE_OK) {
             return res;
         }
@@ -278,6 +310,18 @@ extern "C" EI_IMPULSE_ERROR process_impulse(ei_impulse_handle_t *handle,
         return res;
     }
 #endif // EI_CLASSIFIER_QUANTIZATION_ENABLED == 1 && (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TENSAIFLOW || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_ONNX_TIDL) || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_DRPAI || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_ATON
+#if (EI_CLASSIFIER_QUANTIZATION_ENABLED == 1) && (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+    // Shortcut for quantized MFE and spectrogram models
+    if (can_run_classifier_features_quantized(handle->impulse, handle->impulse->learning_blocks[0]) == EI_IMPULSE_OK) {
+        res = run_classifier_features_quantized(handle->impulse, signal, result, debug);
+        if (res != EI_IMPULSE_OK) {
+            return res;
+        }
+        res = run_postprocessing(handle, result);
+        ei_result_struct_timing_us_to_ms(result);
+        return res;
+    }
+#endif // (EI_CLASSIFIER_QUANTIZATION_ENABLED == 1) && (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
     uint32_t block_num = handle->impulse->dsp_blocks_size;
 
     // smart pointer to features array
@@ -426,6 +470,25 @@ extern "C" EI_IMPULSE_ERROR process_impulse(ei_impulse_handle_t *handle,
 #endif
 }
 
+/**
+ * @brief      Process a complete impulse
+ *
+ * @param      impulse  struct with information about model and DSP
+ * @param      signal   Sample data
+ * @param      result   Output classifier results
+ * @param      handle   Handle from open_impulse. nullptr for backward compatibility
+ * @param[in]  debug    Debug output enable
+ *
+ * @return     The ei impulse error.
+ */
+extern "C" EI_IMPULSE_ERROR process_impulse(ei_impulse_handle_t *handle,
+                                            signal_t *signal,
+                                            ei_impulse_result_t *result,
+                                            bool debug = false)
+{
+    return process_impulse_impl(handle, signal, nullptr, result, debug);
+}
+
 /**
  * @brief      Opens an impulse
  *
@@ -441,6 +504,135 @@ extern "C" EI_IMPULSE_ERROR init_impulse(ei_impulse_handle_t *handle) {
     return EI_IMPULSE_OK;
 }
 
+/**
+ * @brief      Release the continuous inference workspace of an impulse
+ *
+ * @param      handle  struct with information about model and DSP
+ */
+static void ei_impulse_workspace_free(ei_impulse_handle_t *handle)
+{
+    ei_impulse_workspace *ws = handle->workspace;
+
+    if (ws == nullptr) {
+        return;
+    }
+
+    // the matrices are views, there is nothing to destruct
+    ei_free(ws->matrices);
+    ei_free(ws->features_buffer);
+    ei_free(ws->norm_buffer);
+    ei_free(ws->features);
+    ei_free(ws->raw_outputs);
+#if EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 0
+    ei_free(ws->classification);
+#endif
+    ei_free(ws);
+
+    handle->workspace = nullptr;
+}
+
+/**
+ * @brief      Whether process_impulse_continuous can run the impulse: all its
+ *             DSP blocks have a slice version (MFCC, MFE and spectrogram)
+ *
+ * @param      impulse  struct with information about model and DSP
+ */
+static bool ei_impulse_has_slice_blocks(const ei_impulse_t *impulse)
+{
+    for (size_t ix = 0; ix < impulse->dsp_blocks_size; ix++) {
+        ei_model_dsp_t block = impulse->dsp_blocks[ix];
+
+        if (block.extract_fn != extract_mfcc_features &&
+            block.extract_fn != extract_spectrogram_features &&
+            block.extract_fn != extract_mfe_features) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief      Allocate the continuous inference workspace of an impulse.
+ *             Everything process_impulse_continuous needs is sized here, from
+ *             the impulse metadata, so slices can run without heap allocations.
+ *
+ * @param      handle  struct with information about model and DSP
+ *
+ * @return     The ei impulse error.
+ */
+static EI_IMPULSE_ERROR ei_impulse_workspace_init(ei_impulse_handle_t *handle)
+{
+    const ei_impulse_t *impulse = handle->impulse;
+
+    ei_impulse_workspace_free(handle);
+
+    ei_impulse_workspace *ws = (ei_impulse_workspace *)ei_calloc(1, sizeof(ei_impulse_workspace));
+    if (ws == nullptr) {
+        ei_printf("ERR: Out of memory, can't allocate continuous workspace\n");
+        return EI_IMPULSE_ALLOC_FAILED;
+    }
+    handle->workspace = ws;
+
+    ws->features_buffer = (float *)ei_calloc(impulse->nn_input_frame_size, sizeof(float));
+    ws->norm_buffer = (float *)ei_calloc(impulse->nn_input_frame_size, sizeof(float));
+    ws->matrices = (ei::matrix_t *)ei_calloc(impulse->dsp_blocks_size + 1, sizeof(ei::matrix_t));
+    ws->features_size = impulse->dsp_blocks_size + impulse->learning_blocks_size;
+    ws->features = (ei_feature_t *)ei_calloc(ws->features_size, sizeof(ei_feature_t));
+    ws->raw_outputs_size = impulse->output_tensors_size > impulse->learning_blocks_size ?
+        impulse->output_tensors_size : impulse->learning_blocks_size;
+    ws->raw_outputs = (ei_feature_t *)ei_calloc(ws->raw_outputs_size, sizeof(ei_feature_t));
+
+    if (!ws->features_buffer || !ws->norm_buffer || !ws->matrices || !ws->features || !ws->raw_outputs) {
+        ei_printf("ERR: Out of memory, can't allocate continuous workspace\n");
+        ei_impulse_workspace_free(handle);
+        return EI_IMPULSE_ALLOC_FAILED;
+    }
+
+    // views only, the buffers are owned by the workspace (::new, matrix_t has its own operator new)
+    ::new (&ws->matrices[0]) ei::matrix_t(1, impulse->nn_input_frame_size, ws->features_buffer);
+
+    size_t out_features_index = 0;
+    for (size_t ix = 0; ix < impulse->dsp_blocks_size; ix++) {
+        ei_model_dsp_t block = impulse->dsp_blocks[ix];
+
+        if (out_features_index + block.n_output_features > impulse->nn_input_frame_size) {
+            ei_printf("ERR: Would write outside feature buffer\n");
+            ei_impulse_workspace_free(handle);
+            return EI_IMPULSE_DSP_ERROR;
+        }
+
+        ::new (&ws->matrices[ix + 1]) ei::matrix_t(1, block.n_output_features, ws->norm_buffer + out_features_index);
+        out_features_index += block.n_output_features;
+    }
+
+#if EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 0
+    if (impulse->results_type == EI_CLASSIFIER_TYPE_CLASSIFICATION ||
+        impulse->results_type == EI_CLASSIFIER_TYPE_REGRESSION) {
+    #ifdef EI_DSP_RESULT_OVERRIDE
+        ws->classification_size = EI_DSP_RESULT_OVERRIDE;
+    #else
+        ws->classification_size = impulse->label_count;
+    #endif
+        ws->classification = (ei_impulse_result_classification_t *)ei_calloc(
+            ws->classification_size, sizeof(ei_impulse_result_classification_t));
+        if (ws->classification == nullptr) {
+            ei_printf("ERR: Out of memory, can't allocate continuous workspace\n");
+            ei_impulse_workspace_free(handle);
+            return EI_IMPULSE_ALLOC_FAILED;
+        }
+        for (size_t ix = 0; ix < ws->classification_size; ix++) {
+    #ifdef EI_DSP_RESULT_OVERRIDE
+            ws->classification[ix].label = "";
+    #else
+            ws->classification[ix].label = impulse->categories[ix];
+    #endif
+        }
+    }
+#endif // EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 0
+
+    return EI_IMPULSE_OK;
+}
+
 /**
  * @brief      Process a complete impulse for continuous inference
  *
@@ -460,34 +652,21 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
         return EI_IMPULSE_INFERENCE_ERROR;
     }
 
+    // allocated by run_classifier_init(), never by a slice
+    ei_impulse_workspace *ws = handle->workspace;
+    if (ws == nullptr) {
+        ei_printf("ERR: No continuous workspace, run_classifier_init() failed or wasn't called\n");
+        return EI_IMPULSE_ALLOC_FAILED;
+    }
+
     memset(result, 0, sizeof(ei_impulse_result_t));
 
 #if EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 0
-    static std::vector<ei_impulse_result_classification_t> classification_results;
-    classification_results.clear(); // todo, should not clear and re-gen this every time...
-
-    if (handle->impulse->results_type == EI_CLASSIFIER_TYPE_CLASSIFICATION ||
-        handle->impulse->results_type == EI_CLASSIFIER_TYPE_REGRESSION) {
-    #ifdef EI_DSP_RESULT_OVERRIDE
-        for (size_t ix = 0; ix < EI_DSP_RESULT_OVERRIDE; ix++) {
-            ei_impulse_result_classification_t classification = {
-                .label = "",
-                .value = 0.0f
-            };
-            classification_results.push_back(classification);
-        }
-    #else
-        for (size_t ix = 0; ix < handle->impulse->label_count; ix++) {
-            ei_impulse_result_classification_t classification = {
-                .label = handle->impulse->categories[ix],
-                .value = 0.0f
-            };
-            classification_results.push_back(classification);
-        }
-    #endif
+    for (size_t ix = 0; ix < ws->classification_size; ix++) {
+        ws->classification[ix].value = 0.0f;
     }
 
-    result->classification = classification_results.data();
+    result->classification = ws->classification;
 
 #else // EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 1
 
@@ -498,16 +677,11 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
 
 #endif // EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 0
 
-    // smart pointer to results array
-    std::unique_ptr<ei_feature_t[]> raw_results_ptr(new ei_feature_t[handle->impulse->learning_blocks_size]);
-    result->_raw_outputs = raw_results_ptr.get();
-    memset(result->_raw_outputs, 0, sizeof(ei_feature_t) * handle->impulse->learning_blocks_size);
+    result->_raw_outputs = ws->raw_outputs;
+    memset(result->_raw_outputs, 0, sizeof(ei_feature_t) * ws->raw_outputs_size);
 
     auto impulse = handle->impulse;
-    static ei::matrix_t static_features_matrix(1, impulse->nn_input_frame_size);
-    if (!static_features_matrix.buffer) {
-        return EI_IMPULSE_ALLOC_FAILED;
-    }
+    ei::matrix_t &static_features_matrix = ws->matrices[0];
 
     EI_IMPULSE_ERROR ei_impulse_error = EI_IMPULSE_OK;
 
@@ -575,48 +749,20 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
     if (classifier_continuous_features_written >= impulse->nn_input_frame_size) {
         dsp_start_us = ei_read_timer_us();
 
-        uint32_t block_num = impulse->dsp_blocks_size + impulse->learning_blocks_size;
-
-        // smart pointer to features array
-        std::unique_ptr<ei_feature_t[]> features_ptr(new ei_feature_t[block_num]);
-        ei_feature_t* features = features_ptr.get();
-        if (features == nullptr) {
-            ei_printf("ERR: Out of memory, can't allocate features\n");
-            return EI_IMPULSE_ALLOC_FAILED;
-        }
-        memset(features, 0, sizeof(ei_feature_t) * block_num);
-
-        // have it outside of the loop to avoid going out of scope
-        std::unique_ptr<ei::matrix_t> *matrix_ptrs = new std::unique_ptr<ei::matrix_t>[block_num];
-        if (matrix_ptrs == nullptr) {
-            ei_printf("ERR: Out of memory, can't allocate matrix_ptrs\n");
-            return EI_IMPULSE_ALLOC_FAILED;
-        }
+        ei_feature_t* features = ws->features;
+        memset(features, 0, sizeof(ei_feature_t) * ws->features_size);
 
         out_features_index = 0;
         // iterate over every dsp block and run normalization
         for (size_t ix = 0; ix < impulse->dsp_blocks_size; ix++) {
             ei_model_dsp_t block = impulse->dsp_blocks[ix];
-            matrix_ptrs[ix] = std::unique_ptr<ei::matrix_t>(new ei::matrix_t(1, block.n_output_features));
 
-            if (matrix_ptrs[ix] == nullptr) {
-                ei_printf("ERR: Out of memory, can't allocate matrix_ptrs[%lu]\n", (unsigned long)ix);
-                return EI_IMPULSE_ALLOC_FAILED;
-            }
-
-            if (matrix_ptrs[ix]->buffer == nullptr) {
-                ei_printf("ERR: Out of memory, can't allocate matrix_ptrs[%lu]\n", (unsigned long)ix);
-                delete[] matrix_ptrs;
-                return EI_IMPULSE_ALLOC_FAILED;
-            }
-
-            features[ix].matrix = matrix_ptrs[ix].get();
+            features[ix].matrix = &ws->matrices[ix + 1];
             features[ix].blockId = block.blockId;
 
             /* Create a copy of the matrix for normalization */
-            for (size_t m_ix = 0; m_ix < block.n_output_features; m_ix++) {
-                features[ix].matrix->buffer[m_ix] = static_features_matrix.buffer[out_features_index + m_ix];
-            }
+            memcpy(features[ix].matrix->buffer, static_features_matrix.buffer + out_features_index,
+                   block.n_output_features * sizeof(float));
 
             if (block.extract_fn == extract_mfcc_features) {
                 calc_cepstral_mean_and_var_normalization_mfcc(features[ix].matrix, block.config);
@@ -646,7 +792,6 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
         if (ei_impulse_error != EI_IMPULSE_OK) {
             return ei_impulse_error;
         }
-        delete[] matrix_ptrs;
         ei_impulse_error = run_postprocessing(handle, result);
         if (ei_impulse_error != EI_IMPULSE_OK) {
             return ei_impulse_error;
@@ -696,6 +841,86 @@ __attribute__((unused)) static EI_IMPULSE_ERROR can_run_classifier_image_quantiz
     return EI_IMPULSE_OK;
 }
 
+/**
+ * Check if the current impulse could be used by 'run_classifier_features_quantized'
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR can_run_classifier_features_quantized(const ei_impulse_t *impulse, ei_learning_block_t block_ptr) {
+
+    if (impulse->inferencing_engine != EI_CLASSIFIER_TFLITE) {
+        return EI_IMPULSE_UNSUPPORTED_INFERENCING_ENGINE;
+    }
+
+#if EI_CLASSIFIER_HAS_DATA_NORMALIZATION
+    // the normalization block needs the float features
+    return EI_IMPULSE_DSP_ERROR;
+#endif
+
+    // anomaly and other learning blocks also need the float features
+    if (impulse->has_anomaly || impulse->learning_blocks_size != 1) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    if (block_ptr.infer_fn != run_nn_inference) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    ei_learning_block_config_tflite_graph_t *block_config = (ei_learning_block_config_tflite_graph_t*)block_ptr.config;
+    if (block_config->quantized != 1) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    if (impulse->dsp_blocks_size != 1 || impulse->dsp_blocks[0].factory) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    // one MFE or spectrogram block with a per feature normalization (version 3 and up)
+    ei_model_dsp_t block = impulse->dsp_blocks[0];
+    if (block.extract_fn == extract_mfe_features) {
+        ei_dsp_config_mfe_t *config = (ei_dsp_config_mfe_t*)block.config;
+        if (config->implementation_version < 3 || config->implementation_version > 4) {
+            return EI_IMPULSE_DSP_ERROR;
+        }
+    }
+    else if (block.extract_fn == extract_spectrogram_features) {
+        ei_dsp_config_spectrogram_t *config = (ei_dsp_config_spectrogram_t*)block.config;
+        if (config->implementation_version < 3) {
+            return EI_IMPULSE_DSP_ERROR;
+        }
+    }
+    else {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+#if (EI_CLASSIFIER_QUANTIZATION_ENABLED == 1) && (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+/**
+ * Runs the classifier on audio without the float feature matrix, the MFE or
+ * spectrogram features are quantized straight into the input tensor. This only
+ * works if 'can_run_classifier_features_quantized' returns EI_IMPULSE_OK.
+ */
+EI_IMPULSE_ERROR run_classifier_features_quantized(
+    const ei_impulse_t *impulse,
+    signal_t *signal,
+    ei_impulse_result_t *result,
+    bool debug = false)
+{
+#if EIDSP_SIGNAL_C_FN_POINTER
+    if (impulse->dsp_blocks[0].axes_size != impulse->raw_samples_per_frame) {
+        ei_printf("ERR: EIDSP_SIGNAL_C_FN_POINTER can only be used when all axes are selected for DSP blocks\n");
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    auto internal_signal = signal;
+#else
+    SignalWithAxes swa(signal, impulse->dsp_blocks[0].axes, impulse->dsp_blocks[0].axes_size, impulse);
+    auto internal_signal = swa.get_signal();
+#endif
+
+    return run_nn_inference_features_quantized(impulse, internal_signal, 0, result, impulse->learning_blocks[0].config, debug);
+}
+#endif // (EI_CLASSIFIER_QUANTIZATION_ENABLED == 1) && (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+
 #if EI_CLASSIFIER_QUANTIZATION_ENABLED == 1 && (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TENSAIFLOW || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_DRPAI || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_ONNX_TIDL || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_ATON)
 
 /**
@@ -712,6 +937,21 @@ extern "C" EI_IMPULSE_ERROR run_classifier_image_quantized(
     return run_nn_inference_image_quantized(impulse, signal, 0, result, impulse->learning_blocks[0].config, debug);
 }
 
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE)
+/**
+ * Same as above on a native 8 bit image, pixels are quantized straight into
+ * the input tensor (see run_classifier_image).
+ */
+EI_IMPULSE_ERROR run_classifier_image_quantized(
+    const ei_impulse_t *impulse,
+    image_signal_t *image,
+    ei_impulse_result_t *result,
+    bool debug = false)
+{
+    return run_nn_inference_image_quantized(impulse, image, 0, result, impulse->learning_blocks[0].config, debug);
+}
+#endif // EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE
+
 #endif // #if EI_CLASSIFIER_QUANTIZATION_ENABLED == 1 && (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TENSAIFLOW || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_DRPAI)
 
 #if EI_CLASSIFIER_LOAD_IMAGE_SCALING
@@ -865,7 +1105,16 @@ extern "C" void run_classifier_init(void)
 
     classifier_continuous_features_written = 0;
     ei_dsp_clear_continuous_audio_state();
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+    inference_tflite_release();
+#endif
     init_impulse(&ei_default_impulse);
+    // sized once for this impulse, the slices of run_classifier_continuous() reuse it
+    ei_impulse_workspace_free(&ei_default_impulse);
+    if (ei_impulse_has_slice_blocks(ei_default_impulse.impulse)) {
+        ei_impulse_workspace_init(&ei_default_impulse);
+    }
+    ei_dsp_init_audio_blocks(ei_default_impulse.impulse);
     init_postprocessing(&ei_default_impulse);
 #if EI_CLASSIFIER_HAS_DATA_NORMALIZATION
     init_data_normalization(&ei_default_impulse);
@@ -890,7 +1139,16 @@ __attribute__((unused)) void run_classifier_init(ei_impulse_handle_t *handle)
 {
     classifier_continuous_features_written = 0;
     ei_dsp_clear_continuous_audio_state();
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+    inference_tflite_release();
+#endif
     init_impulse(handle);
+    // sized once for this impulse, the slices of run_classifier_continuous() reuse it
+    ei_impulse_workspace_free(handle);
+    if (ei_impulse_has_slice_blocks(handle->impulse)) {
+        ei_impulse_workspace_init(handle);
+    }
+    ei_dsp_init_audio_blocks(handle->impulse);
     init_postprocessing(handle);
 #if EI_CLASSIFIER_HAS_DATA_NORMALIZATION
     init_data_normalization(handle);
@@ -911,16 +1169,48 @@ __attribute__((unused)) void run_classifier_init(ei_impulse_handle_t *handle)
 extern "C" void run_classifier_deinit(void)
 {
     deinit_postprocessing(&ei_default_impulse);
+    ei_impulse_workspace_free(&ei_default_impulse);
+    ei_dsp_free_audio_blocks();
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+    inference_tflite_release();
+#endif
 }
 
 __attribute__((unused)) void run_classifier_deinit(ei_impulse_handle_t *handle)
 {
     deinit_postprocessing(handle);
+    ei_impulse_workspace_free(handle);
+    ei_dsp_free_audio_blocks();
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+    inference_tflite_release();
+#endif
 #if EI_CLASSIFIER_HAS_DATA_NORMALIZATION
     deinit_data_normalization(handle);
 #endif
 }
 
+#if EI_CLASSIFIER_COUNT_ALLOCATIONS == 1
+/**
+ * @brief Number of `ei_malloc()` and `ei_calloc()` calls so far, from the SDK and
+ *  the application.
+ *
+ * Read it before and after a slice of `run_classifier_continuous()` to see the
+ * heap traffic of a slice. The workspace of the classifier is allocated by
+ * run_classifier_init() and reused, the allocations left in a full window come from the
+ * DSP blocks and the inferencing engine. Counted by the porting layer when built with
+ * EI_CLASSIFIER_COUNT_ALLOCATIONS=1, an `ei_malloc()` defined by the
+ * application instead of the porting is not counted.
+ *
+ * **Blocking**: no
+ *
+ * @return Allocation count
+ */
+__attribute__((unused)) uint32_t run_classifier_continuous_allocations(void)
+{
+    return ei_allocation_count;
+}
+#endif // EI_CLASSIFIER_COUNT_ALLOCATIONS == 1
+
 /**
  * @brief Run preprocessing (DSP) on new slice of raw features. Add output features
  *  to rolling matrix and run inference on full sample.
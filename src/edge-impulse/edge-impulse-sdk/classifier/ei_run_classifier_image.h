@@ -37,6 +37,90 @@
 
 #include "ei_run_classifier.h"
 
+#ifdef __cplusplus
+namespace {
+#endif // __cplusplus
 
+static ei::image_signal_t *ei_image_signal_current = nullptr;
+
+/**
+ * @brief      signal_t callback over ei_image_signal_current, packs every pixel
+ *             into a float (0xRRGGBB) for impulses that can't use the native image
+ */
+static int ei_image_signal_get_data(size_t offset, size_t length, float *out_ptr)
+{
+    const ei::image_signal_t *image = ei_image_signal_current;
+
+    for (size_t ix = 0; ix < length; ix++) {
+        const uint8_t *pixel = image->buffer + (offset + ix) * image->channels;
+
+        if (image->channels == 3) {
+            out_ptr[ix] = (float)((pixel[0] << 16) + (pixel[1] << 8) + pixel[2]);
+        }
+        else {
+            out_ptr[ix] = (float)((pixel[0] << 16) + (pixel[0] << 8) + pixel[0]);
+        }
+    }
+
+    return EIDSP_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+/**
+ * @brief Run the classifier on a native 8 bit image (packed RGB888 or grayscale).
+ *
+ * For quantized image models (see can_run_classifier_image_quantized) the pixels
+ * are normalized and quantized straight into the input tensor, without the
+ * float packed signal_t in between. Any other impulse falls back to
+ * process_impulse with a signal_t over the image, so results are the same as
+ * with run_classifier either way.
+ *
+ * @param[in] handle Pointer to an `ei_impulse_handle_t` struct
+ * @param[in] image Image of input_width * input_height pixels
+ * @param[out] result Pointer to an `ei_impulse_result_t` struct that will contain the results
+ * @param[in] debug Print internal preprocessing and inference debugging information via `ei_printf()`
+ *
+ * @return Error code as defined by `EI_IMPULSE_ERROR` enum. Will be `EI_IMPULSE_OK` if inference
+ *  completed successfully.
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR run_classifier_image(
+    ei_impulse_handle_t *handle,
+    ei::image_signal_t *image,
+    ei_impulse_result_t *result,
+    bool debug = false)
+{
+    if ((handle == nullptr) || (handle->impulse == nullptr) || (image == nullptr) || (image->buffer == nullptr)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    if (image->width * image->height != handle->impulse->input_width * handle->impulse->input_height) {
+        ei_printf("ERR: Image is %lux%lu, impulse expects %lux%lu\n",
+            (unsigned long)image->width, (unsigned long)image->height,
+            (unsigned long)handle->impulse->input_width, (unsigned long)handle->impulse->input_height);
+        return EI_IMPULSE_INVALID_SIZE;
+    }
+
+    ei_image_signal_current = image;
+
+    signal_t signal;
+    signal.total_length = image->width * image->height;
+    signal.get_data = &ei_image_signal_get_data;
+
+    return process_impulse_impl(handle, &signal, image, result, debug);
+}
+
+/**
+ * @brief Run the default impulse on a native 8 bit image, see above
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR run_classifier_image(
+    ei::image_signal_t *image,
+    ei_impulse_result_t *result,
+    bool debug = false)
+{
+    return run_classifier_image(&ei_default_impulse, image, result, debug);
+}
 
 #endif // _EDGE_IMPULSE_RUN_CLASSIFIER_IMAGE_H_
@@ -36,6 +36,7 @@
 #define _EDGE_IMPULSE_RUN_DSP_H_
 
 #include "edge-impulse-sdk/classifier/ei_model_types.h"
+#include "edge-impulse-sdk/classifier/ei_quantize.h"
 #include "edge-impulse-sdk/dsp/spectral/spectral.hpp"
 #include "edge-impulse-sdk/dsp/speechpy/speechpy.hpp"
 #include "edge-impulse-sdk/classifier/ei_signal_with_range.h"
@@ -864,6 +865,217 @@ __attribute__((unused)) int extract_mfe_features(signal_t *signal, matrix_t *out
     return EIDSP_OK;
 }
 
+// frames of float features kept in memory by the *_features_quantized functions
+#ifndef EI_DSP_QUANTIZED_FEATURES_ROWS
+#define EI_DSP_QUANTIZED_FEATURES_ROWS 8
+#endif
+
+typedef int (*extract_frames_fn_t)(signal_t *frames, matrix_t *output_matrix, void *config_ptr, const float sampling_frequency);
+
+// window over a few frames of the signal, see extract_frames_quantized
+static signal_t *frames_window_signal;
+static size_t frames_window_offset;
+static int frames_window_get_data(size_t offset, size_t length, float *out_ptr) {
+    return frames_window_signal->get_data(frames_window_offset + offset, length, out_ptr);
+}
+
+/**
+ * Runs a framed audio block EI_DSP_QUANTIZED_FEATURES_ROWS frames at a time
+ * and quantizes every chunk straight into output (normally the input tensor,
+ * int8_t or int16_t), so the float feature matrix is never allocated. Only
+ * valid when the normalization of the block is per feature.
+ * output_size is the number of elements output holds, on return the number of
+ * features written.
+ * If lut is set the features are multiples of 1/256 in [0, 1] and lut[f * 256]
+ * is the quantized value, otherwise they are quantized with scale and zero_point.
+ */
+template<typename T>
+static int extract_frames_quantized(signal_t *signal, T *output, size_t *output_size, extract_frames_fn_t extract_frames,
+                                    void *config_ptr, const float sampling_frequency, float frame_length, float frame_stride,
+                                    uint16_t version, size_t cols, const T *lut, float scale, int32_t zero_point) {
+    // stack_frames trims the signal length, so frame a copy
+    signal_t framed_signal = *signal;
+    speechpy::stack_frames_info_t frames_info = { 0 };
+    frames_info.signal = &framed_signal;
+
+    int ret = speechpy::processing::stack_frames(&frames_info, sampling_frequency, frame_length, frame_stride,
+        false, version);
+    if (ret != EIDSP_OK) {
+        EIDSP_ERR(ret);
+    }
+
+    const size_t rows = frames_info.frame_ixs.size();
+    if (rows * cols > *output_size) {
+        ei_printf("output size = %d\n", (int)*output_size);
+        ei_printf("calculated size = %dx%d\n", (int)rows, (int)cols);
+        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+    }
+
+    EI_DSP_MATRIX(features, EI_DSP_QUANTIZED_FEATURES_ROWS, cols);
+
+    signal_t frames_window;
+    frames_window.get_data = &frames_window_get_data;
+    frames_window_signal = signal;
+
+    T *out_ptr = output;
+
+    for (size_t row = 0; row < rows; row += EI_DSP_QUANTIZED_FEATURES_ROWS) {
+        const size_t chunk_rows = rows - row > EI_DSP_QUANTIZED_FEATURES_ROWS ? EI_DSP_QUANTIZED_FEATURES_ROWS : rows - row;
+
+        // the window holds exactly chunk_rows frames
+        frames_window_offset = frames_info.frame_ixs[row];
+        frames_window.total_length = frames_info.frame_ixs[row + chunk_rows - 1] - frames_window_offset +
+            frames_info.frame_length;
+        features.rows = chunk_rows;
+
+        ret = extract_frames(&frames_window, &features, config_ptr, sampling_frequency);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        const size_t chunk_size = chunk_rows * cols;
+        if (lut) {
+            for (size_t ix = 0; ix < chunk_size; ix++) {
+                *out_ptr++ = lut[static_cast<int>(features.buffer[ix] * 256.0f)];
+            }
+        }
+        else {
+            for (size_t ix = 0; ix < chunk_size; ix++) {
+                *out_ptr++ = quantize_as<T>(features.buffer[ix], scale, zero_point);
+            }
+        }
+    }
+
+    *output_size = rows * cols;
+
+    return EIDSP_OK;
+}
+
+static int extract_mfe_frames(signal_t *frames, matrix_t *output_matrix, void *config_ptr, const float sampling_frequency) {
+    ei_dsp_config_mfe_t *config = (ei_dsp_config_mfe_t*)config_ptr;
+
+    int ret = speechpy::feature::mfe(output_matrix, nullptr, frames,
+        static_cast<uint32_t>(sampling_frequency), config->frame_length, config->frame_stride, config->num_filters,
+        config->fft_length, config->low_frequency, config->high_frequency, config->implementation_version);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: MFE failed (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    return speechpy::processing::mfe_normalization(output_matrix, config->noise_floor_db);
+}
+
+/**
+ * MFE block that quantizes straight into output (int8_t or int16_t, see
+ * extract_frames_quantized), bit for bit the same as extract_mfe_features
+ * followed by quantizing the features with scale and zero_point. Only
+ * implementation version 3 and up (the earlier versions normalize over the
+ * whole matrix).
+ */
+template<typename T>
+int extract_mfe_features_quantized(signal_t *signal, T *output, size_t *output_size, void *config_ptr, float scale, int32_t zero_point, const float sampling_frequency) {
+    ei_dsp_config_mfe_t config = *((ei_dsp_config_mfe_t*)config_ptr);
+
+    if (config.axes != 1) {
+        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+    }
+
+    if (signal->total_length == 0) {
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
+
+    if ((config.implementation_version < 3) || (config.implementation_version > 4)) {
+        EIDSP_ERR(EIDSP_BLOCK_VERSION_INCORRECT);
+    }
+
+    // mfe_normalization rounds to 1/256 steps, so 257 possible values
+    T lut[257];
+    for (int ix = 0; ix <= 256; ix++) {
+        lut[ix] = quantize_as<T>(static_cast<float>(ix) / 256.0f, scale, zero_point);
+    }
+
+    // on the stack, released on every return
+    class speechpy::processing::preemphasis pre(signal, 1, 0.98f, true);
+    preemphasis = &pre;
+
+    signal_t preemphasized_audio_signal;
+    preemphasized_audio_signal.total_length = signal->total_length;
+    preemphasized_audio_signal.get_data = &preemphasized_audio_signal_get_data;
+
+    int ret = extract_frames_quantized<T>(&preemphasized_audio_signal, output, output_size, &extract_mfe_frames, &config,
+        sampling_frequency, config.frame_length, config.frame_stride, config.implementation_version,
+        config.num_filters, lut, scale, zero_point);
+
+    preemphasis = nullptr;
+
+    return ret;
+}
+
+__attribute__((unused)) int extract_mfe_features_quantized(signal_t *signal, matrix_i8_t *output_matrix, void *config_ptr, float scale, int32_t zero_point, const float sampling_frequency) {
+    size_t output_size = output_matrix->rows * output_matrix->cols;
+
+    int ret = extract_mfe_features_quantized<int8_t>(signal, output_matrix->buffer, &output_size, config_ptr, scale,
+        zero_point, sampling_frequency);
+    if (ret == EIDSP_OK) {
+        output_matrix->rows = 1;
+        output_matrix->cols = output_size;
+    }
+
+    return ret;
+}
+
+static int extract_spectrogram_frames(signal_t *frames, matrix_t *output_matrix, void *config_ptr, const float sampling_frequency) {
+    ei_dsp_config_spectrogram_t *config = (ei_dsp_config_spectrogram_t*)config_ptr;
+
+    int ret = speechpy::feature::spectrogram(output_matrix, frames,
+        sampling_frequency, config->frame_length, config->frame_stride, config->fft_length, config->implementation_version);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Spectrogram failed (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    return speechpy::processing::spectrogram_normalization(output_matrix, config->noise_floor_db,
+        config->implementation_version == 3);
+}
+
+/**
+ * Spectrogram block that quantizes straight into output, see
+ * extract_mfe_features_quantized. Only implementation version 3 and up.
+ */
+template<typename T>
+int extract_spectrogram_features_quantized(signal_t *signal, T *output, size_t *output_size, void *config_ptr, float scale, int32_t zero_point, const float sampling_frequency) {
+    ei_dsp_config_spectrogram_t config = *((ei_dsp_config_spectrogram_t*)config_ptr);
+
+    if (config.axes != 1) {
+        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+    }
+
+    if (signal->total_length == 0) {
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
+
+    if (config.implementation_version < 3) {
+        EIDSP_ERR(EIDSP_BLOCK_VERSION_INCORRECT);
+    }
+
+    return extract_frames_quantized<T>(signal, output, output_size, &extract_spectrogram_frames, &config,
+        sampling_frequency, config.frame_length, config.frame_stride, config.implementation_version,
+        config.fft_length / 2 + 1, nullptr, scale, zero_point);
+}
+
+__attribute__((unused)) int extract_spectrogram_features_quantized(signal_t *signal, matrix_i8_t *output_matrix, void *config_ptr, float scale, int32_t zero_point, const float sampling_frequency) {
+    size_t output_size = output_matrix->rows * output_matrix->cols;
+
+    int ret = extract_spectrogram_features_quantized<int8_t>(signal, output_matrix->buffer, &output_size, config_ptr,
+        scale, zero_point, sampling_frequency);
+    if (ret == EIDSP_OK) {
+        output_matrix->rows = 1;
+        output_matrix->cols = output_size;
+    }
+
+    return ret;
+}
+
 __attribute__((unused)) static int extract_mfe_run_slice(signal_t *signal, matrix_t *output_matrix, ei_dsp_config_mfe_t *config, const float sampling_frequency, matrix_size_t *matrix_size_out) {
     uint32_t frequency = (uint32_t)sampling_frequency;
 
@@ -1398,6 +1610,166 @@ __attribute__((unused)) int extract_image_features_quantized(signal_t *signal, m
     }
     return EIDSP_OK;
 }
+
+/**
+ * Same as above, but reads a native 8 bit image (packed RGB888 or grayscale)
+ * instead of a signal with one float packed pixel per sample. Pixels are
+ * quantized straight into the output matrix (normally the input tensor), the
+ * output is bit for bit the same as the signal_t version.
+ */
+__attribute__((unused)) int extract_image_features_quantized(image_signal_t *image, matrix_i8_t *output_matrix, void *config_ptr, float scale, float zero_point, const float frequency,
+                                                             int image_scaling) {
+    (void)frequency;
+    ei_dsp_config_image_t config = *((ei_dsp_config_image_t*)config_ptr);
+
+    int16_t channel_count = strcmp(config.channels, "Grayscale") == 0 ? 1 : 3;
+
+    const size_t pixel_count = (size_t)image->width * image->height;
+
+    if (image->buffer == nullptr || (image->channels != 1 && image->channels != 3)) {
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
+    if (output_matrix->rows * output_matrix->cols < pixel_count * channel_count) {
+        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+    }
+
+    const int32_t iRedToGray = (int32_t)(0.299f * 65536.0f);
+    const int32_t iGreenToGray = (int32_t)(0.587f * 65536.0f);
+    const int32_t iBlueToGray = (int32_t)(0.114f * 65536.0f);
+
+    static const float torch_mean[] = { 0.485, 0.456, 0.406 };
+    static const float torch_std[] = { 0.229, 0.224, 0.225 };
+
+    const bool fast_path = (scale == 0.003921568859368563f && zero_point == -128 && image_scaling == EI_CLASSIFIER_IMAGE_SCALING_NONE);
+
+    const uint8_t *in = image->buffer;
+    int8_t *out = output_matrix->buffer;
+    // a grayscale image is read as r = g = b
+    const size_t in_step = image->channels;
+    const size_t g_offset = image->channels == 3 ? 1 : 0;
+    const size_t b_offset = image->channels == 3 ? 2 : 0;
+
+    if (channel_count == 3) {
+        if (fast_path && image->channels == 3) {
+            // (v - 128) as int8 is v with the top bit flipped, 4 bytes at a time
+            const size_t byte_count = pixel_count * 3;
+            size_t ix = 0;
+            for (; ix + 4 <= byte_count; ix += 4) {
+                uint32_t word;
+                memcpy(&word, in + ix, sizeof(word));
+                word ^= 0x80808080;
+                memcpy(out + ix, &word, sizeof(word));
+            }
+            for (; ix < byte_count; ix++) {
+                out[ix] = static_cast<int8_t>(in[ix] ^ 0x80);
+            }
+        }
+        else if (fast_path) {
+            for (size_t ix = 0; ix < pixel_count; ix++) {
+                int8_t v = static_cast<int8_t>(in[ix] ^ 0x80);
+                *out++ = v;
+                *out++ = v;
+                *out++ = v;
+            }
+        }
+        else {
+            // every channel value maps to one quantized value, so build a
+            // lookup table once per quantization parameters. lut_valid is only
+            // set once the table is complete, a build that didn't finish (or a
+            // zero scale) never leaves a table that looks up to date
+            static int8_t lut[3][256];
+            static bool lut_valid = false;
+            static float lut_scale;
+            static float lut_zero_point;
+            static int lut_image_scaling;
+
+            if (scale == 0.0f) {
+                EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+            }
+
+            if (!lut_valid || lut_scale != scale || lut_zero_point != zero_point || lut_image_scaling != image_scaling) {
+                lut_valid = false;
+                for (int ch = 0; ch < 3; ch++) {
+                    for (int v = 0; v < 256; v++) {
+                        float c = static_cast<float>(v);
+
+                        if (image_scaling == EI_CLASSIFIER_IMAGE_SCALING_NONE) {
+                            c /= 255.0f;
+                        }
+                        else if (image_scaling == EI_CLASSIFIER_IMAGE_SCALING_TORCH) {
+                            c /= 255.0f;
+                            c = (c - torch_mean[ch]) / torch_std[ch];
+                        }
+                        else if (image_scaling == EI_CLASSIFIER_IMAGE_SCALING_MIN128_127) {
+                            c -= 128.0f;
+                        }
+
+                        lut[ch][v] = static_cast<int8_t>(round(c / scale) + zero_point);
+                    }
+                }
+                lut_scale = scale;
+                lut_zero_point = zero_point;
+                lut_image_scaling = image_scaling;
+                lut_valid = true;
+            }
+
+            for (size_t ix = 0; ix < pixel_count; ix++, in += in_step) {
+                *out++ = lut[0][in[0]];
+                *out++ = lut[1][in[g_offset]];
+                *out++ = lut[2][in[b_offset]];
+            }
+        }
+    }
+    else {
+        for (size_t ix = 0; ix < pixel_count; ix++, in += in_step) {
+            if (fast_path) {
+                int32_t r = static_cast<int32_t>(in[0]);
+                int32_t g = static_cast<int32_t>(in[g_offset]);
+                int32_t b = static_cast<int32_t>(in[b_offset]);
+
+                // ITU-R 601-2 luma transform
+                // see: https://pillow.readthedocs.io/en/stable/reference/Image.html#PIL.Image.Image.convert
+                int32_t gray = (iRedToGray * r) + (iGreenToGray * g) + (iBlueToGray * b);
+                gray >>= 16; // scale down to int8_t
+                gray -= 128;
+                if (gray < - 128) gray = -128;
+                else if (gray > 127) gray = 127;
+                *out++ = static_cast<int8_t>(gray);
+            }
+            else {
+                float r = static_cast<float>(in[0]);
+                float g = static_cast<float>(in[g_offset]);
+                float b = static_cast<float>(in[b_offset]);
+
+                if (image_scaling == EI_CLASSIFIER_IMAGE_SCALING_NONE) {
+                    r /= 255.0f;
+                    g /= 255.0f;
+                    b /= 255.0f;
+                }
+                else if (image_scaling == EI_CLASSIFIER_IMAGE_SCALING_TORCH) {
+                    r /= 255.0f;
+                    g /= 255.0f;
+                    b /= 255.0f;
+
+                    r = (r - torch_mean[0]) / torch_std[0];
+                    g = (g - torch_mean[1]) / torch_std[1];
+                    b = (b - torch_mean[2]) / torch_std[2];
+                }
+                else if (image_scaling == EI_CLASSIFIER_IMAGE_SCALING_MIN128_127) {
+                    r -= 128.0f;
+                    g -= 128.0f;
+                    b -= 128.0f;
+                }
+
+                // ITU-R 601-2 luma transform
+                float v = (0.299f * r) + (0.587f * g) + (0.114f * b);
+                *out++ = static_cast<int8_t>(round(v / scale) + zero_point);
+            }
+        }
+    }
+
+    return EIDSP_OK;
+}
 #endif // (EI_CLASSIFIER_QUANTIZATION_ENABLED == 1) && (EI_CLASSIFIER_INFERENCING_ENGINE != EI_CLASSIFIER_DRPAI)
 
 /**
@@ -1415,6 +1787,83 @@ __attribute__((unused)) int ei_dsp_clear_continuous_audio_state() {
     return EIDSP_OK;
 }
 
+/**
+ * Build the Mel filterbanks of the MFE and MFCC blocks and the frame workspaces
+ * (frame buffers and FFT) of the MFE, MFCC and spectrogram blocks of an impulse,
+ * so the first inference doesn't have to. They stay cached until ei_dsp_free_audio_blocks().
+ */
+__attribute__((unused)) int ei_dsp_init_audio_blocks(const ei_impulse_t *impulse) {
+    const uint32_t frequency = static_cast<uint32_t>(impulse->frequency);
+
+    for (size_t ix = 0; ix < impulse->dsp_blocks_size; ix++) {
+        const ei_model_dsp_t *block = &impulse->dsp_blocks[ix];
+        const speechpy::mel_filterbank_t *filterbank = nullptr;
+        speechpy::frame_workspace_t *workspace = nullptr;
+        int ret;
+        int frame_length;
+
+        if (block->extract_fn == extract_mfe_features) {
+            ei_dsp_config_mfe_t *config = (ei_dsp_config_mfe_t *)block->config;
+            // v1 and v2 go through mfe_v3(), see extract_mfe_features()
+            ret = speechpy::mel_filterbank::acquire(&filterbank,
+                config->implementation_version > 2 ? speechpy::MEL_FILTERBANK_MFE : speechpy::MEL_FILTERBANK_SPEECHPY,
+                frequency, config->fft_length, config->num_filters, config->low_frequency, config->high_frequency,
+                config->implementation_version);
+            frame_length = speechpy::processing::calculate_frame_sample_length(frequency, config->frame_length,
+                config->implementation_version);
+            if (ret == EIDSP_OK) {
+                ret = speechpy::frame_engine::acquire(&workspace, frame_length, config->fft_length);
+            }
+        }
+        else if (block->extract_fn == extract_mfcc_features) {
+            ei_dsp_config_mfcc_t *config = (ei_dsp_config_mfcc_t *)block->config;
+            ret = speechpy::mel_filterbank::acquire(&filterbank, speechpy::MEL_FILTERBANK_MFE,
+                frequency, config->fft_length, config->num_filters, config->low_frequency, config->high_frequency,
+                config->implementation_version);
+            frame_length = speechpy::processing::calculate_frame_sample_length(frequency, config->frame_length,
+                config->implementation_version);
+            if (ret == EIDSP_OK) {
+                ret = speechpy::frame_engine::acquire(&workspace, frame_length, config->fft_length);
+            }
+            // and the DCT of the filter energies, see feature::mfcc()
+            if (ret == EIDSP_OK) {
+                speechpy::frame_engine::release(workspace);
+                workspace = nullptr;
+                ret = speechpy::frame_engine::acquire(&workspace, config->num_filters, config->num_filters);
+            }
+        }
+        else if (block->extract_fn == extract_spectrogram_features) {
+            ei_dsp_config_spectrogram_t *config = (ei_dsp_config_spectrogram_t *)block->config;
+            // extract_spectrogram_features() frames with the frequency as a float
+            frame_length = speechpy::processing::calculate_frame_sample_length(impulse->frequency, config->frame_length,
+                config->implementation_version);
+            ret = speechpy::frame_engine::acquire(&workspace, frame_length, config->fft_length);
+        }
+        else {
+            continue;
+        }
+
+        speechpy::mel_filterbank::release(filterbank);
+        speechpy::frame_engine::release(workspace);
+        if (ret != EIDSP_OK) {
+            ei_printf("ERR: Failed to set up the audio DSP block (%d)\n", ret);
+            return ret;
+        }
+    }
+
+    return EIDSP_OK;
+}
+
+/**
+ * Free the Mel filterbanks and frame workspaces cached by ei_dsp_init_audio_blocks()
+ * and the MFE, MFCC and spectrogram blocks, and the buffer of their normalization.
+ */
+__attribute__((unused)) void ei_dsp_free_audio_blocks() {
+    speechpy::mel_filterbank::clear();
+    speechpy::frame_engine::clear();
+    speechpy::processing::cmvnw_buffer::clear();
+}
+
 /**
  * @brief      Calculates the cepstral mean and variable normalization.
  *
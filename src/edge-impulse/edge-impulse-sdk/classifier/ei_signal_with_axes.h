@@ -37,6 +37,7 @@
 
 #include "edge-impulse-sdk/dsp/numpy_types.h"
 #include "edge-impulse-sdk/dsp/returntypes.hpp"
+#include "edge-impulse-sdk/dsp/ei_signal_adaptor.h"
 #include "edge-impulse-sdk/classifier/ei_model_types.h"
 
 #if !EIDSP_SIGNAL_C_FN_POINTER
@@ -46,50 +47,43 @@ using namespace ei;
 class SignalWithAxes {
 public:
     SignalWithAxes(signal_t *original_signal, EI_CLASSIFIER_DSP_AXES_INDEX_TYPE *axes, size_t axes_count, const ei_impulse_t *impulse):
-        _original_signal(original_signal), _axes(axes), _axes_count(axes_count), _impulse(impulse)
+        _original_signal(original_signal), _axes(axes), _axes_count(axes_count), _impulse(impulse),
+        _gather(original_signal, impulse->raw_samples_per_frame, axes, axes_count)
     {
 
     }
 
     signal_t * get_signal() {
-        if (this->_axes_count == _impulse->raw_samples_per_frame) {
+        if (this->all_axes_in_order()) {
             return this->_original_signal;
         }
 
-        wrapped_signal.total_length = _original_signal->total_length / _impulse->raw_samples_per_frame * _axes_count;
-#ifdef __MBED__
-        wrapped_signal.get_data = mbed::callback(this, &SignalWithAxes::get_data);
-#else
-        wrapped_signal.get_data = [this](size_t offset, size_t length, float *out_ptr) {
-            return this->get_data(offset, length, out_ptr);
-        };
-#endif
+        _gather.wrap(&wrapped_signal);
         return &wrapped_signal;
     }
 
     int get_data(size_t offset, size_t length, float *out_ptr) {
-        size_t offset_on_original_signal = offset / _axes_count * _impulse->raw_samples_per_frame;
-        size_t length_on_original_signal = length / _axes_count * _impulse->raw_samples_per_frame;
-
-        size_t out_ptr_ix = 0;
+        return _gather.get_data(offset, length, out_ptr);
+    }
 
-        for (size_t ix = offset_on_original_signal; ix < offset_on_original_signal + length_on_original_signal; ix += _impulse->raw_samples_per_frame) {
-            for (size_t axis_ix = 0; axis_ix < this->_axes_count; axis_ix++) {
-                int r = _original_signal->get_data(ix + _axes[axis_ix], 1, &out_ptr[out_ptr_ix++]);
-                if (r != 0) {
-                    return r;
-                }
+private:
+    bool all_axes_in_order() {
+        if (this->_axes_count != _impulse->raw_samples_per_frame) {
+            return false;
+        }
+        for (size_t axis_ix = 0; axis_ix < this->_axes_count; axis_ix++) {
+            if (_axes[axis_ix] != axis_ix) {
+                return false;
             }
         }
-
-        return 0;
+        return true;
     }
 
-private:
     signal_t *_original_signal;
     EI_CLASSIFIER_DSP_AXES_INDEX_TYPE *_axes;
     size_t _axes_count;
     const ei_impulse_t *_impulse;
+    signal_gather<EI_CLASSIFIER_DSP_AXES_INDEX_TYPE> _gather;
     signal_t wrapped_signal;
 };
 
@@ -45,6 +45,7 @@
 
 #include "edge-impulse-sdk/classifier/ei_classifier_types.h"
 #include "edge-impulse-sdk/classifier/ei_aligned_malloc.h"
+#include "edge-impulse-sdk/classifier/ei_anomaly_kmeans.h"
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
 #include "edge-impulse-sdk/classifier/inferencing_engines/engines.h"
 
@@ -62,43 +63,19 @@ namespace {
  * @param input_size Size of input, scale and mean arrays
  */
 static void standard_scaler(float *input, const float *scale, const float *mean, size_t input_size) {
-    for (size_t ix = 0; ix < input_size; ix++) {
-        input[ix] = (input[ix] - mean[ix]) / scale[ix];
-    }
+    ei_anomaly_standard_scaler(input, scale, mean, input_size);
 }
 
 /**
- * Calculate the distance between input vector and the cluster
- * @param input Array of input values (already scaled by standard_scaler)
- * @param input_size Size of the input array
- * @param cluster A cluster (number of centroids should match input_size)
- */
-static float calculate_cluster_distance(float *input, size_t input_size, const ei_classifier_anom_cluster_t *cluster) {
-    // todo: check input_size and centroid size?
-
-    float dist = 0.0f;
-    for (size_t ix = 0; ix < input_size; ix++) {
-        dist += pow(input[ix] - cluster->centroid[ix], 2);
-    }
-    return sqrt(dist) - cluster->max_error;
-}
-
-/**
- * Get minimum distance to a cluster
+ * Get minimum distance to a cluster, clusters that can't beat the minimum so
+ * far are left before their distance is complete
  * @param input Array of input values (already scaled by standard_scaler)
  * @param input_size Size of the input array
  * @param clusters Array of clusters
  * @param cluster_size Size of cluster array
  */
 static float get_min_distance_to_cluster(float *input, size_t input_size, const ei_classifier_anom_cluster_t *clusters, size_t cluster_size) {
-    float min = 1000.0f;
-    for (size_t ix = 0; ix < cluster_size; ix++) {
-        float dist = calculate_cluster_distance(input, input_size, &clusters[ix]);
-        if (dist < min) {
-            min = dist;
-        }
-    }
-    return min;
+    return ei_anomaly_min_cluster_distance(input, input_size, clusters, cluster_size, 1000.0f);
 }
 #endif // EI_CLASSIFIER_HAS_ANOMALY_KMEANS
 
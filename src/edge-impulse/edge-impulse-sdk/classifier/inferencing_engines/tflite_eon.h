@@ -285,8 +285,21 @@ EI_IMPULSE_ERROR run_nn_inference(
                 }
                 break;
             }
+#if EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
+            case kTfLiteInt16: {
+                // there is no int16 raw output, int16 outputs go through the
+                // float postprocessing
+                if (!block_config->dequantize_output) {
+                    ei_printf("ERR: int16 outputs need dequantize_output (float postprocessing)\n");
+                    return EI_IMPULSE_OUTPUT_TENSOR_WAS_NULL;
+                }
+                result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
+                fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
+                break;
+            }
+#endif // EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
             default: {
-                ei_printf("ERR: Cannot handle output type (%d)\n", output->type);
+                print_unsupported_tensor_type("output", output->type);
                 return EI_IMPULSE_OUTPUT_TENSOR_WAS_NULL;
             }
         }
@@ -309,10 +322,12 @@ EI_IMPULSE_ERROR run_nn_inference(
  * Special function to run the classifier on images, only works on TFLite models (either interpreter or EON or for tensaiflow)
  * that allocates a lot less memory by quantizing in place. This only works if 'can_run_classifier_image_quantized'
  * returns EI_IMPULSE_OK.
+ * signal_type is either a float packed signal_t or a native 8 bit image_signal_t.
  */
+template<typename signal_type>
 EI_IMPULSE_ERROR run_nn_inference_image_quantized(
     const ei_impulse_t *impulse,
-    signal_t *signal,
+    signal_type *signal,
     uint32_t learn_block_index,
     ei_impulse_result_t *result,
     void *config_ptr,
@@ -421,8 +436,21 @@ EI_IMPULSE_ERROR run_nn_inference_image_quantized(
                 }
                 break;
             }
+#if EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
+            case kTfLiteInt16: {
+                // there is no int16 raw output, int16 outputs go through the
+                // float postprocessing
+                if (!block_config->dequantize_output) {
+                    ei_printf("ERR: int16 outputs need dequantize_output (float postprocessing)\n");
+                    return EI_IMPULSE_OUTPUT_TENSOR_WAS_NULL;
+                }
+                result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
+                fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
+                break;
+            }
+#endif // EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
             default: {
-                ei_printf("ERR: Cannot handle output type (%d)\n", output->type);
+                print_unsupported_tensor_type("output", output->type);
                 return EI_IMPULSE_OUTPUT_TENSOR_WAS_NULL;
             }
         }
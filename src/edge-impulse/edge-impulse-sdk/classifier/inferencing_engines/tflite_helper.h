@@ -54,6 +54,26 @@
 #include "edge-impulse-sdk/tensorflow/lite/schema/schema_generated.h"
 #endif // EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE
 
+/**
+ * Size of an element of the tensor in bytes, for the types handled below
+ */
+static inline size_t tensor_element_size(TfLiteTensor *tensor) {
+    switch (tensor->type) {
+        case kTfLiteFloat32: return 4;
+        case kTfLiteInt16: return 2;
+        default: return 1;
+    }
+}
+
+static inline void print_unsupported_tensor_type(const char *name, TfLiteType type) {
+    ei_printf("ERR: Cannot handle %s type (%d)\n", name, type);
+#if EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS != 1
+    if (type == kTfLiteInt16) {
+        ei_printf("ERR: Models with int16 activations need EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS=1\n");
+    }
+#endif
+}
+
 EI_IMPULSE_ERROR fill_input_tensor_from_matrix(
     ei_feature_t *fmatrix,
     ei_feature_t *omatrix,
@@ -105,14 +125,24 @@ EI_IMPULSE_ERROR fill_input_tensor_from_matrix(
                         pre_cast_quantize(val, input->params.scale, input->params.zero_point, false));            }
                 break;
             }
+#if EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
+            case kTfLiteInt16: {
+                for (size_t ix = 0; ix < matrix->rows * matrix->cols; ix++) {
+                    float val = (float)matrix->buffer[ix];
+                    input->data.i16[input_idx++] = static_cast<int16_t>(
+                        pre_cast_quantize_i16(val, input->params.scale, input->params.zero_point));
+                }
+                break;
+            }
+#endif // EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
             default: {
-                ei_printf("ERR: Cannot handle input type (%d)\n", input->type);
+                print_unsupported_tensor_type("input", input->type);
                 return EI_IMPULSE_INPUT_TENSOR_WAS_NULL;
             }
         }
     }
 
-    if (input->bytes / 4 != matrix_els && input->bytes != matrix_els) {
+    if (input->bytes / tensor_element_size(input) != matrix_els) {
         ei_printf("ERR: input tensor has size %d bytes, but input matrix has has size %d bytes\n",
             (int)input->bytes, (int)matrix_els);
         return EI_IMPULSE_INVALID_SIZE;
@@ -235,8 +265,42 @@ EI_IMPULSE_ERROR fill_input_tensor_from_signal(
             }
             break;
         }
+#if EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
+        case kTfLiteInt16: {
+            // no images with int16 activations, expect an exact match in length
+            if (input->bytes / 2 != signal->total_length) {
+                ei_printf("ERR: input tensor has size %d, but signal has size %d\n",
+                    (int)input->bytes / 2, (int)signal->total_length);
+                return EI_IMPULSE_INVALID_SIZE;
+            }
+
+            float scale = input->params.scale;
+            if (scale == 0.0f) { // not quantized?
+                scale = 1.0f;
+            }
+
+            const size_t page_size = 1024;
+            matrix_t input_matrix(page_size, 1);
+            if (!input_matrix.buffer) {
+                return EI_IMPULSE_ALLOC_FAILED;
+            }
+
+            // buffered read from the signal
+            for (size_t ix = 0; ix < signal->total_length; ix += page_size) {
+                size_t elements_to_read = signal->total_length - ix > page_size ? page_size : signal->total_length - ix;
+
+                signal->get_data(ix, elements_to_read, input_matrix.buffer);
+
+                for (size_t jx = 0; jx < elements_to_read; jx++) {
+                    input->data.i16[ix + jx] = static_cast<int16_t>(
+                        pre_cast_quantize_i16(input_matrix.buffer[jx], scale, input->params.zero_point));
+                }
+            }
+            break;
+        }
+#endif // EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
         default: {
-            ei_printf("ERR: Cannot handle input type (%d)\n", input->type);
+            print_unsupported_tensor_type("input", input->type);
             return EI_IMPULSE_INPUT_TENSOR_WAS_NULL;
         }
     }
@@ -287,8 +351,23 @@ EI_IMPULSE_ERROR fill_output_matrix_from_tensor(
             }
             break;
         }
+#if EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
+        case kTfLiteInt16: {
+            if (output->bytes / 2 != matrix_els) {
+                ei_printf("ERR: output tensor has size %d, but input matrix has has size %d\n",
+                    (int)output->bytes / 2, (int)matrix_els);
+                return EI_IMPULSE_INVALID_SIZE;
+            }
+
+            for (size_t ix = 0; ix < matrix_els; ix++) {
+                float value = static_cast<float>(output->data.i16[ix] - output->params.zero_point) * output->params.scale;
+                output_matrix->buffer[ix] = value;
+            }
+            break;
+        }
+#endif // EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
         default: {
-            ei_printf("ERR: Cannot handle output type (%d)\n", output->type);
+            print_unsupported_tensor_type("output", output->type);
             return EI_IMPULSE_OUTPUT_TENSOR_WAS_NULL;
         }
     }
@@ -48,12 +48,19 @@
 #include "edge-impulse-sdk/classifier/ei_model_types.h"
 #include "edge-impulse-sdk/classifier/inferencing_engines/tflite_helper.h"
 
-#if defined(EI_CLASSIFIER_HAS_TFLITE_OPS_RESOLVER) && EI_CLASSIFIER_HAS_TFLITE_OPS_RESOLVER == 1
+#if defined(EI_TFLITE_GENERATED_RESOLVER) && EI_TFLITE_GENERATED_RESOLVER == 1
+// generated at build time from the model (firmware-sdk/tools/gen_op_resolver.cpp),
+// matches the kernels compiled in
+#include "ei_tflite_op_resolver.h"
+#elif defined(EI_CLASSIFIER_HAS_TFLITE_OPS_RESOLVER) && EI_CLASSIFIER_HAS_TFLITE_OPS_RESOLVER == 1
 #include "tflite-model/tflite-resolver.h"
 #endif // EI_CLASSIFIER_HAS_TFLITE_OPS_RESOLVER
 
 #ifdef EI_CLASSIFIER_ENABLE_PROFILER
 #include "edge-impulse-sdk/tensorflow/lite/micro/micro_profiler.h"
+#elif defined(EI_CLASSIFIER_LAYER_PROFILER) && EI_CLASSIFIER_LAYER_PROFILER == 1
+// per layer hardware counters, the profiler is owned by the firmware
+#include "firmware-sdk/ei_layer_profiler.h"
 #endif
 
 #ifdef EI_CLASSIFIER_ALLOCATION_STATIC
@@ -69,6 +76,13 @@
 #define STRINGIZE(x) #x
 #define STRINGIZE_VALUE_OF(x) STRINGIZE(x)
 
+// Keep the interpreter (and its planned arena) alive between inferences instead
+// of building it and running AllocateTensors() on every call. The interpreter is
+// released by run_classifier_deinit() or when a different graph is run.
+#ifndef EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER
+#define EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER 0
+#endif
+
 #if defined (__GNUC__)  /* GNU compiler */
 #define ALIGN(X) __attribute__((aligned(X)))
 #define DEFINE_SECTION(x) __attribute__((section(x)))
@@ -88,6 +102,139 @@
 #define DEFINE_SECTION(x) __attribute__((section(x)))
 #endif
 
+// The static arena is sized for the largest graph of the impulse.
+// EI_TENSOR_ARENA_SIZE overrides it (and the arena of every graph) with the
+// use reported by the memory-plan tool or AT+ARENA? to reclaim the rest.
+#ifdef EI_TENSOR_ARENA_SIZE
+#define EI_TFLITE_STATIC_ARENA_SIZE     (EI_TENSOR_ARENA_SIZE)
+#define EI_TFLITE_ARENA_SIZE(graph)     ((size_t)(EI_TENSOR_ARENA_SIZE))
+#else
+#define EI_TFLITE_STATIC_ARENA_SIZE     EI_CLASSIFIER_TFLITE_LARGEST_ARENA_SIZE
+#define EI_TFLITE_ARENA_SIZE(graph)     ((graph)->arena_size)
+#endif
+
+/**
+ * Arena use measured after AllocateTensors()
+ */
+typedef struct {
+    size_t size;                // static arena, or the one allocated for the graph
+    size_t used;                // used by the graph set up last
+    size_t peak;                // highest use since boot
+} ei_tflite_arena_usage_t;
+
+static ei_tflite_arena_usage_t ei_tflite_arena_usage = { 0, 0, 0 };
+
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER == 1
+/**
+ * Interpreter kept between inferences. Only one graph at a time, as with
+ * EI_CLASSIFIER_ALLOCATION_STATIC all graphs share the same arena.
+ */
+typedef struct {
+    const unsigned char *model;
+    tflite::MicroInterpreter *interpreter;
+    ei_unique_ptr_t tensor_arena;
+    void *profiler;
+    uint32_t setup_count;       // number of full setups (interpreter + AllocateTensors)
+} ei_tflite_persistent_t;
+
+static ei_tflite_persistent_t ei_tflite_persistent = { nullptr, nullptr, ei_unique_ptr_t(nullptr, ei_aligned_free), nullptr, 0 };
+#endif
+
+/**
+ * Release the interpreter kept by EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER,
+ * the next inference does a full setup again. No-op otherwise.
+ */
+__attribute__((unused)) static void inference_tflite_release(void)
+{
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER == 1
+    delete ei_tflite_persistent.interpreter;
+#ifdef EI_CLASSIFIER_ENABLE_PROFILER
+    delete (tflite::MicroProfiler*)ei_tflite_persistent.profiler;
+#endif
+    ei_tflite_persistent.interpreter = nullptr;
+    ei_tflite_persistent.profiler = nullptr;
+    ei_tflite_persistent.model = nullptr;
+    ei_tflite_persistent.tensor_arena.reset();
+#endif
+}
+
+#ifndef EI_CLASSIFIER_ALLOCATION_STATIC
+/**
+ * Arena on the heap shared by the graphs of several impulses (see
+ * ei_multi_impulse.h), used instead of allocating one at every setup
+ */
+typedef struct {
+    uint8_t *arena;
+    size_t size;
+} ei_tflite_shared_arena_t;
+
+static ei_tflite_shared_arena_t ei_tflite_shared_arena = { nullptr, 0 };
+
+/**
+ * Set up the graphs that fit in arena there from now on, nullptr to allocate
+ * an arena at every setup again. The caller owns the arena.
+ */
+__attribute__((unused)) static void inference_tflite_set_shared_arena(uint8_t *arena, size_t size)
+{
+    // the kept interpreter may be in the arena being replaced
+    inference_tflite_release();
+
+    ei_tflite_shared_arena.arena = arena;
+    ei_tflite_shared_arena.size = arena ? size : 0;
+}
+#endif
+
+/**
+ * Number of full interpreter setups done so far, stays constant between
+ * inferences when EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER is enabled.
+ */
+__attribute__((unused)) static uint32_t inference_tflite_setup_count(void)
+{
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER == 1
+    return ei_tflite_persistent.setup_count;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Arena use of the interpreters set up so far, all zero before the first one
+ */
+__attribute__((unused)) static ei_tflite_arena_usage_t inference_tflite_arena_usage(void)
+{
+    return ei_tflite_arena_usage;
+}
+
+/**
+ * Same for the translation units that don't include the classifier, which
+ * declare it themselves
+ */
+void inference_tflite_get_arena_usage(size_t *size, size_t *used, size_t *peak)
+{
+    *size = ei_tflite_arena_usage.size;
+    *used = ei_tflite_arena_usage.used;
+    *peak = ei_tflite_arena_usage.peak;
+}
+
+/**
+ * Hand the interpreter back after an inference, it's deleted unless
+ * it's kept by EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER
+ *
+ * @param   interpreter     TFLite interpreter from inference_tflite_setup
+ * @param   failed          Interpreter returned an error, don't reuse it
+ */
+static void inference_tflite_done(tflite::MicroInterpreter *interpreter, bool failed = false)
+{
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER == 1
+    if (failed && interpreter == ei_tflite_persistent.interpreter) {
+        inference_tflite_release();
+    }
+#else
+    (void)failed;
+    delete interpreter;
+#endif
+}
+
 /**
  * Setup the TFLite runtime
  *
@@ -112,18 +259,62 @@ static EI_IMPULSE_ERROR inference_tflite_setup(
 
     ei_config_tflite_graph_t *graph_config = (ei_config_tflite_graph_t*)block_config->graph_config;
 
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER == 1
+    if (ei_tflite_persistent.interpreter != nullptr && ei_tflite_persistent.model == graph_config->model) {
+        tflite::MicroInterpreter *interpreter = ei_tflite_persistent.interpreter;
+
+        // same state as after AllocateTensors(), e.g. variable tensors cleared
+        if (interpreter->Reset() != kTfLiteOk) {
+            ei_printf("Interpreter Reset() failed");
+            inference_tflite_release();
+            return EI_IMPULSE_TFLITE_ERROR;
+        }
+
+#ifdef EI_CLASSIFIER_ENABLE_PROFILER
+        ((tflite::MicroProfiler*)ei_tflite_persistent.profiler)->ClearEvents();
+#elif defined(EI_CLASSIFIER_LAYER_PROFILER) && EI_CLASSIFIER_LAYER_PROFILER == 1
+        ei_layer_profiler_get()->start_inference();
+#endif
+        *micro_profiler = ei_tflite_persistent.profiler;
+        *micro_interpreter = interpreter;
+
+        *input = interpreter->input(0);
+        for (uint8_t i = 0; i < block_config->output_tensors_size; i++) {
+            outputs[i] = interpreter->output(block_config->output_tensors_indices[i]);
+        }
+
+        return EI_IMPULSE_OK;
+    }
+
+    // different graph, its arena is about to be reused
+    inference_tflite_release();
+#endif
+
+    const size_t arena_size = EI_TFLITE_ARENA_SIZE(graph_config);
+
 #ifdef EI_CLASSIFIER_ALLOCATION_STATIC
     // Assign a no-op lambda to the "free" function in case of static arena
-    static uint8_t tensor_arena[EI_CLASSIFIER_TFLITE_LARGEST_ARENA_SIZE] ALIGN(16) DEFINE_SECTION(STRINGIZE_VALUE_OF(EI_TENSOR_ARENA_LOCATION));
+    static uint8_t tensor_arena[EI_TFLITE_STATIC_ARENA_SIZE] ALIGN(16) DEFINE_SECTION(STRINGIZE_VALUE_OF(EI_TENSOR_ARENA_LOCATION));
     p_tensor_arena = ei_unique_ptr_t(tensor_arena, [](void*){});
+    ei_tflite_arena_usage.size = sizeof(tensor_arena);
 #else
-    // Create an area of memory to use for input, output, and intermediate arrays.
-    uint8_t *tensor_arena = (uint8_t*)ei_aligned_calloc(16, graph_config->arena_size);
-    if (tensor_arena == NULL) {
-        ei_printf("Failed to allocate TFLite arena (%zu bytes)\n", graph_config->arena_size);
-        return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+    uint8_t *tensor_arena;
+    if (ei_tflite_shared_arena.arena != nullptr && arena_size <= ei_tflite_shared_arena.size) {
+        // owned by whoever set it, not freed with the interpreter
+        tensor_arena = ei_tflite_shared_arena.arena;
+        p_tensor_arena = ei_unique_ptr_t(tensor_arena, [](void*){});
+        ei_tflite_arena_usage.size = ei_tflite_shared_arena.size;
+    }
+    else {
+        // Create an area of memory to use for input, output, and intermediate arrays.
+        tensor_arena = (uint8_t*)ei_aligned_calloc(16, arena_size);
+        if (tensor_arena == NULL) {
+            ei_printf("Failed to allocate TFLite arena (%zu bytes)\n", arena_size);
+            return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+        }
+        p_tensor_arena = ei_unique_ptr_t(tensor_arena, ei_aligned_free);
+        ei_tflite_arena_usage.size = arena_size;
     }
-    p_tensor_arena = ei_unique_ptr_t(tensor_arena, ei_aligned_free);
 #endif
 
     static bool tflite_first_run = true;
@@ -167,14 +358,23 @@ static EI_IMPULSE_ERROR inference_tflite_setup(
     tflite::MicroProfiler *profiler = new tflite::MicroProfiler;
 
     tflite::MicroInterpreter *interpreter = new tflite::MicroInterpreter(
-        model, resolver, tensor_arena, graph_config->arena_size, nullptr, profiler);
+        model, resolver, tensor_arena, arena_size, nullptr, profiler);
 
     *micro_profiler = (void*)profiler;
+#elif defined(EI_CLASSIFIER_LAYER_PROFILER) && EI_CLASSIFIER_LAYER_PROFILER == 1
+    EiLayerProfiler *layer_profiler = ei_layer_profiler_get();
+    layer_profiler->start_inference();
+
+    tflite::MicroInterpreter *interpreter = new tflite::MicroInterpreter(
+        model, resolver, tensor_arena, arena_size, nullptr, layer_profiler);
+
+    // not owned by the interpreter, keeps counting across setups
+    *micro_profiler = nullptr;
 #else
     tflite::MicroInterpreter *interpreter = new tflite::MicroInterpreter(
-        model, resolver, tensor_arena, graph_config->arena_size, nullptr, nullptr);
+        model, resolver, tensor_arena, arena_size, nullptr, nullptr);
 
-    micro_profiler = nullptr;
+    *micro_profiler = nullptr;
 #endif
 
     *micro_interpreter = interpreter;
@@ -182,10 +382,27 @@ static EI_IMPULSE_ERROR inference_tflite_setup(
     // Allocate memory from the tensor_arena for the model's tensors.
     TfLiteStatus allocate_status = interpreter->AllocateTensors(true);
     if (allocate_status != kTfLiteOk) {
-        ei_printf("AllocateTensors() failed");
+        ei_printf("AllocateTensors() failed\n");
+        // not kept, the caller only frees its outputs
+        delete interpreter;
+        *micro_interpreter = nullptr;
         return EI_IMPULSE_TFLITE_ERROR;
     }
 
+    ei_tflite_arena_usage.used = interpreter->arena_used_bytes();
+    if (ei_tflite_arena_usage.used > ei_tflite_arena_usage.peak) {
+        ei_tflite_arena_usage.peak = ei_tflite_arena_usage.used;
+    }
+
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER == 1
+    // the arena now belongs to the persistent interpreter
+    ei_tflite_persistent.model = graph_config->model;
+    ei_tflite_persistent.interpreter = interpreter;
+    ei_tflite_persistent.tensor_arena = std::move(p_tensor_arena);
+    ei_tflite_persistent.profiler = *micro_profiler;
+    ei_tflite_persistent.setup_count++;
+#endif
+
     // Obtain pointers to the model's input and output tensors.
     *input = interpreter->input(0);
     for (uint8_t i = 0; i < block_config->output_tensors_size; i++) {
@@ -209,7 +426,9 @@ static EI_IMPULSE_ERROR inference_tflite_setup(
  * @param   result          Struct for results
  * @param   debug           Whether to print debug info
  *
- * @return  EI_IMPULSE_OK if successful
+ * @return  EI_IMPULSE_OK if successful, EI_IMPULSE_TFLITE_ERROR if Invoke()
+ *          failed: the caller hands the interpreter back with
+ *          inference_tflite_done(interpreter, true)
  */
 static EI_IMPULSE_ERROR inference_tflite_run(
     uint64_t ctx_start_us,
@@ -220,11 +439,14 @@ static EI_IMPULSE_ERROR inference_tflite_run(
     // Run inference, and report any error
     TfLiteStatus invoke_status = interpreter->Invoke();
     if (invoke_status != kTfLiteOk) {
-        delete interpreter;
         ei_printf("Invoke failed (%d)\n", invoke_status);
         return EI_IMPULSE_TFLITE_ERROR;
     }
 
+#if defined(EI_CLASSIFIER_LAYER_PROFILER) && EI_CLASSIFIER_LAYER_PROFILER == 1
+    ei_layer_profiler_get()->end_inference();
+#endif
+
     uint64_t ctx_end_us = ei_read_timer_us();
 
     result->timing.classification_us = ctx_end_us - ctx_start_us;
@@ -251,6 +473,83 @@ static EI_IMPULSE_ERROR inference_tflite_run(
 }
 
 
+/**
+ * @brief      Copy (or dequantize) the output tensors into result->_raw_outputs
+ *
+ * @param      block_config       Learning block config
+ * @param      outputs            Output tensors
+ * @param[in]  learn_block_index  Index of the first raw output of the block
+ * @param      result             Output classifier results
+ *
+ * @return     The ei impulse error.
+ */
+static EI_IMPULSE_ERROR inference_tflite_copy_outputs(
+    ei_learning_block_config_tflite_graph_t *block_config,
+    TfLiteTensor **outputs,
+    uint32_t learn_block_index,
+    ei_impulse_result_t *result) {
+
+    for (uint32_t output_ix = 0; output_ix < block_config->output_tensors_size; output_ix++) {
+        TfLiteTensor *output = outputs[output_ix];
+        // calculate the size of the output by iterating through dims
+        size_t output_size = 1;
+        for (int dim_num = 0; dim_num < output->dims->size; dim_num++) {
+            output_size *= output->dims->data[dim_num];
+        }
+
+        switch (output->type) {
+            case kTfLiteFloat32: {
+                result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
+                memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix->buffer, output->data.f, output->bytes);
+                break;
+            }
+            case kTfLiteInt8: {
+                if (block_config->dequantize_output) {
+                    result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
+                    fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
+                }
+                else {
+                    result->_raw_outputs[learn_block_index + output_ix].matrix_i8 = new matrix_i8_t(1, output_size);
+                    memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix_i8->buffer, output->data.int8, output->bytes);
+                }
+                break;
+            }
+            case kTfLiteUInt8: {
+                if (block_config->dequantize_output) {
+                    result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
+                    fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
+                }
+                else {
+                    result->_raw_outputs[learn_block_index + output_ix].matrix_u8 = new matrix_u8_t(1, output_size);
+                    memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix_u8->buffer, output->data.uint8, output->bytes);
+                }
+                break;
+            }
+#if EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
+            case kTfLiteInt16: {
+                // there is no int16 raw output, int16 outputs go through the
+                // float postprocessing
+                if (!block_config->dequantize_output) {
+                    ei_printf("ERR: int16 outputs need dequantize_output (float postprocessing)\n");
+                    return EI_IMPULSE_OUTPUT_TENSOR_WAS_NULL;
+                }
+                result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
+                fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
+                break;
+            }
+#endif // EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
+            default: {
+                print_unsupported_tensor_type("output", output->type);
+                return EI_IMPULSE_OUTPUT_TENSOR_WAS_NULL;
+            }
+        }
+
+        result->_raw_outputs[learn_block_index + output_ix].blockId = block_config->block_id + output_ix;
+    }
+
+    return EI_IMPULSE_OK;
+}
+
 /**
  * @brief      Do neural network inferencing over a signal (from the DSP)
  *
@@ -288,29 +587,39 @@ EI_IMPULSE_ERROR run_nn_inference_from_dsp(
         (void**)&profiler);
 
     if (init_res != EI_IMPULSE_OK) {
+        ei_free(outputs);
         return init_res;
     }
 
     auto input_res = fill_input_tensor_from_signal(signal, input);
     if (input_res != EI_IMPULSE_OK) {
+        inference_tflite_done(interpreter, true);
+        ei_free(outputs);
         return input_res;
     }
 
     // Run inference, and report any error
     TfLiteStatus invoke_status = interpreter->Invoke();
     if (invoke_status != kTfLiteOk) {
+        inference_tflite_done(interpreter, true);
+        ei_free(outputs);
         ei_printf("Invoke failed (%d)\n", invoke_status);
         return EI_IMPULSE_TFLITE_ERROR;
     }
 
+#if defined(EI_CLASSIFIER_LAYER_PROFILER) && EI_CLASSIFIER_LAYER_PROFILER == 1
+    ei_layer_profiler_get()->end_inference();
+#endif
+
     auto output_res = fill_output_matrix_from_tensor(outputs[0], output_matrix);
+
+    inference_tflite_done(interpreter);
+    ei_free(outputs);
+
     if (output_res != EI_IMPULSE_OK) {
         return output_res;
     }
 
-    delete interpreter;
-    ei_free(outputs);
-
     return EI_IMPULSE_OK;
 }
 
@@ -358,6 +667,7 @@ EI_IMPULSE_ERROR run_nn_inference(
         (void**)&profiler);
 
     if (init_res != EI_IMPULSE_OK) {
+        ei_free(outputs);
         return init_res;
     }
 
@@ -369,6 +679,8 @@ EI_IMPULSE_ERROR run_nn_inference(
                                                    impulse->dsp_blocks_size,
                                                    impulse->learning_blocks_size);
     if (input_res != EI_IMPULSE_OK) {
+        inference_tflite_done(interpreter, true);
+        ei_free(outputs);
         return input_res;
     }
 
@@ -378,54 +690,22 @@ EI_IMPULSE_ERROR run_nn_inference(
         result,
         profiler);
 
-    for (uint32_t output_ix = 0; output_ix < block_config->output_tensors_size; output_ix++) {
-        TfLiteTensor *output = outputs[output_ix];
-        // calculate the size of the output by iterating through dims
-        size_t output_size = 1;
-        for (int dim_num = 0; dim_num < output->dims->size; dim_num++) {
-            output_size *= output->dims->data[dim_num];
-        }
-
-        switch (output->type) {
-            case kTfLiteFloat32: {
-                result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
-                memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix->buffer, output->data.f, output->bytes);
-                break;
-            }
-            case kTfLiteInt8: {
-                if (block_config->dequantize_output) {
-                    result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
-                    fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
-                }
-                else {
-                    result->_raw_outputs[learn_block_index + output_ix].matrix_i8 = new matrix_i8_t(1, output_size);
-                    memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix_i8->buffer, output->data.int8, output->bytes);
-                }
-                break;
-            }
-            case kTfLiteUInt8: {
-                if (block_config->dequantize_output) {
-                    result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
-                    fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
-                }
-                else {
-                    result->_raw_outputs[learn_block_index + output_ix].matrix_u8 = new matrix_u8_t(1, output_size);
-                    memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix_u8->buffer, output->data.uint8, output->bytes);
-                }
-                break;
-            }
-            default: {
-                ei_printf("ERR: Cannot handle output type (%d)\n", output->type);
-                return EI_IMPULSE_OUTPUT_TENSOR_WAS_NULL;
-            }
-        }
-
-        result->_raw_outputs[learn_block_index + output_ix].blockId = block_config->block_id + output_ix;
+    // Invoke() failed, the outputs aren't valid and the interpreter isn't kept
+    if (run_res == EI_IMPULSE_TFLITE_ERROR) {
+        inference_tflite_done(interpreter, true);
+        ei_free(outputs);
+        return run_res;
     }
 
-    delete interpreter;
+    EI_IMPULSE_ERROR output_res = inference_tflite_copy_outputs(block_config, outputs, learn_block_index, result);
+
+    inference_tflite_done(interpreter);
     ei_free(outputs);
 
+    if (output_res != EI_IMPULSE_OK) {
+        return output_res;
+    }
+
     if (run_res != EI_IMPULSE_OK) {
         return run_res;
     }
@@ -438,10 +718,12 @@ EI_IMPULSE_ERROR run_nn_inference(
  * Special function to run the classifier on images, only works on TFLite models (either interpreter or EON or for tensaiflow)
  * that allocates a lot less memory by quantizing in place. This only works if 'can_run_classifier_image_quantized'
  * returns EI_IMPULSE_OK.
+ * signal_type is either a float packed signal_t or a native 8 bit image_signal_t.
  */
+template<typename signal_type>
 EI_IMPULSE_ERROR run_nn_inference_image_quantized(
     const ei_impulse_t *impulse,
-    signal_t *signal,
+    signal_type *signal,
     uint32_t learn_block_index,
     ei_impulse_result_t *result,
     void *config_ptr,
@@ -473,10 +755,13 @@ EI_IMPULSE_ERROR run_nn_inference_image_quantized(
         (void**)&profiler);
 
     if (init_res != EI_IMPULSE_OK) {
+        ei_free(outputs);
         return init_res;
     }
 
     if (input->type != TfLiteType::kTfLiteInt8 && input->type != TfLiteType::kTfLiteUInt8) {
+        inference_tflite_done(interpreter, true);
+        ei_free(outputs);
         return EI_IMPULSE_ONLY_SUPPORTED_FOR_IMAGES;
     }
 
@@ -490,10 +775,14 @@ EI_IMPULSE_ERROR run_nn_inference_image_quantized(
         impulse->frequency, impulse->learning_blocks[0].image_scaling);
     if (ret != EIDSP_OK) {
         ei_printf("ERR: Failed to run DSP process (%d)\n", ret);
+        inference_tflite_done(interpreter, true);
+        ei_free(outputs);
         return EI_IMPULSE_DSP_ERROR;
     }
 
     if (ei_run_impulse_check_canceled() == EI_IMPULSE_CANCELED) {
+        inference_tflite_done(interpreter, true);
+        ei_free(outputs);
         return EI_IMPULSE_CANCELED;
     }
 
@@ -516,54 +805,171 @@ EI_IMPULSE_ERROR run_nn_inference_image_quantized(
         result,
         profiler);
 
-    for (uint32_t output_ix = 0; output_ix < block_config->output_tensors_size; output_ix++) {
-        TfLiteTensor* output = outputs[output_ix];
-        // calculate the size of the output by iterating through dims
-        size_t output_size = 1;
-        for (int dim_num = 0; dim_num < output->dims->size; dim_num++) {
-            output_size *= output->dims->data[dim_num];
-        }
+    // Invoke() failed, the outputs aren't valid and the interpreter isn't kept
+    if (run_res == EI_IMPULSE_TFLITE_ERROR) {
+        inference_tflite_done(interpreter, true);
+        ei_free(outputs);
+        return run_res;
+    }
 
-        switch (output->type) {
-            case kTfLiteFloat32: {
-                result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
-                memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix->buffer, output->data.f, output->bytes);
-                break;
-            }
-            case kTfLiteInt8: {
-                if (block_config->dequantize_output) {
-                    result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
-                    fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
-                }
-                else {
-                    result->_raw_outputs[learn_block_index + output_ix].matrix_i8 = new matrix_i8_t(1, output_size);
-                    memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix_i8->buffer, output->data.int8, output->bytes);
-                }
-                break;
-            }
-            case kTfLiteUInt8: {
-                if (block_config->dequantize_output) {
-                    result->_raw_outputs[learn_block_index + output_ix].matrix = new matrix_t(1, output_size);
-                    fill_output_matrix_from_tensor(output, result->_raw_outputs[learn_block_index + output_ix].matrix);
-                }
-                else {
-                    result->_raw_outputs[learn_block_index + output_ix].matrix_u8 = new matrix_u8_t(1, output_size);
-                    memcpy(result->_raw_outputs[learn_block_index + output_ix].matrix_u8->buffer, output->data.uint8, output->bytes);
-                }
-                break;
-            }
-            default: {
-                ei_printf("ERR: Cannot handle output type (%d)\n", output->type);
-                return EI_IMPULSE_OUTPUT_TENSOR_WAS_NULL;
-            }
+    EI_IMPULSE_ERROR output_res = inference_tflite_copy_outputs(block_config, outputs, learn_block_index, result);
+
+    inference_tflite_done(interpreter);
+    ei_free(outputs);
+
+    if (output_res != EI_IMPULSE_OK) {
+        return output_res;
+    }
+
+    if (run_res != EI_IMPULSE_OK) {
+        return run_res;
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+// runs the MFE or spectrogram block of the impulse into an int8 or int16 buffer, see below
+template<typename T>
+static int extract_features_quantized(const ei_impulse_t *impulse, signal_t *signal, T *output, size_t *output_size,
+    float scale, int32_t zero_point)
+{
+    ei_model_dsp_t block = impulse->dsp_blocks[0];
+
+    if (block.extract_fn == extract_mfe_features) {
+        return extract_mfe_features_quantized<T>(signal, output, output_size, block.config, scale, zero_point,
+            impulse->frequency);
+    }
+    return extract_spectrogram_features_quantized<T>(signal, output, output_size, block.config, scale, zero_point,
+        impulse->frequency);
+}
+
+/**
+ * Same idea for audio: runs the MFE or spectrogram block a few frames at a time
+ * and quantizes the features straight into the input tensor (int8, or int16
+ * with EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS), so the float feature matrix is
+ * never allocated. This only works if 'can_run_classifier_features_quantized'
+ * returns EI_IMPULSE_OK.
+ */
+EI_IMPULSE_ERROR run_nn_inference_features_quantized(
+    const ei_impulse_t *impulse,
+    signal_t *signal,
+    uint32_t learn_block_index,
+    ei_impulse_result_t *result,
+    void *config_ptr,
+    bool debug = false)
+{
+    ei_learning_block_config_tflite_graph_t *block_config = (ei_learning_block_config_tflite_graph_t*)config_ptr;
+
+    uint64_t ctx_start_us;
+
+    TfLiteTensor* input = nullptr; // will be owned by TFLite
+    TfLiteTensor** outputs = (TfLiteTensor**)ei_malloc(block_config->output_tensors_size * sizeof(TfLiteTensor*));
+
+    ei_unique_ptr_t p_tensor_arena(nullptr, ei_aligned_free);
+
+    tflite::MicroInterpreter* interpreter;
+#ifdef EI_CLASSIFIER_ENABLE_PROFILER
+    tflite::MicroProfiler* profiler;
+#else
+    void* profiler = nullptr;
+#endif
+
+    EI_IMPULSE_ERROR init_res = inference_tflite_setup(
+        block_config,
+        &ctx_start_us,
+        &input,
+        outputs,
+        &interpreter,
+        p_tensor_arena,
+        (void**)&profiler);
+
+    if (init_res != EI_IMPULSE_OK) {
+        ei_free(outputs);
+        return init_res;
+    }
+
+    bool input_int16 = false;
+#if EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS == 1
+    input_int16 = input->type == TfLiteType::kTfLiteInt16;
+#endif
+    if (input->type != TfLiteType::kTfLiteInt8 && !input_int16) {
+        print_unsupported_tensor_type("input", input->type);
+        inference_tflite_done(interpreter);
+        ei_free(outputs);
+        return EI_IMPULSE_INVALID_SIZE;
+    }
+    if (input->bytes != impulse->nn_input_frame_size * (input_int16 ? 2 : 1)) {
+        ei_printf("ERR: Cannot quantize features into input tensor (type %d, %d bytes)\n",
+            input->type, (int)input->bytes);
+        inference_tflite_done(interpreter);
+        ei_free(outputs);
+        return EI_IMPULSE_INVALID_SIZE;
+    }
+
+    uint64_t dsp_start_us = ei_read_timer_us();
+
+    // the features are written straight into the input tensor
+    size_t features_size = impulse->nn_input_frame_size;
+
+    int ret;
+    if (input_int16) {
+        ret = extract_features_quantized<int16_t>(impulse, signal, input->data.i16, &features_size,
+            input->params.scale, input->params.zero_point);
+    }
+    else {
+        ret = extract_features_quantized<int8_t>(impulse, signal, input->data.int8, &features_size,
+            input->params.scale, input->params.zero_point);
+    }
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to run DSP process (%d)\n", ret);
+        inference_tflite_done(interpreter);
+        ei_free(outputs);
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    if (ei_run_impulse_check_canceled() == EI_IMPULSE_CANCELED) {
+        inference_tflite_done(interpreter);
+        ei_free(outputs);
+        return EI_IMPULSE_CANCELED;
+    }
+
+    result->timing.dsp_us = ei_read_timer_us() - dsp_start_us;
+
+    if (debug) {
+        ei_printf("Features (%d ms.): ", (int)(result->timing.dsp_us / 1000));
+        for (size_t ix = 0; ix < features_size; ix++) {
+            int32_t value = input_int16 ? input->data.i16[ix] : input->data.int8[ix];
+            ei_printf_float((value - input->params.zero_point) * input->params.scale);
+            ei_printf(" ");
         }
+        ei_printf("\n");
+        ei_printf("Running impulse...\n");
+    }
 
-        result->_raw_outputs[learn_block_index + output_ix].blockId = block_config->block_id + output_ix;
+    ctx_start_us = ei_read_timer_us();
+
+    EI_IMPULSE_ERROR run_res = inference_tflite_run(
+        ctx_start_us,
+        interpreter,
+        result,
+        profiler);
+
+    // Invoke() failed, the outputs aren't valid and the interpreter isn't kept
+    if (run_res == EI_IMPULSE_TFLITE_ERROR) {
+        inference_tflite_done(interpreter, true);
+        ei_free(outputs);
+        return run_res;
     }
 
-    delete interpreter;
+    EI_IMPULSE_ERROR output_res = inference_tflite_copy_outputs(block_config, outputs, learn_block_index, result);
+
+    inference_tflite_done(interpreter);
     ei_free(outputs);
 
+    if (output_res != EI_IMPULSE_OK) {
+        return output_res;
+    }
+
     if (run_res != EI_IMPULSE_OK) {
         return run_res;
     }
@@ -95,6 +95,32 @@
 #define EIDSP_QUANTIZE_FILTERBANK    1
 #endif // EIDSP_QUANTIZE_FILTERBANK
 
+// Mel filterbanks (MFE, MFCC) are built once per configuration and kept in a
+// cache of this many entries, 0 builds them on every call
+#ifndef EIDSP_MEL_FILTERBANK_CACHE_SIZE
+#define EIDSP_MEL_FILTERBANK_CACHE_SIZE    2
+#endif // EIDSP_MEL_FILTERBANK_CACHE_SIZE
+
+// Frame buffers and FFT state of the MFE, MFCC and spectrogram frame loops
+// (see speechpy/frame_engine.hpp), one entry per frame and FFT length (MFCC
+// uses two, the frames and the DCT), 0 allocates them on every call
+#ifndef EIDSP_FRAME_WORKSPACE_CACHE_SIZE
+#define EIDSP_FRAME_WORKSPACE_CACHE_SIZE    4
+#endif // EIDSP_FRAME_WORKSPACE_CACHE_SIZE
+
+// Keep the scratch buffer of speechpy::processing::cmvnw() (a copy of the
+// features) between calls, 0 allocates it on every call
+#ifndef EIDSP_CMVNW_KEEP_BUFFER
+#define EIDSP_CMVNW_KEEP_BUFFER    1
+#endif // EIDSP_CMVNW_KEEP_BUFFER
+
+// Samples the signal adaptors (ei_signal_adaptor.h, e.g. the axes a DSP block
+// selects) read from the original signal per get_data() call, a page of floats
+// on the stack
+#ifndef EIDSP_SIGNAL_PAGE_SIZE
+#define EIDSP_SIGNAL_PAGE_SIZE    64
+#endif // EIDSP_SIGNAL_PAGE_SIZE
+
 // prints buffer allocations to stdout, useful when debugging
 #ifndef EIDSP_TRACK_ALLOCATIONS
 #define EIDSP_TRACK_ALLOCATIONS      0
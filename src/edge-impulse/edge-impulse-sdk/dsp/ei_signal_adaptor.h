@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ *
+ * Generated by Edge Impulse and licensed under the applicable Edge Impulse
+ * Terms of Service. Community and Professional Terms of Service
+ * (https://edgeimpulse.com/legal/terms-of-service) or Enterprise Terms of
+ * Service (https://edgeimpulse.com/legal/enterprise-terms-of-service),
+ * according to your product plan subscription (the “License”).
+ *
+ * This software, documentation and other associated files (collectively referred
+ * to as the “Software”) is a single SDK variation generated by the Edge Impulse
+ * platform and requires an active paid Edge Impulse subscription to use this
+ * Software for any purpose.
+ *
+ * You may NOT use this Software unless you have an active Edge Impulse subscription
+ * that meets the eligibility requirements for the applicable License, subject to
+ * your full and continued compliance with the terms and conditions of the License,
+ * including without limitation any usage restrictions under the applicable License.
+ *
+ * If you do not have an active Edge Impulse product plan subscription, or if use
+ * of this Software exceeds the usage limitations of your Edge Impulse product plan
+ * subscription, you are not permitted to use this Software and must immediately
+ * delete and erase all copies of this Software within your control or possession.
+ * Edge Impulse reserves all rights and remedies available to enforce its rights.
+ *
+ * Unless required by applicable law or agreed to in writing, the Software is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language governing
+ * permissions, disclaimers and limitations under the License.
+ */
+#ifndef __EI_SIGNAL_ADAPTOR__H__
+#define __EI_SIGNAL_ADAPTOR__H__
+
+#include "edge-impulse-sdk/dsp/numpy_types.h"
+#include "edge-impulse-sdk/dsp/returntypes.hpp"
+#include "edge-impulse-sdk/dsp/config.hpp"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+
+namespace ei {
+
+/**
+ * Signal made of some of the lanes of a signal of interleaved frames, e.g. the
+ * axes a DSP block selects out of an accelerometer window: sample ix is lane
+ * lanes[ix % lanes_count] of frame ix / lanes_count of the original signal.
+ *
+ * The original signal is read in pages of whole frames (EIDSP_SIGNAL_PAGE_SIZE
+ * samples on the stack), one get_data() call per page, and the lanes are copied
+ * out of the page; frames larger than a page fall back to one call per sample.
+ */
+template<typename index_t>
+class signal_gather {
+public:
+    /**
+     * @param signal Original signal, frames of frame_size samples
+     * @param frame_size Samples per frame of the original signal
+     * @param lanes Index in the frame of each lane to keep (not copied, must outlive this)
+     * @param lanes_count Number of lanes
+     */
+    signal_gather(signal_t *signal, size_t frame_size, const index_t *lanes, size_t lanes_count)
+        : _signal(signal), _frame_size(frame_size), _lanes(lanes), _lanes_count(lanes_count)
+    {
+    }
+
+    /**
+     * Samples in the gathered signal (whole frames of the original signal)
+     */
+    size_t total_length() const {
+        return _signal->total_length / _frame_size * _lanes_count;
+    }
+
+    /**
+     * Read gathered samples [offset, offset + length)
+     */
+    int get_data(size_t offset, size_t length, float *out_ptr) {
+        if (offset + length > total_length()) {
+            EIDSP_ERR(EIDSP_OUT_OF_BOUNDS);
+        }
+
+        size_t frame = offset / _lanes_count;
+        size_t lane = offset % _lanes_count;
+        size_t out_ix = 0;
+
+        if (_frame_size > EIDSP_SIGNAL_PAGE_SIZE) {
+            for (; out_ix < length; out_ix++) {
+                int r = _signal->get_data(frame * _frame_size + _lanes[lane], 1, &out_ptr[out_ix]);
+                if (r != 0) {
+                    return r;
+                }
+                if (++lane == _lanes_count) {
+                    lane = 0;
+                    frame++;
+                }
+            }
+            return EIDSP_OK;
+        }
+
+        float page[EIDSP_SIGNAL_PAGE_SIZE];
+        const size_t page_frames = EIDSP_SIGNAL_PAGE_SIZE / _frame_size;
+
+        while (out_ix < length) {
+            // frames the rest of the samples are in, the first one from lane on
+            size_t frames = (lane + (length - out_ix) + _lanes_count - 1) / _lanes_count;
+            if (frames > page_frames) {
+                frames = page_frames;
+            }
+
+            int r = _signal->get_data(frame * _frame_size, frames * _frame_size, page);
+            if (r != 0) {
+                return r;
+            }
+
+            const float *frame_ptr = page;
+            for (size_t ix = 0; ix < frames; ix++, frame_ptr += _frame_size) {
+                for (; lane < _lanes_count && out_ix < length; lane++) {
+                    out_ptr[out_ix++] = frame_ptr[_lanes[lane]];
+                }
+                lane = 0;
+            }
+            frame += frames;
+        }
+
+        return EIDSP_OK;
+    }
+
+#if !EIDSP_SIGNAL_C_FN_POINTER
+    /**
+     * Set up a signal_t that reads through this adaptor
+     */
+    void wrap(signal_t *out_signal) {
+        out_signal->total_length = total_length();
+#ifdef __MBED__
+        out_signal->get_data = mbed::callback(this, &signal_gather::get_data);
+#else
+        out_signal->get_data = [this](size_t offset, size_t length, float *out_ptr) {
+            return this->get_data(offset, length, out_ptr);
+        };
+#endif
+    }
+#endif // #if !EIDSP_SIGNAL_C_FN_POINTER
+
+private:
+    signal_t *_signal;
+    size_t _frame_size;
+    const index_t *_lanes;
+    size_t _lanes_count;
+};
+
+} // namespace ei
+
+#endif // __EI_SIGNAL_ADAPTOR__H__
@@ -2305,7 +2305,6 @@ public:
         }
     }
 
-private:
     /**
      * Helper function to handle FFT hardware acceleration failures and logging
      * @param res Result code from hardware FFT attempt
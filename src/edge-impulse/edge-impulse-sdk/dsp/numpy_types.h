@@ -701,6 +701,19 @@ typedef struct ei_signal_t {
     size_t total_length;
 } signal_t;
 
+/**
+ * Image with native 8 bit pixels, as most camera pipelines produce them.
+ * Pixels are row major without padding, either packed RGB888 (`channels` = 3)
+ * or grayscale (`channels` = 1). Can be passed to `run_classifier_image()`
+ * instead of a `signal_t` that packs every pixel into a float.
+ */
+typedef struct ei_image_signal_t {
+    const uint8_t *buffer;
+    uint32_t width;
+    uint32_t height;
+    uint8_t channels;
+} image_signal_t;
+
 /** @} */
 
 #ifdef __cplusplus
@@ -34,7 +34,9 @@
 #include <stdint.h>
 #include "../../porting/ei_classifier_porting.h"
 #include "../ei_utils.h"
+#include "frame_engine.hpp"
 #include "functions.hpp"
+#include "mel_filterbank.hpp"
 #include "processing.hpp"
 #include "../memory.hpp"
 #include "../returntypes.hpp"
@@ -223,16 +225,6 @@ public:
     {
         int ret = 0;
 
-        if (high_frequency == 0) {
-            high_frequency = sampling_frequency / 2;
-        }
-
-        if (version<4) {
-            if (low_frequency == 0) {
-                low_frequency = 300;
-            }
-        }
-
         stack_frames_info_t stack_frame_info = { 0 };
         stack_frame_info.signal = signal;
 
@@ -266,88 +258,37 @@ public:
             *(out_features->buffer + i) = 0;
         }
 
-        const size_t power_spectrum_frame_size = (fft_length / 2 + 1);
-        // Computing the Mel filterbank
-        // converting the upper and lower frequencies to Mels.
-        // num_filter + 2 is because for num_filter filterbanks we need
-        // num_filter+2 point.
-        float *mels;
-        const int MELS_SIZE = num_filters + 2;
-        const size_t mem_size = MELS_SIZE * sizeof(float);
-        mels = (float*)ei_dsp_calloc(MELS_SIZE, sizeof(float));
-        EI_ERR_AND_RETURN_ON_NULL(mels, EIDSP_OUT_OF_MEM);
-        ei_unique_ptr_t __ptr__(mels,[mem_size](void* ptr){ei::ei_dsp_free_func(ptr, mem_size);});
-        uint16_t* bins = reinterpret_cast<uint16_t*>(mels); // alias the mels array so we can reuse the space
-
-        numpy::linspace(
-            functions::frequency_to_mel(static_cast<float>(low_frequency)),
-            functions::frequency_to_mel(static_cast<float>(high_frequency)),
-            num_filters + 2,
-            mels);
-
-        uint16_t max_bin = version >= 4 ? fft_length : power_spectrum_frame_size; // preserve a bug in v<4
-        // go to -1 size b/c special handling, see after
-        for (uint16_t ix = 0; ix < MELS_SIZE-1; ix++) {
-            mels[ix] = functions::mel_to_frequency(mels[ix]);
-            if (mels[ix] < low_frequency) {
-                mels[ix] = low_frequency;
-            }
-            if (mels[ix] > high_frequency) {
-                mels[ix] = high_frequency;
-            }
-            bins[ix] = get_fft_bin_from_hertz(max_bin, mels[ix], sampling_frequency);
-        }
-
-        // here is a really annoying bug in Speechpy which calculates the frequency index wrong for the last bucket
-        // the last 'hertz' value is not 8,000 (with sampling rate 16,000) but 7,999.999999
-        // thus calculating the bucket to 64, not 65.
-        // we're adjusting this here a tiny bit to ensure we have the same result
-        mels[MELS_SIZE-1] = functions::mel_to_frequency(mels[MELS_SIZE-1]);
-        if (mels[MELS_SIZE-1] > high_frequency) {
-            mels[MELS_SIZE-1] = high_frequency;
+        // the filterbank is cached, built by run_classifier_init() or on the first call
+        const mel_filterbank_t *filterbank;
+        ret = mel_filterbank::acquire(&filterbank, MEL_FILTERBANK_MFE, sampling_frequency, fft_length,
+            num_filters, low_frequency, high_frequency, version);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
         }
-        mels[MELS_SIZE-1] -= 0.001;
-        bins[MELS_SIZE-1] = get_fft_bin_from_hertz(max_bin, mels[MELS_SIZE-1], sampling_frequency);
+        ei_unique_ptr_t __filterbank_ptr__((void*)filterbank,
+            [](void* ptr){ mel_filterbank::release((const mel_filterbank_t*)ptr); });
 
-        EI_DSP_MATRIX(power_spectrum_frame, 1, power_spectrum_frame_size);
-        if (!power_spectrum_frame.buffer) {
-            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        // the frame buffers and the FFT are kept across windows
+        frame_workspace_t *workspace;
+        ret = frame_engine::acquire(&workspace, stack_frame_info.frame_length, fft_length);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
         }
-
-        // get signal data from the audio file
-        EI_DSP_MATRIX(signal_frame, 1, stack_frame_info.frame_length);
+        ei_unique_ptr_t __workspace_ptr__((void*)workspace,
+            [](void* ptr){ frame_engine::release((frame_workspace_t*)ptr); });
 
         for (size_t ix = 0; ix < stack_frame_info.frame_ixs.size(); ix++) {
-            // don't read outside of the audio buffer... we'll automatically zero pad then
-            size_t signal_offset = stack_frame_info.frame_ixs.at(ix);
-            size_t signal_length = stack_frame_info.frame_length;
-            if (signal_offset + signal_length > stack_frame_info.signal->total_length) {
-                signal_length = signal_length -
-                    (stack_frame_info.signal->total_length - (signal_offset + signal_length));
-            }
-
-            ret = stack_frame_info.signal->get_data(
-                signal_offset,
-                signal_length,
-                signal_frame.buffer
-            );
-            if (ret != 0) {
+            ret = frame_engine::read_frame(workspace, &stack_frame_info, ix);
+            if (ret != EIDSP_OK) {
                 EIDSP_ERR(ret);
             }
 
-            ret = numpy::power_spectrum(
-                signal_frame.buffer,
-                stack_frame_info.frame_length,
-                power_spectrum_frame.buffer,
-                power_spectrum_frame_size,
-                fft_length
-            );
-
-            if (ret != 0) {
+            float energy;
+            ret = frame_engine::power_spectrum(workspace, workspace->power, &energy);
+            if (ret != EIDSP_OK) {
                 EIDSP_ERR(ret);
             }
 
-            float energy = numpy::sum(power_spectrum_frame.buffer, power_spectrum_frame_size);
             if (energy == 0) {
                 energy = 1e-10;
             }
@@ -356,38 +297,8 @@ public:
                 out_energies->buffer[ix] = energy;
             }
 
-            auto row_ptr = out_features->get_row_ptr(ix);
-            for (size_t i = 0; i < num_filters; i++) {
-                size_t left = bins[i];
-                size_t middle = bins[i+1];
-                size_t right = bins[i+2];
-
-                assert(right < power_spectrum_frame_size);
-                // now we have weights and locations to move from fft to mel sgram
-                // both left and right become zero weights, so skip them
-
-                // middle always has weight of 1.0
-                // since we skip left and right, if left = middle we need to handle that
-                row_ptr[i] = power_spectrum_frame.buffer[middle];
-
-                for (size_t bin = left+1; bin < right; bin++) {
-                    if (bin < middle) {
-                        row_ptr[i] +=
-                            ((static_cast<float>(bin) - left) / (middle - left)) * // weight *
-                            power_spectrum_frame.buffer[bin];
-                    }
-                    // intentionally skip middle, handled above
-                    if (bin > middle) {
-                        row_ptr[i] +=
-                            ((right - static_cast<float>(bin)) / (right - middle)) * // weight *
-                            power_spectrum_frame.buffer[bin];
-                    }
-                }
-            }
-
-            if (ret != 0) {
-                EIDSP_ERR(ret);
-            }
+            // weights and locations to move from fft to mel sgram
+            mel_filterbank::apply(filterbank, workspace->power, out_features->get_row_ptr(ix));
         }
 
         numpy::zero_handling(out_features);
@@ -425,14 +336,6 @@ public:
     {
         int ret = 0;
 
-        if (high_frequency == 0) {
-            high_frequency = sampling_frequency / 2;
-        }
-
-        if (low_frequency == 0) {
-            low_frequency = 300;
-        }
-
         stack_frames_info_t stack_frame_info = { 0 };
         stack_frame_info.signal = signal;
 
@@ -466,65 +369,37 @@ public:
             *(out_features->buffer + i) = 0;
         }
 
-        uint16_t coefficients = fft_length / 2 + 1;
-
-        // calculate the filterbanks first... preferably I would want to do the matrix multiplications
-        // whenever they happen, but OK...
-#if EIDSP_QUANTIZE_FILTERBANK
-        EI_DSP_QUANTIZED_MATRIX(filterbanks, num_filters, coefficients, &numpy::dequantize_zero_one);
-#else
-        EI_DSP_MATRIX(filterbanks, num_filters, coefficients);
-#endif
-        if (!filterbanks.buffer) {
-            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        // the filterbanks are cached, built by run_classifier_init() or on the first call
+        const mel_filterbank_t *filterbank;
+        ret = mel_filterbank::acquire(&filterbank, MEL_FILTERBANK_SPEECHPY, sampling_frequency, fft_length,
+            num_filters, low_frequency, high_frequency, version);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
         }
+        ei_unique_ptr_t __filterbank_ptr__((void*)filterbank,
+            [](void* ptr){ mel_filterbank::release((const mel_filterbank_t*)ptr); });
 
-        ret = feature::filterbanks(
-            &filterbanks, num_filters, coefficients, sampling_frequency, low_frequency, high_frequency, true);
-        if (ret != 0) {
+        // the frame buffers and the FFT are kept across windows
+        frame_workspace_t *workspace;
+        ret = frame_engine::acquire(&workspace, stack_frame_info.frame_length, fft_length);
+        if (ret != EIDSP_OK) {
             EIDSP_ERR(ret);
         }
-        for (size_t ix = 0; ix < stack_frame_info.frame_ixs.size(); ix++) {
-            size_t power_spectrum_frame_size = (fft_length / 2 + 1);
-
-            EI_DSP_MATRIX(power_spectrum_frame, 1, power_spectrum_frame_size);
-            if (!power_spectrum_frame.buffer) {
-                EIDSP_ERR(EIDSP_OUT_OF_MEM);
-            }
-
-            // get signal data from the audio file
-            EI_DSP_MATRIX(signal_frame, 1, stack_frame_info.frame_length);
-
-            // don't read outside of the audio buffer... we'll automatically zero pad then
-            size_t signal_offset = stack_frame_info.frame_ixs.at(ix);
-            size_t signal_length = stack_frame_info.frame_length;
-            if (signal_offset + signal_length > stack_frame_info.signal->total_length) {
-                signal_length = signal_length -
-                    (stack_frame_info.signal->total_length - (signal_offset + signal_length));
-            }
+        ei_unique_ptr_t __workspace_ptr__((void*)workspace,
+            [](void* ptr){ frame_engine::release((frame_workspace_t*)ptr); });
 
-            ret = stack_frame_info.signal->get_data(
-                signal_offset,
-                signal_length,
-                signal_frame.buffer
-            );
-            if (ret != 0) {
+        for (size_t ix = 0; ix < stack_frame_info.frame_ixs.size(); ix++) {
+            ret = frame_engine::read_frame(workspace, &stack_frame_info, ix);
+            if (ret != EIDSP_OK) {
                 EIDSP_ERR(ret);
             }
 
-            ret = numpy::power_spectrum(
-                signal_frame.buffer,
-                stack_frame_info.frame_length,
-                power_spectrum_frame.buffer,
-                power_spectrum_frame_size,
-                fft_length
-            );
-
-            if (ret != 0) {
+            float energy;
+            ret = frame_engine::power_spectrum(workspace, workspace->power, &energy);
+            if (ret != EIDSP_OK) {
                 EIDSP_ERR(ret);
             }
 
-            float energy = numpy::sum(power_spectrum_frame.buffer, power_spectrum_frame_size);
             if (energy == 0) {
                 energy = 1e-10;
             }
@@ -534,17 +409,7 @@ public:
             }
 
             // calculate the out_features directly here
-            ret = numpy::dot_by_row(
-                ix,
-                power_spectrum_frame.buffer,
-                power_spectrum_frame_size,
-                &filterbanks,
-                out_features
-            );
-
-            if (ret != 0) {
-                EIDSP_ERR(ret);
-            }
+            mel_filterbank::apply(filterbank, workspace->power, out_features->get_row_ptr(ix));
         }
 
         numpy::zero_handling(out_features);
@@ -602,29 +467,24 @@ public:
             *(out_features->buffer + i) = 0;
         }
 
-        for (size_t ix = 0; ix < stack_frame_info.frame_ixs.size(); ix++) {
-            // get signal data from the audio file
-            EI_DSP_MATRIX(signal_frame, 1, stack_frame_info.frame_length);
-
-            // don't read outside of the audio buffer... we'll automatically zero pad then
-            size_t signal_offset = stack_frame_info.frame_ixs.at(ix);
-            size_t signal_length = stack_frame_info.frame_length;
-            if (signal_offset + signal_length > stack_frame_info.signal->total_length) {
-                signal_length = signal_length -
-                    (stack_frame_info.signal->total_length - (signal_offset + signal_length));
-            }
+        frame_workspace_t *workspace;
+        ret = frame_engine::acquire(&workspace, stack_frame_info.frame_length, fft_length);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+        ei_unique_ptr_t __workspace_ptr__((void*)workspace,
+            [](void* ptr){ frame_engine::release((frame_workspace_t*)ptr); });
 
-            ret = stack_frame_info.signal->get_data(
-                signal_offset,
-                signal_length,
-                signal_frame.buffer
-            );
-            if (ret != 0) {
+        for (size_t ix = 0; ix < stack_frame_info.frame_ixs.size(); ix++) {
+            ret = frame_engine::read_frame(workspace, &stack_frame_info, ix);
+            if (ret != EIDSP_OK) {
                 EIDSP_ERR(ret);
             }
 
             // normalize data (only when version is 3)
             if (version == 3) {
+                EI_DSP_MATRIX_B(signal_frame, 1, stack_frame_info.frame_length, workspace->frame);
+
                 // it might be that everything is already normalized here...
                 bool all_between_min_1_and_1 = true;
                 for (size_t ix = 0; ix < signal_frame.rows * signal_frame.cols; ix++) {
@@ -642,15 +502,8 @@ public:
                 }
             }
 
-            ret = numpy::power_spectrum(
-                signal_frame.buffer,
-                stack_frame_info.frame_length,
-                out_features->buffer + (ix * coefficients),
-                coefficients,
-                fft_length
-            );
-
-            if (ret != 0) {
+            ret = frame_engine::power_spectrum(workspace, out_features->buffer + (ix * coefficients), nullptr);
+            if (ret != EIDSP_OK) {
                 EIDSP_ERR(ret);
             }
         }
@@ -762,11 +615,21 @@ public:
             EIDSP_ERR(ret);
         }
 
-        // now do DST type 2
-        ret = numpy::dct2(&features_matrix, DCT_NORMALIZATION_ORTHO);
+        // now do DST type 2, one workspace for all the rows
+        frame_workspace_t *dct_workspace;
+        ret = frame_engine::acquire(&dct_workspace, features_matrix.cols, features_matrix.cols);
         if (ret != EIDSP_OK) {
             EIDSP_ERR(ret);
         }
+        ei_unique_ptr_t __dct_workspace_ptr__((void*)dct_workspace,
+            [](void* ptr){ frame_engine::release((frame_workspace_t*)ptr); });
+
+        for (size_t row = 0; row < features_matrix.rows; row++) {
+            ret = frame_engine::dct2(dct_workspace, features_matrix.get_row_ptr(row), DCT_NORMALIZATION_ORTHO);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+        }
 
         // replace first cepstral coefficient with log of frame energy for DC elimination
         if (dc_elimination) {
@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ *
+ * Generated by Edge Impulse and licensed under the applicable Edge Impulse
+ * Terms of Service. Community and Professional Terms of Service
+ * (https://edgeimpulse.com/legal/terms-of-service) or Enterprise Terms of
+ * Service (https://edgeimpulse.com/legal/enterprise-terms-of-service),
+ * according to your product plan subscription (the “License”).
+ *
+ * This software, documentation and other associated files (collectively referred
+ * to as the “Software”) is a single SDK variation generated by the Edge Impulse
+ * platform and requires an active paid Edge Impulse subscription to use this
+ * Software for any purpose.
+ *
+ * You may NOT use this Software unless you have an active Edge Impulse subscription
+ * that meets the eligibility requirements for the applicable License, subject to
+ * your full and continued compliance with the terms and conditions of the License,
+ * including without limitation any usage restrictions under the applicable License.
+ *
+ * If you do not have an active Edge Impulse product plan subscription, or if use
+ * of this Software exceeds the usage limitations of your Edge Impulse product plan
+ * subscription, you are not permitted to use this Software and must immediately
+ * delete and erase all copies of this Software within your control or possession.
+ * Edge Impulse reserves all rights and remedies available to enforce its rights.
+ *
+ * Unless required by applicable law or agreed to in writing, the Software is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language governing
+ * permissions, disclaimers and limitations under the License.
+ */
+#ifndef _EIDSP_SPEECHPY_FRAME_ENGINE_H_
+#define _EIDSP_SPEECHPY_FRAME_ENGINE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "../config.hpp"
+#include "../memory.hpp"
+#include "../numpy.hpp"
+#include "../returntypes.hpp"
+#include "processing.hpp"
+
+// the CMSIS-DSP engine, see numpy.hpp
+#if EIDSP_USE_CMSIS_DSP && !EIDSP_USE_CEVA_DSP
+#define EIDSP_FRAME_ENGINE_CMSIS_RFFT    1
+#else
+#define EIDSP_FRAME_ENGINE_CMSIS_RFFT    0
+#endif
+
+#if EIDSP_INCLUDE_KISSFFT || !defined(EIDSP_INCLUDE_KISSFFT)
+#define EIDSP_FRAME_ENGINE_KISSFFT       1
+#else
+#define EIDSP_FRAME_ENGINE_KISSFFT       0
+#endif
+
+namespace ei {
+namespace speechpy {
+
+/**
+ * Scratch memory and FFT state of the frame loop of a DSP block
+ */
+typedef struct {
+    // the key
+    uint32_t frame_length;              // in samples
+    uint16_t fft_length;
+
+    float *frame;                       // max(frame_length, fft_length), the FFT input, zero padded
+    fft_complex_t *spectrum;            // fft_length / 2 + 1
+    float *power;                       // the spectrum as fft_length / 2 + 1 floats, for power_spectrum() in place
+#if EIDSP_FRAME_ENGINE_CMSIS_RFFT
+    arm_rfft_fast_instance_f32 rfft_instance;
+    bool cmsis_rfft;
+#endif
+#if EIDSP_FRAME_ENGINE_KISSFFT
+    kiss_fftr_cfg kiss_cfg;             // built when the hardware can't do the FFT
+    size_t kiss_cfg_size;
+#endif
+    size_t mem_size;                    // this struct, the frame and the spectrum in one allocation
+    bool cached;
+    bool in_use;
+} frame_workspace_t;
+
+/**
+ * Frame loop of the speechpy features. A workspace holds the buffers of one
+ * frame and the initialized FFT of a frame length and FFT length; it's built
+ * once and kept in a cache of EIDSP_FRAME_WORKSPACE_CACHE_SIZE entries, so
+ * the frames of a window don't allocate anything. MFCC also runs the DCT of
+ * every frame through a workspace.
+ */
+class frame_engine {
+public:
+    /**
+     * Get a workspace, from the cache or built now. Give it back with release().
+     * @param workspace Receives the workspace
+     * @param frame_length Frame length in samples, stack_frames_info_t::frame_length
+     * @param fft_length Number of FFT points
+     * @returns EIDSP_OK if OK
+     */
+    static int acquire(frame_workspace_t **workspace, uint32_t frame_length, uint16_t fft_length)
+    {
+        if (frame_length == 0 || fft_length == 0) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+#if EIDSP_FRAME_WORKSPACE_CACHE_SIZE > 0
+        frame_workspace_t **entries = cache_entries();
+        for (size_t ix = 0; ix < EIDSP_FRAME_WORKSPACE_CACHE_SIZE; ix++) {
+            if (entries[ix] && !entries[ix]->in_use &&
+                    entries[ix]->frame_length == frame_length && entries[ix]->fft_length == fft_length) {
+                entries[ix]->in_use = true;
+                *workspace = entries[ix];
+                return EIDSP_OK;
+            }
+        }
+#endif
+
+        frame_workspace_t *built;
+        int ret = build(&built, frame_length, fft_length);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+#if EIDSP_FRAME_WORKSPACE_CACHE_SIZE > 0
+        // a full cache builds the workspace for this call only
+        for (size_t ix = 0; ix < EIDSP_FRAME_WORKSPACE_CACHE_SIZE; ix++) {
+            if (entries[ix] == nullptr) {
+                built->cached = true;
+                entries[ix] = built;
+                break;
+            }
+        }
+#endif
+
+        built->in_use = true;
+        *workspace = built;
+        return EIDSP_OK;
+    }
+
+    /**
+     * Give back a workspace from acquire(), frees it if it's not cached
+     */
+    static void release(frame_workspace_t *workspace)
+    {
+        if (!workspace) {
+            return;
+        }
+        workspace->in_use = false;
+        if (!workspace->cached) {
+            destroy(workspace);
+        }
+    }
+
+    /**
+     * Free all cached workspaces
+     */
+    static void clear()
+    {
+#if EIDSP_FRAME_WORKSPACE_CACHE_SIZE > 0
+        frame_workspace_t **entries = cache_entries();
+        for (size_t ix = 0; ix < EIDSP_FRAME_WORKSPACE_CACHE_SIZE; ix++) {
+            if (entries[ix]) {
+                destroy(entries[ix]);
+                entries[ix] = nullptr;
+            }
+        }
+#endif
+    }
+
+    /**
+     * Read frame `ix` of the stacked frames into the frame of the workspace,
+     * zero padded to the FFT length
+     */
+    static int read_frame(frame_workspace_t *workspace, stack_frames_info_t *info, size_t ix)
+    {
+        // don't read outside of the audio buffer... we'll automatically zero pad then
+        size_t signal_offset = info->frame_ixs.at(ix);
+        size_t signal_length = info->frame_length;
+        if (signal_offset + signal_length > info->signal->total_length) {
+            signal_length = signal_length -
+                (info->signal->total_length - (signal_offset + signal_length));
+        }
+
+        int ret = info->signal->get_data(signal_offset, signal_length, workspace->frame);
+        if (ret != 0) {
+            EIDSP_ERR(ret);
+        }
+
+        // the FFT can overwrite its input, pad every frame
+        if (workspace->frame_length < workspace->fft_length) {
+            memset(workspace->frame + workspace->frame_length, 0,
+                (workspace->fft_length - workspace->frame_length) * sizeof(float));
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Power spectrum of the frame, |rfft(frame)|^2 / fft_length, and its sum in
+     * one pass over the FFT output. The frame is truncated to the FFT length and
+     * can be overwritten.
+     * @param workspace Workspace from acquire(), with the frame read
+     * @param out Power spectrum (fft_length / 2 + 1), can be workspace->power
+     * @param energy Receives the sum of the power spectrum, can be NULL
+     * @returns EIDSP_OK if OK
+     */
+    static int power_spectrum(frame_workspace_t *workspace, float *out, float *energy)
+    {
+        int ret = rfft(workspace);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        const fft_complex_t *spectrum = workspace->spectrum;
+        const size_t bins = workspace->fft_length / 2 + 1;
+        const float scale = 1.0f / static_cast<float>(workspace->fft_length);
+        float sum = 0.0f;
+
+        // out can alias the spectrum, bin ix only overwrites bins before it
+        for (size_t ix = 0; ix < bins; ix++) {
+            const float re = spectrum[ix].r;
+            const float im = spectrum[ix].i;
+            const float power = (re * re + im * im) * scale;
+            out[ix] = power;
+            sum += power;
+        }
+
+        if (energy) {
+            *energy = sum;
+        }
+        return EIDSP_OK;
+    }
+
+    /**
+     * numpy::dct2() of one row, with the FFT of the workspace (frame_length and
+     * fft_length the size of the row) instead of buffers and an FFT per row
+     * @param workspace Workspace from acquire()
+     * @param input Row, transformed in place
+     * @param normalization DCT_NORMALIZATION_NONE or DCT_NORMALIZATION_ORTHO
+     * @returns EIDSP_OK if OK
+     */
+    static int dct2(frame_workspace_t *workspace, float *input, DCT_NORMALIZATION_MODE normalization)
+    {
+        const size_t len = workspace->fft_length;
+        if (workspace->frame_length != len) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        // same steps as numpy::dct_transform()
+        float *fft_data_in = workspace->frame;
+        size_t halfLen = len / 2;
+        for (size_t i = 0; i < halfLen; i++) {
+            fft_data_in[i] = input[i * 2];
+            fft_data_in[len - 1 - i] = input[i * 2 + 1];
+        }
+        if (len % 2 == 1) {
+            fft_data_in[halfLen] = input[len - 1];
+        }
+
+        int ret = rfft(workspace);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        const fft_complex_t *fft_data_out = workspace->spectrum;
+        size_t i = 0;
+        for (; i < len / 2 + 1; i++) {
+            float temp = i * M_PI / (len * 2);
+            input[i] = fft_data_out[i].r * cos(temp) + fft_data_out[i].i * sin(temp);
+        }
+        for (; i < len; i++) {
+            float temp = i * M_PI / (len * 2);
+            int conj_idx = len - i;
+            input[i] = fft_data_out[conj_idx].r * cos(temp) - fft_data_out[conj_idx].i * sin(temp);
+        }
+
+        // and numpy::dct2()
+        for (size_t ix = 0; ix < len; ix++) {
+            input[ix] *= 2;
+        }
+
+        if (normalization == DCT_NORMALIZATION_ORTHO) {
+            input[0] = input[0] * sqrt(1.0f / static_cast<float>(4 * len));
+            for (size_t ix = 1; ix < len; ix++) {
+                input[ix] = input[ix] * sqrt(1.0f / static_cast<float>(2 * len));
+            }
+        }
+
+        return EIDSP_OK;
+    }
+
+private:
+#if EIDSP_FRAME_WORKSPACE_CACHE_SIZE > 0
+    static frame_workspace_t **cache_entries()
+    {
+        static frame_workspace_t *entries[EIDSP_FRAME_WORKSPACE_CACHE_SIZE] = { 0 };
+        return entries;
+    }
+#endif
+
+    /**
+     * rfft of the frame into the spectrum, same output as numpy::rfft()
+     */
+    static int rfft(frame_workspace_t *workspace)
+    {
+        const size_t n_fft = workspace->fft_length;
+
+#if EIDSP_FRAME_ENGINE_CMSIS_RFFT
+        if (workspace->cmsis_rfft) {
+            float *output = reinterpret_cast<float*>(workspace->spectrum);
+            arm_rfft_fast_f32(&workspace->rfft_instance, workspace->frame, output, 0);
+
+            // Take care of the Nyquist bin, see ei::fft::hw_r2c_fft()
+            workspace->spectrum[n_fft / 2].r = output[1];
+            workspace->spectrum[n_fft / 2].i = 0.0f;
+            workspace->spectrum[0].i = 0.0f;
+            return EIDSP_OK;
+        }
+#endif
+
+        int res = ei::fft::hw_r2c_fft(workspace->frame, workspace->spectrum, n_fft);
+        if (!numpy::handle_fft_hw_failure(res, n_fft)) {
+            return EIDSP_OK;
+        }
+
+#if EIDSP_FRAME_ENGINE_KISSFFT
+        if (!workspace->kiss_cfg) {
+            size_t kiss_fftr_mem_length;
+            workspace->kiss_cfg = kiss_fftr_alloc(n_fft, 0, NULL, NULL, &kiss_fftr_mem_length);
+            if (!workspace->kiss_cfg) {
+                EIDSP_ERR(EIDSP_OUT_OF_MEM);
+            }
+            ei_dsp_register_alloc(kiss_fftr_mem_length, workspace->kiss_cfg);
+            workspace->kiss_cfg_size = kiss_fftr_mem_length;
+        }
+
+        kiss_fftr(workspace->kiss_cfg, workspace->frame, reinterpret_cast<kiss_fft_cpx*>(workspace->spectrum));
+        return EIDSP_OK;
+#else
+        return EIDSP_NOT_SUPPORTED;
+#endif
+    }
+
+    static int build(frame_workspace_t **workspace, uint32_t frame_length, uint16_t fft_length)
+    {
+        const size_t frame_size = frame_length > fft_length ? frame_length : fft_length;
+        const size_t bins = fft_length / 2 + 1;
+        const size_t mem_size = sizeof(frame_workspace_t) + frame_size * sizeof(float) +
+            bins * sizeof(fft_complex_t);
+
+        frame_workspace_t *ws = (frame_workspace_t*)ei_dsp_calloc(mem_size, 1);
+        EI_ERR_AND_RETURN_ON_NULL(ws, EIDSP_OUT_OF_MEM);
+        ws->frame_length = frame_length;
+        ws->fft_length = fft_length;
+        ws->spectrum = reinterpret_cast<fft_complex_t*>(ws + 1);
+        ws->frame = reinterpret_cast<float*>(ws->spectrum + bins);
+        ws->power = reinterpret_cast<float*>(ws->spectrum);
+        ws->mem_size = mem_size;
+
+#if EIDSP_FRAME_ENGINE_CMSIS_RFFT
+        ws->cmsis_rfft = ei::fft::can_do_fft(fft_length) &&
+            ei::fft::cmsis_rfft_init_f32(&ws->rfft_instance, fft_length) == ARM_MATH_SUCCESS;
+#endif
+
+        // one FFT of the zeroed frame picks the FFT and builds its state now
+        int ret = rfft(ws);
+        if (ret != EIDSP_OK) {
+            destroy(ws);
+            EIDSP_ERR(ret);
+        }
+
+        *workspace = ws;
+        return EIDSP_OK;
+    }
+
+    static void destroy(frame_workspace_t *workspace)
+    {
+#if EIDSP_FRAME_ENGINE_KISSFFT
+        if (workspace->kiss_cfg) {
+            ei_dsp_free(workspace->kiss_cfg, workspace->kiss_cfg_size);
+        }
+#endif
+        ei_dsp_free(workspace, workspace->mem_size);
+    }
+};
+
+} // namespace speechpy
+} // namespace ei
+
+#endif // _EIDSP_SPEECHPY_FRAME_ENGINE_H_
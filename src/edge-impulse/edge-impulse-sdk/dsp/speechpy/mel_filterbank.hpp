@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ *
+ * Generated by Edge Impulse and licensed under the applicable Edge Impulse
+ * Terms of Service. Community and Professional Terms of Service
+ * (https://edgeimpulse.com/legal/terms-of-service) or Enterprise Terms of
+ * Service (https://edgeimpulse.com/legal/enterprise-terms-of-service),
+ * according to your product plan subscription (the “License”).
+ *
+ * This software, documentation and other associated files (collectively referred
+ * to as the “Software”) is a single SDK variation generated by the Edge Impulse
+ * platform and requires an active paid Edge Impulse subscription to use this
+ * Software for any purpose.
+ *
+ * You may NOT use this Software unless you have an active Edge Impulse subscription
+ * that meets the eligibility requirements for the applicable License, subject to
+ * your full and continued compliance with the terms and conditions of the License,
+ * including without limitation any usage restrictions under the applicable License.
+ *
+ * If you do not have an active Edge Impulse product plan subscription, or if use
+ * of this Software exceeds the usage limitations of your Edge Impulse product plan
+ * subscription, you are not permitted to use this Software and must immediately
+ * delete and erase all copies of this Software within your control or possession.
+ * Edge Impulse reserves all rights and remedies available to enforce its rights.
+ *
+ * Unless required by applicable law or agreed to in writing, the Software is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language governing
+ * permissions, disclaimers and limitations under the License.
+ */
+#ifndef _EIDSP_SPEECHPY_MEL_FILTERBANK_H_
+#define _EIDSP_SPEECHPY_MEL_FILTERBANK_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "../config.hpp"
+#include "../memory.hpp"
+#include "../numpy.hpp"
+#include "../returntypes.hpp"
+#include "functions.hpp"
+
+namespace ei {
+namespace speechpy {
+
+typedef enum {
+    MEL_FILTERBANK_MFE = 0,             // feature::mfe(), MFE v3+ and MFCC
+    MEL_FILTERBANK_SPEECHPY             // feature::mfe_v3(), the speechpy filterbanks of MFE v1 and v2
+} mel_filterbank_type_t;
+
+#define MEL_FILTER_NO_MIDDLE            0xffff
+
+/**
+ * One triangular filter, only the bins in [start, end) have a weight
+ */
+typedef struct {
+    uint16_t start;
+    uint16_t end;
+    uint16_t middle;                    // summed first with weight 1, or MEL_FILTER_NO_MIDDLE
+    uint16_t weights;                   // index of the weight of bin `start` in mel_filterbank_t::weights
+} mel_filter_t;
+
+typedef struct {
+    // the key, frequencies with their defaults applied
+    mel_filterbank_type_t type;
+    uint32_t sampling_frequency;
+    uint16_t fft_length;
+    uint16_t num_filters;
+    uint32_t low_frequency;
+    uint32_t high_frequency;
+    uint16_t version;
+
+    mel_filter_t *filters;              // num_filters
+    float *weights;
+    size_t weights_size;
+    size_t mem_size;                    // this struct, the filters and the weights in one allocation
+    bool cached;
+} mel_filterbank_t;
+
+/**
+ * Sparse Mel filterbanks. The filterbank of a configuration is built once and
+ * kept in a cache of EIDSP_MEL_FILTERBANK_CACHE_SIZE entries; applying it only
+ * touches the bins of each filter, with the weights of the dense versions, in
+ * the same order, so the features don't change.
+ */
+class mel_filterbank {
+public:
+    /**
+     * Get the filterbank of a configuration, from the cache or built now.
+     * Give it back with release().
+     * @param filterbank Receives the filterbank
+     * @param type MEL_FILTERBANK_MFE (feature::mfe) or MEL_FILTERBANK_SPEECHPY (feature::mfe_v3)
+     * @param sampling_frequency In Hz
+     * @param fft_length Number of FFT points
+     * @param num_filters Number of filters
+     * @param low_frequency Lowest band edge in Hz, 0 for the default of the type and version
+     * @param high_frequency Highest band edge in Hz, 0 for sampling_frequency / 2
+     * @param version Implementation version of the DSP block
+     * @returns EIDSP_OK if OK
+     */
+    static int acquire(const mel_filterbank_t **filterbank, mel_filterbank_type_t type,
+        uint32_t sampling_frequency, uint16_t fft_length, uint16_t num_filters,
+        uint32_t low_frequency, uint32_t high_frequency, uint16_t version)
+    {
+        mel_filterbank_t key;
+        memset(&key, 0, sizeof(key));
+        key.type = type;
+        key.sampling_frequency = sampling_frequency;
+        key.fft_length = fft_length;
+        key.num_filters = num_filters;
+        key.low_frequency = low_frequency;
+        key.high_frequency = high_frequency == 0 ? sampling_frequency / 2 : high_frequency;
+        if (low_frequency == 0 && (type == MEL_FILTERBANK_SPEECHPY || version < 4)) {
+            key.low_frequency = 300;
+        }
+        // versions with the same filterbank share an entry
+        key.version = (type == MEL_FILTERBANK_MFE && version >= 4) ? 4 : 1;
+
+#if EIDSP_MEL_FILTERBANK_CACHE_SIZE > 0
+        mel_filterbank_t **entries = cache_entries();
+        for (size_t ix = 0; ix < EIDSP_MEL_FILTERBANK_CACHE_SIZE; ix++) {
+            if (entries[ix] && same_key(entries[ix], &key)) {
+                *filterbank = entries[ix];
+                return EIDSP_OK;
+            }
+        }
+#endif
+
+        mel_filterbank_t *built;
+        int ret = build(&built, &key);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+#if EIDSP_MEL_FILTERBANK_CACHE_SIZE > 0
+        // a full cache builds the filterbank for this call only
+        for (size_t ix = 0; ix < EIDSP_MEL_FILTERBANK_CACHE_SIZE; ix++) {
+            if (entries[ix] == nullptr) {
+                built->cached = true;
+                entries[ix] = built;
+                break;
+            }
+        }
+#endif
+
+        *filterbank = built;
+        return EIDSP_OK;
+    }
+
+    /**
+     * Give back a filterbank from acquire(), frees it if it's not cached
+     */
+    static void release(const mel_filterbank_t *filterbank)
+    {
+        if (filterbank && !filterbank->cached) {
+            ei_dsp_free(const_cast<mel_filterbank_t *>(filterbank), filterbank->mem_size);
+        }
+    }
+
+    /**
+     * Free all cached filterbanks
+     */
+    static void clear()
+    {
+#if EIDSP_MEL_FILTERBANK_CACHE_SIZE > 0
+        mel_filterbank_t **entries = cache_entries();
+        for (size_t ix = 0; ix < EIDSP_MEL_FILTERBANK_CACHE_SIZE; ix++) {
+            if (entries[ix]) {
+                ei_dsp_free(entries[ix], entries[ix]->mem_size);
+                entries[ix] = nullptr;
+            }
+        }
+#endif
+    }
+
+    /**
+     * Apply the filterbank to one frame
+     * @param filterbank Filterbank from acquire()
+     * @param power_spectrum Power spectrum of the frame (fft_length / 2 + 1)
+     * @param out Filter energies (num_filters)
+     */
+    static void apply(const mel_filterbank_t *filterbank, const float *power_spectrum, float *out)
+    {
+        for (size_t i = 0; i < filterbank->num_filters; i++) {
+            const mel_filter_t *filter = &filterbank->filters[i];
+            const float *weights = filterbank->weights + filter->weights;
+            const size_t below_middle = filter->middle < filter->end ? filter->middle : filter->end;
+            size_t bin = filter->start;
+
+            float energy = filter->middle == MEL_FILTER_NO_MIDDLE ? 0.0f : power_spectrum[filter->middle];
+            for (; bin < below_middle; bin++) {
+                energy += weights[bin - filter->start] * power_spectrum[bin];
+            }
+            bin = filter->middle + 1 > filter->start ? filter->middle + 1 : filter->start;
+            for (; bin < filter->end; bin++) {
+                energy += weights[bin - filter->start] * power_spectrum[bin];
+            }
+            out[i] = energy;
+        }
+    }
+
+private:
+#if EIDSP_MEL_FILTERBANK_CACHE_SIZE > 0
+    static mel_filterbank_t **cache_entries()
+    {
+        static mel_filterbank_t *entries[EIDSP_MEL_FILTERBANK_CACHE_SIZE] = { 0 };
+        return entries;
+    }
+#endif
+
+    static bool same_key(const mel_filterbank_t *a, const mel_filterbank_t *b)
+    {
+        return a->type == b->type && a->sampling_frequency == b->sampling_frequency &&
+            a->fft_length == b->fft_length && a->num_filters == b->num_filters &&
+            a->low_frequency == b->low_frequency && a->high_frequency == b->high_frequency &&
+            a->version == b->version;
+    }
+
+    static int fft_bin(int fft_size, float hertz, uint32_t sampling_frequency)
+    {
+        return static_cast<int>(floor((fft_size + 1) * hertz / sampling_frequency));
+    }
+
+    /**
+     * Left, middle and right bins of the filters of feature::mfe()
+     */
+    static int mfe_edges(const mel_filterbank_t *key, float *mels, int *edges)
+    {
+        const int mels_size = key->num_filters + 2;
+        const uint32_t low_frequency = key->low_frequency;
+        const uint32_t high_frequency = key->high_frequency;
+
+        int ret = numpy::linspace(
+            functions::frequency_to_mel(static_cast<float>(low_frequency)),
+            functions::frequency_to_mel(static_cast<float>(high_frequency)),
+            mels_size,
+            mels);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        uint16_t max_bin = key->version >= 4 ? key->fft_length : key->fft_length / 2 + 1; // preserve a bug in v<4
+        for (int ix = 0; ix < mels_size - 1; ix++) {
+            mels[ix] = functions::mel_to_frequency(mels[ix]);
+            if (mels[ix] < low_frequency) {
+                mels[ix] = low_frequency;
+            }
+            if (mels[ix] > high_frequency) {
+                mels[ix] = high_frequency;
+            }
+            edges[ix] = static_cast<uint16_t>(fft_bin(max_bin, mels[ix], key->sampling_frequency));
+        }
+
+        // the speechpy bug of the last bucket, see feature::filterbanks()
+        mels[mels_size - 1] = functions::mel_to_frequency(mels[mels_size - 1]);
+        if (mels[mels_size - 1] > high_frequency) {
+            mels[mels_size - 1] = high_frequency;
+        }
+        mels[mels_size - 1] -= 0.001;
+        edges[mels_size - 1] = static_cast<uint16_t>(fft_bin(max_bin, mels[mels_size - 1], key->sampling_frequency));
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Left, middle and right bins of the filters of feature::filterbanks()
+     */
+    static int speechpy_edges(const mel_filterbank_t *key, float *hertz, int *edges)
+    {
+        const int hertz_size = key->num_filters + 2;
+        const uint32_t low_freq = key->low_frequency;
+        const uint32_t high_freq = key->high_frequency;
+        const int coefficients = key->fft_length / 2 + 1;
+
+        int ret = numpy::linspace(
+            functions::frequency_to_mel(static_cast<float>(low_freq)),
+            functions::frequency_to_mel(static_cast<float>(high_freq)),
+            hertz_size,
+            hertz);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        for (int ix = 0; ix < hertz_size; ix++) {
+            hertz[ix] = functions::mel_to_frequency(hertz[ix]);
+            if (hertz[ix] < low_freq) {
+                hertz[ix] = low_freq;
+            }
+            if (hertz[ix] > high_freq) {
+                hertz[ix] = high_freq;
+            }
+            if (ix == hertz_size - 1) {
+                hertz[ix] -= 0.001;
+            }
+            edges[ix] = fft_bin(coefficients, hertz[ix], key->sampling_frequency);
+        }
+
+        return EIDSP_OK;
+    }
+
+    static int build(mel_filterbank_t **filterbank, const mel_filterbank_t *key)
+    {
+        const int coefficients = key->fft_length / 2 + 1;
+        const int edges_size = key->num_filters + 2;
+
+        // edges, then the weights of one filter (speechpy)
+        const size_t scratch_size = edges_size * sizeof(int) +
+            (edges_size > coefficients ? edges_size : coefficients) * sizeof(float);
+        uint8_t *scratch = (uint8_t*)ei_dsp_malloc(scratch_size);
+        EI_ERR_AND_RETURN_ON_NULL(scratch, EIDSP_OUT_OF_MEM);
+        ei_unique_ptr_t __ptr__(scratch, [scratch_size](void* ptr){ei::ei_dsp_free_func(ptr, scratch_size);});
+        int *edges = reinterpret_cast<int*>(scratch);
+        float *z = reinterpret_cast<float*>(scratch + edges_size * sizeof(int));
+
+        int ret = key->type == MEL_FILTERBANK_MFE ?
+            mfe_edges(key, z, edges) :
+            speechpy_edges(key, z, edges);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        // mfe() skips left and right, filterbanks() has weights from left to right
+        const int skip = key->type == MEL_FILTERBANK_MFE ? 1 : 0;
+        size_t max_weights = 0;
+        for (size_t i = 0; i < key->num_filters; i++) {
+            for (int e = 0; e < 3; e++) {
+                if (edges[i + e] < 0 || edges[i + e] >= coefficients) {
+                    EIDSP_ERR(EIDSP_OUT_OF_BOUNDS);
+                }
+            }
+            const int width = edges[i + 2] - edges[i] + 1 - 2 * skip;
+            max_weights += width > 0 ? width : 0;
+        }
+        if (max_weights > MEL_FILTER_NO_MIDDLE) {
+            EIDSP_ERR(EIDSP_NARROWING);
+        }
+
+        const size_t mem_size = sizeof(mel_filterbank_t) + key->num_filters * sizeof(mel_filter_t) +
+            max_weights * sizeof(float);
+        mel_filterbank_t *fb = (mel_filterbank_t*)ei_dsp_calloc(mem_size, 1);
+        EI_ERR_AND_RETURN_ON_NULL(fb, EIDSP_OUT_OF_MEM);
+        *fb = *key;
+        fb->filters = reinterpret_cast<mel_filter_t*>(fb + 1);
+        fb->weights = reinterpret_cast<float*>(fb->filters + key->num_filters);
+        fb->mem_size = mem_size;
+        fb->cached = false;
+
+        for (size_t i = 0; i < key->num_filters; i++) {
+            mel_filter_t *filter = &fb->filters[i];
+            filter->weights = fb->weights_size;
+
+            if (key->type == MEL_FILTERBANK_MFE) {
+                size_t left = edges[i];
+                size_t middle = edges[i + 1];
+                size_t right = edges[i + 2];
+
+                filter->start = left + 1;
+                filter->end = right > left + 1 ? right : left + 1;
+                filter->middle = middle;
+                // same expressions as the weights mfe() computed per frame
+                for (size_t bin = left + 1; bin < right; bin++) {
+                    float weight = 1.0f; // middle, not used
+                    if (bin < middle) {
+                        weight = (static_cast<float>(bin) - left) / (middle - left);
+                    }
+                    if (bin > middle) {
+                        weight = (right - static_cast<float>(bin)) / (right - middle);
+                    }
+                    fb->weights[fb->weights_size++] = weight;
+                }
+            }
+            else {
+                int left = edges[i];
+                int middle = edges[i + 1];
+                int right = edges[i + 2];
+                int first = 0;
+                int last = right - left + 1;
+
+                if (last > 0) {
+                    numpy::linspace(left, right, (right - left + 1), z);
+                    functions::triangle(z, (right - left + 1), left, middle, right);
+#if EIDSP_QUANTIZE_FILTERBANK
+                    for (int zx = 0; zx < last; zx++) {
+                        z[zx] = numpy::dequantize_zero_one(numpy::quantize_zero_one(z[zx]));
+                    }
+#endif
+                    // the dot product skips (or adds) zero weights, drop them at the ends
+                    while (first < last && z[first] == 0.0f) {
+                        first++;
+                    }
+                    while (last > first && z[last - 1] == 0.0f) {
+                        last--;
+                    }
+                }
+                else {
+                    last = 0;
+                }
+
+                filter->start = left + first;
+                filter->end = left + last;
+                filter->middle = MEL_FILTER_NO_MIDDLE;
+                for (int zx = first; zx < last; zx++) {
+                    fb->weights[fb->weights_size++] = z[zx];
+                }
+            }
+        }
+
+        *filterbank = fb;
+        return EIDSP_OK;
+    }
+};
+
+} // namespace speechpy
+} // namespace ei
+
+#endif // _EIDSP_SPEECHPY_MEL_FILTERBANK_H_
@@ -46,6 +46,11 @@ typedef struct ei_stack_frames_info {
 namespace processing {
     /**
      * Lazy Preemphasising on the signal.
+     * y[n] = x[n] - cof * x[n - shift], x[n - shift] from the end of the signal
+     * for the first shift samples (numpy.roll). Each block is filtered in one
+     * pass over the data read from the signal; the shift samples before it are
+     * kept from the previous block when the blocks follow each other, read from
+     * the signal otherwise.
      * @param signal: The input signal.
      * @param shift (int): The shift step.
      * @param cof (float): The preemphasising coefficient. 0 equals to no filtering.
@@ -55,18 +60,24 @@ public:
         preemphasis(ei_signal_t *signal, int shift, float cof, bool rescale)
             : _signal(signal), _shift(shift), _cof(cof), _rescale(rescale)
         {
-            _prev_buffer = (float*)ei_dsp_calloc(shift * sizeof(float), 1);
-            _end_of_signal_buffer = (float*)ei_dsp_calloc(shift * sizeof(float), 1);
-            _next_offset_should_be = 0;
-
             if (shift < 0) {
                 _shift = signal->total_length + shift;
             }
 
-            if (!_prev_buffer || !_end_of_signal_buffer) return;
+            // end of the signal, then the history of this block and of the next one
+            _buffer = (float*)ei_dsp_calloc(_shift * 3 * sizeof(float), 1);
+            if (!_buffer) return;
+
+            _end_of_signal_buffer = _buffer;
+            _history = _buffer + _shift;
+            _next_history = _buffer + (_shift * 2);
 
             // we need to get the shift bytes from the end of the buffer...
-            signal->get_data(signal->total_length - shift, shift, _end_of_signal_buffer);
+            signal->get_data(signal->total_length - _shift, _shift, _end_of_signal_buffer);
+
+            // which is also the history of the block at offset 0
+            memcpy(_history, _end_of_signal_buffer, _shift * sizeof(float));
+            _next_offset_should_be = 0;
         }
 
         /**
@@ -76,76 +87,91 @@ public:
          * @param length Length of the audio signal
          */
         int get_data(size_t offset, size_t length, float *out_buffer) {
-            if (!_prev_buffer || !_end_of_signal_buffer) {
+            if (!_buffer) {
                 EIDSP_ERR(EIDSP_OUT_OF_MEM);
             }
             if (offset + length > _signal->total_length) {
                 EIDSP_ERR(EIDSP_OUT_OF_BOUNDS);
             }
 
+            const size_t shift = static_cast<size_t>(_shift);
             int ret;
-            if (static_cast<int32_t>(offset) - _shift >= 0) {
-                ret = _signal->get_data(offset - _shift, _shift, _prev_buffer);
+
+            if (offset != _next_offset_should_be) {
+                ret = load_history(offset);
                 if (ret != 0) {
                     EIDSP_ERR(ret);
                 }
+                _next_offset_should_be = offset;
             }
-            // else we'll use the end_of_signal_buffer; so no need to check
 
             ret = _signal->get_data(offset, length, out_buffer);
             if (ret != 0) {
                 EIDSP_ERR(ret);
             }
 
-            // now we have the signal and we can preemphasize
-            for (size_t ix = 0; ix < length; ix++) {
-                float now = out_buffer[ix];
-
-                // under shift? read from end
-                if (offset + ix < static_cast<uint32_t>(_shift)) {
-                    out_buffer[ix] = now - (_cof * _end_of_signal_buffer[offset + ix]);
-                }
-                // otherwise read from history buffer
-                else {
-                    out_buffer[ix] = now - (_cof * _prev_buffer[0]);
-                }
-
-                // roll through and overwrite last element
-                if (_shift != 1) {
-                    numpy::roll(_prev_buffer, _shift, -1);
-                }
-                _prev_buffer[_shift - 1] = now;
+            // the last shift samples are the history of the next block
+            if (length >= shift) {
+                memcpy(_next_history, out_buffer + (length - shift), shift * sizeof(float));
+            }
+            else {
+                memcpy(_next_history, _history + length, (shift - length) * sizeof(float));
+                memcpy(_next_history + (shift - length), out_buffer, length * sizeof(float));
             }
 
-            _next_offset_should_be += length;
+            // rescale from [-1 .. 1] ? (x 1.0f doesn't change the result)
+            const float scale = _rescale ? 1.0f / 32768.0f : 1.0f;
+            const float cof = _cof;
 
-            // rescale from [-1 .. 1] ?
-            if (_rescale) {
-                matrix_t scale_matrix(length, 1, out_buffer);
-                ret = numpy::scale(&scale_matrix, 1.0f / 32768.0f);
-                if (ret != 0) {
-                    EIDSP_ERR(ret);
-                }
+            // backwards, so x[n - shift] is not filtered yet
+            for (size_t ix = length; ix > shift; ix--) {
+                out_buffer[ix - 1] = (out_buffer[ix - 1] - (cof * out_buffer[ix - 1 - shift])) * scale;
+            }
+            const size_t head = length < shift ? length : shift;
+            for (size_t ix = 0; ix < head; ix++) {
+                out_buffer[ix] = (out_buffer[ix] - (cof * _history[ix])) * scale;
             }
 
+            float *history = _history;
+            _history = _next_history;
+            _next_history = history;
+            _next_offset_should_be = offset + length;
+
             return EIDSP_OK;
         }
 
         ~preemphasis() {
-            if (_prev_buffer) {
-                ei_dsp_free(_prev_buffer, _shift * sizeof(float));
-            }
-            if (_end_of_signal_buffer) {
-                ei_dsp_free(_end_of_signal_buffer, _shift * sizeof(float));
+            if (_buffer) {
+                ei_dsp_free(_buffer, _shift * 3 * sizeof(float));
             }
         }
 
 private:
+        /**
+         * Read the shift samples before offset into the history, from the
+         * end of the signal before its start
+         */
+        int load_history(size_t offset) {
+            const size_t shift = static_cast<size_t>(_shift);
+
+            if (offset >= shift) {
+                return _signal->get_data(offset - shift, shift, _history);
+            }
+
+            memcpy(_history, _end_of_signal_buffer + offset, (shift - offset) * sizeof(float));
+            if (offset > 0) {
+                return _signal->get_data(0, offset, _history + (shift - offset));
+            }
+            return EIDSP_OK;
+        }
+
         ei_signal_t *_signal;
         int _shift;
         float _cof;
-        float *_prev_buffer;
+        float *_buffer = nullptr;
         float *_end_of_signal_buffer;
+        float *_history;
+        float *_next_history;
         size_t _next_offset_should_be;
         bool _rescale;
     };
@@ -167,28 +193,22 @@ namespace processing {
             shift = signal_size + shift;
         }
 
-        // so we need to keep some history
-        float *prev_buffer = (float*)ei_dsp_calloc(shift * sizeof(float), 1);
-
-        // signal - cof * xt::roll(signal, shift)
-        for (size_t ix = 0; ix < signal_size; ix++) {
-            float now = signal[ix];
-
-            // under shift? read from end
-            if (ix < static_cast<uint32_t>(shift)) {
-                signal[ix] = now - (cof * signal[signal_size - shift + ix]);
-            }
-            // otherwise read from history buffer
-            else {
-                signal[ix] = now - (cof * prev_buffer[0]);
-            }
+        // the end of the signal, before it's filtered
+        float *end_buffer = (float*)ei_dsp_calloc(shift * sizeof(float), 1);
+        if (!end_buffer) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+        memcpy(end_buffer, signal + (signal_size - shift), shift * sizeof(float));
 
-            // roll through and overwrite last element
-            numpy::roll(prev_buffer, shift, -1);
-            prev_buffer[shift - 1] = now;
+        // signal - cof * xt::roll(signal, shift), backwards so x[n - shift] is not filtered yet
+        for (size_t ix = signal_size; ix > static_cast<size_t>(shift); ix--) {
+            signal[ix - 1] = signal[ix - 1] - (cof * signal[ix - 1 - shift]);
+        }
+        for (size_t ix = 0; ix < static_cast<size_t>(shift) && ix < signal_size; ix++) {
+            signal[ix] = signal[ix] - (cof * end_buffer[ix]);
         }
 
-        ei_dsp_free(prev_buffer, shift * sizeof(float));
+        ei_dsp_free(end_buffer, shift * sizeof(float));
 
         return EIDSP_OK;
     }
@@ -208,6 +228,20 @@ namespace processing {
         return v;
     }
 
+    /**
+     * Length of a frame in samples, as stack_frames() computes it.
+     * @param sampling_frequency (int): The sampling frequency of the signal.
+     * @param frame_length (float): The length of the frame in second.
+     * @returns Frame length in samples
+     */
+    static int calculate_frame_sample_length(float sampling_frequency, float frame_length, uint16_t version)
+    {
+        if (version == 1) {
+            return static_cast<int>(round(static_cast<float>(sampling_frequency) * frame_length));
+        }
+        return static_cast<int>(ceil_unless_very_close_to_floor(static_cast<float>(sampling_frequency) * frame_length));
+    }
+
     /**
      * Calculate the length of a signal that will be sused for the settings provided.
      * @param signal_size: The number of frames in the signal
@@ -282,15 +316,13 @@ namespace processing {
         }
 
         size_t length_signal = info->signal->total_length;
-        int frame_sample_length;
+        int frame_sample_length = calculate_frame_sample_length(sampling_frequency, frame_length, version);
         int length;
         if (version == 1) {
-            frame_sample_length = static_cast<int>(round(static_cast<float>(sampling_frequency) * frame_length));
             frame_stride = round(static_cast<float>(sampling_frequency) * frame_stride);
             length = frame_sample_length;
         }
         else {
-            frame_sample_length = static_cast<int>(ceil_unless_very_close_to_floor(static_cast<float>(sampling_frequency) * frame_length));
             float frame_stride_arg = frame_stride;
             frame_stride = ceil_unless_very_close_to_floor(static_cast<float>(sampling_frequency) * frame_stride_arg);
             length = (frame_sample_length - (int)frame_stride);
@@ -384,10 +416,154 @@ namespace processing {
         return numframes;
     }
 
+    /**
+     * Scratch buffer of cmvnw(): the column sums of the window and a copy of
+     * the features. Kept between calls and grown when a larger matrix comes in
+     * (EIDSP_CMVNW_KEEP_BUFFER), until clear().
+     */
+    class cmvnw_buffer {
+    public:
+        static void *acquire(size_t size)
+        {
+#if EIDSP_CMVNW_KEEP_BUFFER == 1
+            void **buffer = cached_buffer();
+            size_t *cached = cached_size();
+            if (*buffer && *cached >= size) {
+                return *buffer;
+            }
+            clear();
+
+            *buffer = ei_dsp_malloc(size);
+            if (*buffer) {
+                *cached = size;
+            }
+            return *buffer;
+#else
+            return ei_dsp_malloc(size);
+#endif
+        }
+
+        static void release(void *buffer, size_t size)
+        {
+#if EIDSP_CMVNW_KEEP_BUFFER == 1
+            (void)buffer;
+            (void)size;
+#else
+            ei_dsp_free(buffer, size);
+#endif
+        }
+
+        static void clear()
+        {
+#if EIDSP_CMVNW_KEEP_BUFFER == 1
+            void **buffer = cached_buffer();
+            size_t *size = cached_size();
+            if (*buffer) {
+                ei_dsp_free(*buffer, *size);
+                *buffer = nullptr;
+                *size = 0;
+            }
+#endif
+        }
+
+    private:
+#if EIDSP_CMVNW_KEEP_BUFFER == 1
+        static void **cached_buffer()
+        {
+            static void *buffer = nullptr;
+            return &buffer;
+        }
+
+        static size_t *cached_size()
+        {
+            static size_t size = 0;
+            return &size;
+        }
+#endif
+    };
+
+    /**
+     * Row of the features at index ix of the symmetric padding of the features
+     * (ix < 0 before the first row, ix >= rows after the last), the same row
+     * numpy::pad_1d_symmetric() copies there
+     */
+    static inline size_t cmvnw_padded_row(int32_t ix, int32_t rows)
+    {
+        int32_t period = rows * 2;
+        int32_t row = ix % period;
+        if (row < 0) {
+            row += period;
+        }
+        return row < rows ? row : period - 1 - row;
+    }
+
+    /**
+     * Add (sign 1) or remove (sign -1) a row of the features from the running
+     * column sums of the window
+     */
+    static inline void cmvnw_slide(const float *row, size_t cols, double sign, double *sum, double *sum_sq)
+    {
+        for (size_t col = 0; col < cols; col++) {
+            sum[col] += sign * row[col];
+        }
+        if (sum_sq) {
+            for (size_t col = 0; col < cols; col++) {
+                double value = row[col];
+                sum_sq[col] += sign * value * value;
+            }
+        }
+    }
+
+    /**
+     * Sum the window of every row of the features (win_size rows starting
+     * pad_size rows before it in the symmetric padding, the last one cut at the
+     * end of the padding when win_size is even) and call fn(row, count, sum, sum_sq) for it.
+     * The sums run over the window, a row is added when it enters the window
+     * and removed when it leaves it, so this is O(rows x cols) for any window.
+     * They are doubles: sums of a few hundred floats are then (nearly) exact,
+     * so nothing is left of a row that left the window, and the sum of squares
+     * minus the squared sum doesn't cancel out the variance of the window.
+     * @param features Copy of the features (rows x cols)
+     * @param sum Column sums (cols)
+     * @param sum_sq Column sums of squares (cols), or nullptr
+     */
+    template<typename Fn>
+    static void cmvnw_windows(const float *features, size_t rows, size_t cols, uint16_t win_size,
+        uint16_t pad_size, double *sum, double *sum_sq, Fn fn)
+    {
+        const int32_t n = static_cast<int32_t>(rows);
+        // last row of the padding
+        const int32_t last = n - 1 + pad_size;
+
+        memset(sum, 0, cols * sizeof(double));
+        if (sum_sq) {
+            memset(sum_sq, 0, cols * sizeof(double));
+        }
+
+        int32_t first = -static_cast<int32_t>(pad_size);
+        for (int32_t ix = first; ix < first + win_size - 1 && ix <= last; ix++) {
+            cmvnw_slide(features + cmvnw_padded_row(ix, n) * cols, cols, 1.0, sum, sum_sq);
+        }
+
+        for (int32_t row = 0; row < n; row++, first++) {
+            int32_t enter = first + win_size - 1;
+            if (enter <= last) {
+                cmvnw_slide(features + cmvnw_padded_row(enter, n) * cols, cols, 1.0, sum, sum_sq);
+            }
+
+            int32_t count = (enter <= last ? enter : last) - first + 1;
+            fn(row, static_cast<double>(count), sum, sum_sq);
+
+            cmvnw_slide(features + cmvnw_padded_row(first, n) * cols, cols, -1.0, sum, sum_sq);
+        }
+    }
+
     /**
      * This function performs local cepstral mean and
      * variance normalization on a sliding window. The code assumes that
      * there is one observation per row.
+     * Running sums over the window, see cmvnw_reference() for the direct
+     * computation of every window.
      * @param features_matrix input feature matrix, will be modified in place
      * @param win_size The size of sliding window for local normalization.
      *   Default=301 which is around 3s if 100 Hz rate is
@@ -404,6 +580,84 @@ namespace processing {
             return EIDSP_OK;
         }
 
+        if (features_matrix->rows == 0) {
+            EIDSP_ERR(EIDSP_INPUT_MATRIX_EMPTY);
+        }
+
+        const uint16_t pad_size = (win_size - 1) / 2;
+        const size_t rows = features_matrix->rows;
+        const size_t cols = features_matrix->cols;
+        float *features = features_matrix->buffer;
+
+        // the sums and the sums of squares, then the copy of the features
+        const size_t buffer_size = (2 * cols * sizeof(double)) + (rows * cols * sizeof(float));
+        double *sum = (double *)cmvnw_buffer::acquire(buffer_size);
+        if (!sum) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+        double *sum_sq = sum + cols;
+        float *copy = (float *)(sum_sq + cols);
+
+        // mean normalization, the windows see the features before the mean is subtracted
+        memcpy(copy, features, rows * cols * sizeof(float));
+        cmvnw_windows(copy, rows, cols, win_size, pad_size, sum, nullptr,
+            [features, cols](int32_t row, double count, const double *window_sum, const double *) {
+                float *out = features + row * cols;
+                for (size_t col = 0; col < cols; col++) {
+                    out[col] = out[col] - static_cast<float>(window_sum[col] / count);
+                }
+            });
+
+        // variance normalization over windows of the mean normalized features
+        if (variance_normalization) {
+            memcpy(copy, features, rows * cols * sizeof(float));
+            cmvnw_windows(copy, rows, cols, win_size, pad_size, sum, sum_sq,
+                [features, cols](int32_t row, double count, const double *window_sum, const double *window_sum_sq) {
+                    float *out = features + row * cols;
+                    for (size_t col = 0; col < cols; col++) {
+                        double mean = window_sum[col] / count;
+                        // rounding can take it just under 0
+                        float variance = static_cast<float>((window_sum_sq[col] / count) - (mean * mean));
+                        float std = variance > 0.0f ? numpy::sqrt(variance) : 0.0f;
+                        out[col] = out[col] / (std + 1e-10);
+                    }
+                });
+        }
+
+        cmvnw_buffer::release(sum, buffer_size);
+
+        if (scale) {
+            int ret = numpy::normalize(features_matrix);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * This function performs local cepstral mean and
+     * variance normalization on a sliding window. The code assumes that
+     * there is one observation per row.
+     * Computes every window again (O(rows x win_size x cols)), kept as the
+     * reference of cmvnw().
+     * @param features_matrix input feature matrix, will be modified in place
+     * @param win_size The size of sliding window for local normalization.
+     *   Default=301 which is around 3s if 100 Hz rate is
+     *   considered(== 10ms frame stide)
+     * @param variance_normalization If the variance normilization should
+     *   be performed or not.
+     * @param scale Scale output to 0..1
+     * @returns 0 if OK
+     */
+    static int cmvnw_reference(matrix_t *features_matrix, uint16_t win_size = 301, bool variance_normalization = false,
+        bool scale = false)
+    {
+        if (win_size == 0) {
+            return EIDSP_OK;
+        }
+
         uint16_t pad_size = (win_size - 1) / 2;
 
         int ret;
@@ -431,8 +685,9 @@ namespace processing {
         }
 
         for (size_t ix = 0; ix < features_matrix->rows; ix++) {
-            // create a slice on the vec_pad
-            EI_DSP_MATRIX_B(window, win_size, vec_pad.cols, vec_pad.buffer + (ix * vec_pad.cols));
+            // create a slice on the vec_pad, the last one is a row short for an even win_size
+            EI_DSP_MATRIX_B(window, std::min<size_t>(win_size, vec_pad.rows - ix), vec_pad.cols,
+                vec_pad.buffer + (ix * vec_pad.cols));
             if (!window.buffer) {
                 EIDSP_ERR(EIDSP_OUT_OF_MEM);
             }
@@ -455,8 +710,9 @@ namespace processing {
         }
 
         for (size_t ix = 0; ix < features_matrix->rows; ix++) {
-            // create a slice on the vec_pad
-            EI_DSP_MATRIX_B(window, win_size, vec_pad.cols, vec_pad.buffer + (ix * vec_pad.cols));
+            // create a slice on the vec_pad, the last one is a row short for an even win_size
+            EI_DSP_MATRIX_B(window, std::min<size_t>(win_size, vec_pad.rows - ix), vec_pad.cols,
+                vec_pad.buffer + (ix * vec_pad.cols));
             if (!window.buffer) {
                 EIDSP_ERR(EIDSP_OUT_OF_MEM);
             }
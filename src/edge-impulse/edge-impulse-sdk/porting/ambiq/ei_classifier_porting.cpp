@@ -97,14 +97,20 @@ __attribute__((weak)) void ei_printf_float(float f) {
     ei_printf("%f", f);
 }
 
+#if EI_CLASSIFIER_COUNT_ALLOCATIONS == 1
+uint32_t ei_allocation_count = 0;
+#endif
+
 __attribute__((weak)) void *ei_malloc(size_t size) {
 
+    EI_COUNT_ALLOCATION();
     void *p = ns_malloc(size);
     return p;
 }
 
 __attribute__((weak)) void *ei_calloc(size_t nitems, size_t size) {
 
+    EI_COUNT_ALLOCATION();
     void *ret = ns_malloc(nitems*size);
     memset(ret, 0, nitems*size);
     return ret;
@@ -115,9 +121,14 @@ __attribute__((weak)) void ei_free(void *ptr) {
     ns_free(ptr);
 }
 
-void ei_putchar(char c) 
-{ 
-    ei_printf("%c", c);
+void ei_putchar(char c)
+{
+#if defined(EI_APOLLO_USE_UART) && (EI_APOLLO_USE_UART == 1)
+    uart_send((uint8_t *)&c, 1);
+#else
+    /* buffered, flushed on the next ei_printf or explicit ei_usb_flush */
+    ei_usb_putc(c);
+#endif
 }
 
 char ei_getchar(void)
@@ -257,6 +257,17 @@ void *ei_calloc(size_t nitems, size_t size);
  */
 void ei_free(void *ptr);
 
+#if EI_CLASSIFIER_COUNT_ALLOCATIONS == 1
+/**
+ * @brief Number of `ei_malloc()` and `ei_calloc()` calls, incremented by the
+ * porting with EI_COUNT_ALLOCATION() when built with EI_CLASSIFIER_COUNT_ALLOCATIONS=1
+ */
+extern uint32_t ei_allocation_count;
+#define EI_COUNT_ALLOCATION()   (ei_allocation_count++)
+#else
+#define EI_COUNT_ALLOCATION()
+#endif // EI_CLASSIFIER_COUNT_ALLOCATIONS == 1
+
 /** @} */
 
 #if defined(__cplusplus) && EI_C_LINKAGE == 1
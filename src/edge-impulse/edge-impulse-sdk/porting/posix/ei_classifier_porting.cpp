@@ -98,11 +98,17 @@ __attribute__((weak)) char ei_getchar(void)
     return getchar();
 }
 
+#if EI_CLASSIFIER_COUNT_ALLOCATIONS == 1
+uint32_t ei_allocation_count = 0;
+#endif
+
 __attribute__((weak)) void *ei_malloc(size_t size) {
+    EI_COUNT_ALLOCATION();
     return malloc(size);
 }
 
 __attribute__((weak)) void *ei_calloc(size_t nitems, size_t size) {
+    EI_COUNT_ALLOCATION();
     return calloc(nitems, size);
 }
 
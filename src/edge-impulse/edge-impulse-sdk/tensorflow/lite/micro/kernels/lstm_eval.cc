@@ -26,6 +26,13 @@ limitations under the License.
 #include "edge-impulse-sdk/tensorflow/lite/kernels/internal/reference/tanh.h"
 #include "edge-impulse-sdk/tensorflow/lite/kernels/internal/types.h"
 
+// Patched by Edge Impulse to route the integer gate math through CMSIS-NN
+#include "edge-impulse-sdk/classifier/ei_classifier_config.h"
+#if EI_CLASSIFIER_TFLITE_ENABLE_CMSIS_NN == 1
+#include "edge-impulse-sdk/CMSIS/NN/Include/arm_nnfunctions.h"
+#include "edge-impulse-sdk/CMSIS/NN/Include/arm_nnsupportfunctions.h"
+#endif
+
 namespace tflite {
 namespace lstm_internal {
 
@@ -102,6 +109,18 @@ void Mul(const RuntimeShape& shape, const ArithmeticParams& params,
 void Mul(const RuntimeShape& shape, const ArithmeticParams& params,
          const int16_t* input1_data, const int16_t* input2_data,
          int16_t* output_data) {
+#if EI_CLASSIFIER_TFLITE_ENABLE_CMSIS_NN == 1
+  // The gate outputs and the cell state are symmetric, so the s16 kernel
+  // (which ignores offsets) matches the reference bit for bit.
+  if (params.input1_offset == 0 && params.input2_offset == 0 &&
+      params.output_offset == 0) {
+    arm_elementwise_mul_s16(input1_data, input2_data, 0, 0, output_data, 0,
+                            params.output_multiplier, params.output_shift,
+                            params.quantized_activation_min,
+                            params.quantized_activation_max, shape.FlatSize());
+    return;
+  }
+#endif
   return reference_integer_ops::MulElementwise(
       shape.FlatSize(), params, input1_data, input2_data, output_data);
 }
@@ -119,6 +138,24 @@ void FullyConnected(const FullyConnectedParams& params,
                     const RuntimeShape& filter_shape, const int8_t* filter_data,
                     const RuntimeShape& bias_shape, const int32_t* bias_data,
                     const RuntimeShape& output_shape, int16_t* output_data) {
+#if EI_CLASSIFIER_TFLITE_ENABLE_CMSIS_NN == 1
+  if (params.weights_offset == 0 && params.output_offset == 0) {
+    const int output_dim_count = output_shape.DimensionsCount();
+    const int batches = FlatSizeSkipDim(output_shape, output_dim_count - 1);
+    const int output_depth = output_shape.Dims(output_dim_count - 1);
+    const int accum_depth =
+        filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+    for (int b = 0; b < batches; ++b) {
+      arm_nn_vec_mat_mult_t_s8_s16(
+          input_data + b * accum_depth, filter_data, bias_data,
+          output_data + b * output_depth, params.input_offset,
+          params.output_multiplier, params.output_shift, accum_depth,
+          output_depth, params.quantized_activation_min,
+          params.quantized_activation_max);
+    }
+    return;
+  }
+#endif
   return tflite::reference_integer_ops::FullyConnected(
       params, input_shape, input_data, filter_shape, filter_data, bias_shape,
       bias_data, output_shape, output_data);
@@ -129,6 +166,28 @@ void FullyConnected(const FullyConnectedParams& params,
                     const RuntimeShape& filter_shape, const int8_t* filter_data,
                     const RuntimeShape& bias_shape, const int64_t* bias_data,
                     const RuntimeShape& output_shape, int16_t* output_data) {
+#if EI_CLASSIFIER_TFLITE_ENABLE_CMSIS_NN == 1
+  if (params.input_offset == 0 && params.weights_offset == 0 &&
+      params.output_offset == 0) {
+    const int output_dim_count = output_shape.DimensionsCount();
+    const int batches = FlatSizeSkipDim(output_shape, output_dim_count - 1);
+    const int output_depth = output_shape.Dims(output_dim_count - 1);
+    const int accum_depth =
+        filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+    // The s16 kernel requantizes with the 64 bit reduced multiplier, the same
+    // rounding as MultiplyByQuantizedMultiplier() on an int64_t accumulator.
+    const int32_t reduced_multiplier =
+        REDUCE_MULTIPLIER(params.output_multiplier);
+    for (int b = 0; b < batches; ++b) {
+      arm_nn_vec_mat_mult_t_s16(
+          input_data + b * accum_depth, filter_data, bias_data,
+          output_data + b * output_depth, reduced_multiplier,
+          params.output_shift, accum_depth, output_depth,
+          params.quantized_activation_min, params.quantized_activation_max);
+    }
+    return;
+  }
+#endif
   return tflite::reference_integer_ops::FullyConnected(
       params, input_shape, input_data, filter_shape, filter_data, bias_shape,
       bias_data, output_shape, output_data);
@@ -2,6 +2,586 @@
 #include "../../../../classifier/ei_classifier_config.h"
 #if 0 == 1
 /* noop */
+#elif EI_CLASSIFIER_TFLITE_ENABLE_CMSIS_NN == 1
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/reference/transpose_conv.h"
+
+#include <string.h>
+
+#include "edge-impulse-sdk/CMSIS/NN/Include/arm_nn_types.h"
+#include "edge-impulse-sdk/CMSIS/NN/Include/arm_nnfunctions.h"
+#include "edge-impulse-sdk/tensorflow/lite/c/builtin_op_data.h"
+#include "edge-impulse-sdk/tensorflow/lite/c/common.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/common.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/quantization_util.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/reference/integer_ops/transpose_conv.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/kernel_util.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/padding.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/kernels/kernel_util.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_log.h"
+
+namespace tflite {
+namespace {
+
+// For the TfLite transpose_conv implementation, input tensor 0 corresponds to
+// the OutputShapeTensor. However, since TFLM does not support dynamic tensors,
+// the TFLM implementation ignores input tensor 0 and the only inputs we care
+// about are kFilterTensor, kInputTensor and kBiasTensor.
+constexpr int kFilterTensor = 1;
+constexpr int kInputTensor = 2;
+constexpr int kBiasTensor = 3;
+constexpr int kOutputTensor = 0;
+
+// Conv is quantized along dimension 0:
+// https://www.tensorflow.org/lite/performance/quantization_spec
+constexpr int kConvQuantizedDimension = 0;
+
+// The quantized kernels run the transpose convolution as a stride 1 CMSIS-NN
+// convolution over the input upsampled by the strides (zero points inserted
+// between the pixels). A convolution correlates with the filter while a
+// transpose convolution scatters it, so the upsampled input is built with its
+// pixel order reversed, and the reversed output is reversed back in place.
+// Same accumulators as the reference kernel, the results are bit exact.
+struct OpData {
+  ConvParams params;
+
+  // Upsampled (and reversed) input of one batch for the quantized kernels.
+  int scratch_buffer_index;
+  int upsampled_height;
+  int upsampled_width;
+
+  // Padding of the convolution over the upsampled input.
+  int conv_padding_height;
+  int conv_padding_width;
+
+  // Index to the CMSIS-NN convolution buffer, -1 if not required.
+  int buffer_idx;
+
+  // TODO(b/192090531): Remove this once all 8x16 transpose conv models use
+  // 64-bit biases.
+  int bias_converted_buffer_index;
+
+  // Multiplier and shift arrays are required for the int8 implementation.
+  int32_t* per_channel_output_multiplier;
+  int32_t* per_channel_output_shift;
+};
+
+inline PaddingType RuntimePaddingType(TfLitePadding padding) {
+  switch (padding) {
+    case TfLitePadding::kTfLitePaddingSame:
+      return PaddingType::kSame;
+    case TfLitePadding::kTfLitePaddingValid:
+      return PaddingType::kValid;
+    case TfLitePadding::kTfLitePaddingUnknown:
+    default:
+      return PaddingType::kNone;
+  }
+}
+
+TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
+                             const TfLiteTransposeConvParams* params, int width,
+                             int height, int filter_width, int filter_height,
+                             const TfLiteType data_type, OpData* data) {
+  bool has_bias = node->inputs->size == 4;
+  // Check number of inputs/outputs
+  TF_LITE_ENSURE(context, has_bias || node->inputs->size == 3);
+  TF_LITE_ENSURE_EQ(context, node->outputs->size, 1);
+
+  // Matching GetWindowedOutputSize in TensorFlow.
+  auto padding = params->padding;
+  int unused_output_width;
+  int unused_output_height;
+  TfLitePaddingValues padding_values = ComputePaddingHeightWidth(
+      params->stride_height, params->stride_width, 1,
+      1,  // Dilation height and width are always 1 for transpose_conv.
+      height, width, filter_height, filter_width, padding,
+      &unused_output_height, &unused_output_width);
+
+  data->params.padding_type = RuntimePaddingType(padding);
+  data->params.padding_values.width = padding_values.width;
+  data->params.padding_values.height = padding_values.height;
+
+  // Note that quantized inference requires that all tensors have their
+  // parameters set. This is usually done during quantized training.
+  if (data_type != kTfLiteFloat32) {
+    MicroContext* micro_context = GetMicroContext(context);
+
+    TfLiteTensor* input =
+        micro_context->AllocateTempInputTensor(node, kInputTensor);
+    TF_LITE_ENSURE(context, input != nullptr);
+    TfLiteTensor* filter =
+        micro_context->AllocateTempInputTensor(node, kFilterTensor);
+    TF_LITE_ENSURE(context, filter != nullptr);
+    TfLiteTensor* bias =
+        micro_context->AllocateTempInputTensor(node, kBiasTensor);
+    TfLiteTensor* output =
+        micro_context->AllocateTempOutputTensor(node, kOutputTensor);
+    TF_LITE_ENSURE(context, output != nullptr);
+    int output_channels = filter->dims->data[kConvQuantizedDimension];
+
+    TF_LITE_ENSURE_STATUS(tflite::PopulateConvolutionQuantizationParams(
+        context, input, filter, bias, output, kTfLiteActNone,
+        &data->params.output_multiplier, &data->params.output_shift,
+        &data->params.quantized_activation_min,
+        &data->params.quantized_activation_max,
+        data->per_channel_output_multiplier, data->per_channel_output_shift,
+        output_channels));
+
+    // TODO(b/192090531): Remove this once all 8x16 transpose conv models use
+    // 64-bit biases.
+    if (input->type == kTfLiteInt16) {
+      TFLITE_DCHECK(filter->type == kTfLiteInt8);
+      TFLITE_DCHECK(output->type == kTfLiteInt16);
+      if (bias->type == kTfLiteInt16) {
+        TFLITE_DCHECK(
+            context->RequestScratchBufferInArena(
+                context, GetTensorShape(bias).FlatSize() * sizeof(std::int64_t),
+                &(data->bias_converted_buffer_index)) == kTfLiteOk);
+      }
+    }
+
+    micro_context->DeallocateTempTfLiteTensor(input);
+    micro_context->DeallocateTempTfLiteTensor(filter);
+    micro_context->DeallocateTempTfLiteTensor(output);
+    if (bias != nullptr) {
+      micro_context->DeallocateTempTfLiteTensor(bias);
+    }
+  }
+  return kTfLiteOk;
+}
+
+// Parameters of the stride 1 convolution over one upsampled batch.
+void FillCmsisNnParams(const OpData& data, const RuntimeShape& input_shape,
+                       const RuntimeShape& filter_shape,
+                       const RuntimeShape& output_shape,
+                       cmsis_nn_conv_params* conv_params,
+                       cmsis_nn_dims* input_dims, cmsis_nn_dims* filter_dims,
+                       cmsis_nn_dims* output_dims) {
+  conv_params->input_offset = data.params.input_offset;
+  conv_params->output_offset = data.params.output_offset;
+  conv_params->stride.h = 1;
+  conv_params->stride.w = 1;
+  conv_params->dilation.h = 1;
+  conv_params->dilation.w = 1;
+  conv_params->padding.h = data.conv_padding_height;
+  conv_params->padding.w = data.conv_padding_width;
+  conv_params->activation.min = data.params.quantized_activation_min;
+  conv_params->activation.max = data.params.quantized_activation_max;
+
+  input_dims->n = 1;
+  input_dims->h = data.upsampled_height;
+  input_dims->w = data.upsampled_width;
+  input_dims->c = input_shape.Dims(3);
+
+  filter_dims->n = output_shape.Dims(3);
+  filter_dims->h = filter_shape.Dims(1);
+  filter_dims->w = filter_shape.Dims(2);
+  filter_dims->c = input_shape.Dims(3);
+
+  output_dims->n = 1;
+  output_dims->h = output_shape.Dims(1);
+  output_dims->w = output_shape.Dims(2);
+  output_dims->c = output_shape.Dims(3);
+}
+
+// Scatters one batch of the input to every stride-th pixel of the upsampled
+// buffer, in reverse pixel order. The pixels in between are pad_value, i.e.
+// the input zero point, which doesn't contribute to the accumulators.
+template <typename T>
+void UpsampleReversed(const OpData& data, const RuntimeShape& input_shape,
+                      const T* input_data, T pad_value, T* upsampled_data) {
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int depth = input_shape.Dims(3);
+  const int upsampled_pixels = data.upsampled_height * data.upsampled_width;
+
+  if (data.params.stride_height > 1 || data.params.stride_width > 1) {
+    for (int i = 0; i < upsampled_pixels * depth; i++) {
+      upsampled_data[i] = pad_value;
+    }
+  }
+
+  for (int y = 0; y < input_height; y++) {
+    const int upsampled_y =
+        data.upsampled_height - 1 - y * data.params.stride_height;
+    for (int x = 0; x < input_width; x++) {
+      const int upsampled_x =
+          data.upsampled_width - 1 - x * data.params.stride_width;
+      memcpy(&upsampled_data[(upsampled_y * data.upsampled_width +
+                              upsampled_x) * depth],
+             &input_data[(y * input_width + x) * depth], depth * sizeof(T));
+    }
+  }
+}
+
+// Reverses the pixel order (flips height and width) of one batch in place.
+template <typename T>
+void ReversePixels(const RuntimeShape& output_shape, T* output_data) {
+  const int pixels = output_shape.Dims(1) * output_shape.Dims(2);
+  const int depth = output_shape.Dims(3);
+
+  for (int i = 0; i < pixels / 2; i++) {
+    T* front = &output_data[i * depth];
+    T* back = &output_data[(pixels - 1 - i) * depth];
+    for (int c = 0; c < depth; c++) {
+      const T tmp = front[c];
+      front[c] = back[c];
+      back[c] = tmp;
+    }
+  }
+}
+
+TfLiteStatus EvalQuantizedPerChannel(TfLiteContext* context,
+                                     const OpData& data,
+                                     const TfLiteEvalTensor* input,
+                                     const TfLiteEvalTensor* filter,
+                                     const TfLiteEvalTensor* bias,
+                                     TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+
+  cmsis_nn_conv_params conv_params;
+  cmsis_nn_dims input_dims;
+  cmsis_nn_dims filter_dims;
+  cmsis_nn_dims output_dims;
+  FillCmsisNnParams(data, input_shape, filter_shape, output_shape,
+                    &conv_params, &input_dims, &filter_dims, &output_dims);
+
+  cmsis_nn_dims bias_dims;
+  bias_dims.n = 1;
+  bias_dims.h = 1;
+  bias_dims.w = 1;
+  bias_dims.c = output_dims.c;
+
+  cmsis_nn_per_channel_quant_params quant_params;
+  quant_params.multiplier = data.per_channel_output_multiplier;
+  quant_params.shift = data.per_channel_output_shift;
+
+  cmsis_nn_context ctx;
+  ctx.buf = nullptr;
+  ctx.size = 0;
+  if (data.buffer_idx > -1) {
+    ctx.buf = context->GetScratchBuffer(context, data.buffer_idx);
+  }
+
+  int8_t* upsampled_data = static_cast<int8_t*>(
+      context->GetScratchBuffer(context, data.scratch_buffer_index));
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  const int input_batch_size = input_shape.FlatSize() / batches;
+  const int output_batch_size = output_shape.FlatSize() / batches;
+
+  for (int b = 0; b < batches; b++) {
+    UpsampleReversed<int8_t>(data, input_shape,
+                             input_data + b * input_batch_size,
+                             static_cast<int8_t>(-data.params.input_offset),
+                             upsampled_data);
+
+    TF_LITE_ENSURE_EQ(
+        context,
+        arm_convolve_wrapper_s8(
+            &ctx, &conv_params, &quant_params, &input_dims, upsampled_data,
+            &filter_dims, tflite::micro::GetTensorData<int8_t>(filter),
+            &bias_dims, tflite::micro::GetOptionalTensorData<int32_t>(bias),
+            &output_dims, output_data + b * output_batch_size),
+        ARM_CMSIS_NN_SUCCESS);
+
+    ReversePixels<int8_t>(output_shape, output_data + b * output_batch_size);
+  }
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus EvalQuantizedPerChannel16x8(TfLiteContext* context,
+                                         const OpData& data,
+                                         const TfLiteEvalTensor* input,
+                                         const TfLiteEvalTensor* filter,
+                                         const int64_t* bias_data,
+                                         TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+
+  cmsis_nn_conv_params conv_params;
+  cmsis_nn_dims input_dims;
+  cmsis_nn_dims filter_dims;
+  cmsis_nn_dims output_dims;
+  FillCmsisNnParams(data, input_shape, filter_shape, output_shape,
+                    &conv_params, &input_dims, &filter_dims, &output_dims);
+
+  cmsis_nn_dims bias_dims;
+  bias_dims.n = 1;
+  bias_dims.h = 1;
+  bias_dims.w = 1;
+  bias_dims.c = output_dims.c;
+
+  cmsis_nn_per_channel_quant_params quant_params;
+  quant_params.multiplier = data.per_channel_output_multiplier;
+  quant_params.shift = data.per_channel_output_shift;
+
+  cmsis_nn_context ctx;
+  ctx.buf = nullptr;
+  ctx.size = 0;
+  if (data.buffer_idx > -1) {
+    ctx.buf = context->GetScratchBuffer(context, data.buffer_idx);
+  }
+
+  int16_t* upsampled_data = static_cast<int16_t*>(
+      context->GetScratchBuffer(context, data.scratch_buffer_index));
+  const int16_t* input_data = tflite::micro::GetTensorData<int16_t>(input);
+  int16_t* output_data = tflite::micro::GetTensorData<int16_t>(output);
+  const int input_batch_size = input_shape.FlatSize() / batches;
+  const int output_batch_size = output_shape.FlatSize() / batches;
+
+  for (int b = 0; b < batches; b++) {
+    UpsampleReversed<int16_t>(data, input_shape,
+                              input_data + b * input_batch_size, 0,
+                              upsampled_data);
+
+    TF_LITE_ENSURE_EQ(
+        context,
+        arm_convolve_wrapper_s16(
+            &ctx, &conv_params, &quant_params, &input_dims, upsampled_data,
+            &filter_dims, tflite::micro::GetTensorData<int8_t>(filter),
+            &bias_dims, bias_data, &output_dims,
+            output_data + b * output_batch_size),
+        ARM_CMSIS_NN_SUCCESS);
+
+    ReversePixels<int16_t>(output_shape, output_data + b * output_batch_size);
+  }
+
+  return kTfLiteOk;
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  TFLITE_DCHECK(node->builtin_data != nullptr);
+
+  OpData* data = static_cast<OpData*>(node->user_data);
+  const auto params =
+      static_cast<const TfLiteTransposeConvParams*>(node->builtin_data);
+
+  MicroContext* micro_context = GetMicroContext(context);
+
+  TfLiteTensor* output =
+      micro_context->AllocateTempOutputTensor(node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+  TfLiteTensor* input =
+      micro_context->AllocateTempInputTensor(node, kInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  TfLiteTensor* filter =
+      micro_context->AllocateTempInputTensor(node, kFilterTensor);
+  TF_LITE_ENSURE(context, filter != nullptr);
+
+  // Get height and width of the output.
+  const int width = SizeOfDimension(output, 2);
+  const int height = SizeOfDimension(output, 1);
+  const int filter_width = SizeOfDimension(filter, 2);
+  const int filter_height = SizeOfDimension(filter, 1);
+
+  // Dynamically allocate per-channel quantization parameters.
+  const int num_channels = filter->dims->data[kConvQuantizedDimension];
+  data->per_channel_output_multiplier =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, num_channels * sizeof(int32_t)));
+  data->per_channel_output_shift =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, num_channels * sizeof(int32_t)));
+
+  // Quantized kernels upsample the input of one batch into a scratch buffer.
+  if (input->type == kTfLiteInt8 || input->type == kTfLiteInt16) {
+    data->upsampled_height =
+        (SizeOfDimension(input, 1) - 1) * params->stride_height + 1;
+    data->upsampled_width =
+        (SizeOfDimension(input, 2) - 1) * params->stride_width + 1;
+    TFLITE_DCHECK(context->RequestScratchBufferInArena != nullptr);
+    TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+        context,
+        data->upsampled_height * data->upsampled_width *
+            SizeOfDimension(input, 3) * TfLiteTypeGetSize(input->type),
+        &(data->scratch_buffer_index)));
+  }
+
+  // All per-channel quantized tensors need valid zero point and scale arrays.
+  if (input->type == kTfLiteInt8 || input->type == kTfLiteInt16) {
+    TF_LITE_ENSURE_EQ(context, filter->quantization.type,
+                      kTfLiteAffineQuantization);
+
+    const auto* affine_quantization =
+        static_cast<TfLiteAffineQuantization*>(filter->quantization.params);
+    TF_LITE_ENSURE(context, affine_quantization);
+    TF_LITE_ENSURE(context, affine_quantization->scale);
+    TF_LITE_ENSURE(context, affine_quantization->zero_point);
+
+    TF_LITE_ENSURE(context,
+                   affine_quantization->scale->size == 1 ||
+                       affine_quantization->scale->size ==
+                           filter->dims->data[kConvQuantizedDimension]);
+    TF_LITE_ENSURE_EQ(context, affine_quantization->scale->size,
+                      affine_quantization->zero_point->size);
+  }
+
+  TF_LITE_ENSURE_STATUS(CalculateOpData(context, node, params, width, height,
+                                        filter_width, filter_height,
+                                        input->type, data));
+
+  // Offsets (zero points)
+  data->params.input_offset = -input->params.zero_point;
+  data->params.weights_offset = -filter->params.zero_point;
+  data->params.output_offset = output->params.zero_point;
+
+  // Stride
+  data->params.stride_width = params->stride_width;
+  data->params.stride_height = params->stride_height;
+
+  data->buffer_idx = -1;
+  if (input->type == kTfLiteInt8 || input->type == kTfLiteInt16) {
+    // Output pixel o of the reversed output reads upsampled pixels
+    // o - conv_padding .. o - conv_padding + filter - 1, which lines up with
+    // the transpose convolution padding. Never negative, at least filter - 1
+    // for VALID padding and stride - 1 for SAME padding.
+    data->conv_padding_height =
+        height - data->upsampled_height + data->params.padding_values.height;
+    data->conv_padding_width =
+        width - data->upsampled_width + data->params.padding_values.width;
+    TF_LITE_ENSURE(context, data->conv_padding_height >= 0 &&
+                                data->conv_padding_width >= 0);
+
+    cmsis_nn_conv_params conv_params;
+    cmsis_nn_dims input_dims;
+    cmsis_nn_dims filter_dims;
+    cmsis_nn_dims output_dims;
+    FillCmsisNnParams(*data, GetTensorShape(input), GetTensorShape(filter),
+                      GetTensorShape(output), &conv_params, &input_dims,
+                      &filter_dims, &output_dims);
+
+    int32_t buf_size = 0;
+    if (input->type == kTfLiteInt8) {
+      buf_size = arm_convolve_wrapper_s8_get_buffer_size(
+          &conv_params, &input_dims, &filter_dims, &output_dims);
+    } else {
+      TF_LITE_ENSURE_EQ(context, input->params.zero_point, 0);
+      TF_LITE_ENSURE_EQ(context, output->params.zero_point, 0);
+      buf_size = arm_convolve_wrapper_s16_get_buffer_size(
+          &conv_params, &input_dims, &filter_dims, &output_dims);
+    }
+
+    if (buf_size > 0) {
+      TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+          context, buf_size, &data->buffer_idx));
+    }
+  }
+
+  micro_context->DeallocateTempTfLiteTensor(output);
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(filter);
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const TfLiteEvalTensor* filter =
+      tflite::micro::GetEvalInput(context, node, kFilterTensor);
+  const TfLiteEvalTensor* bias =
+      (NumInputs(node) == 4)
+          ? tflite::micro::GetEvalInput(context, node, kBiasTensor)
+          : nullptr;
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+
+  TF_LITE_ENSURE_EQ(context, input->type, output->type);
+  TF_LITE_ENSURE_MSG(
+      context,
+      input->type == filter->type ||
+          (input->type == kTfLiteInt16 && filter->type == kTfLiteInt8),
+      "Hybrid models are not supported on TFLite Micro.");
+
+  switch (input->type) {  // Already know in/out types are same.
+    case kTfLiteFloat32: {
+      const auto& params =
+          *(reinterpret_cast<TfLiteConvParams*>(node->builtin_data));
+      ConvParams op_params = data.params;
+      CalculateActivationRange(params.activation,
+                               &op_params.float_activation_min,
+                               &op_params.float_activation_max);
+
+      reference_ops::TransposeConv(
+          op_params, tflite::micro::GetTensorShape(input),
+          tflite::micro::GetTensorData<float>(input),
+          tflite::micro::GetTensorShape(filter),
+          tflite::micro::GetTensorData<float>(filter),
+          tflite::micro::GetTensorShape(bias),
+          tflite::micro::GetOptionalTensorData<float>(bias),
+          tflite::micro::GetTensorShape(output),
+          tflite::micro::GetTensorData<float>(output),
+          tflite::micro::GetTensorShape(nullptr), nullptr);
+      break;
+    }
+    case kTfLiteInt8: {
+      return EvalQuantizedPerChannel(context, data, input, filter, bias,
+                                     output);
+    }
+    case kTfLiteInt16: {
+      // TODO(b/192090531): Remove this once all 8x16 transpose conv models use
+      // 64-bit biases.
+      if (bias != nullptr && bias->type == kTfLiteInt16) {
+        std::int64_t* bias_converted_buffer =
+            static_cast<int64_t*>(context->GetScratchBuffer(
+                context, data.bias_converted_buffer_index));
+        for (int i = 0; i < tflite::micro::GetTensorShape(bias).FlatSize();
+             i++) {
+          bias_converted_buffer[i] = bias->data.i16[i];
+        }
+        return EvalQuantizedPerChannel16x8(context, data, input, filter,
+                                           bias_converted_buffer, output);
+      }
+      return EvalQuantizedPerChannel16x8(
+          context, data, input, filter,
+          tflite::micro::GetOptionalTensorData<std::int64_t>(bias), output);
+    }
+    default:
+      MicroPrintf("Type %s (%d) not supported.", TfLiteTypeGetName(input->type),
+                  input->type);
+      return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteRegistration Register_TRANSPOSE_CONV() {
+  return tflite::micro::RegisterOp(Init, Prepare, Eval);
+}
+
+}  // namespace tflite
+
 #elif EI_CLASSIFIER_TFLITE_ENABLE_SILABS_MVP == 1
 
 #include "edge-impulse-sdk/tensorflow/lite/c/common.h"
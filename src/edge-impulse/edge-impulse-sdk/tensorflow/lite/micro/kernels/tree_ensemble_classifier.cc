@@ -44,6 +44,15 @@
 namespace tflite {
 namespace {
 
+// An internal node with the fields Eval reads next to each other, children[0]
+// is taken when the feature is <= value
+struct TreeNode {
+  float value;
+  uint16_t featureid;
+  uint16_t children[2];
+  uint16_t padding;
+};
+
 struct OpDataTree {
   uint32_t num_leaf_nodes;
   uint32_t num_internal_nodes;
@@ -58,6 +67,9 @@ struct OpDataTree {
   const uint16_t* tree_root_ids;
   const uint8_t* buffer_t;
   size_t buffer_length;
+  // internal nodes copied out of the flexbuffer at Prepare, in a persistent
+  // buffer of the arena; nullptr (arena too small) walks the flexbuffer
+  TreeNode* nodes;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -82,14 +94,36 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   data->nodes_weights = (float*)(m["nodes_weights"].AsBlob().data());
   data->nodes_classids = (uint8_t*)(m["nodes_classids"].AsBlob().data());
   data->tree_root_ids = (uint16_t*)(m["tree_root_ids"].AsBlob().data());
+  data->nodes = nullptr;
 
   return data;
 }
 
+// Copy the internal nodes into one array of TreeNode: a node is then one
+// aligned 12 byte read instead of five flexbuffer arrays
+void FlattenNodes(TfLiteContext* context, OpDataTree* data) {
+  if (data->nodes != nullptr || data->num_internal_nodes == 0) {
+    return;
+  }
+  data->nodes = static_cast<TreeNode*>(context->AllocatePersistentBuffer(
+      context, data->num_internal_nodes * sizeof(TreeNode)));
+  if (data->nodes == nullptr) {
+    return;
+  }
+  for (uint32_t i = 0; i < data->num_internal_nodes; i++) {
+    TreeNode* node = &data->nodes[i];
+    memcpy(&node->value, data->nodes_values + i, sizeof(float));
+    node->featureid = data->nodes_featureids[i];
+    node->children[0] = data->nodes_truenodeids[i];
+    node->children[1] = data->nodes_falsenodeids[i];
+    node->padding = 0;
+  }
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   MicroContext* micro_context = GetMicroContext(context);
-  const OpDataTree* data = static_cast<const OpDataTree*>(node->user_data);
+  OpDataTree* data = static_cast<OpDataTree*>(node->user_data);
   const flexbuffers::Map& m = flexbuffers::GetRoot(data->buffer_t, data->buffer_length).AsMap();
 
   // The OOB checks below are very important to prevent vulnerabilities where an adversary sends
@@ -152,6 +186,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   micro_context->DeallocateTempTfLiteTensor(input);
   micro_context->DeallocateTempTfLiteTensor(output);
 
+  // only once the node indices are known to be valid
+  FlattenNodes(context, data);
+
   return kTfLiteOk;
 }
 
@@ -170,6 +207,25 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const tflite::RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
   memset(out_data, 0, output_shape.FlatSize() * sizeof(float));
 
+  if (data->nodes != nullptr) {
+    const TreeNode* nodes = data->nodes;
+    for (uint32_t i = 0; i < data->num_trees; i++) {
+      uint32_t ix = data->tree_root_ids[i];
+
+      while (ix < data->num_internal_nodes) {
+        const TreeNode& n = nodes[ix];
+        // not (>) so that NaN features take the false branch as below
+        ix = n.children[!(in_data[n.featureid] <= n.value)];
+      }
+      ix -= data->num_internal_nodes;
+
+      float weight = 0;
+      memcpy(&weight, (data->nodes_weights + ix), sizeof(float));
+      out_data[data->nodes_classids[ix]] += weight;
+    }
+    return kTfLiteOk;
+  }
+
   for (uint32_t i = 0; i < data->num_trees; i++) {
     uint16_t ix = data->tree_root_ids[i];
 
@@ -198,7 +254,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
 TfLiteRegistration* Register_TreeEnsembleClassifier() {
   static TfLiteRegistration r = {Init,
-          nullptr,
+          /*free=*/nullptr,
           Prepare,
           Eval,
           /*profiling_string=*/nullptr,
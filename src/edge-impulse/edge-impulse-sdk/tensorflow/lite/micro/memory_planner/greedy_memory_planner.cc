@@ -15,9 +15,17 @@ limitations under the License.
 
 #include "edge-impulse-sdk/tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
 
+#include <stdint.h>
+
 #include "edge-impulse-sdk/tensorflow/lite/micro/micro_log.h"
 #include "edge-impulse-sdk/tensorflow/lite/micro/micro_string.h"
 
+// Number of buffer offsets kept by the plan cache, 0 disables it. The cache
+// holds the last plan only and isn't thread safe: plan one model at a time.
+#ifndef TF_LITE_MICRO_PLAN_CACHE_SIZE
+#define TF_LITE_MICRO_PLAN_CACHE_SIZE 64
+#endif
+
 namespace tflite {
 
 namespace {
@@ -35,35 +43,75 @@ char GetOrdinalCharacter(int i) {
   return '*';
 }
 
-}  // namespace
+// In-place heap sort of buffer ids, O(n log n) without extra memory. Not
+// stable, the orders used break ties on the id so the result is deterministic.
+template <typename Less>
+void SiftDown(int* ids, int root, int size, Less less) {
+  while (true) {
+    int child = root * 2 + 1;
+    if (child >= size) {
+      return;
+    }
+    if (child + 1 < size && less(ids[child], ids[child + 1])) {
+      ++child;
+    }
+    if (!less(ids[root], ids[child])) {
+      return;
+    }
+    const int temp = ids[root];
+    ids[root] = ids[child];
+    ids[child] = temp;
+    root = child;
+  }
+}
 
-// Simple stable in-place sort function. Not time-efficient for large arrays.
-// Would normally be in an anonymous namespace to keep it private, but we want
-// to be able to test it externally.
-void ReverseSortInPlace(int* values, int* ids, int size) {
-  bool any_swapped;
-  do {
-    any_swapped = false;
-    for (int i = 1; i < size; ++i) {
-      if (values[i - 1] < values[i]) {
-        const int value_temp = values[i - 1];
-        values[i - 1] = values[i];
-        values[i] = value_temp;
-        const int id_temp = ids[i - 1];
-        ids[i - 1] = ids[i];
-        ids[i] = id_temp;
-        any_swapped = true;
-      }
+template <typename Less>
+void HeapSort(int* ids, int size, Less less) {
+  for (int i = size / 2 - 1; i >= 0; --i) {
+    SiftDown(ids, i, size, less);
+  }
+  for (int end = size - 1; end > 0; --end) {
+    const int temp = ids[0];
+    ids[0] = ids[end];
+    ids[end] = temp;
+    SiftDown(ids, 0, end, less);
+  }
+}
+
+#if TF_LITE_MICRO_PLAN_CACHE_SIZE > 0
+// The last plan calculated, keyed by a hash of the buffer requirements.
+struct PlanCache {
+  uint64_t hash;
+  int buffer_count;
+  int offsets[TF_LITE_MICRO_PLAN_CACHE_SIZE];
+  size_t max_memory_size;
+};
+
+PlanCache plan_cache = {0, 0, {0}, 0};
+
+// 64-bit FNV-1a
+uint64_t HashInts(uint64_t hash, const int* values, int count) {
+  for (int i = 0; i < count; ++i) {
+    uint32_t value = static_cast<uint32_t>(values[i]);
+    for (int byte = 0; byte < 4; ++byte) {
+      hash ^= value & 0xff;
+      hash *= 1099511628211ull;
+      value >>= 8;
     }
-  } while (any_swapped);
+  }
+  return hash;
 }
+#endif  // TF_LITE_MICRO_PLAN_CACHE_SIZE > 0
+
+}  // namespace
 
-GreedyMemoryPlanner::GreedyMemoryPlanner() {}
+GreedyMemoryPlanner::GreedyMemoryPlanner() : best_of_strategies_(false) {}
 
 TfLiteStatus GreedyMemoryPlanner::Init(unsigned char* scratch_buffer,
                                        int scratch_buffer_size) {
   // Reset internal states
   buffer_count_ = 0;
+  max_memory_size_ = 0;
   need_to_calculate_offsets_ = true;
 
   // Allocate the arrays we need within the scratch buffer arena.
@@ -73,16 +121,22 @@ TfLiteStatus GreedyMemoryPlanner::Init(unsigned char* scratch_buffer,
   requirements_ = reinterpret_cast<BufferRequirements*>(next_free);
   next_free += sizeof(BufferRequirements) * max_buffer_count_;
 
-  buffer_sizes_sorted_ = reinterpret_cast<int*>(next_free);
+  buffer_ids_sorted_ = reinterpret_cast<int*>(next_free);
   next_free += sizeof(int) * max_buffer_count_;
 
-  buffer_ids_sorted_ = reinterpret_cast<int*>(next_free);
+  buffer_ids_by_time_ = reinterpret_cast<int*>(next_free);
   next_free += sizeof(int) * max_buffer_count_;
 
-  buffers_sorted_by_offset_ = reinterpret_cast<ListEntry*>(next_free);
-  next_free += sizeof(ListEntry) * max_buffer_count_;
+  max_last_time_used_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  active_buffer_ids_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
 
   buffer_offsets_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  best_buffer_offsets_ = reinterpret_cast<int*>(next_free);
   return kTfLiteOk;
 }
 
@@ -117,148 +171,156 @@ TfLiteStatus GreedyMemoryPlanner::AddBuffer(int size, int first_time_used,
   return kTfLiteOk;
 }
 
-bool GreedyMemoryPlanner::DoesEntryOverlapInTime(
-    const GreedyMemoryPlanner::ListEntry* entry, const int first_time_used,
-    const int last_time_used) const {
-  const BufferRequirements* entry_requirements =
-      &requirements_[entry->requirements_index];
-  if (entry_requirements->first_time_used > last_time_used) {
-    return false;
+bool GreedyMemoryPlanner::IsPlacedBefore(int a, int b,
+                                         PlacementOrder order) const {
+  const BufferRequirements* a_requirements = &requirements_[a];
+  const BufferRequirements* b_requirements = &requirements_[b];
+  const int a_lifetime =
+      a_requirements->last_time_used - a_requirements->first_time_used + 1;
+  const int b_lifetime =
+      b_requirements->last_time_used - b_requirements->first_time_used + 1;
+  switch (order) {
+    case kByArea: {
+      const int64_t a_area =
+          static_cast<int64_t>(a_requirements->size) * a_lifetime;
+      const int64_t b_area =
+          static_cast<int64_t>(b_requirements->size) * b_lifetime;
+      if (a_area != b_area) {
+        return a_area > b_area;
+      }
+      break;
+    }
+    case kByLifetime:
+      if (a_lifetime != b_lifetime) {
+        return a_lifetime > b_lifetime;
+      }
+      break;
+    case kByFirstUse:
+      if (a_requirements->first_time_used != b_requirements->first_time_used) {
+        return a_requirements->first_time_used <
+               b_requirements->first_time_used;
+      }
+      break;
+    default:
+      break;
   }
-  if (first_time_used > entry_requirements->last_time_used) {
-    return false;
+  if (a_requirements->size != b_requirements->size) {
+    return a_requirements->size > b_requirements->size;
   }
-  return true;
+  // Same as the stable sort this planner used to have: buffers of the same
+  // size are placed from the last one added to the first.
+  return a > b;
 }
 
-GreedyMemoryPlanner::ListEntry*
-GreedyMemoryPlanner::NextSimultaneouslyActiveBuffer(
-    const GreedyMemoryPlanner::ListEntry* start, const int first_time_used,
-    const int last_time_used) {
-  ListEntry* result = nullptr;
-  ListEntry* candidate_next_entry;
-  if (start == nullptr) {
-    candidate_next_entry = &buffers_sorted_by_offset_[first_entry_index_];
-  } else {
-    if (start->next_entry_index == -1) {
-      return nullptr;
+void GreedyMemoryPlanner::AddToIntervalTree(int buffer_id) {
+  const BufferRequirements* requirements = &requirements_[buffer_id];
+  int lo = 0;
+  int hi = buffer_count_;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    if (max_last_time_used_[mid] < requirements->last_time_used) {
+      max_last_time_used_[mid] = requirements->last_time_used;
     }
-    candidate_next_entry = &buffers_sorted_by_offset_[start->next_entry_index];
-  }
-  do {
-    if (DoesEntryOverlapInTime(candidate_next_entry, first_time_used,
-                               last_time_used)) {
-      result = candidate_next_entry;
-      break;
+    const int mid_id = buffer_ids_by_time_[mid];
+    if (mid_id == buffer_id) {
+      return;
     }
-    if (candidate_next_entry->next_entry_index == -1) {
-      break;
+    const int mid_first_time_used = requirements_[mid_id].first_time_used;
+    if (requirements->first_time_used < mid_first_time_used ||
+        (requirements->first_time_used == mid_first_time_used &&
+         buffer_id < mid_id)) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
     }
-    candidate_next_entry =
-        &buffers_sorted_by_offset_[candidate_next_entry->next_entry_index];
-  } while (true);
-  return result;
+  }
 }
 
-void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
-  if (!need_to_calculate_offsets_ || (buffer_count_ == 0)) {
+void GreedyMemoryPlanner::FindActiveBuffers(int lo, int hi,
+                                            const int first_time_used,
+                                            const int last_time_used,
+                                            int* active_count) {
+  if (lo >= hi) {
     return;
   }
-  need_to_calculate_offsets_ = false;
+  const int mid = (lo + hi) / 2;
+  // No buffer placed in this range is still active at first_time_used.
+  if (max_last_time_used_[mid] < first_time_used) {
+    return;
+  }
+  FindActiveBuffers(lo, mid, first_time_used, last_time_used, active_count);
+  const int mid_id = buffer_ids_by_time_[mid];
+  const BufferRequirements* mid_requirements = &requirements_[mid_id];
+  // This buffer and the ones after it start after last_time_used.
+  if (mid_requirements->first_time_used > last_time_used) {
+    return;
+  }
+  if (buffer_offsets_[mid_id] != -1 &&
+      mid_requirements->last_time_used >= first_time_used) {
+    active_buffer_ids_[(*active_count)++] = mid_id;
+  }
+  FindActiveBuffers(mid + 1, hi, first_time_used, last_time_used,
+                    active_count);
+}
 
-  // Start off by ordering the buffers in descending order of size.
-  // This helps find a more compact layout. Intuitively, you can think
-  // about putting the large buffers in place first, and then the
-  // smaller buffers can fit in the gaps, rather than fragmenting the
-  // gaps with small buffers at the beginning. Add offline planned offsets
-  // first in the list, since they have a predetermined offset.
-  int idx_from_tail = buffer_count_;
-  int idx_from_head = 0;
+void GreedyMemoryPlanner::PlaceBuffers(PlacementOrder order) {
+  // Offline planned buffers go first in the list, since they have a
+  // predetermined offset. The online planned ones follow in placement order.
+  // In descending order of size this helps find a more compact layout.
+  // Intuitively, you can think about putting the large buffers in place
+  // first, and then the smaller buffers can fit in the gaps, rather than
+  // fragmenting the gaps with small buffers at the beginning.
+  int online_start = 0;
   for (int i = 0; i < buffer_count_; ++i) {
-    if (requirements_[i].offline_offset == kOnlinePlannedBuffer) {
-      idx_from_tail--;
-      buffer_sizes_sorted_[idx_from_tail] = requirements_[i].size;
-      buffer_ids_sorted_[idx_from_tail] = i;
-      buffer_offsets_[i] = -1;
-    } else {
-      buffer_sizes_sorted_[idx_from_head] = requirements_[i].size;
-      buffer_ids_sorted_[idx_from_head] = i;
-      buffer_offsets_[i] = requirements_[i].offline_offset;
-      idx_from_head++;
+    if (requirements_[i].offline_offset != kOnlinePlannedBuffer) {
+      buffer_ids_sorted_[online_start++] = i;
     }
   }
-
-  // This sorting algorithm is naive, and may end up taking a very long time
-  // with hundreds of buffers. Do not sort the offline planned offsets.
-  ReverseSortInPlace(&buffer_sizes_sorted_[idx_from_head],
-                     &buffer_ids_sorted_[idx_from_head],
-                     buffer_count_ - idx_from_head);
-
-  // Initialize the first entry to the first buffer in
-  // buffer_ids_sorted_.
-  //   - If there are no offline planned offsets, the largest buffer will be
-  //     first, and the buffers will be handled in size order.
-  //   - If offline offsets are present, these will be handled first in order
-  //     for the greedy algorithm to utilized gaps in the offline plan.
-  first_entry_index_ = 0;
-  next_free_entry_ = 1;
-  ListEntry* first_entry = &buffers_sorted_by_offset_[first_entry_index_];
-  first_entry->next_entry_index = -1;  // to mark the entry as end of list
-  int buffer_id = buffer_ids_sorted_[0];
-  first_entry->requirements_index = buffer_id;
-  if (requirements_[buffer_id].offline_offset == kOnlinePlannedBuffer) {
-    buffer_offsets_[buffer_id] = 0;
+  int online_end = online_start;
+  for (int i = 0; i < buffer_count_; ++i) {
+    if (requirements_[i].offline_offset == kOnlinePlannedBuffer) {
+      buffer_ids_sorted_[online_end++] = i;
+    }
+    buffer_offsets_[i] = -1;
+    max_last_time_used_[i] = INT32_MIN;
   }
-  first_entry->offset = buffer_offsets_[buffer_id];
+  HeapSort(&buffer_ids_sorted_[online_start], buffer_count_ - online_start,
+           [this, order](int a, int b) { return IsPlacedBefore(a, b, order); });
 
-  // Work through the rest of the buffers to find a good gap to place each one.
-  for (int i = 1; i < buffer_count_; ++i) {
+  for (int i = 0; i < buffer_count_; ++i) {
     // The id is the order the buffer was originally added by the client.
-    buffer_id = buffer_ids_sorted_[i];
+    const int buffer_id = buffer_ids_sorted_[i];
     // Look at what size and time range the buffer needs to be active.
-    BufferRequirements* wanted_requirements = &requirements_[buffer_id];
+    const BufferRequirements* wanted_requirements = &requirements_[buffer_id];
     const int wanted_size = wanted_requirements->size;
-    const int wanted_first_time_used = wanted_requirements->first_time_used;
-    const int wanted_last_time_used = wanted_requirements->last_time_used;
-
-    // Find the first buffer that's active in our time range. All placed
-    // buffers are stored in the order of their starting position in the arena
-    // so that it's easy to find the next buffer in memory, and so the gap.
-    // The candidate_entry variable holds the buffer that we're considering
-    // placing the current buffer after.
 
     int candidate_offset = 0;
-    // Loop through the offset-ordered list of buffers, looking for gaps.
     if (wanted_requirements->offline_offset == kOnlinePlannedBuffer) {
-      ListEntry* prior_entry = nullptr;
-      while (true) {
-        // Find out what the next active buffer is.
-        ListEntry* next_entry = NextSimultaneouslyActiveBuffer(
-            prior_entry, wanted_first_time_used, wanted_last_time_used);
-
-        if (prior_entry) {
-          BufferRequirements* candidate_requirements =
-              &requirements_[prior_entry->requirements_index];
-          const int prior_entry_offset =
-              prior_entry->offset + candidate_requirements->size;
-          if (prior_entry_offset > candidate_offset) {
-            candidate_offset = prior_entry_offset;
-          }
-        }
-        if (next_entry == nullptr) {
-          // We're at the end of the list, so we can always append the buffer
-          // here.
-          break;
-        }
+      // Find the buffers that are active in our time range, in the order of
+      // their starting position in the arena, so it's easy to find the gaps.
+      int active_count = 0;
+      FindActiveBuffers(0, buffer_count_, wanted_requirements->first_time_used,
+                        wanted_requirements->last_time_used, &active_count);
+      const int* offsets = buffer_offsets_;
+      HeapSort(active_buffer_ids_, active_count, [offsets](int a, int b) {
+        return offsets[a] < offsets[b] || (offsets[a] == offsets[b] && a < b);
+      });
+
+      for (int j = 0; j < active_count; ++j) {
+        const int active_id = active_buffer_ids_[j];
         // Find out how much space there is between us and the next buffer.
-        const int gap = next_entry->offset - candidate_offset;
+        const int gap = buffer_offsets_[active_id] - candidate_offset;
         if (gap >= wanted_size) {
           // This entry has a big enough gap between it and the next, so
           // use it!
           break;
         }
         // The gap wasn't big enough, so move on to another candidate.
-        prior_entry = next_entry;
+        const int active_end =
+            buffer_offsets_[active_id] + requirements_[active_id].size;
+        if (active_end > candidate_offset) {
+          candidate_offset = active_end;
+        }
       }
     } else {
       // Offline planned offset are to be considered constant
@@ -269,45 +331,93 @@ void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
     // buffers in this time range and so we can put it at offset zero.
     // Record the buffer's offset in our plan.
     buffer_offsets_[buffer_id] = candidate_offset;
-    // Add the newly-placed buffer to our offset-ordered list, so that
-    // subsequent passes can fit in their buffers around it.
-    ListEntry* new_entry = &buffers_sorted_by_offset_[next_free_entry_];
-    new_entry->offset = candidate_offset;
-    new_entry->requirements_index = buffer_id;
-    const int new_entry_index = next_free_entry_;
-    ++next_free_entry_;
-
-    if (first_entry->offset > candidate_offset) {
-      // The new entry offset is smaller than the first entry offset =>
-      // replace the first entry
-      first_entry = new_entry;
-      first_entry->next_entry_index = first_entry_index_;
-      first_entry_index_ = new_entry_index;
-    } else {
-      ListEntry* current_entry = first_entry;
-      // Make sure that we insert the buffer at the correct place in the
-      // buffer-offset-ordered list
-      while (true) {
-        const int next_entry_index = current_entry->next_entry_index;
-        if (next_entry_index == -1) {
-          // We're at the end of the list, so just add the new entry here.
-          current_entry->next_entry_index = new_entry_index;
-          new_entry->next_entry_index = -1;
-          break;
-        }
-        // not at the end of the list -> take a look at next entry
-        ListEntry* next_entry = &buffers_sorted_by_offset_[next_entry_index];
-        if (next_entry->offset > candidate_offset) {
-          // We're at the right spot to do an insertion and retain the sorting
-          // order, so place the new entry here.
-          new_entry->next_entry_index = current_entry->next_entry_index;
-          current_entry->next_entry_index = new_entry_index;
-          break;
+    // Add the newly-placed buffer to the interval tree, so that subsequent
+    // passes can fit in their buffers around it.
+    AddToIntervalTree(buffer_id);
+  }
+}
+
+size_t GreedyMemoryPlanner::CalculateMaximumMemorySize() const {
+  size_t max_size = 0;
+  for (int i = 0; i < buffer_count_; ++i) {
+    const size_t current_size = buffer_offsets_[i] + requirements_[i].size;
+    if (current_size > max_size) {
+      max_size = current_size;
+    }
+  }
+  return max_size;
+}
+
+void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
+  if (!need_to_calculate_offsets_ || (buffer_count_ == 0)) {
+    return;
+  }
+  need_to_calculate_offsets_ = false;
+
+#if TF_LITE_MICRO_PLAN_CACHE_SIZE > 0
+  const bool use_cache =
+      !best_of_strategies_ && buffer_count_ <= TF_LITE_MICRO_PLAN_CACHE_SIZE;
+  uint64_t hash = 0;
+  if (use_cache) {
+    hash = HashInts(14695981039346656037ull, &buffer_count_, 1);
+    hash = HashInts(hash, reinterpret_cast<const int*>(requirements_),
+                    buffer_count_ * (sizeof(BufferRequirements) / sizeof(int)));
+    if (plan_cache.hash == hash && plan_cache.buffer_count == buffer_count_) {
+      for (int i = 0; i < buffer_count_; ++i) {
+        buffer_offsets_[i] = plan_cache.offsets[i];
+      }
+      max_memory_size_ = plan_cache.max_memory_size;
+      return;
+    }
+  }
+#endif  // TF_LITE_MICRO_PLAN_CACHE_SIZE > 0
+
+  // The interval tree: buffers sorted by the time they're first used.
+  for (int i = 0; i < buffer_count_; ++i) {
+    buffer_ids_by_time_[i] = i;
+  }
+  const BufferRequirements* requirements = requirements_;
+  HeapSort(buffer_ids_by_time_, buffer_count_,
+           [requirements](int a, int b) {
+             return requirements[a].first_time_used <
+                        requirements[b].first_time_used ||
+                    (requirements[a].first_time_used ==
+                         requirements[b].first_time_used &&
+                     a < b);
+           });
+
+  PlaceBuffers(kBySize);
+  max_memory_size_ = CalculateMaximumMemorySize();
+
+  if (best_of_strategies_) {
+    for (int i = 0; i < buffer_count_; ++i) {
+      best_buffer_offsets_[i] = buffer_offsets_[i];
+    }
+    for (int order = kBySize + 1; order < kPlacementOrderCount; ++order) {
+      PlaceBuffers(static_cast<PlacementOrder>(order));
+      const size_t memory_size = CalculateMaximumMemorySize();
+      if (memory_size < max_memory_size_) {
+        max_memory_size_ = memory_size;
+        for (int i = 0; i < buffer_count_; ++i) {
+          best_buffer_offsets_[i] = buffer_offsets_[i];
         }
-        current_entry = next_entry;
       }
     }
+    for (int i = 0; i < buffer_count_; ++i) {
+      buffer_offsets_[i] = best_buffer_offsets_[i];
+    }
   }
+
+#if TF_LITE_MICRO_PLAN_CACHE_SIZE > 0
+  if (use_cache) {
+    plan_cache.hash = hash;
+    plan_cache.buffer_count = buffer_count_;
+    for (int i = 0; i < buffer_count_; ++i) {
+      plan_cache.offsets[i] = buffer_offsets_[i];
+    }
+    plan_cache.max_memory_size = max_memory_size_;
+  }
+#endif  // TF_LITE_MICRO_PLAN_CACHE_SIZE > 0
 }
 
 size_t GreedyMemoryPlanner::GetMaximumMemorySize() {
@@ -315,21 +425,7 @@ size_t GreedyMemoryPlanner::GetMaximumMemorySize() {
   if (buffer_count_ == 0) {
     return 0;
   }
-  ListEntry* entry = &buffers_sorted_by_offset_[first_entry_index_];
-  size_t max_size = 0;
-  while (entry) {
-    BufferRequirements* requirements =
-        &requirements_[entry->requirements_index];
-    const size_t current_size = entry->offset + requirements->size;
-    if (current_size > max_size) {
-      max_size = current_size;
-    }
-    if (entry->next_entry_index == -1) {
-      break;
-    }
-    entry = &buffers_sorted_by_offset_[entry->next_entry_index];
-  }
-  return max_size;
+  return max_memory_size_;
 }
 
 void GreedyMemoryPlanner::PrintMemoryPlan() {
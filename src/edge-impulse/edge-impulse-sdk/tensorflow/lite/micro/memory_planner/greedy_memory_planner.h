@@ -31,18 +31,27 @@ constexpr int kOnlinePlannedBuffer = -1;
 //  - When a function like GetOffsetForBuffer() is called, the
 //    CalculateOffsetsIfNeeded() method is invoked.
 //  - If an up to date plan is not already present, one will be calculated.
+//    The last plan is cached by a hash of the buffers added, so setting up the
+//    same model again (e.g. on every inference) reuses it.
 //  - The buffers are sorted in descending order of size.
 //  - The largest buffer is placed at offset zero.
 //  - The rest of the buffers are looped through in descending size order.
-//  - The other buffers that need to be in memory at the same time are found.
+//  - The other buffers that need to be in memory at the same time are found
+//    with an interval tree over the lifetimes of the placed buffers, and
+//    sorted by offset.
 //  - The first gap between simultaneously active buffers that the current
 //    buffer fits into will be used.
 //  - If no large-enough gap is found, the current buffer is placed after the
 //    last buffer that's simultaneously active.
 //  - This continues until all buffers are placed, and the offsets stored.
 //
+// Planning is O(n log n) for n buffers as long as only a few of them are
+// active at the same time, which is the case for most models.
+//
 // This is not guaranteed to produce the best placement, since that's an
 // NP-Complete problem, but in practice it should produce one that's decent.
+// SetBestOfStrategies() makes the planner try a few placement orders and keep
+// the smallest plan, this is meant for offline planning on the host.
 class GreedyMemoryPlanner : public MicroMemoryPlanner {
  public:
   GreedyMemoryPlanner();
@@ -56,7 +65,7 @@ class GreedyMemoryPlanner : public MicroMemoryPlanner {
   // planned for will depend on the size of this scratch memory, so you should
   // enlarge it if you see an error when calling AddBuffer(). The memory can be
   // reused once you're done with the planner, as long as you copy the
-  // calculated offsets to another location. Each buffer requires about 36 bytes
+  // calculated offsets to another location. Each buffer requires about 40 bytes
   // of scratch.
   TfLiteStatus Init(unsigned char* scratch_buffer,
                     int scratch_buffer_size) override;
@@ -89,34 +98,62 @@ class GreedyMemoryPlanner : public MicroMemoryPlanner {
   // is an O(N^2) complexity operation, so only use for testing.
   bool DoAnyBuffersOverlap();
 
-  // Used to store a list of buffers ordered by their offset.
-  struct ListEntry {
-    int offset;
-    int requirements_index;
-    int next_entry_index;
+  // Orders the online planned buffers are placed in.
+  enum PlacementOrder {
+    kBySize,      // largest first, the default
+    kByArea,      // largest size * lifetime first
+    kByLifetime,  // longest lived first
+    kByFirstUse,  // earliest first, then largest
+    kPlacementOrderCount,
   };
 
+  // Place the buffers in every PlacementOrder and keep the plan with the
+  // smallest arena. This plans kPlacementOrderCount times and bypasses the
+  // plan cache, use it for offline planning (e.g. on the host) rather than on
+  // the device.
+  void SetBestOfStrategies(bool enabled) {
+    best_of_strategies_ = enabled;
+    need_to_calculate_offsets_ = true;
+  }
+
   // Number of bytes required in order to plan a buffer.
   static size_t per_buffer_size() {
     const int per_buffer_size =
         sizeof(BufferRequirements) +  // requirements_
-        sizeof(int) +                 // buffer_sizes_sorted_
         sizeof(int) +                 // buffer_ids_sorted_
-        sizeof(ListEntry) +           // buffers_sorted_by_offset_
-        sizeof(int);                  // buffer_offsets_;
+        sizeof(int) +                 // buffer_ids_by_time_
+        sizeof(int) +                 // max_last_time_used_
+        sizeof(int) +                 // active_buffer_ids_
+        sizeof(int) +                 // buffer_offsets_
+        sizeof(int);                  // best_buffer_offsets_
     return per_buffer_size;
   }
 
  private:
-  // Whether a buffer is active in a given time range.
-  bool DoesEntryOverlapInTime(const ListEntry* entry, const int first_time_used,
-                              const int last_time_used) const;
+  // Records the client-provided information about each buffer.
+  struct BufferRequirements {
+    int size;
+    int offline_offset;
+    int first_time_used;
+    int last_time_used;
+  };
+
+  // Whether buffer a is placed before buffer b in the given order.
+  bool IsPlacedBefore(int a, int b, PlacementOrder order) const;
+
+  // Place every buffer in the given order, into buffer_offsets_.
+  void PlaceBuffers(PlacementOrder order);
 
-  // Walks the list to return the next buffer that is active in a given time
-  // range, or a null pointer if there are none.
-  ListEntry* NextSimultaneouslyActiveBuffer(const ListEntry* start,
-                                            const int first_time_used,
-                                            const int last_time_used);
+  // Record a placed buffer in the interval tree.
+  void AddToIntervalTree(int buffer_id);
+
+  // Collects the placed buffers of buffer_ids_by_time_[lo, hi) that are active
+  // in a given time range into active_buffer_ids_.
+  void FindActiveBuffers(int lo, int hi, int first_time_used,
+                         int last_time_used, int* active_count);
+
+  // High-water mark of buffer_offsets_.
+  size_t CalculateMaximumMemorySize() const;
 
   // If there isn't an up to date plan, calculate a new one.
   void CalculateOffsetsIfNeeded();
@@ -128,35 +165,31 @@ class GreedyMemoryPlanner : public MicroMemoryPlanner {
   // The number of buffers added so far.
   int buffer_count_;
 
-  // Records the client-provided information about each buffer.
-  struct BufferRequirements {
-    int size;
-    int offline_offset;
-    int first_time_used;
-    int last_time_used;
-  };
-
   // Working arrays used during the layout algorithm.
   BufferRequirements* requirements_;
-  // buffer_sizes_sorted_ and buffer_ids_sorted_ are sorted according to:
-  //   {
-  //     offline planned buffers,
-  //     online planned buffers sorted by size
-  //   }
-  int* buffer_sizes_sorted_;
+  // Buffer ids in placement order: offline planned buffers first, then the
+  // online planned buffers sorted by the PlacementOrder.
   int* buffer_ids_sorted_;
-  ListEntry* buffers_sorted_by_offset_;
-  int next_free_entry_;    // Index of the next free entry of
-                           // buffers_sorted_by_offset_
-  int first_entry_index_;  // Index of the first entry (smallest offset) of
-                           // buffers_sorted_by_offset_
+  // Buffer ids sorted by first_time_used (then id), this is the interval tree:
+  // the node of the range [lo, hi) is at (lo + hi) / 2 and
+  // max_last_time_used_ holds the latest last_time_used of the placed buffers
+  // in its range.
+  int* buffer_ids_by_time_;
+  int* max_last_time_used_;
+  // Placed buffers active at the same time as the buffer being placed.
+  int* active_buffer_ids_;
 
   // Stores the outcome of the plan, the location of each buffer in the arena.
   int* buffer_offsets_;
+  // Smallest plan so far with best_of_strategies_.
+  int* best_buffer_offsets_;
+  size_t max_memory_size_;
 
   // Whether buffers have been added since the last plan was calculated.
   bool need_to_calculate_offsets_;
 
+  bool best_of_strategies_;
+
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
 
@@ -44,7 +44,7 @@
  * If you are adding or modifying OPTIONAL commands,
  * just upgrade the release version.
  */
-#define AT_COMMAND_VERSION "1.8.0"
+#define AT_COMMAND_VERSION "1.9.0"
 
 /*************************************************************************************************/
 /* Required commands by Edge Impulse CLI Tools        */
@@ -89,7 +89,7 @@
 #define AT_RUNIMPULSECONT_HELP_TEXT  "Run the impulse continuously"
 #define AT_RUNIMPULSESTATIC          "RUNIMPULSESTATIC"
 #define AT_RUNIMPULSESTATIC_ARGS     "DEBUG,LENGTH"
-#define AT_RUNIMPULSESTATIC_HELP_TEXT "Run the impulse on static data (base64 encoded)"
+#define AT_RUNIMPULSESTATIC_HELP_TEXT "Run the impulse on static data (base64 encoded or binary frames)"
 #define AT_INGESTIONCYCLESETTINGS            "INGESTIONCYCLESETTINGS"
 #define AT_INGESTIONCYCLESETTINGS_ARGS       "SENSOR_LABEL,TOTAL_INGESTION_TIME_MS,INTERVAL_TIME_MS"
 #define AT_INGESTIONCYCLESETTINGS_HELP_TEXT  "Set ingestion cycle settings"
@@ -126,6 +126,15 @@
 #define AT_BOOTMODE_HELP_TEXT       "Jump to bootloader"
 #define AT_INFO                     "INFO"
 #define AT_INFO_HELP_TEXT           "Prints details about compiled firmware and ML model"
+#define AT_CAMERASTATS              "CAMERASTATS"
+#define AT_CAMERASTATS_HELP_TEXT    "Prints FPS and per stage latency of the camera inference loop"
+#define AT_LAYERPROFILE             "LAYERPROFILE"
+#define AT_LAYERPROFILE_HELP_TEXT   "Prints cycles and cache misses per model layer as CSV, run to reset the counters"
+#define AT_BINARYFRAMES             "BINARYFRAMES"
+#define AT_BINARYFRAMES_ARGS        "ENABLE"
+#define AT_BINARYFRAMES_HELP_TEXT   "Lists or sets binary framed transfers (instead of base64) for RUNIMPULSESTATIC, READBUFFER and SNAPSHOT"
+#define AT_ARENA                    "ARENA"
+#define AT_ARENA_HELP_TEXT          "Prints the TFLite arena size and how much of it AllocateTensors() used"
 
 /*************************************************************************************************/
 /* HELP is not necessary as it is built-in into ATServer and
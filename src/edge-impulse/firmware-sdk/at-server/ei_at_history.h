@@ -34,47 +34,64 @@
 
 #ifndef AT_HISTORY_H
 #define AT_HISTORY_H
-#include <string>
-#include <vector>
+#include "ei_line_buffer.h"
+#include <cstddef>
+#include <cstring>
+
+/* Upper limit of the history entries, storage is allocated statically */
+#ifndef AT_HISTORY_MAX_SIZE
+#define AT_HISTORY_MAX_SIZE 10
+#endif
 
 class ATHistory {
 private:
-    std::vector<std::string> history;
+    // ring of entries, the oldest one is at history_start
+    char history[AT_HISTORY_MAX_SIZE][AT_LINE_BUFFER_SIZE + 1];
     const size_t history_max_size;
+    size_t history_start;
+    size_t history_count;
     size_t history_position;
 
+    const char *entry(size_t index)
+    {
+        return history[(history_start + index) % history_max_size];
+    }
+
 public:
     ATHistory(size_t max_size = 10)
-        : history_max_size(max_size)
+        : history_max_size(
+              (max_size > AT_HISTORY_MAX_SIZE) ? AT_HISTORY_MAX_SIZE : max_size)
+        , history_start(0)
+        , history_count(0)
         , history_position(0) {};
 
-    std::string go_back(void)
+    const char *go_back(void)
     {
         if (!is_at_begin()) {
             history_position--;
         }
 
-        if (history.size() == 0) {
-            return std::string("");
+        if (history_count == 0) {
+            return "";
         }
         else {
-            return history[history_position];
+            return entry(history_position);
         }
     }
 
-    std::string go_next(void)
+    const char *go_next(void)
     {
-        if (++history_position >= history.size()) {
-            history_position = history.size();
-            return std::string("");
+        if (++history_position >= history_count) {
+            history_position = history_count;
+            return "";
         }
 
-        return history[history_position];
+        return entry(history_position);
     }
 
     bool is_at_end(void)
     {
-        return history_position == history.size();
+        return history_position == history_count;
     }
 
     bool is_at_begin(void)
@@ -82,21 +99,29 @@ public:
         return history_position == 0;
     }
 
-    void add(std::string &entry)
+    void add(const char *line)
     {
         // don't add empty entries
-        if (entry == "") {
+        if (line == nullptr || line[0] == '\0' || history_max_size == 0) {
             return;
         }
 
-        history.push_back(entry);
-
-        if (history.size() > history_max_size) {
-            history.erase(history.begin());
+        size_t slot;
+        if (history_count < history_max_size) {
+            slot = (history_start + history_count) % history_max_size;
+            history_count++;
+        }
+        else {
+            // overwrite the oldest entry
+            slot = history_start;
+            history_start = (history_start + 1) % history_max_size;
         }
 
-        history_position = history.size();
+        strncpy(history[slot], line, AT_LINE_BUFFER_SIZE);
+        history[slot][AT_LINE_BUFFER_SIZE] = '\0';
+
+        history_position = history_count;
     }
 };
 
-#endif /* AT_HISTORY_H */
\ No newline at end of file
+#endif /* AT_HISTORY_H */
@@ -33,83 +33,93 @@
  */
 
 #include "ei_at_parser.h"
-
-using namespace std;
+#include <cstring>
 
 void ATParser::init_result(void)
 {
     last_result.type = AT_UNKNOWN;
-    last_result.command.clear();
-    last_result.arguments.clear();
-    last_result.max_arg_len = 0;
+    last_result.command = "";
+    last_result.arguments_count = 0;
 }
 
-const ATParseResult_t &ATParser::parse(string input)
+/**
+ * @brief Parse an AT command. The line is tokenized in place (delimiters are
+ * replaced with null terminators), so the result is only valid as long as
+ * the line isn't modified. No memory is allocated.
+ *
+ * @param line null terminated command line
+ * @return const ATParseResult_t& type is AT_UNKNOWN if the line is not a valid
+ * AT command or has more than AT_MAX_ARGUMENTS arguments
+ */
+const ATParseResult_t &ATParser::parse(char *line)
 {
-    string tmp;
-    size_t pos = string::npos;
-    size_t delim1 = string::npos;
-    size_t delim2 = string::npos;
+    char *pos;
+    char *end;
 
     this->init_result();
 
-    if (input.size() == 0) {
-        last_result.type = AT_UNKNOWN;
+    if (line == nullptr) {
         return last_result;
     }
 
     // trim leading whitespaces
-    input = input.substr(input.find_first_not_of(" \t"));
+    line += strspn(line, " \t");
 
-    if (input.rfind("AT+", 0) != 0) {
-        last_result.type = AT_UNKNOWN;
+    if (strncmp(line, "AT+", 3) != 0) {
         return last_result;
     }
 
     //remove "AT+"
-    input = input.substr(3);
+    line += 3;
 
     // trim spaces, newline and CR at the end
-    input = input.erase(input.find_last_not_of(" \r\n") + 1);
+    end = line + strlen(line);
+    while (end > line && (end[-1] == ' ' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
 
     // extract command itself
-    pos = input.find_first_of("?=");
-    last_result.command = input.substr(0, pos);
+    pos = strpbrk(line, "?=");
+    last_result.command = line;
 
-    if (pos == string::npos) {
+    if (pos == nullptr) {
         last_result.type = AT_RUN;
+        return last_result;
     }
-    else if (input.at(pos) == '=') {
-        last_result.type = AT_WRITE;
-    }
-    else if (input.at(pos) == '?') {
+
+    if (*pos == '?') {
         last_result.type = AT_READ;
-    }
-    else {
-        last_result.type = AT_UNKNOWN;
+        *pos = '\0';
+        return last_result;
     }
 
-    // check if command has arguments and extract them
-    if (pos != string::npos && input.at(pos) == '=') {
-        delim1 = pos;
-        delim2 = input.find_first_of(",", pos);
-        // we have arguments, let's extract them
-        while (delim2 != string::npos) {
-            //TODO: support args in a quote
-            tmp = string(input, delim1 + 1, delim2 - delim1 - 1);
-            last_result.arguments.push_back(tmp);
-            if (tmp.size() > last_result.max_arg_len) {
-                last_result.max_arg_len = tmp.size();
-            }
-            delim1 = delim2;
-            delim2 = input.find_first_of(",", delim1 + 1);
+    // write command, check number of arguments before splitting them in place
+    //TODO: support args in a quote
+    char *arg = pos + 1;
+    unsigned int count = 1;
+    for (const char *c = arg; *c != '\0'; c++) {
+        if (*c == ',') {
+            count++;
         }
-        //there is one more argument, behind last comma so, get it until end of command
-        tmp = string(input, delim1 + 1);
-        last_result.arguments.push_back(tmp);
-        if (tmp.size() > last_result.max_arg_len) {
-            last_result.max_arg_len = tmp.size();
+    }
+
+    if (count > AT_MAX_ARGUMENTS) {
+        return last_result;
+    }
+
+    last_result.type = AT_WRITE;
+    *pos = '\0';
+
+    while (true) {
+        last_result.arguments[last_result.arguments_count++] = arg;
+
+        char *comma = strchr(arg, ',');
+        if (comma == nullptr) {
+            break;
         }
+        *comma = '\0';
+        arg = comma + 1;
     }
 
     return last_result;
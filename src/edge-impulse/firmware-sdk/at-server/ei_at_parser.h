@@ -34,8 +34,12 @@
 
 #ifndef AT_PARSER_H
 #define AT_PARSER_H
-#include <string>
-#include <vector>
+#include <cstddef>
+
+/* Maximum number of arguments of a write command, eg. AT+CMD=arg1,arg2 */
+#ifndef AT_MAX_ARGUMENTS
+#define AT_MAX_ARGUMENTS 16
+#endif
 
 enum ATCommandType_t
 {
@@ -45,11 +49,12 @@ enum ATCommandType_t
     AT_UNKNOWN
 };
 
+/* command and arguments point into the line passed to ATParser::parse */
 typedef struct {
     ATCommandType_t type;
-    std::string command;
-    std::vector<std::string> arguments;
-    unsigned int max_arg_len;
+    const char *command;
+    const char *arguments[AT_MAX_ARGUMENTS];
+    unsigned int arguments_count;
 } ATParseResult_t;
 
 class ATParser {
@@ -60,7 +65,7 @@ private:
 public:
     ATParser() {};
     ~ATParser() {};
-    const ATParseResult_t &parse(std::string command);
+    const ATParseResult_t &parse(char *line);
 };
 
-#endif /* AT_PARSER_H */
\ No newline at end of file
+#endif /* AT_PARSER_H */
@@ -44,6 +44,9 @@
 
 using namespace std;
 
+/* Longest supported escape sequence (without leading 0x1b), eg. [3~ */
+#define AT_CONTROL_SEQUENCE_MAX_LEN 8
+
 // fake handler (will never be called) just to make it
 // possible to register HELP command
 static bool print_help_handler(void)
@@ -225,46 +228,50 @@ void ATServer::print_prompt(void)
 
 void ATServer::handle(char c)
 {
-    string tmp;
+    const char *tmp;
     bool print_new_prompt = true;
     static bool in_ctrl_char = false;
-    static vector<char> control_sequence;
+    static char control_sequence[AT_CONTROL_SEQUENCE_MAX_LEN];
+    static size_t control_sequence_len = 0;
 
     // control characters start with 0x1b and end with a-zA-Z
     // typically \x1b[<LETTER> eg. \x1b[A
     if (in_ctrl_char) {
-        control_sequence.push_back(c);
+        // longer sequences are not supported, just wait for the end of it
+        if (control_sequence_len < AT_CONTROL_SEQUENCE_MAX_LEN) {
+            control_sequence[control_sequence_len++] = c;
+        }
         // if a-zA-Z then it's the last one in the control char...
         if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c == 0x7e)) {
             in_ctrl_char = false;
             // up: \x1b[A
-            if (control_sequence.size() == 2 && control_sequence.at(0) == 0x5b &&
-                control_sequence.at(1) == 0x41) {
+            if (control_sequence_len == 2 && control_sequence[0] == 0x5b &&
+                control_sequence[1] == 0x41) {
 
                 ei_printf("\x1b[u"); // restore current position
                 tmp = history.go_back();
                 // ei_printf("\r\x1b[K> %s", tmp.c_str());
-                ei_printf("\x1b[2K\r> %s", tmp.c_str());
+                ei_printf("\x1b[2K\r> %s", tmp);
                 buffer.clear();
                 buffer.add(tmp);
             }
             // down: \x1b[B
             else if (
-                control_sequence.size() == 2 && control_sequence.at(0) == 0x5b &&
-                control_sequence.at(1) == 0x42) {
+                control_sequence_len == 2 && control_sequence[0] == 0x5b &&
+                control_sequence[1] == 0x42) {
 
                 ei_printf("\x1b[u"); // restore current position
                 tmp = history.go_next();
                 // reset cursor to 0, do \r, then write the new command...
                 // ei_printf("\r\x1b[K> %s", tmp.c_str());
-                ei_printf("\x1b[2K\r> %s", tmp.c_str());
+                ei_printf("\x1b[2K\r> %s", tmp);
                 buffer.clear();
                 buffer.add(tmp);
             }
             // left: \x1b[D
             else if (
-                control_sequence.size() == 2 && control_sequence.at(0) == 0x5b &&
-                control_sequence.at(1) == 0x44) {
+                control_sequence_len == 2 && control_sequence[0] == 0x5b &&
+                control_sequence[1] == 0x44) {
 
                 size_t curr = buffer.get_position();
 
@@ -276,15 +283,15 @@ void ATServer::handle(char c)
                 else {
                     buffer.set_position(curr - 1);
                     ei_putchar('\x1b');
-                    for (size_t ix = 0; ix < control_sequence.size(); ix++) {
+                    for (size_t ix = 0; ix < control_sequence_len; ix++) {
                         ei_putchar(control_sequence[ix]);
                     }
                 }
             }
             // right: \x1b[C
             else if (
-                control_sequence.size() == 2 && control_sequence.at(0) == 0x5b &&
-                control_sequence.at(1) == 0x43) {
+                control_sequence_len == 2 && control_sequence[0] == 0x5b &&
+                control_sequence[1] == 0x43) {
 
                 size_t curr = buffer.get_position();
 
@@ -295,55 +302,55 @@ void ATServer::handle(char c)
                 else {
                     buffer.set_position(curr + 1);
                     ei_putchar('\x1b');
-                    for (size_t ix = 0; ix < control_sequence.size(); ix++) {
+                    for (size_t ix = 0; ix < control_sequence_len; ix++) {
                         ei_putchar(control_sequence[ix]);
                     }
                 }
             }
             // HOME key: \x1b[H
             else if (
-                control_sequence.size() == 2 && control_sequence.at(0) == 0x5b &&
-                control_sequence.at(1) == 0x48) {
+                control_sequence_len == 2 && control_sequence[0] == 0x5b &&
+                control_sequence[1] == 0x48) {
                 // move to begining of the buffer...
                 buffer.set_position(0);
                 // ...and the line
                 ei_printf(
                     "\r\x1b[K> %s\x1b[%uG",
-                    buffer.get_string().c_str(),
+                    buffer.get_string(),
                     (unsigned int)buffer.get_position() + 3);
             }
             // END key: \x1b[F
             else if (
-                control_sequence.size() == 2 && control_sequence.at(0) == 0x5b &&
-                control_sequence.at(1) == 0x46) {
+                control_sequence_len == 2 && control_sequence[0] == 0x5b &&
+                control_sequence[1] == 0x46) {
                 // move to end of the buffer...
                 buffer.set_position(buffer.size());
                 // ...and the line
                 ei_printf(
                     "\r\x1b[K> %s\x1b[%uG",
-                    buffer.get_string().c_str(),
+                    buffer.get_string(),
                     (unsigned int)buffer.get_position() + 3);
             }
             // DELETE key: \x1b[3\x7e
             else if (
-                control_sequence.size() == 3 && control_sequence.at(0) == 0x5b &&
-                control_sequence.at(1) == 0x33 && control_sequence.at(2) == 0x7e) {
+                control_sequence_len == 3 && control_sequence[0] == 0x5b &&
+                control_sequence[1] == 0x33 && control_sequence[2] == 0x7e) {
                 if (buffer.do_delete()) {
                     ei_printf(
                         "\r\x1b[K> %s\x1b[%uG",
-                        buffer.get_string().c_str(),
+                        buffer.get_string(),
                         (unsigned int)buffer.get_position() + 3);
                 }
             }
             else {
                 // not up/down? execute original control sequence
                 ei_putchar('\x1b');
-                for (size_t ix = 0; ix < control_sequence.size(); ix++) {
+                for (size_t ix = 0; ix < control_sequence_len; ix++) {
                     ei_putchar(control_sequence[ix]);
                 }
             }
 
-            control_sequence.clear();
+            control_sequence_len = 0;
         }
         return;
     }
@@ -354,11 +361,17 @@ void ATServer::handle(char c)
     case '\r': /* want to run the buffer */
         ei_putchar(c);
         ei_putchar('\n');
-        tmp = buffer.get_string();
 
-        history.add(tmp);
+        // the rest of an overlong line has been discarded, don't run what's left of it
+        if (buffer.is_overflowed()) {
+            ei_printf("ERR: Command too long (max %d characters)\n", AT_LINE_BUFFER_SIZE);
+        }
+        else {
+            history.add(buffer.get_string());
 
-        print_new_prompt = execute(tmp);
+            // command is tokenized in place, in the line buffer
+            print_new_prompt = execute(buffer.get_data());
+        }
 
         buffer.clear();
 
@@ -371,7 +384,7 @@ void ATServer::handle(char c)
         if (buffer.do_backspace() == false) {
             break;
         }
-        ei_printf("\r\x1b[K> %s\x1b[%uG", buffer.get_string().c_str(), (unsigned int)buffer.get_position() + 3);
+        ei_printf("\r\x1b[K> %s\x1b[%uG", buffer.get_string(), (unsigned int)buffer.get_position() + 3);
         break;
     case 0x1b: /* control character */
         // start processing characters as they are control sequence
@@ -379,33 +392,32 @@ void ATServer::handle(char c)
         ei_printf("\x1b[s"); // save current position
         break;
     default:
-        if (c >= 0x20 && c <= 0x7e) {
-            buffer.add(c);
+        // printable characters past the end of a full line buffer are dropped (not echoed)
+        // and the whole line is rejected at its end
+        if (c >= 0x20 && c <= 0x7e && buffer.add(c)) {
             if (buffer.is_at_end()) {
                 ei_putchar(c);
             }
             else {
-                ei_printf("\r> %s\x1b[%uG", buffer.get_string().c_str(), (unsigned int)buffer.get_position() + 3);
+                ei_printf("\r> %s\x1b[%uG", buffer.get_string(), (unsigned int)buffer.get_position() + 3);
             }
         }
         break;
     }
 }
 
-bool ATServer::execute(string &input)
+bool ATServer::execute(char *line)
 {
     bool new_prompt_required = false;
-    char **args = nullptr;
-    ATParseResult_t res;
 
-    res = parser.parse(input);
+    const ATParseResult_t &res = parser.parse(line);
     if (res.type == AT_UNKNOWN) {
-        ei_printf("Not a valid AT command (%s)\n", input.c_str());
+        ei_printf("Not a valid AT command (%s)\n", line);
         return true;
     }
 
     // exception for HELP command which is built-in
-    if (res.command == AT_HELP && res.type == AT_RUN) {
+    if (strcmp(res.command, AT_HELP) == 0 && res.type == AT_RUN) {
         return this->print_help();
     }
 
@@ -423,24 +435,12 @@ bool ATServer::execute(string &input)
             }
             else if (res.type == AT_WRITE && it->write_handler) {
                 // write command like AT+DEVICEID=abcde
-                args = (char **)ei_malloc(res.arguments.size() * sizeof(char *));
-                for (unsigned int i = 0; i < res.arguments.size(); i++) {
-                    // one more byte for null terminator (in case of zero-length = empty argument eg. AT+RUN=123,,5)
-                    args[i] = (char *)ei_malloc(res.max_arg_len + 1);
-                    strncpy(args[i], res.arguments.at(i).c_str(), res.max_arg_len + 1);
-                }
-
+                // arguments point into the line buffer, valid until the handler returns
                 new_prompt_required =
-                    it->write_handler((const char **)args, (int)res.arguments.size());
-
-                // now we are freeing the memory
-                for (unsigned int i = 0; i < res.arguments.size(); i++) {
-                    ei_free(args[i]);
-                }
-                ei_free(args);
+                    it->write_handler((const char **)res.arguments, (int)res.arguments_count);
             }
             else {
-                ei_printf("No handler for command! (%s)\n", input.c_str());
+                ei_printf("No handler for command! (AT+%s)\n", res.command);
                 return true;
             }
             return new_prompt_required;
@@ -448,6 +448,6 @@ bool ATServer::execute(string &input)
     }
 
     // we shouldn't be here!
-    ei_printf("Command not found! (AT+%s)\n", res.command.c_str());
+    ei_printf("Command not found! (AT+%s)\n", res.command);
     return true;
 }
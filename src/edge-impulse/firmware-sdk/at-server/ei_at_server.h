@@ -69,7 +69,7 @@ protected:
     ATServer(ATCommand_t *commands, size_t length, size_t max_history_size = default_history_size);
     ~ATServer();
     bool print_help(void);
-    bool execute(std::string &command);
+    bool execute(char *line);
 
 public:
     ATServer(ATServer &other) = delete;
@@ -35,44 +35,63 @@
 #ifndef LINEBUFFER_H
 #define LINEBUFFER_H
 
-#include <string>
+#include <cstddef>
+#include <cstring>
+
+/* Maximum length of a single command line (without null terminator) */
+#ifndef AT_LINE_BUFFER_SIZE
+#define AT_LINE_BUFFER_SIZE 256
+#endif
 
 class LineBuffer {
 private:
-    std::string buffer;
+    char buffer[AT_LINE_BUFFER_SIZE + 1];
+    size_t length;
     size_t position;
+    bool overflow;
 
 public:
     LineBuffer()
-        : buffer("")
-        , position(0) {};
+        : length(0)
+        , position(0)
+        , overflow(false)
+    {
+        buffer[0] = '\0';
+    };
 
     void clear()
     {
-        buffer.clear();
+        buffer[0] = '\0';
+        length = 0;
         position = 0;
+        overflow = false;
     }
 
-    void add(std::string &s)
+    void add(const char *s)
     {
-        if (position == buffer.size()) {
-            buffer.append(s);
+        if (s == nullptr) {
+            return;
         }
-        else {
-            buffer.insert(position, s);
+
+        while (*s != '\0') {
+            add(*s++);
         }
-        position += s.size();
     }
 
-    void add(const char c)
+    /* characters that don't fit into the buffer are dropped and the line is marked as overflowed */
+    bool add(const char c)
     {
-        if (position == buffer.size()) {
-            buffer.append(&c, 1);
-        }
-        else {
-            buffer.insert(position, &c, 1);
+        if (length == AT_LINE_BUFFER_SIZE) {
+            overflow = true;
+            return false;
         }
+
+        memmove(&buffer[position + 1], &buffer[position], length - position + 1);
+        buffer[position] = c;
+        length++;
         position++;
+
+        return true;
     }
 
     bool do_backspace(void)
@@ -81,7 +100,8 @@ public:
             return false;
         }
 
-        buffer.erase(position - 1, 1);
+        memmove(&buffer[position - 1], &buffer[position], length - position + 1);
+        length--;
         position--;
 
         return true;
@@ -93,7 +113,8 @@ public:
             return false;
         }
 
-        buffer.erase(position, 1);
+        memmove(&buffer[position], &buffer[position + 1], length - position);
+        length--;
 
         return true;
     }
@@ -105,15 +126,32 @@ public:
 
     bool is_at_end(void)
     {
-        return position == buffer.size();
+        return position == length;
     }
 
     bool is_empty(void)
     {
-        return buffer.size() == 0;
+        return length == 0;
+    }
+
+    bool is_full(void)
+    {
+        return length == AT_LINE_BUFFER_SIZE;
+    }
+
+    /* true if characters were dropped since the last clear(), the line is incomplete */
+    bool is_overflowed(void)
+    {
+        return overflow;
+    }
+
+    const char *get_string()
+    {
+        return buffer;
     }
 
-    std::string get_string()
+    /* writable access to the line, used to tokenize the command in place */
+    char *get_data()
     {
         return buffer;
     }
@@ -125,8 +163,8 @@ public:
 
     void set_position(int pos)
     {
-        if (pos > (int)buffer.size()) {
-            position = buffer.size();
+        if (pos > (int)length) {
+            position = length;
         }
         else if (pos < 0) {
             position = 0;
@@ -138,8 +176,8 @@ public:
 
     size_t size()
     {
-        return buffer.size();
+        return length;
     }
 };
 
-#endif /* LINEBUFFER_H */
\ No newline at end of file
+#endif /* LINEBUFFER_H */
@@ -166,6 +166,121 @@ void base64_encode_finish(void (*putc_f)(char))
     base64_encode_chunk(nullptr, 0, putc_f);
 }
 
+/**
+ * @brief Encode 3 input bytes into a group of 4 characters
+ */
+static inline void base64_encode_group(const unsigned char *in, char *out)
+{
+    out[0] = base64_chars[(in[0] & 0xfc) >> 2];
+    out[1] = base64_chars[((in[0] & 0x03) << 4) + ((in[1] & 0xf0) >> 4)];
+    out[2] = base64_chars[((in[1] & 0x0f) << 2) + ((in[2] & 0xc0) >> 6)];
+    out[3] = base64_chars[in[2] & 0x3f];
+}
+
+/**
+ * @brief Encode the last 1 or 2 input bytes into a padded group of 4 characters
+ */
+static inline void base64_encode_tail(const unsigned char *in, size_t input_size, char *out)
+{
+    unsigned char tail[3] = { 0 };
+
+    for (size_t i = 0; i < input_size; i++) {
+        tail[i] = in[i];
+    }
+
+    base64_encode_group(tail, out);
+    if (input_size == 1) {
+        out[2] = '=';
+    }
+    out[3] = '=';
+}
+
+/**
+ * @brief Base64 encode and write to a block write function.
+ * Output is staged in whole 4-byte groups, so write_f is called once
+ * per 64 output characters instead of once per character.
+ *
+ * @param input
+ * @param input_size
+ * @param write_f pointer to write function
+ */
+void base64_encode_write(const char *input, size_t input_size, void (*write_f)(const char *, size_t))
+{
+    char out[64];
+    size_t out_ix = 0;
+    const unsigned char *in = (const unsigned char *)input;
+
+    while (input_size >= 3) {
+        base64_encode_group(in, &out[out_ix]);
+        out_ix += 4;
+        in += 3;
+        input_size -= 3;
+
+        if (out_ix == sizeof(out)) {
+            write_f(out, out_ix);
+            out_ix = 0;
+        }
+    }
+
+    if (input_size) {
+        base64_encode_tail(in, input_size, &out[out_ix]);
+        out_ix += 4;
+    }
+
+    if (out_ix) {
+        write_f(out, out_ix);
+    }
+}
+
+/**
+ * @brief Base64 encode straight into the buffer of the output, without
+ * staging. reserve_f hands out free space of at least min_length
+ * characters, commit_f takes back the characters written into it.
+ * Stops when reserve_f has no room for a group of 4 characters.
+ *
+ * @param input
+ * @param input_size
+ * @param reserve_f sets span to the free space, returns its size (0 if none)
+ * @param commit_f
+ * @return size_t number of input bytes encoded, a multiple of 3 if the
+ * output ran out of space
+ */
+size_t base64_encode_span(
+    const char *input,
+    size_t input_size,
+    size_t (*reserve_f)(char **span, size_t min_length),
+    void (*commit_f)(size_t length))
+{
+    const unsigned char *in = (const unsigned char *)input;
+    size_t encoded = 0;
+
+    while (encoded < input_size) {
+        char *span;
+        size_t space = reserve_f(&span, 4);
+        size_t out_ix = 0;
+
+        if (space < 4) {
+            break;
+        }
+
+        while (out_ix + 4 <= space && input_size - encoded >= 3) {
+            base64_encode_group(&in[encoded], &span[out_ix]);
+            out_ix += 4;
+            encoded += 3;
+        }
+
+        if (out_ix + 4 <= space && input_size - encoded > 0 && input_size - encoded < 3) {
+            base64_encode_tail(&in[encoded], input_size - encoded, &span[out_ix]);
+            out_ix += 4;
+            encoded = input_size;
+        }
+
+        commit_f(out_ix);
+    }
+
+    return encoded;
+}
+
 /**
  * @brief Base64 encode and write to output buffer, errors on buffer overflow
  *
@@ -70,6 +70,12 @@
 void base64_encode(const char *input, size_t input_size, void (*putc_f)(char));
 void base64_encode_chunk(const char *input, size_t input_size, void (*putc_f)(char));
 void base64_encode_finish(void (*putc_f)(char));
+void base64_encode_write(const char *input, size_t input_size, void (*write_f)(const char *, size_t));
+size_t base64_encode_span(
+    const char *input,
+    size_t input_size,
+    size_t (*reserve_f)(char **span, size_t min_length),
+    void (*commit_f)(size_t length));
 int base64_encode_buffer(const char *input, size_t input_size, char *output, size_t output_size);
 std::vector<unsigned char> base64_decode(std::string const&);
 
@@ -0,0 +1,295 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ei_binary_frame.h"
+#include <string.h>
+
+static bool binary_mode = false;
+
+/* CRC-32 (reflected, polynomial 0xEDB88320), 4 bits at a time */
+static const uint32_t crc32_nibble_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t ei_frame_crc32(uint32_t crc, const uint8_t *data, size_t length)
+{
+    crc = ~crc;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0F];
+    }
+
+    return ~crc;
+}
+
+static void pack_header(uint8_t *out, uint8_t type, uint8_t seq, uint16_t length)
+{
+    out[0] = EI_FRAME_SYNC_0;
+    out[1] = EI_FRAME_SYNC_1;
+    out[2] = type;
+    out[3] = seq;
+    out[4] = (uint8_t)(length & 0xFF);
+    out[5] = (uint8_t)(length >> 8);
+}
+
+static void pack_u32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)(value & 0xFF);
+    out[1] = (uint8_t)((value >> 8) & 0xFF);
+    out[2] = (uint8_t)((value >> 16) & 0xFF);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t unpack_u32(const uint8_t *in)
+{
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+/**
+ * @brief Validate sync, type and length of a packed header
+ */
+static int parse_header(const uint8_t *in, ei_frame_header_t *header)
+{
+    if (in[0] != EI_FRAME_SYNC_0 || in[1] != EI_FRAME_SYNC_1) {
+        return EI_FRAME_ERR_SYNC;
+    }
+
+    header->type = in[2];
+    header->seq = in[3];
+    header->length = (uint16_t)(in[4] | (in[5] << 8));
+
+    if (header->type != EI_FRAME_DATA && header->type != EI_FRAME_END) {
+        return EI_FRAME_ERR_TYPE;
+    }
+
+    if (header->length > EI_FRAME_MAX_PAYLOAD) {
+        return EI_FRAME_ERR_LENGTH;
+    }
+
+    return EI_FRAME_OK;
+}
+
+size_t ei_frame_encode(
+    uint8_t type,
+    uint8_t seq,
+    const uint8_t *payload,
+    uint16_t length,
+    uint8_t *out,
+    size_t out_size)
+{
+    uint32_t crc;
+
+    if (length > EI_FRAME_MAX_PAYLOAD || out_size < (size_t)length + EI_FRAME_OVERHEAD) {
+        return 0;
+    }
+
+    pack_header(out, type, seq, length);
+    if (length > 0) {
+        memcpy(&out[EI_FRAME_HEADER_SIZE], payload, length);
+    }
+
+    // sync bytes are not part of the CRC
+    crc = ei_frame_crc32(0, &out[2], EI_FRAME_HEADER_SIZE - 2 + length);
+    pack_u32(&out[EI_FRAME_HEADER_SIZE + length], crc);
+
+    return length + EI_FRAME_OVERHEAD;
+}
+
+int ei_frame_decode(
+    const uint8_t *in,
+    size_t in_size,
+    ei_frame_header_t *header,
+    const uint8_t **payload)
+{
+    int ret;
+    uint32_t crc;
+
+    if (in_size < EI_FRAME_HEADER_SIZE) {
+        return EI_FRAME_ERR_INCOMPLETE;
+    }
+
+    ret = parse_header(in, header);
+    if (ret != EI_FRAME_OK) {
+        return ret;
+    }
+
+    if (in_size < (size_t)header->length + EI_FRAME_OVERHEAD) {
+        return EI_FRAME_ERR_INCOMPLETE;
+    }
+
+    crc = ei_frame_crc32(0, &in[2], EI_FRAME_HEADER_SIZE - 2 + header->length);
+    if (crc != unpack_u32(&in[EI_FRAME_HEADER_SIZE + header->length])) {
+        return EI_FRAME_ERR_CRC;
+    }
+
+    *payload = &in[EI_FRAME_HEADER_SIZE];
+
+    return header->length + EI_FRAME_OVERHEAD;
+}
+
+int ei_frame_receive(
+    ei_frame_header_t *header,
+    uint8_t *payload,
+    size_t capacity,
+    uint8_t expected_seq,
+    ei_frame_read_f read_f,
+    uint32_t timeout_ms)
+{
+    uint8_t raw[EI_FRAME_HEADER_SIZE];
+    uint8_t raw_crc[EI_FRAME_CRC_SIZE];
+    uint32_t crc;
+    int ret;
+
+    if (read_f(raw, sizeof(raw), timeout_ms) != sizeof(raw)) {
+        return EI_FRAME_ERR_TIMEOUT;
+    }
+
+    ret = parse_header(raw, header);
+    if (ret != EI_FRAME_OK) {
+        return ret;
+    }
+
+    if (header->length > capacity) {
+        return EI_FRAME_ERR_LENGTH;
+    }
+
+    if (header->length > 0 && read_f(payload, header->length, timeout_ms) != header->length) {
+        return EI_FRAME_ERR_TIMEOUT;
+    }
+
+    if (read_f(raw_crc, sizeof(raw_crc), timeout_ms) != sizeof(raw_crc)) {
+        return EI_FRAME_ERR_TIMEOUT;
+    }
+
+    crc = ei_frame_crc32(0, &raw[2], EI_FRAME_HEADER_SIZE - 2);
+    crc = ei_frame_crc32(crc, payload, header->length);
+    if (crc != unpack_u32(raw_crc)) {
+        return EI_FRAME_ERR_CRC;
+    }
+
+    // checked last, so a frame that is only out of order is still consumed completely
+    if (header->seq != expected_seq) {
+        return EI_FRAME_ERR_SEQUENCE;
+    }
+
+    return EI_FRAME_OK;
+}
+
+/**
+ * @brief Send a frame without copying the payload
+ */
+static void write_frame(ei_frame_writer_t *writer, uint8_t type, const uint8_t *payload, uint16_t length)
+{
+    uint8_t header[EI_FRAME_HEADER_SIZE];
+    uint8_t raw_crc[EI_FRAME_CRC_SIZE];
+    uint32_t crc;
+
+    pack_header(header, type, writer->seq, length);
+    crc = ei_frame_crc32(0, &header[2], EI_FRAME_HEADER_SIZE - 2);
+    crc = ei_frame_crc32(crc, payload, length);
+    pack_u32(raw_crc, crc);
+
+    writer->write_f((const char *)header, sizeof(header));
+    if (length > 0) {
+        writer->write_f((const char *)payload, length);
+    }
+    writer->write_f((const char *)raw_crc, sizeof(raw_crc));
+
+    writer->seq++;
+}
+
+void ei_frame_writer_begin(ei_frame_writer_t *writer, ei_frame_write_f write_f)
+{
+    writer->write_f = write_f;
+    writer->seq = 0;
+    writer->total = 0;
+}
+
+void ei_frame_writer_data(ei_frame_writer_t *writer, const uint8_t *data, size_t length)
+{
+    while (length > 0) {
+        uint16_t chunk = (length > EI_FRAME_MAX_PAYLOAD) ? EI_FRAME_MAX_PAYLOAD : (uint16_t)length;
+
+        write_frame(writer, EI_FRAME_DATA, data, chunk);
+
+        writer->total += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void ei_frame_writer_end(ei_frame_writer_t *writer)
+{
+    uint8_t total[4];
+
+    pack_u32(total, writer->total);
+    write_frame(writer, EI_FRAME_END, total, sizeof(total));
+}
+
+const char *ei_frame_status_str(int status)
+{
+    switch (status) {
+    case EI_FRAME_OK:
+        return "OK";
+    case EI_FRAME_ERR_INCOMPLETE:
+        return "INCOMPLETE";
+    case EI_FRAME_ERR_SYNC:
+        return "SYNC";
+    case EI_FRAME_ERR_TYPE:
+        return "TYPE";
+    case EI_FRAME_ERR_LENGTH:
+        return "LENGTH";
+    case EI_FRAME_ERR_CRC:
+        return "CRC";
+    case EI_FRAME_ERR_SEQUENCE:
+        return "SEQUENCE";
+    case EI_FRAME_ERR_TIMEOUT:
+        return "TIMEOUT";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+void ei_frame_set_binary_mode(bool enable)
+{
+    binary_mode = enable;
+}
+
+bool ei_frame_is_binary_mode(void)
+{
+    return binary_mode;
+}
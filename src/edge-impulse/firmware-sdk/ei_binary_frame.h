@@ -0,0 +1,197 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EI_BINARY_FRAME_H
+#define EI_BINARY_FRAME_H
+
+/*
+ * Binary framed transport, an alternative to base64 for bulk transfers
+ * (AT+RUNIMPULSESTATIC data, AT+READBUFFER and snapshots). Enabled with
+ * AT+BINARYFRAMES=y, the AT commands themselves and all text responses
+ * are unchanged.
+ *
+ * Frame layout (all multi-byte fields little endian):
+ *
+ *   offset  size  field
+ *   0       2     sync, 0xE1 0x5A
+ *   2       1     type, see ei_frame_type_t
+ *   3       1     sequence number, 0 for the first frame of a transfer,
+ *                 incremented by one per frame (wraps at 256)
+ *   4       2     payload length, 0..EI_FRAME_MAX_PAYLOAD
+ *   6       n     payload
+ *   6 + n   4     CRC-32 of type, sequence, length and payload
+ *                 (IEEE 802.3, same as zlib crc32 / binascii.crc32)
+ *
+ * A transfer is any number of DATA frames followed by a single END frame.
+ * The END payload is the total number of DATA payload bytes (uint32). The
+ * device also ends a transfer it can't complete (e.g. a failed read of the
+ * sample memory) with END, the total is then short of the requested length.
+ *
+ * Device to host (AT+READBUFFER, AT+SNAPSHOT): the frames replace the base64
+ * text, everything else printed around it stays the same.
+ *
+ * Host to device (AT+RUNIMPULSESTATIC): after "OK CHUNK=<max payload>" the
+ * host streams DATA frames with the raw float32 features followed by END,
+ * without waiting for per chunk acknowledgements. Any error aborts the
+ * transfer with "ERR <reason> <sequence>".
+ *
+ * The codec has C linkage and no device dependencies, so the host reference
+ * tool (tools/binary_frame.py) can load it for a loopback test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define EI_FRAME_VERSION        1
+#define EI_FRAME_SYNC_0         0xE1
+#define EI_FRAME_SYNC_1         0x5A
+#define EI_FRAME_HEADER_SIZE    6
+#define EI_FRAME_CRC_SIZE       4
+#define EI_FRAME_OVERHEAD       (EI_FRAME_HEADER_SIZE + EI_FRAME_CRC_SIZE)
+#define EI_FRAME_MAX_PAYLOAD    1024
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef enum {
+    EI_FRAME_DATA = 0x01,
+    EI_FRAME_END = 0x02
+} ei_frame_type_t;
+
+typedef enum {
+    EI_FRAME_OK = 0,
+    EI_FRAME_ERR_INCOMPLETE = -1,   // need more bytes (ei_frame_decode only)
+    EI_FRAME_ERR_SYNC = -2,
+    EI_FRAME_ERR_TYPE = -3,
+    EI_FRAME_ERR_LENGTH = -4,
+    EI_FRAME_ERR_CRC = -5,
+    EI_FRAME_ERR_SEQUENCE = -6,
+    EI_FRAME_ERR_TIMEOUT = -7
+} ei_frame_status_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t seq;
+    uint16_t length;
+} ei_frame_header_t;
+
+typedef void (*ei_frame_write_f)(const char *buffer, size_t length);
+typedef size_t (*ei_frame_read_f)(uint8_t *buffer, size_t length, uint32_t timeout_ms);
+
+/**
+ * @brief Sends a payload split into frames, used to stream one transfer
+ */
+typedef struct {
+    ei_frame_write_f write_f;
+    uint8_t seq;
+    uint32_t total;
+} ei_frame_writer_t;
+
+/**
+ * @brief CRC-32 (IEEE 802.3), chainable: pass 0 to start, then the previous result
+ */
+uint32_t ei_frame_crc32(uint32_t crc, const uint8_t *data, size_t length);
+
+/**
+ * @brief Encode a single frame into a buffer
+ *
+ * @return size_t frame size (length + EI_FRAME_OVERHEAD), 0 if it doesn't fit
+ * or the payload is too big
+ */
+size_t ei_frame_encode(
+    uint8_t type,
+    uint8_t seq,
+    const uint8_t *payload,
+    uint16_t length,
+    uint8_t *out,
+    size_t out_size);
+
+/**
+ * @brief Decode a single frame from the beginning of a buffer
+ *
+ * @param in received bytes
+ * @param in_size number of received bytes
+ * @param header decoded header
+ * @param payload set to the payload inside of the in buffer
+ * @return int frame size on success, EI_FRAME_ERR_INCOMPLETE if more bytes
+ * are needed or another (negative) ei_frame_status_t
+ */
+int ei_frame_decode(
+    const uint8_t *in,
+    size_t in_size,
+    ei_frame_header_t *header,
+    const uint8_t **payload);
+
+/**
+ * @brief Receive a single frame, the payload is read straight into
+ * the destination buffer
+ *
+ * @param header received header
+ * @param payload destination
+ * @param capacity size of the destination, bigger frames are rejected
+ * @param expected_seq expected sequence number
+ * @param read_f
+ * @param timeout_ms timeout for each of the header, payload and CRC reads
+ * @return int ei_frame_status_t
+ */
+int ei_frame_receive(
+    ei_frame_header_t *header,
+    uint8_t *payload,
+    size_t capacity,
+    uint8_t expected_seq,
+    ei_frame_read_f read_f,
+    uint32_t timeout_ms);
+
+void ei_frame_writer_begin(ei_frame_writer_t *writer, ei_frame_write_f write_f);
+/**
+ * @brief Send data as one or more DATA frames of up to EI_FRAME_MAX_PAYLOAD bytes
+ */
+void ei_frame_writer_data(ei_frame_writer_t *writer, const uint8_t *data, size_t length);
+/**
+ * @brief Send the END frame with the total number of bytes sent
+ */
+void ei_frame_writer_end(ei_frame_writer_t *writer);
+
+const char *ei_frame_status_str(int status);
+
+void ei_frame_set_binary_mode(bool enable);
+bool ei_frame_is_binary_mode(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* EI_BINARY_FRAME_H */
@@ -37,6 +37,7 @@
 #include "ei_device_info_lib.h"
 #include "ei_device_memory.h"
 #include "ei_device_interface.h"
+#include "ei_binary_frame.h"
 
 #include "edge-impulse-sdk/classifier/ei_classifier_types.h"
 #include "edge-impulse-sdk/classifier/ei_signal_with_axes.h"
@@ -65,9 +66,30 @@ __attribute__((weak)) bool ei_user_invoke_stop_lib(void)
     }
 }
 
+/**
+ * @brief Write data to the serial port. Default implementation calls
+ * ei_putchar for each byte, ports with a buffered or DMA transmit path
+ * should override it.
+ *
+ * @param buffer
+ * @param length number of bytes to write
+ */
+__attribute__((weak)) void ei_serial_write(const uint8_t *buffer, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        ei_putchar((char)buffer[i]);
+    }
+}
+
+static void serial_write_chars(const char *buffer, size_t length)
+{
+    ei_serial_write((const uint8_t *)buffer, length);
+}
+
 /**
  * @brief Helper function for sending a data from memory over the
- * serial port. Data are encoded into base64 on the fly.
+ * serial port. Data are encoded into base64 on the fly (or sent as binary
+ * frames, see ei_binary_frame.h).
  *
  * @param address address of samples
  * @param length number of samples (bytes)
@@ -81,38 +103,133 @@ __attribute__((weak)) bool read_encode_send_sample_buffer(size_t address, size_t
     // we are encoiding data into base64, so it needs to be divisible by 3
     const int buffer_size = 513;
     uint8_t* buffer = (uint8_t*)ei_malloc(buffer_size);
+    bool binary = ei_frame_is_binary_mode();
+    bool ret = (buffer != NULL);
+    ei_frame_writer_t writer;
 
-    while (1) {
+    if (binary) {
+        ei_frame_writer_begin(&writer, serial_write_chars);
+    }
+
+    while (ret && length > 0) {
         size_t bytes_to_read = buffer_size;
 
         if (bytes_to_read > length) {
             bytes_to_read = length;
         }
 
-        if (bytes_to_read == 0) {
-            ei_free(buffer);
-            return true;
-        }
-
         if (memory->read_sample_data(buffer, address, bytes_to_read) != bytes_to_read) {
-            ei_free(buffer);
-            return false;
+            ret = false;
+            break;
         }
 
-        base64_encode((char *)buffer, bytes_to_read, ei_putchar);
+        if (binary) {
+            ei_frame_writer_data(&writer, buffer, bytes_to_read);
+        }
+        else {
+            base64_encode_write((char *)buffer, bytes_to_read, serial_write_chars);
+        }
 
         address += bytes_to_read;
         length -= bytes_to_read;
     }
 
-    return true;
+    // sent on errors too, the host sees a total short of the length it asked for
+    if (binary) {
+        ei_frame_writer_end(&writer);
+    }
+
+    if (buffer != NULL) {
+        ei_free(buffer);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Read data from the serial port. Default implementation polls
+ * ei_getchar, null characters are ignored.
+ *
+ * @param buffer
+ * @param length number of bytes to read
+ * @param timeout_ms how long to wait for all of the data
+ * @return size_t number of bytes read, less than length on timeout
+ */
+__attribute__((weak)) size_t ei_serial_read(uint8_t *buffer, size_t length, uint32_t timeout_ms)
+{
+    size_t received = 0;
+    uint64_t start_time = ei_read_timer_ms();
+
+    while (received < length) {
+        if (ei_read_timer_ms() - start_time > timeout_ms) {
+            break;
+        }
+        char rec = ei_getchar();
+        if (rec != 0) {
+            buffer[received++] = (uint8_t)rec;
+        }
+    }
+
+    return received;
+}
+
+/**
+ * @brief Receive static data as binary frames (see ei_binary_frame.h)
+ * straight into the destination buffer
+ *
+ * @param data destination
+ * @param size size of the destination in bytes
+ * @return int number of bytes received or -1 on error
+ */
+static int receive_static_data_frames(uint8_t *data, size_t size)
+{
+    ei_frame_header_t header;
+    uint8_t end_payload[4];
+    size_t received = 0;
+    uint8_t seq = 0;
+    int ret;
+
+    while (1) {
+        // near the end there is no room for the END payload in the destination
+        bool to_data = (size - received) >= sizeof(end_payload);
+        uint8_t *dst = to_data ? &data[received] : end_payload;
+        size_t capacity = to_data ? (size - received) : sizeof(end_payload);
+
+        ret = ei_frame_receive(&header, dst, capacity, seq, ei_serial_read, 100);
+        if (ret != EI_FRAME_OK) {
+            ei_printf("ERR %s %d\r\n", ei_frame_status_str(ret), (int)seq);
+            return -1;
+        }
+        seq++;
+
+        if (header.type == EI_FRAME_END) {
+            uint32_t total = (header.length == sizeof(end_payload))
+                ? (uint32_t)dst[0] | ((uint32_t)dst[1] << 8) | ((uint32_t)dst[2] << 16) | ((uint32_t)dst[3] << 24)
+                : 0;
+
+            if (total != received) {
+                ei_printf("ERR %s %d\r\n", ei_frame_status_str(EI_FRAME_ERR_LENGTH), (int)header.seq);
+                return -1;
+            }
+            return (int)received;
+        }
+
+        if (header.length > size - received) {
+            ei_printf("ERR %s %d\r\n", ei_frame_status_str(EI_FRAME_ERR_LENGTH), (int)header.seq);
+            return -1;
+        }
+
+        if (!to_data) {
+            memcpy(&data[received], end_payload, header.length);
+        }
+        received += header.length;
+    }
 }
 
 bool run_impulse_static_data(bool debug, size_t length, size_t buf_len)
 {
     size_t cur_pos = 0;
     uint32_t buf_pos = 0;
-    uint64_t start_time = 0;
 
     static float *data_pt = NULL;
     static uint8_t *temp_buf = NULL;
@@ -128,21 +245,33 @@ bool run_impulse_static_data(bool debug, size_t length, size_t buf_len)
         return false;
     }
 
-    temp_buf = (uint8_t*)ei_calloc(buf_len + 1, sizeof(uint8_t));
-    if (temp_buf == NULL) {
-        ei_printf("ERR: Memory allocation for serial read buffer failed\r\n");
-        ei_free(data_pt);
-        data_pt = NULL;
-        return false;
+    if (ei_frame_is_binary_mode()) {
+        ei_printf("OK CHUNK=%d\r\n", EI_FRAME_MAX_PAYLOAD);
+
+        int received = receive_static_data_frames((uint8_t *)data_pt, length * sizeof(float));
+        if (received < 0) {
+            ei_free(data_pt);
+            data_pt = NULL;
+            ei_printf("END OUTPUT\r\n");
+            return false;
+        }
+        cur_pos = received / sizeof(float);
     }
+    else {
+        temp_buf = (uint8_t*)ei_calloc(buf_len + 1, sizeof(uint8_t));
+        if (temp_buf == NULL) {
+            ei_printf("ERR: Memory allocation for serial read buffer failed\r\n");
+            ei_free(data_pt);
+            data_pt = NULL;
+            return false;
+        }
 
-    ei_printf("OK CHUNK=%d\r\n", (int)buf_len);
+        ei_printf("OK CHUNK=%d\r\n", (int)buf_len);
 
-    while (cur_pos < length) {
+        while (cur_pos < length) {
 
-        start_time = ei_read_timer_ms();
-        while (buf_pos < buf_len) {
-            if (ei_read_timer_ms() - start_time > 100) {
+            buf_pos = ei_serial_read(temp_buf, buf_len, 100);
+            if (buf_pos < buf_len) {
                 ei_printf("TIMEOUT\r\n");
                 ei_free(data_pt);
                 ei_free(temp_buf);
@@ -151,30 +280,28 @@ bool run_impulse_static_data(bool debug, size_t length, size_t buf_len)
                 ei_printf("END OUTPUT\r\n");
                 return false;
             }
-            uint8_t rec = ei_getchar();
-            if (rec != 0) {
-                temp_buf[buf_pos++] = rec;
-            }
-        }
 
-        std::vector<unsigned char> decoded = base64_decode((const char*)temp_buf);
+            std::vector<unsigned char> decoded = base64_decode((const char*)temp_buf);
 
-        int copylength = decoded.size() > (length - cur_pos) * sizeof(float)
-                       ? (length - cur_pos) * sizeof(float)
-                       : decoded.size();
+            int copylength = decoded.size() > (length - cur_pos) * sizeof(float)
+                           ? (length - cur_pos) * sizeof(float)
+                           : decoded.size();
 
-        memcpy((void*)(data_pt + cur_pos), decoded.data(), copylength);
+            memcpy((void*)(data_pt + cur_pos), decoded.data(), copylength);
 
-        cur_pos = cur_pos + copylength/sizeof(float);
-        buf_pos = 0;
-        ei_printf("OK %d \r\n", (int)cur_pos);
+            cur_pos = cur_pos + copylength/sizeof(float);
+            buf_pos = 0;
+            ei_printf("OK %d \r\n", (int)cur_pos);
+        }
     }
 
     ei_printf("TRANSFER COMPLETED %d\r\n", (int)cur_pos);
     uint32_t res = (uint32_t)ei_start_impulse_static_data(debug, data_pt, cur_pos);
     cur_pos = 0;
     ei_free(data_pt);
-    ei_free(temp_buf);
+    if (temp_buf != NULL) {
+        ei_free(temp_buf);
+    }
     data_pt = NULL;
     temp_buf = NULL;
     ei_printf("RESULT %d\r\n", res);
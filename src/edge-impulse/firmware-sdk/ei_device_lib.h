@@ -58,6 +58,24 @@ bool ei_user_invoke_stop_lib(void);
  */
 bool read_encode_send_sample_buffer(size_t address, size_t length);
 
+/**
+ * @brief Read data from the serial port
+ *
+ * @param buffer
+ * @param length number of bytes to read
+ * @param timeout_ms how long to wait for all of the data
+ * @return size_t number of bytes read, less than length on timeout
+ */
+size_t ei_serial_read(uint8_t *buffer, size_t length, uint32_t timeout_ms);
+
+/**
+ * @brief Write data to the serial port
+ *
+ * @param buffer
+ * @param length number of bytes to write
+ */
+void ei_serial_write(const uint8_t *buffer, size_t length);
+
 bool run_impulse_static_data(bool debug, size_t length, size_t buf_len);
 
 EI_IMPULSE_ERROR ei_start_impulse_static_data(bool debug, float* data, size_t size);
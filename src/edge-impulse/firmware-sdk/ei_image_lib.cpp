@@ -49,11 +49,18 @@
 #include "edge-impulse-sdk/dsp/image/image.hpp"
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
 #include "firmware-sdk/at_base64_lib.h"
+#include "firmware-sdk/ei_binary_frame.h"
 #include "firmware-sdk/ei_device_interface.h"
+#include "firmware-sdk/ei_device_lib.h"
 #include "firmware-sdk/ei_image_lib.h"
 
 // *********************************** AT cmd functions ***************
 
+static void serial_write_chars(const char *buffer, size_t length)
+{
+    ei_serial_write((const uint8_t *)buffer, length);
+}
+
 static void respond_and_change_to_max_baud()
 {
     auto device = EiDeviceInfo::get_device();
@@ -186,10 +193,19 @@ static bool ei_camera_take_snapshot_encode_and_output_no_init(size_t width, size
 #endif
 
     // recalculate size b/c now we want to send just the interpolated bytes
-    base64_encode(
-        reinterpret_cast<char *>(image),
-        final_height * final_width * pixel_size_B,
-        ei_putchar);
+    if (ei_frame_is_binary_mode()) {
+        ei_frame_writer_t writer;
+
+        ei_frame_writer_begin(&writer, serial_write_chars);
+        ei_frame_writer_data(&writer, image, final_height * final_width * pixel_size_B);
+        ei_frame_writer_end(&writer);
+    }
+    else {
+        base64_encode_write(
+            reinterpret_cast<char *>(image),
+            final_height * final_width * pixel_size_B,
+            serial_write_chars);
+    }
 
     return true;
 }
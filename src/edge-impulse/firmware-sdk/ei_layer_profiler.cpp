@@ -0,0 +1,150 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ei_layer_profiler.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+#include <string.h>
+
+/* Handle of the events that don't fit in the table, ignored by EndEvent */
+#define EVENT_DROPPED   UINT32_MAX
+
+EiLayerProfiler::EiLayerProfiler(ei_layer_profile_t *layers, uint16_t max_layers, ei_layer_counters_read_t read_counters)
+    : layers(layers)
+    , max_layers(max_layers)
+    , read_counters(read_counters)
+{
+    reset();
+}
+
+uint32_t EiLayerProfiler::BeginEvent(const char *tag)
+{
+    if (next_layer >= max_layers) {
+        dropped_events++;
+        return EVENT_DROPPED;
+    }
+
+    ei_layer_profile_t *layer = &layers[next_layer];
+    layer->tag = tag;
+
+    // read last, keeps the profiler overhead out of the layer
+    read_counters(&layer->start);
+
+    return next_layer++;
+}
+
+void EiLayerProfiler::EndEvent(uint32_t event_handle)
+{
+    ei_layer_counters_t end;
+
+    // read first, keeps the profiler overhead out of the layer
+    read_counters(&end);
+
+    if (event_handle >= max_layers) {
+        return;
+    }
+
+    ei_layer_profile_t *layer = &layers[event_handle];
+    // unsigned subtraction, correct across one wrap of the counters
+    uint32_t cycles = end.cycles - layer->start.cycles;
+
+    layer->runs++;
+    layer->cycles += cycles;
+    layer->icache_misses += end.icache_misses - layer->start.icache_misses;
+    layer->dcache_misses += end.dcache_misses - layer->start.dcache_misses;
+    if (cycles > layer->cycles_max) {
+        layer->cycles_max = cycles;
+    }
+
+    if (event_handle >= layer_count) {
+        layer_count = (uint16_t)(event_handle + 1);
+    }
+}
+
+void EiLayerProfiler::start_inference(void)
+{
+    next_layer = 0;
+}
+
+void EiLayerProfiler::end_inference(void)
+{
+    inferences++;
+}
+
+void EiLayerProfiler::reset(void)
+{
+    memset(layers, 0, max_layers * sizeof(ei_layer_profile_t));
+    next_layer = 0;
+    layer_count = 0;
+    inferences = 0;
+    dropped_events = 0;
+}
+
+const ei_layer_profile_t *EiLayerProfiler::get_layer(uint16_t index) const
+{
+    if (index >= layer_count) {
+        return nullptr;
+    }
+
+    return &layers[index];
+}
+
+void EiLayerProfiler::print_csv(void) const
+{
+    uint64_t total_cycles = 0;
+
+    ei_printf("layer,op,runs,cycles,cycles_max,icache_misses,dcache_misses\r\n");
+
+    for (uint16_t i = 0; i < layer_count; i++) {
+        const ei_layer_profile_t *layer = &layers[i];
+        uint32_t runs = layer->runs > 0 ? layer->runs : 1;
+
+        ei_printf("%u,%s,%lu,%lu,%lu,%lu,%lu\r\n",
+            i,
+            layer->tag ? layer->tag : "",
+            (unsigned long)layer->runs,
+            (unsigned long)(layer->cycles / runs),
+            (unsigned long)layer->cycles_max,
+            (unsigned long)(layer->icache_misses / runs),
+            (unsigned long)(layer->dcache_misses / runs));
+
+        total_cycles += layer->cycles / runs;
+    }
+
+    ei_printf("total,,%lu,%lu,,,\r\n", (unsigned long)inferences, (unsigned long)total_cycles);
+
+    if (dropped_events > 0) {
+        ei_printf("WARN: %lu events dropped, more layers than EI_LAYER_PROFILER_MAX_LAYERS (%u)\r\n",
+            (unsigned long)dropped_events, max_layers);
+    }
+}
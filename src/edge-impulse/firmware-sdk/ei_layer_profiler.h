@@ -0,0 +1,129 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EI_LAYER_PROFILER_H
+#define EI_LAYER_PROFILER_H
+
+/*
+ * Per layer profiler for TFLite Micro. The interpreter reports an event per
+ * operator, the profiler attributes the hardware counters read at begin and
+ * end of each event to the layer (operator index) and accumulates them over
+ * inferences. One fixed table entry per layer, no per event storage.
+ *
+ * The counters come from a read function given by the platform (DWT cycle
+ * counter and cache monitors on Apollo4), which can be a fake tick source to
+ * test the recording and aggregation on the host.
+ */
+
+#include <stdint.h>
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_profiler_interface.h"
+
+/* Layers in the profiler table, default to the operators of the model
+   (EI_TFLITE_MODEL_OPERATORS comes from the op resolver generator) */
+#ifndef EI_LAYER_PROFILER_MAX_LAYERS
+#ifdef EI_TFLITE_MODEL_OPERATORS
+#define EI_LAYER_PROFILER_MAX_LAYERS    EI_TFLITE_MODEL_OPERATORS
+#else
+#define EI_LAYER_PROFILER_MAX_LAYERS    128
+#endif
+#endif
+
+/**
+ * @brief Snapshot of the free running hardware counters, all wrap at 32 bits
+ */
+typedef struct {
+    uint32_t cycles;
+    uint32_t icache_misses;
+    uint32_t dcache_misses;
+} ei_layer_counters_t;
+
+typedef void (*ei_layer_counters_read_t)(ei_layer_counters_t *counters);
+
+/**
+ * @brief Counters of one layer, summed over all inferences since reset
+ */
+typedef struct {
+    const char *tag;            // op name, e.g. "CONV_2D"
+    uint32_t runs;
+    uint64_t cycles;
+    uint32_t cycles_max;
+    uint64_t icache_misses;
+    uint64_t dcache_misses;
+    ei_layer_counters_t start;  // snapshot at BeginEvent
+} ei_layer_profile_t;
+
+class EiLayerProfiler : public tflite::MicroProfilerInterface {
+public:
+    EiLayerProfiler(ei_layer_profile_t *layers, uint16_t max_layers, ei_layer_counters_read_t read_counters);
+
+    uint32_t BeginEvent(const char *tag) override;
+    void EndEvent(uint32_t event_handle) override;
+
+    /**
+     * @brief Call before each Invoke(), the next event is layer 0 again
+     */
+    void start_inference(void);
+    /**
+     * @brief Call after each Invoke() that succeeded, counts the inference
+     */
+    void end_inference(void);
+    void reset(void);
+
+    uint32_t get_inferences(void) const { return inferences; };
+    uint16_t get_layer_count(void) const { return layer_count; };
+    uint32_t get_dropped_events(void) const { return dropped_events; };
+    const ei_layer_profile_t *get_layer(uint16_t index) const;
+
+    /**
+     * @brief Print one CSV row per layer, averages per run
+     */
+    void print_csv(void) const;
+
+private:
+    ei_layer_profile_t *layers;
+    uint16_t max_layers;
+    ei_layer_counters_read_t read_counters;
+    uint16_t next_layer;
+    uint16_t layer_count;
+    uint32_t inferences;
+    uint32_t dropped_events;
+};
+
+/**
+ * @brief Profiler passed to the TFLite interpreter when
+ * EI_CLASSIFIER_LAYER_PROFILER is enabled, implemented by the platform
+ */
+EiLayerProfiler *ei_layer_profiler_get(void);
+
+#endif /* EI_LAYER_PROFILER_H */
@@ -433,31 +433,44 @@ int sensor_aq_add_data_i16(sensor_aq_ctx *ctx, int16_t values[], size_t values_s
 
 /**
  * Add data to the sensor file for many intervals at the same time
- * This only works if there is only a single sensor
+ * With more than one axis the values are interleaved per interval
+ * (e.g. L0 R0 L1 R1 ...), each interval is emitted as an array
  * @param ctx The context
  * @param values Values
- * @param values_size Size of the values array
+ * @param values_size Size of the values array, a multiple of the axis count
  */
 int sensor_aq_add_data_batch(sensor_aq_ctx *ctx, int16_t values[], size_t values_size) {
-    if (ctx->axis_count != 1) {
-        return AQ_BATCH_ONLY_SUPPORTS_SINGLE_AXIS;
+    if (ctx->axis_count == 0 || values_size % ctx->axis_count != 0) {
+        return AQ_VALUES_SIZE_DOES_NOT_MATCH_AXIS_COUNT;
     }
 
     if (ctx->stream == NULL) {
         return AQ_STREAM_IS_NULL;
     }
 
+    // an interval takes at most an array header and 3 bytes per int16
+    const size_t flush_margin = 8 + 3 * (ctx->axis_count - 1);
+
     // clear memory
     memset(ctx->cbor_buffer.ptr, 0, ctx->cbor_buffer.len);
 
     // re-initialize
     QCBOREncode_Init(&ctx->encode_context, ctx->cbor_buffer);
 
-    for (size_t ix = 0; ix < values_size; ix++) {
-        QCBOREncode_AddInt64(&ctx->encode_context, values[ix]);
+    for (size_t ix = 0; ix < values_size; ix += ctx->axis_count) {
+        if (ctx->axis_count == 1) {
+            QCBOREncode_AddInt64(&ctx->encode_context, values[ix]);
+        }
+        else {
+            QCBOREncode_OpenArray(&ctx->encode_context);
+            for (size_t axis = 0; axis < ctx->axis_count; axis++) {
+                QCBOREncode_AddInt64(&ctx->encode_context, values[ix + axis]);
+            }
+            QCBOREncode_CloseArray(&ctx->encode_context);
+        }
 
-        // within 8 bytes of the size of the buffer...
-        if (ctx->encode_context.OutBuf.data_len >= ctx->cbor_buffer.len - 8) {
+        // not enough room left for another interval...
+        if (ctx->encode_context.OutBuf.data_len >= ctx->cbor_buffer.len - flush_margin) {
             int fr = sensor_aq_flush_buffer(ctx);
             if (fr != AQ_OK) {
                 return fr;
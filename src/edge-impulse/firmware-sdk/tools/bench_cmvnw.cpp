@@ -0,0 +1,240 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host check and benchmark of speechpy::processing::cmvnw() (running
+ * sums over the window) against cmvnw_reference() (every window computed
+ * again), on random features with a different mean and spread per column,
+ * an all-zero column, windows longer than the matrix and odd and even
+ * windows, with and without variance normalization and scaling.
+ *
+ * Fails if a feature differs from cmvnw_reference() by more than the float
+ * tolerance plus the rounding error of cmvnw_reference() itself, against the
+ * same normalization in double precision: where the window barely varies
+ * (e.g. a single row reflected into the whole window) cmvnw_reference() divides
+ * its rounding error by a near zero deviation.
+ *
+ * Usage:
+ *     bench_cmvnw
+ */
+
+#include "edge-impulse-sdk/dsp/speechpy/speechpy.hpp"
+
+/* Each implementation is repeated for about this long to time it */
+#define BENCH_TIME_US               20000.0
+
+#include "bench_util.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace ei;
+using namespace ei::speechpy;
+
+/* Of max(1, |reference|), the running sums round differently than the sums of every window */
+#define MAX_DIFF                    1e-4f
+
+/**
+ * @brief Features with a random mean and spread per column, the last column all zero
+ */
+static void random_features(std::vector<float> &features, size_t rows, size_t cols)
+{
+    std::uniform_real_distribution<float> mean(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> spread(0.1f, 5.0f);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    features.resize(rows * cols);
+    for (size_t col = 0; col < cols; col++) {
+        float col_mean = mean(rng);
+        float col_spread = spread(rng);
+        for (size_t row = 0; row < rows; row++) {
+            features[row * cols + col] = col == cols - 1 ? 0.0f : col_mean + col_spread * normal(rng);
+        }
+    }
+}
+
+/**
+ * @brief Row of the features at index ix of the symmetric padding (numpy 'symmetric')
+ */
+static size_t padded_row(long ix, long rows)
+{
+    while (ix < 0 || ix >= rows) {
+        ix = ix < 0 ? -ix - 1 : 2 * rows - ix - 1;
+    }
+    return ix;
+}
+
+/**
+ * @brief Local mean (and variance) normalization in double precision, windows
+ * as speechpy's cmvnw (the last one cut at the end of the padding)
+ */
+static void exact_cmvnw(std::vector<double> &features, size_t rows, size_t cols, uint16_t win_size,
+    bool variance_normalization)
+{
+    const long pad_size = (win_size - 1) / 2;
+    const long last = rows - 1 + pad_size;
+
+    for (int pass = 0; pass < (variance_normalization ? 2 : 1); pass++) {
+        std::vector<double> input = features;
+        for (size_t row = 0; row < rows; row++) {
+            long first = row - pad_size;
+            long end = std::min<long>(first + win_size - 1, last);
+            for (size_t col = 0; col < cols; col++) {
+                double sum = 0, sum_sq = 0;
+                for (long ix = first; ix <= end; ix++) {
+                    double value = input[padded_row(ix, rows) * cols + col];
+                    sum += value;
+                    sum_sq += value * value;
+                }
+                double count = end - first + 1;
+                double mean = sum / count;
+                if (pass == 0) {
+                    features[row * cols + col] -= mean;
+                }
+                else {
+                    double std = sqrt(std::max(0.0, sum_sq / count - mean * mean));
+                    features[row * cols + col] /= (std + 1e-10);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Compare cmvnw() with cmvnw_reference() on one shape, print a row
+ * @param timed Also time both
+ */
+static bool check(size_t rows, size_t cols, uint16_t win_size, bool variance_normalization, bool scale, bool timed)
+{
+    std::vector<float> features, reference, fast;
+    random_features(features, rows, cols);
+
+    reference = features;
+    fast = features;
+    matrix_t reference_matrix(rows, cols, reference.data());
+    matrix_t fast_matrix(rows, cols, fast.data());
+
+    int ret = processing::cmvnw_reference(&reference_matrix, win_size, variance_normalization, scale);
+    if (ret != EIDSP_OK) {
+        printf("cmvnw_reference failed (%d)\n", ret);
+        return false;
+    }
+    ret = processing::cmvnw(&fast_matrix, win_size, variance_normalization, scale);
+    if (ret != EIDSP_OK) {
+        printf("cmvnw failed (%d)\n", ret);
+        return false;
+    }
+
+    // scaling is the same code on both, compare before it
+    std::vector<double> exact(features.begin(), features.end());
+    exact_cmvnw(exact, rows, cols, win_size, variance_normalization);
+    if (scale) {
+        matrix_t exact_matrix(rows, cols);
+        for (size_t ix = 0; ix < features.size(); ix++) {
+            exact_matrix.buffer[ix] = exact[ix];
+        }
+        numpy::normalize(&exact_matrix);
+        for (size_t ix = 0; ix < features.size(); ix++) {
+            exact[ix] = exact_matrix.buffer[ix];
+        }
+    }
+
+    float max_diff = 0.0f;
+    size_t mismatches = 0;
+    for (size_t ix = 0; ix < features.size(); ix++) {
+        float scale_of = std::max(1.0f, fabsf(reference[ix]));
+        float diff = fabsf(reference[ix] - fast[ix]) / scale_of;
+        float reference_error = fabs(reference[ix] - exact[ix]) / scale_of;
+        if (!(diff <= MAX_DIFF + reference_error)) {
+            mismatches++;
+        }
+        max_diff = std::max(max_diff, diff);
+    }
+
+    printf("%4zu x %2zu win %3u %-8s %-5s",
+        rows, cols, win_size, variance_normalization ? "variance" : "mean", scale ? "scale" : "");
+
+    if (timed) {
+        double reference_us = time_us([&]() {
+            reference = features;
+            processing::cmvnw_reference(&reference_matrix, win_size, variance_normalization, scale);
+        });
+        double fast_us = time_us([&]() {
+            fast = features;
+            processing::cmvnw(&fast_matrix, win_size, variance_normalization, scale);
+        });
+        printf(" %9.1f %9.1f %7.2fx", reference_us, fast_us, reference_us / fast_us);
+    }
+    else {
+        printf(" %9s %9s %8s", "", "", "");
+    }
+
+    printf("  %.2e  %zu/%zu\n", max_diff, mismatches, features.size());
+    return mismatches == 0;
+}
+
+int main(void)
+{
+    printf("%-32s %9s %9s %8s  %-8s  %s\n", "", "reference", "running", "", "max", "");
+    printf("%-32s %9s %9s %8s  %-8s  %s\n", "", "us", "us", "", "diff", "mismatches");
+
+    bool ok = true;
+
+    // shapes of the MFCC and MFE blocks (1 s at a 20 ms stride), timed
+    const uint16_t timed_windows[] = { 101, 151, 301 };
+    for (uint16_t win_size : timed_windows) {
+        ok &= check(49, 13, win_size, true, false, true);
+        ok &= check(99, 13, win_size, true, false, true);
+        ok &= check(99, 40, win_size, false, true, true);
+    }
+
+    // odd and even windows, windows longer than the matrix, a single row
+    const size_t rows[] = { 1, 2, 3, 10, 64 };
+    const uint16_t windows[] = { 1, 2, 3, 4, 9, 10, 63, 64, 65, 200, 301 };
+    for (size_t r : rows) {
+        for (uint16_t win_size : windows) {
+            ok &= check(r, 7, win_size, true, false, false);
+            ok &= check(r, 7, win_size, false, false, false);
+            ok &= check(r, 7, win_size, false, true, false);
+        }
+    }
+
+    processing::cmvnw_buffer::clear();
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
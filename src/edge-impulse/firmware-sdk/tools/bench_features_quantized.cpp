@@ -0,0 +1,386 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host benchmark of the quantized audio features shortcut
+ * (run_nn_inference_features_quantized): one second of audio through an MFE
+ * block into a small int8 model built in memory (FULLY_CONNECTED and SOFTMAX),
+ * run as an impulse with the MFE features quantized straight into the input
+ * tensor, and through the float feature matrix.
+ *
+ *  - both paths give the same scores
+ *  - peak heap and time per inference of both paths
+ *  - the error paths of the shortcut (arena too small, DSP error, canceled,
+ *    input tensor of another size) return the error and hand back all the
+ *    heap they took
+ *
+ * Returns 1 on a failed check.
+ *
+ * Usage:
+ *     bench_features_quantized
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "edge-impulse-sdk/tensorflow/lite/schema/schema_generated_full.h"
+
+#include "bench_util.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#define SAMPLE_RATE                 16000
+#define SAMPLE_COUNT                16000
+#define MFE_FILTERS                 40
+#define MFE_FEATURES                (99 * MFE_FILTERS)
+#define LABELS                      2
+#define WINDOWS                     16
+#define ARENA_SIZE                  (16 * 1024)
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* Heap of the SDK, in use and peak, the posix porting defines these weak */
+static size_t heap_in_use = 0;
+static size_t heap_peak = 0;
+
+// size in front of each block, keeps the alignment of malloc
+#define HEAP_HEADER                 16
+
+void *ei_malloc(size_t size)
+{
+    uint8_t *ptr = (uint8_t*)malloc(size + HEAP_HEADER);
+    if (ptr == nullptr) {
+        return nullptr;
+    }
+    *(size_t*)ptr = size;
+    heap_in_use += size;
+    if (heap_in_use > heap_peak) {
+        heap_peak = heap_in_use;
+    }
+    return ptr + HEAP_HEADER;
+}
+
+void *ei_calloc(size_t nitems, size_t size)
+{
+    void *ptr = ei_malloc(nitems * size);
+    if (ptr != nullptr) {
+        memset(ptr, 0, nitems * size);
+    }
+    return ptr;
+}
+
+void ei_free(void *ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    uint8_t *block = (uint8_t*)ptr - HEAP_HEADER;
+    heap_in_use -= *(size_t*)block;
+    free(block);
+}
+
+static bool cancel = false;
+
+EI_IMPULSE_ERROR ei_run_impulse_check_canceled()
+{
+    return cancel ? EI_IMPULSE_CANCELED : EI_IMPULSE_OK;
+}
+
+/**
+ * @brief FULLY_CONNECTED and SOFTMAX over inputs MFE features, int8
+ */
+static std::vector<uint8_t> build_model(int inputs)
+{
+    std::unique_ptr<tflite::ModelT> model(new tflite::ModelT());
+    model->version = TFLITE_SCHEMA_VERSION;
+    model->buffers.push_back(std::unique_ptr<tflite::BufferT>(new tflite::BufferT()));
+    model->subgraphs.push_back(std::unique_ptr<tflite::SubGraphT>(new tflite::SubGraphT()));
+    tflite::SubGraphT *subgraph = model->subgraphs[0].get();
+
+    auto add_buffer = [&](const std::vector<uint8_t> &data) {
+        std::unique_ptr<tflite::BufferT> buffer(new tflite::BufferT());
+        buffer->data = data;
+        model->buffers.push_back(std::move(buffer));
+        return (int)model->buffers.size() - 1;
+    };
+    auto add_tensor = [&](const char *name, std::vector<int> shape, tflite::TensorType type,
+        float scale, int zero_point, int buffer) {
+        std::unique_ptr<tflite::TensorT> tensor(new tflite::TensorT());
+        tensor->name = name;
+        tensor->shape = shape;
+        tensor->type = type;
+        tensor->buffer = buffer;
+        tensor->quantization.reset(new tflite::QuantizationParametersT());
+        tensor->quantization->scale.push_back(scale);
+        tensor->quantization->zero_point.push_back(zero_point);
+        subgraph->tensors.push_back(std::move(tensor));
+        return (int)subgraph->tensors.size() - 1;
+    };
+    auto add_opcode = [&](tflite::BuiltinOperator op) {
+        std::unique_ptr<tflite::OperatorCodeT> code(new tflite::OperatorCodeT());
+        code->builtin_code = op;
+        code->deprecated_builtin_code = (int8_t)op;
+        code->version = 1;
+        model->operator_codes.push_back(std::move(code));
+        return (uint32_t)model->operator_codes.size() - 1;
+    };
+
+    // random weights with a scale of 1 / 1024, the MFE features are in [0, 1]
+    std::uniform_int_distribution<int> weight(-127, 127);
+    std::vector<uint8_t> weights(LABELS * inputs);
+    for (uint8_t &w : weights) {
+        w = (uint8_t)(int8_t)weight(rng);
+    }
+    int input = add_tensor("input", { 1, inputs }, tflite::TensorType_INT8, 1.0f / 256, -128, 0);
+    int w = add_tensor("fc/w", { LABELS, inputs }, tflite::TensorType_INT8, 1.0f / 1024, 0, add_buffer(weights));
+    int b = add_tensor("fc/b", { LABELS }, tflite::TensorType_INT32, 1.0f / (256 * 1024), 0,
+        add_buffer(std::vector<uint8_t>(LABELS * 4, 0)));
+    int logits = add_tensor("logits", { 1, LABELS }, tflite::TensorType_INT8, 0.25f, 0, 0);
+    int output = add_tensor("output", { 1, LABELS }, tflite::TensorType_INT8, 1.0f / 256, -128, 0);
+    subgraph->inputs = { input };
+    subgraph->outputs = { output };
+
+    std::unique_ptr<tflite::OperatorT> fc(new tflite::OperatorT());
+    fc->opcode_index = add_opcode(tflite::BuiltinOperator_FULLY_CONNECTED);
+    fc->inputs = { input, w, b };
+    fc->outputs = { logits };
+    fc->builtin_options.Set(tflite::FullyConnectedOptionsT());
+    subgraph->operators.push_back(std::move(fc));
+
+    std::unique_ptr<tflite::OperatorT> softmax(new tflite::OperatorT());
+    softmax->opcode_index = add_opcode(tflite::BuiltinOperator_SOFTMAX);
+    softmax->inputs = { logits };
+    softmax->outputs = { output };
+    tflite::SoftmaxOptionsT softmax_options;
+    softmax_options.beta = 1.0f;
+    softmax->builtin_options.Set(softmax_options);
+    subgraph->operators.push_back(std::move(softmax));
+
+    // no default allocator in the flatbuffers of the SDK
+    flatbuffers::DefaultAllocator allocator;
+    flatbuffers::FlatBufferBuilder fbb(1024, &allocator);
+    tflite::FinishModelBuffer(fbb, tflite::Model::Pack(fbb, model.get()));
+    return std::vector<uint8_t>(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+}
+
+static ei_dsp_config_mfe_t mfe_config = {
+    1, 4, 1, 0.02f, 0.01f, MFE_FILTERS, 256, 0, 0, 101, -52, 1
+};
+
+/**
+ * @brief Impulse of one model: the MFE block, the model and the classification
+ * post-processing. quantized selects the quantized features shortcut. The
+ * model is built by main().
+ */
+#define TEST_IMPULSE(name, quantized)                                                                \
+    static EI_CLASSIFIER_DSP_AXES_INDEX_TYPE name##_axes[1] = { 0 };                                 \
+    static ei_model_dsp_t name##_dsp_blocks[1] = {                                                   \
+        { 1, MFE_FEATURES, &extract_mfe_features, (void*)&mfe_config, name##_axes, 1, 1, nullptr,    \
+          nullptr }                                                                                  \
+    };                                                                                               \
+    static ei_config_tflite_graph_t name##_graph_config = { 1, nullptr, 0, ARENA_SIZE };             \
+    static const uint8_t name##_output_tensors_indices[1] = { 0 };                                   \
+    static ei_learning_block_config_tflite_graph_t name##_block_config = {                           \
+        1, 2, name##_output_tensors_indices, 1, quantized, false, (void*)&name##_graph_config, true  \
+    };                                                                                               \
+    static const uint32_t name##_learning_block_inputs[1] = { 1 };                                   \
+    static const ei_learning_block_t name##_learning_blocks[1] = {                                   \
+        { 2, &run_nn_inference, (void*)&name##_block_config, EI_CLASSIFIER_IMAGE_SCALING_NONE,       \
+          name##_learning_block_inputs, 1 }                                                          \
+    };                                                                                               \
+    static const ei_postprocessing_block_t name##_postprocessing_blocks[1] = {                       \
+        { 3, EI_CLASSIFIER_MODE_CLASSIFICATION, nullptr, nullptr, &process_classification_f32,       \
+          nullptr, nullptr, 2 }                                                                      \
+    };                                                                                               \
+    static const ei_impulse_t name##_impulse = {                                                     \
+        0, "", "", 0, #name, 0,                                                                      \
+        MFE_FEATURES, SAMPLE_COUNT, 1, SAMPLE_COUNT, 0, 0, 0, 1000.0f / SAMPLE_RATE, SAMPLE_RATE,    \
+        1, name##_dsp_blocks,                                                                        \
+        1, name##_learning_blocks,                                                                   \
+        1, name##_postprocessing_blocks,                                                             \
+        1, EI_CLASSIFIER_TFLITE, EI_CLASSIFIER_SENSOR_MICROPHONE, "audio", SAMPLE_COUNT, 1,          \
+        EI_ANOMALY_TYPE_UNKNOWN, LABELS, labels, EI_CLASSIFIER_TYPE_CLASSIFICATION, 0, nullptr       \
+    };                                                                                               \
+    static ei_impulse_handle_t name##_handle = ei_impulse_handle_t(&name##_impulse);
+
+static const char *labels[] = { "noise", "tone" };
+
+TEST_IMPULSE(quantized, true)
+TEST_IMPULSE(matrix, false)
+// model input smaller than the MFE features of the impulse
+TEST_IMPULSE(wrong_size, true)
+// arena too small for the model, set by main()
+TEST_IMPULSE(small_arena, true)
+
+static void load_model(ei_config_tflite_graph_t *graph_config, const std::vector<uint8_t> &model)
+{
+    graph_config->model = model.data();
+    graph_config->model_size = model.size();
+}
+
+static std::vector<float> audio(SAMPLE_COUNT);
+static bool audio_error = false;
+
+static int get_audio(size_t offset, size_t length, float *out_ptr)
+{
+    if (audio_error) {
+        return -1;
+    }
+    memcpy(out_ptr, audio.data() + offset, length * sizeof(float));
+    return 0;
+}
+
+/**
+ * @brief One second of noise, plus a tone on odd windows, in the range of the
+ * microphone samples
+ */
+static void make_audio(int window)
+{
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    const float frequency = 400.0f * (float)(1 + window);
+
+    for (int ix = 0; ix < SAMPLE_COUNT; ix++) {
+        float value = 500.0f * noise(rng);
+        if (window % 2) {
+            value += 4000.0f * std::sin(2.0f * (float)M_PI * frequency * (float)ix / SAMPLE_RATE);
+        }
+        audio[ix] = std::max(-32768.0f, std::min(32767.0f, std::round(value)));
+    }
+}
+
+/**
+ * @brief Peak heap of the SDK during one inference, over the heap in use before
+ */
+static size_t peak_heap(ei_impulse_handle_t *handle, signal_t *signal, ei_impulse_result_t *result, EI_IMPULSE_ERROR *res)
+{
+    size_t in_use = heap_in_use;
+    heap_peak = heap_in_use;
+    *res = process_impulse(handle, signal, result);
+    return heap_peak - in_use;
+}
+
+/**
+ * @brief An error path of the shortcut returns the error and leaves no heap behind
+ */
+static void check_error_path(ei_impulse_handle_t *handle, signal_t *signal, EI_IMPULSE_ERROR expected, const char *what)
+{
+    ei_impulse_result_t result;
+    char message[128];
+
+    size_t in_use = heap_in_use;
+    EI_IMPULSE_ERROR res = process_impulse(handle, signal, &result);
+    snprintf(message, sizeof(message), "%s returns %d (got %d)", what, expected, res);
+    check(res == expected, message);
+    snprintf(message, sizeof(message), "%s leaves %ld bytes of heap", what, (long)(heap_in_use - in_use));
+    check(heap_in_use == in_use, message);
+}
+
+int main(void)
+{
+    if (LABELS > EI_CLASSIFIER_LABEL_COUNT && EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 1) {
+        printf("the results of the impulse of the firmware hold %d labels, %d needed\n", EI_CLASSIFIER_LABEL_COUNT, LABELS);
+        return 1;
+    }
+
+    std::vector<uint8_t> model = build_model(MFE_FEATURES);
+    std::vector<uint8_t> small_model = build_model(MFE_FEATURES - MFE_FILTERS);
+    load_model(&quantized_graph_config, model);
+    load_model(&matrix_graph_config, model);
+    load_model(&wrong_size_graph_config, small_model);
+    load_model(&small_arena_graph_config, model);
+    small_arena_graph_config.arena_size = 512;
+
+    if (can_run_classifier_features_quantized(&quantized_impulse, quantized_learning_blocks[0]) != EI_IMPULSE_OK) {
+        printf("FAILED: the impulse can't run the quantized features shortcut\n");
+        return 1;
+    }
+
+    signal_t signal;
+    signal.total_length = SAMPLE_COUNT;
+    signal.get_data = &get_audio;
+
+    size_t quantized_peak = 0, matrix_peak = 0;
+    for (int window = 0; window < WINDOWS; window++) {
+        make_audio(window);
+
+        ei_impulse_result_t quantized_result, matrix_result;
+        EI_IMPULSE_ERROR quantized_res, matrix_res;
+        quantized_peak = std::max(quantized_peak, peak_heap(&quantized_handle, &signal, &quantized_result, &quantized_res));
+        matrix_peak = std::max(matrix_peak, peak_heap(&matrix_handle, &signal, &matrix_result, &matrix_res));
+        check(quantized_res == EI_IMPULSE_OK, "quantized features");
+        check(matrix_res == EI_IMPULSE_OK, "float features");
+        if (failures) {
+            break;
+        }
+
+        for (size_t ix = 0; ix < LABELS; ix++) {
+            check(quantized_result.classification[ix].value == matrix_result.classification[ix].value,
+                "quantized features give the scores of the float features");
+        }
+    }
+
+    ei_impulse_result_t result;
+    double quantized_us = time_us([&]() { process_impulse(&quantized_handle, &signal, &result); });
+    double matrix_us = time_us([&]() { process_impulse(&matrix_handle, &signal, &result); });
+
+    printf("%d windows, %d MFE features into an int8 model, arena %d bytes\n", WINDOWS, MFE_FEATURES, ARENA_SIZE);
+    printf("path                 peak heap    time\n");
+    printf("float features    %9zu B %7.2f ms\n", matrix_peak, matrix_us / 1000);
+    printf("quantized features%9zu B %7.2f ms\n", quantized_peak, quantized_us / 1000);
+    check(quantized_peak < matrix_peak, "less peak heap with the quantized features");
+
+    check_error_path(&small_arena_handle, &signal, EI_IMPULSE_TFLITE_ERROR, "arena too small");
+    audio_error = true;
+    check_error_path(&quantized_handle, &signal, EI_IMPULSE_DSP_ERROR, "DSP error");
+    audio_error = false;
+    cancel = true;
+    check_error_path(&quantized_handle, &signal, EI_IMPULSE_CANCELED, "canceled");
+    cancel = false;
+    check_error_path(&wrong_size_handle, &signal, EI_IMPULSE_INVALID_SIZE, "input tensor of another size");
+    check_error_path(&quantized_handle, &signal, EI_IMPULSE_OK, "inference after the errors");
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
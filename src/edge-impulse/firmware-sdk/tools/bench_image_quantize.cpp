@@ -0,0 +1,183 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host check and benchmark of extract_image_features_quantized() on a
+ * native 8 bit image (image_signal_t, the camera snapshot), against the
+ * signal_t version that reads every pixel packed into a float (0xRRGGBB), on
+ * a random 160x160 frame:
+ *
+ *  - RGB888 and grayscale images, into RGB and grayscale models
+ *  - the quantization of image models (scale 1/255, zero point -128, no
+ *    scaling), which takes the fast paths, and other scales, zero points and
+ *    image scalings, which take the lookup table and the float path
+ *  - parameters changed back and forth, so the lookup table is rebuilt
+ *
+ * Prints the time of both per frame. Fails if an output is not bit-exact, or
+ * if a zero scale is not rejected.
+ *
+ * Usage:
+ *     bench_image_quantize
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_dsp.h"
+
+#include "bench_util.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace ei;
+
+#define FRAME_WIDTH                 160
+#define FRAME_HEIGHT                160
+#define PIXELS                      (FRAME_WIDTH * FRAME_HEIGHT)
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* Frame as the camera gives it, and the signal_t over it */
+static std::vector<uint8_t> frame;
+static uint8_t frame_channels;
+
+static int frame_get_data(size_t offset, size_t length, float *out_ptr)
+{
+    for (size_t ix = 0; ix < length; ix++) {
+        const uint8_t *pixel = frame.data() + (offset + ix) * frame_channels;
+
+        if (frame_channels == 3) {
+            out_ptr[ix] = (float)((pixel[0] << 16) + (pixel[1] << 8) + pixel[2]);
+        }
+        else {
+            out_ptr[ix] = (float)((pixel[0] << 16) + (pixel[0] << 8) + pixel[0]);
+        }
+    }
+    return EIDSP_OK;
+}
+
+typedef struct {
+    const char *name;
+    float scale;
+    float zero_point;
+    int image_scaling;
+} quantization_t;
+
+static const quantization_t quantizations[] = {
+    { "1/255, -128",            0.003921568859368563f, -128, EI_CLASSIFIER_IMAGE_SCALING_NONE },
+    { "0.0078, -1",             0.0078125f,            -1,   EI_CLASSIFIER_IMAGE_SCALING_NONE },
+    { "1/255, -128, torch",     0.003921568859368563f, -128, EI_CLASSIFIER_IMAGE_SCALING_TORCH },
+    { "0.0186, 14, torch",      0.018658f,             14,   EI_CLASSIFIER_IMAGE_SCALING_TORCH },
+    { "1, 0, -128..127",        1.0f,                  0,    EI_CLASSIFIER_IMAGE_SCALING_MIN128_127 },
+    { "1/255, -128, 0..255",    0.003921568859368563f, -128, EI_CLASSIFIER_IMAGE_SCALING_0_255 },
+};
+
+int main(int argc, char **argv)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<int8_t> from_signal(PIXELS * 3);
+    std::vector<int8_t> from_image(PIXELS * 3);
+    char rgb[] = "RGB";
+    char grayscale[] = "Grayscale";
+
+    printf("%ux%u frame, time per frame\n", FRAME_WIDTH, FRAME_HEIGHT);
+    printf("%-10s %-10s %-22s %10s %10s\n", "image", "model", "quantization", "signal_t", "image");
+
+    for (int image_channels : { 3, 1 }) {
+        frame_channels = (uint8_t)image_channels;
+        frame.resize(PIXELS * frame_channels);
+        for (uint8_t &v : frame) {
+            v = (uint8_t)byte(rng);
+        }
+
+        signal_t signal;
+        signal.total_length = PIXELS;
+        signal.get_data = &frame_get_data;
+
+        image_signal_t image = { frame.data(), FRAME_WIDTH, FRAME_HEIGHT, frame_channels };
+
+        for (char *channels : { rgb, grayscale }) {
+            ei_dsp_config_image_t config = { 0, 1, 1, channels, 1 };
+            const size_t features = PIXELS * (channels == rgb ? 3 : 1);
+            matrix_i8_t signal_matrix(1, features, from_signal.data());
+            matrix_i8_t image_matrix(1, features, from_image.data());
+
+            for (const quantization_t &q : quantizations) {
+                memset(from_signal.data(), 0x55, from_signal.size());
+                memset(from_image.data(), 0xaa, from_image.size());
+
+                int signal_res = extract_image_features_quantized(&signal, &signal_matrix, &config,
+                    q.scale, q.zero_point, 0, q.image_scaling);
+                int image_res = extract_image_features_quantized(&image, &image_matrix, &config,
+                    q.scale, q.zero_point, 0, q.image_scaling);
+
+                check(signal_res == EIDSP_OK && image_res == EIDSP_OK, "extract_image_features_quantized");
+                check(memcmp(from_signal.data(), from_image.data(), features) == 0, "image output is bit-exact");
+
+                double signal_us = time_us([&]() {
+                    extract_image_features_quantized(&signal, &signal_matrix, &config,
+                        q.scale, q.zero_point, 0, q.image_scaling);
+                });
+                double image_us = time_us([&]() {
+                    extract_image_features_quantized(&image, &image_matrix, &config,
+                        q.scale, q.zero_point, 0, q.image_scaling);
+                });
+
+                printf("%-10s %-10s %-22s %8.1f us %8.1f us\n",
+                    frame_channels == 3 ? "RGB888" : "grayscale", channels, q.name, signal_us, image_us);
+            }
+
+            // lookup table of the first parameters again, after the others
+            const quantization_t &q = quantizations[1];
+            extract_image_features_quantized(&signal, &signal_matrix, &config, q.scale, q.zero_point, 0, q.image_scaling);
+            extract_image_features_quantized(&image, &image_matrix, &config, q.scale, q.zero_point, 0, q.image_scaling);
+            check(memcmp(from_signal.data(), from_image.data(), features) == 0, "rebuilt lookup table is bit-exact");
+        }
+
+        ei_dsp_config_image_t config = { 0, 1, 1, rgb, 1 };
+        matrix_i8_t image_matrix(1, PIXELS * 3, from_image.data());
+        check(extract_image_features_quantized(&image, &image_matrix, &config, 0.0f, 0, 0,
+            EI_CLASSIFIER_IMAGE_SCALING_TORCH) != EIDSP_OK, "zero scale is rejected");
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Runs a TFLite Micro kernel on the host for the checks and benchmarks:
+ * the KernelRunner of the TFLite Micro tests, with an arena of any size, except
+ * that after InitAndPrepare() the kernel reads eval tensors set up once, like
+ * the interpreter, instead of new temporary ones that fill the arena
+ */
+
+#ifndef EI_TOOLS_BENCH_KERNEL_RUNNER_H
+#define EI_TOOLS_BENCH_KERNEL_RUNNER_H
+
+#include "edge-impulse-sdk/tensorflow/lite/micro/fake_micro_context.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/mock_micro_graph.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/single_arena_buffer_allocator.h"
+
+#include <vector>
+
+class BenchKernelRunner {
+public:
+    BenchKernelRunner(const TfLiteRegistration &registration, TfLiteTensor *tensors, int tensors_size,
+        TfLiteIntArray *inputs, TfLiteIntArray *outputs, void *builtin_data, size_t arena_size)
+        : registration_(registration),
+          arena_(arena_size),
+          allocator_(tflite::SingleArenaBufferAllocator::Create(arena_.data(), arena_.size())),
+          graph_(allocator_),
+          micro_context_(tensors, allocator_, &graph_),
+          tensors_(tensors),
+          tensors_size_(tensors_size)
+    {
+        context_.impl_ = &micro_context_;
+        context_.ReportError = tflite::MicroContextReportOpError;
+        context_.GetTensor = tflite::MicroContextGetTensor;
+        context_.GetEvalTensor = tflite::MicroContextGetEvalTensor;
+        context_.AllocatePersistentBuffer = tflite::MicroContextAllocatePersistentBuffer;
+        context_.RequestScratchBufferInArena = tflite::MicroContextRequestScratchBufferInArena;
+        context_.GetScratchBuffer = tflite::MicroContextGetScratchBuffer;
+        node_.inputs = inputs;
+        node_.outputs = outputs;
+        node_.builtin_data = builtin_data;
+    }
+
+    ~BenchKernelRunner()
+    {
+        if (registration_.free) {
+            registration_.free(&context_, node_.user_data);
+        }
+    }
+
+    TfLiteStatus InitAndPrepare(const char *init_data = nullptr, size_t length = 0)
+    {
+        if (registration_.init) {
+            node_.user_data = registration_.init(&context_, init_data, length);
+        }
+        TfLiteStatus status = registration_.prepare ? registration_.prepare(&context_, &node_) : kTfLiteOk;
+
+        /* With the dims Prepare may have resized */
+        micro_context_.eval_tensors.resize(tensors_size_);
+        for (int i = 0; i < tensors_size_; i++) {
+            micro_context_.eval_tensors[i].data = tensors_[i].data;
+            micro_context_.eval_tensors[i].dims = tensors_[i].dims;
+            micro_context_.eval_tensors[i].type = tensors_[i].type;
+        }
+        context_.GetEvalTensor = GetEvalTensor;
+        return status;
+    }
+
+    TfLiteStatus Invoke()
+    {
+        return registration_.invoke(&context_, &node_);
+    }
+
+private:
+    /* Holds the eval tensors set up once */
+    class BenchMicroContext : public tflite::FakeMicroContext {
+    public:
+        BenchMicroContext(TfLiteTensor *tensors, tflite::SingleArenaBufferAllocator *allocator,
+            tflite::MicroGraph *graph)
+            : tflite::FakeMicroContext(tensors, allocator, graph)
+        {
+        }
+
+        std::vector<TfLiteEvalTensor> eval_tensors;
+    };
+
+    static TfLiteEvalTensor *GetEvalTensor(const TfLiteContext *context, int tensor_idx)
+    {
+        return &static_cast<BenchMicroContext*>(context->impl_)->eval_tensors[tensor_idx];
+    }
+
+    const TfLiteRegistration &registration_;
+    std::vector<uint8_t> arena_;
+    tflite::SingleArenaBufferAllocator *allocator_;
+    tflite::MockMicroGraph graph_;
+    BenchMicroContext micro_context_;
+    TfLiteTensor *tensors_;
+    int tensors_size_;
+    TfLiteContext context_ = {};
+    TfLiteNode node_ = {};
+};
+
+#endif // EI_TOOLS_BENCH_KERNEL_RUNNER_H
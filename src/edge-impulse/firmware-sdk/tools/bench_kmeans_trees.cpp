@@ -0,0 +1,393 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host benchmark of the K-means anomaly score and of the tree ensemble
+ * classifier kernel, against the scalar code they replaced.
+ *
+ *  - K-means: standard scaler and smallest distance to the clusters, 90% of
+ *    the windows close to a cluster (the normal case), 10% far from all of them
+ *  - trees: TreeEnsembleClassifier with the nodes flattened at Prepare, against
+ *    the walk over the flexbuffer arrays
+ *
+ * Usage:
+ *     bench_kmeans_trees
+ */
+
+#define FLATBUFFERS_LOCALE_INDEPENDENT 0
+#include "edge-impulse-sdk/third_party/flatbuffers/include/flatbuffers/flexbuffers.h"
+#include "edge-impulse-sdk/classifier/ei_anomaly_kmeans.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/kernels/tree_ensemble_classifier.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/test_helpers.h"
+
+#include "bench_kernel_runner.h"
+#include "bench_util.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define KMEANS_WINDOWS              1000
+#define TREES_WINDOWS               256
+#define TREES_ARENA_SIZE            4096
+// the kernel copies each internal node into a 12 byte TreeNode of the arena
+#define TREES_NODE_SIZE             12
+
+typedef struct {
+    float *centroid;
+    float max_error;
+} cluster_t;
+
+/**
+ * @brief The scaler and distance of anomaly.h before the CMSIS-DSP kernels
+ */
+static float reference_kmeans(float *input, const float *scale, const float *mean, size_t input_size,
+    const cluster_t *clusters, size_t cluster_count)
+{
+    for (size_t ix = 0; ix < input_size; ix++) {
+        input[ix] = (input[ix] - mean[ix]) / scale[ix];
+    }
+    float min = 1000.0f;
+    for (size_t c = 0; c < cluster_count; c++) {
+        float dist = 0.0f;
+        for (size_t ix = 0; ix < input_size; ix++) {
+            dist += pow(input[ix] - clusters[c].centroid[ix], 2);
+        }
+        dist = sqrt(dist) - clusters[c].max_error;
+        if (dist < min) {
+            min = dist;
+        }
+    }
+    return min;
+}
+
+static void bench_kmeans(size_t features, size_t cluster_count)
+{
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::uniform_real_distribution<float> uniform(0.5f, 2.0f);
+
+    std::vector<float> scale(features), mean(features);
+    for (size_t ix = 0; ix < features; ix++) {
+        scale[ix] = uniform(rng);
+        mean[ix] = normal(rng);
+    }
+    std::vector<std::vector<float>> centroids(cluster_count, std::vector<float>(features));
+    std::vector<cluster_t> clusters(cluster_count);
+    for (size_t c = 0; c < cluster_count; c++) {
+        for (size_t ix = 0; ix < features; ix++) {
+            centroids[c][ix] = normal(rng) * 2.0f;
+        }
+        clusters[c].centroid = centroids[c].data();
+        clusters[c].max_error = uniform(rng) * sqrtf((float)features) * 0.2f;
+    }
+
+    // raw features, so the scaler has something to undo
+    std::vector<std::vector<float>> windows(KMEANS_WINDOWS, std::vector<float>(features));
+    for (size_t w = 0; w < KMEANS_WINDOWS; w++) {
+        const float *centroid = centroids[rng() % cluster_count].data();
+        bool normal_window = (w % 10) != 0;
+        for (size_t ix = 0; ix < features; ix++) {
+            float scaled = normal_window ? centroid[ix] + normal(rng) * 0.3f : normal(rng) * 4.0f;
+            windows[w][ix] = scaled * scale[ix] + mean[ix];
+        }
+    }
+
+    std::vector<float> input(features);
+    std::vector<float> reference(KMEANS_WINDOWS), scores(KMEANS_WINDOWS);
+    double reference_us = time_us([&]() {
+        for (size_t w = 0; w < KMEANS_WINDOWS; w++) {
+            memcpy(input.data(), windows[w].data(), features * sizeof(float));
+            reference[w] = reference_kmeans(input.data(), scale.data(), mean.data(), features,
+                clusters.data(), cluster_count);
+        }
+    });
+    double kernels_us = time_us([&]() {
+        for (size_t w = 0; w < KMEANS_WINDOWS; w++) {
+            memcpy(input.data(), windows[w].data(), features * sizeof(float));
+            ei_anomaly_standard_scaler(input.data(), scale.data(), mean.data(), features);
+            scores[w] = ei_anomaly_min_cluster_distance(input.data(), features, clusters.data(), cluster_count, 1000.0f);
+        }
+    });
+
+    float max_diff = 0.0f;
+    for (size_t w = 0; w < KMEANS_WINDOWS; w++) {
+        max_diff = std::max(max_diff, fabsf(scores[w] - reference[w]) / std::max(1.0f, fabsf(reference[w])));
+    }
+
+    printf("kmeans %3zu features %3zu clusters    %9.3f %9.3f %6.2fx   %.1e\n", features, cluster_count,
+        reference_us / KMEANS_WINDOWS, kernels_us / KMEANS_WINDOWS, reference_us / kernels_us, max_diff);
+}
+
+typedef struct {
+    uint32_t num_internal_nodes;
+    uint32_t num_leaf_nodes;
+    std::vector<uint16_t> featureids;
+    std::vector<float> values;
+    std::vector<uint16_t> truenodeids;
+    std::vector<uint16_t> falsenodeids;
+    std::vector<float> weights;
+    std::vector<uint8_t> classids;
+    std::vector<uint16_t> tree_root_ids;
+} trees_t;
+
+/**
+ * @brief Random full trees, internal nodes in preorder then the leaves, as
+ * laid out by the converter
+ */
+static void random_trees(trees_t &trees, size_t tree_count, size_t depth, size_t features, size_t classes)
+{
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    size_t internal_per_tree = (1u << depth) - 1;
+    size_t leaves_per_tree = 1u << depth;
+
+    trees.num_internal_nodes = tree_count * internal_per_tree;
+    trees.num_leaf_nodes = tree_count * leaves_per_tree;
+    trees.featureids.resize(trees.num_internal_nodes);
+    trees.values.resize(trees.num_internal_nodes);
+    trees.truenodeids.resize(trees.num_internal_nodes);
+    trees.falsenodeids.resize(trees.num_internal_nodes);
+    trees.weights.resize(trees.num_leaf_nodes);
+    trees.classids.resize(trees.num_leaf_nodes);
+    trees.tree_root_ids.resize(tree_count);
+
+    for (size_t t = 0; t < tree_count; t++) {
+        size_t first_internal = t * internal_per_tree;
+        size_t first_leaf = trees.num_internal_nodes + t * leaves_per_tree;
+        trees.tree_root_ids[t] = first_internal;
+
+        // preorder: the node of heap index h (children 2h+1 and 2h+2) is at
+        // preorder[h], leaves get the leaf ids in order
+        std::vector<uint16_t> id(internal_per_tree + leaves_per_tree);
+        size_t next_internal = first_internal, next_leaf = first_leaf;
+        std::vector<size_t> stack(1, 0);
+        while (!stack.empty()) {
+            size_t h = stack.back();
+            stack.pop_back();
+            if (h < internal_per_tree) {
+                id[h] = next_internal++;
+                stack.push_back(2 * h + 2);
+                stack.push_back(2 * h + 1);
+            }
+            else {
+                id[h] = next_leaf++;
+            }
+        }
+        for (size_t h = 0; h < internal_per_tree; h++) {
+            uint16_t ix = id[h];
+            trees.featureids[ix] = rng() % features;
+            trees.values[ix] = normal(rng);
+            trees.truenodeids[ix] = id[2 * h + 1];
+            trees.falsenodeids[ix] = id[2 * h + 2];
+        }
+    }
+    for (size_t ix = 0; ix < trees.num_leaf_nodes; ix++) {
+        trees.weights[ix] = normal(rng);
+        trees.classids[ix] = rng() % classes;
+    }
+}
+
+/**
+ * @brief Prepare() checks the node counts against the blob sizes: set the
+ * size prefix of the blob to the element count
+ */
+static void set_blob_count(const flexbuffers::Map &m, const char *key, size_t count)
+{
+    flexbuffers::Blob blob = m[key].AsBlob();
+    uint8_t *data = const_cast<uint8_t*>(blob.data());
+    size_t byte_width = 1u << flexbuffers::WidthU(blob.size());
+    for (size_t i = 0; i < byte_width; i++) {
+        (data - byte_width)[i] = (uint8_t)(count >> (8 * i));
+    }
+}
+
+static void build_options(const trees_t &trees, std::vector<uint8_t> &options)
+{
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() {
+        fbb.UInt("num_leaf_nodes", trees.num_leaf_nodes);
+        fbb.UInt("num_internal_nodes", trees.num_internal_nodes);
+        fbb.UInt("num_trees", trees.tree_root_ids.size());
+        fbb.Key("nodes_featureids");
+        fbb.Blob(trees.featureids.data(), trees.featureids.size() * sizeof(uint16_t));
+        fbb.Key("nodes_values");
+        fbb.Blob(trees.values.data(), trees.values.size() * sizeof(float));
+        fbb.Key("nodes_truenodeids");
+        fbb.Blob(trees.truenodeids.data(), trees.truenodeids.size() * sizeof(uint16_t));
+        fbb.Key("nodes_falsenodeids");
+        fbb.Blob(trees.falsenodeids.data(), trees.falsenodeids.size() * sizeof(uint16_t));
+        fbb.Key("nodes_weights");
+        fbb.Blob(trees.weights.data(), trees.weights.size() * sizeof(float));
+        fbb.Key("nodes_classids");
+        fbb.Blob(trees.classids.data(), trees.classids.size());
+        fbb.Key("tree_root_ids");
+        fbb.Blob(trees.tree_root_ids.data(), trees.tree_root_ids.size() * sizeof(uint16_t));
+        fbb.String("tree_index_type", "uint16");
+        fbb.String("node_value_type", "float32");
+        fbb.String("class_index_type", "uint8");
+        fbb.String("class_weight_type", "float32");
+        fbb.String("equality_operator", "leq");
+    });
+    fbb.Finish();
+    options = fbb.GetBuffer();
+
+    const flexbuffers::Map m = flexbuffers::GetRoot(options.data(), options.size()).AsMap();
+    set_blob_count(m, "nodes_featureids", trees.num_internal_nodes);
+    set_blob_count(m, "nodes_values", trees.num_internal_nodes);
+    set_blob_count(m, "nodes_truenodeids", trees.num_internal_nodes);
+    set_blob_count(m, "nodes_falsenodeids", trees.num_internal_nodes);
+    set_blob_count(m, "nodes_weights", trees.num_leaf_nodes);
+    set_blob_count(m, "nodes_classids", trees.num_leaf_nodes);
+}
+
+typedef struct {
+    const float *nodes_values;
+    const uint16_t *nodes_featureids;
+    const uint16_t *nodes_truenodeids;
+    const uint16_t *nodes_falsenodeids;
+    const float *nodes_weights;
+    const uint8_t *nodes_classids;
+} flexbuffer_trees_t;
+
+/**
+ * @brief The arrays in the flexbuffer, as Init() of TreeEnsembleClassifier
+ */
+static void get_flexbuffer_trees(const std::vector<uint8_t> &options, flexbuffer_trees_t &fb)
+{
+    const flexbuffers::Map m = flexbuffers::GetRoot(options.data(), options.size()).AsMap();
+    fb.nodes_values = (const float*)m["nodes_values"].AsBlob().data();
+    fb.nodes_featureids = (const uint16_t*)m["nodes_featureids"].AsBlob().data();
+    fb.nodes_truenodeids = (const uint16_t*)m["nodes_truenodeids"].AsBlob().data();
+    fb.nodes_falsenodeids = (const uint16_t*)m["nodes_falsenodeids"].AsBlob().data();
+    fb.nodes_weights = (const float*)m["nodes_weights"].AsBlob().data();
+    fb.nodes_classids = (const uint8_t*)m["nodes_classids"].AsBlob().data();
+}
+
+/**
+ * @brief The Eval of TreeEnsembleClassifier before the nodes were flattened
+ */
+static void reference_trees(const trees_t &trees, const flexbuffer_trees_t &fb,
+    const float *in_data, float *out_data, size_t classes)
+{
+    memset(out_data, 0, classes * sizeof(float));
+    for (size_t i = 0; i < trees.tree_root_ids.size(); i++) {
+        uint16_t ix = trees.tree_root_ids[i];
+
+        while (ix < trees.num_internal_nodes) {
+            float node_val = 0;
+            memcpy(&node_val, (fb.nodes_values + ix), sizeof(float));
+
+            if (in_data[fb.nodes_featureids[ix]] <= node_val) {
+                ix = fb.nodes_truenodeids[ix];
+            } else {
+                ix = fb.nodes_falsenodeids[ix];
+            }
+        }
+        ix -= trees.num_internal_nodes;
+
+        float weight = 0;
+        memcpy(&weight, (fb.nodes_weights + ix), sizeof(float));
+        out_data[fb.nodes_classids[ix]] += weight;
+    }
+}
+
+static void bench_trees(size_t tree_count, size_t depth, size_t features, size_t classes)
+{
+    trees_t trees;
+    std::vector<uint8_t> options;
+    random_trees(trees, tree_count, depth, features, classes);
+    build_options(trees, options);
+
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::vector<float> windows(TREES_WINDOWS * features);
+    for (float &f : windows) {
+        f = normal(rng);
+    }
+
+    std::vector<float> input(features), output(classes);
+    int input_dims[] = { 2, 1, (int)features };
+    int output_dims[] = { 2, 1, (int)classes };
+    TfLiteTensor tensors[] = {
+        tflite::testing::CreateTensor(input.data(), tflite::testing::IntArrayFromInts(input_dims)),
+        tflite::testing::CreateTensor(output.data(), tflite::testing::IntArrayFromInts(output_dims)),
+    };
+    int inputs_array[] = { 1, 0 };
+    int outputs_array[] = { 1, 1 };
+    BenchKernelRunner runner(*tflite::Register_TreeEnsembleClassifier(), tensors, 2,
+        tflite::testing::IntArrayFromInts(inputs_array), tflite::testing::IntArrayFromInts(outputs_array), nullptr,
+        TREES_ARENA_SIZE + trees.num_internal_nodes * TREES_NODE_SIZE);
+    if (runner.InitAndPrepare((const char*)options.data(), options.size()) != kTfLiteOk) {
+        printf("trees  %3zu trees of depth %zu: Prepare() failed\n", tree_count, depth);
+        return;
+    }
+
+    flexbuffer_trees_t fb;
+    get_flexbuffer_trees(options, fb);
+
+    std::vector<float> reference(TREES_WINDOWS * classes), scores(TREES_WINDOWS * classes);
+    double reference_us = time_us([&]() {
+        for (size_t w = 0; w < TREES_WINDOWS; w++) {
+            reference_trees(trees, fb, &windows[w * features], &reference[w * classes], classes);
+        }
+    });
+    double kernel_us = time_us([&]() {
+        for (size_t w = 0; w < TREES_WINDOWS; w++) {
+            memcpy(input.data(), &windows[w * features], features * sizeof(float));
+            runner.Invoke();
+            memcpy(&scores[w * classes], output.data(), classes * sizeof(float));
+        }
+    });
+
+    bool identical = memcmp(reference.data(), scores.data(), reference.size() * sizeof(float)) == 0;
+    printf("trees  %3zu trees of depth %zu     %9.3f %9.3f %6.2fx   %s\n", tree_count, depth,
+        reference_us / TREES_WINDOWS, kernel_us / TREES_WINDOWS, reference_us / kernel_us,
+        identical ? "identical" : "DIFFERENT");
+}
+
+int main(void)
+{
+    printf("%-34s %9s %9s %7s   %s\n", "", "old us", "new us", "", "max diff");
+
+    bench_kmeans(3, 8);
+    bench_kmeans(16, 32);
+    bench_kmeans(33, 32);
+    bench_kmeans(64, 64);
+
+    bench_trees(10, 4, 33, 4);
+    bench_trees(50, 6, 33, 4);
+    bench_trees(100, 8, 33, 4);
+
+    return 0;
+}
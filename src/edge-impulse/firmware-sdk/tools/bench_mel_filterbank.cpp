@@ -0,0 +1,288 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host check and benchmark of the cached sparse Mel filterbanks
+ * (speechpy/mel_filterbank.hpp) against the filterbank code they replaced,
+ * on power spectra of synthetic audio:
+ *
+ *  - MFE v1, v2: feature::filterbanks() and numpy::dot_by_row() per frame,
+ *    as mfe_v3() did
+ *  - MFE v3, v4 and MFCC: the bins and weights of mfe(), computed per call
+ *    and per frame
+ *
+ * Fails if a filter energy differs by more than the float tolerance.
+ *
+ * Usage:
+ *     bench_mel_filterbank
+ */
+
+#include "edge-impulse-sdk/dsp/speechpy/speechpy.hpp"
+
+#include "bench_util.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace ei;
+using namespace ei::speechpy;
+
+#define FRAMES                      64
+#define MAX_RELATIVE_DIFF           1e-6f
+
+typedef struct {
+    uint32_t sampling_frequency;
+    uint16_t fft_length;
+    uint16_t num_filters;
+    uint32_t low_frequency;
+    uint32_t high_frequency;
+} config_t;
+
+/**
+ * @brief The bins mfe() computed on every call
+ */
+static void reference_mfe_bins(const config_t &c, uint16_t version, std::vector<uint16_t> &bins)
+{
+    uint32_t low_frequency = c.low_frequency;
+    uint32_t high_frequency = c.high_frequency == 0 ? c.sampling_frequency / 2 : c.high_frequency;
+    if (version < 4 && low_frequency == 0) {
+        low_frequency = 300;
+    }
+
+    const int mels_size = c.num_filters + 2;
+    std::vector<float> mels(mels_size);
+    bins.resize(mels_size);
+    numpy::linspace(
+        functions::frequency_to_mel(static_cast<float>(low_frequency)),
+        functions::frequency_to_mel(static_cast<float>(high_frequency)),
+        mels_size,
+        mels.data());
+
+    uint16_t max_bin = version >= 4 ? c.fft_length : c.fft_length / 2 + 1;
+    for (int ix = 0; ix < mels_size - 1; ix++) {
+        mels[ix] = functions::mel_to_frequency(mels[ix]);
+        if (mels[ix] < low_frequency) {
+            mels[ix] = low_frequency;
+        }
+        if (mels[ix] > high_frequency) {
+            mels[ix] = high_frequency;
+        }
+        bins[ix] = feature::get_fft_bin_from_hertz(max_bin, mels[ix], c.sampling_frequency);
+    }
+    mels[mels_size - 1] = functions::mel_to_frequency(mels[mels_size - 1]);
+    if (mels[mels_size - 1] > high_frequency) {
+        mels[mels_size - 1] = high_frequency;
+    }
+    mels[mels_size - 1] -= 0.001;
+    bins[mels_size - 1] = feature::get_fft_bin_from_hertz(max_bin, mels[mels_size - 1], c.sampling_frequency);
+}
+
+/**
+ * @brief The filters of mfe() on one frame, weights computed per frame
+ */
+static void reference_mfe_frame(const std::vector<uint16_t> &bins, const float *power_spectrum, float *row_ptr,
+    size_t num_filters)
+{
+    for (size_t i = 0; i < num_filters; i++) {
+        size_t left = bins[i];
+        size_t middle = bins[i + 1];
+        size_t right = bins[i + 2];
+
+        row_ptr[i] = power_spectrum[middle];
+        for (size_t bin = left + 1; bin < right; bin++) {
+            if (bin < middle) {
+                row_ptr[i] += ((static_cast<float>(bin) - left) / (middle - left)) * power_spectrum[bin];
+            }
+            if (bin > middle) {
+                row_ptr[i] += ((right - static_cast<float>(bin)) / (right - middle)) * power_spectrum[bin];
+            }
+        }
+    }
+}
+
+/**
+ * @brief mfe_v3() on the frames: the dense filterbanks, then one dot product per frame
+ */
+static int reference_speechpy(const config_t &c, matrix_t &spectra, matrix_t *out)
+{
+    const uint16_t coefficients = c.fft_length / 2 + 1;
+    uint32_t low_frequency = c.low_frequency == 0 ? 300 : c.low_frequency;
+    uint32_t high_frequency = c.high_frequency == 0 ? c.sampling_frequency / 2 : c.high_frequency;
+
+#if EIDSP_QUANTIZE_FILTERBANK
+    EI_DSP_QUANTIZED_MATRIX(filterbanks, c.num_filters, coefficients, &numpy::dequantize_zero_one);
+#else
+    EI_DSP_MATRIX(filterbanks, c.num_filters, coefficients);
+#endif
+    int ret = feature::filterbanks(&filterbanks, c.num_filters, coefficients, c.sampling_frequency,
+        low_frequency, high_frequency, true);
+    if (ret != EIDSP_OK) {
+        return ret;
+    }
+
+    memset(out->buffer, 0, out->rows * out->cols * sizeof(float));
+    for (size_t f = 0; f < spectra.rows; f++) {
+        numpy::dot_by_row(f, spectra.get_row_ptr(f), coefficients, &filterbanks, out);
+    }
+    return EIDSP_OK;
+}
+
+/**
+ * @brief Power spectra of frames of tones in noise, one frame per row
+ */
+static void power_spectra(const config_t &c, matrix_t *spectra)
+{
+    std::normal_distribution<float> noise(0.0f, 200.0f);
+    std::uniform_real_distribution<float> tone(50.0f, c.sampling_frequency / 2.0f);
+    std::vector<float> frame(c.fft_length);
+
+    for (size_t f = 0; f < spectra->rows; f++) {
+        float f1 = tone(rng), f2 = tone(rng);
+        for (size_t ix = 0; ix < c.fft_length; ix++) {
+            float t = (float)(f * c.fft_length + ix) / c.sampling_frequency;
+            frame[ix] = 8000.0f * sinf(2 * M_PI * f1 * t) + 2000.0f * sinf(2 * M_PI * f2 * t) + noise(rng);
+        }
+        numpy::power_spectrum(frame.data(), c.fft_length, spectra->get_row_ptr(f), spectra->cols, c.fft_length);
+    }
+}
+
+static bool compare(const matrix_t &reference, const matrix_t &features, size_t *mismatches)
+{
+    float max_diff = 0.0f;
+    *mismatches = 0;
+    for (size_t ix = 0; ix < reference.rows * reference.cols; ix++) {
+        if (memcmp(&reference.buffer[ix], &features.buffer[ix], sizeof(float)) != 0) {
+            (*mismatches)++;
+        }
+        float diff = fabsf(features.buffer[ix] - reference.buffer[ix]) / std::max(1.0f, fabsf(reference.buffer[ix]));
+        max_diff = std::max(max_diff, diff);
+    }
+    return max_diff <= MAX_RELATIVE_DIFF;
+}
+
+static bool bench(const char *block, uint16_t version, const config_t &c)
+{
+    const mel_filterbank_type_t type = (strcmp(block, "MFE") == 0 && version < 3) ?
+        MEL_FILTERBANK_SPEECHPY : MEL_FILTERBANK_MFE;
+    const uint16_t coefficients = c.fft_length / 2 + 1;
+
+    matrix_t spectra(FRAMES, coefficients);
+    power_spectra(c, &spectra);
+    matrix_t reference(FRAMES, c.num_filters);
+    matrix_t features(FRAMES, c.num_filters);
+
+    double reference_us;
+    if (type == MEL_FILTERBANK_SPEECHPY) {
+        reference_us = time_us([&]() {
+            reference_speechpy(c, spectra, &reference);
+        });
+    }
+    else {
+        reference_us = time_us([&]() {
+            std::vector<uint16_t> bins;
+            reference_mfe_bins(c, version, bins);
+            for (size_t f = 0; f < FRAMES; f++) {
+                reference_mfe_frame(bins, spectra.get_row_ptr(f), reference.get_row_ptr(f), c.num_filters);
+            }
+        });
+    }
+
+    const mel_filterbank_t *filterbank = nullptr;
+    double build_us = time_us([&]() {
+        mel_filterbank::clear();
+        mel_filterbank::acquire(&filterbank, type, c.sampling_frequency, c.fft_length, c.num_filters,
+            c.low_frequency, c.high_frequency, version);
+        mel_filterbank::release(filterbank);
+    });
+    mel_filterbank::acquire(&filterbank, type, c.sampling_frequency, c.fft_length, c.num_filters,
+        c.low_frequency, c.high_frequency, version);
+#if EIDSP_MEL_FILTERBANK_CACHE_SIZE > 0
+    const mel_filterbank_t *again = nullptr;
+    mel_filterbank::acquire(&again, type, c.sampling_frequency, c.fft_length, c.num_filters,
+        c.low_frequency, c.high_frequency, version);
+    if (filterbank == nullptr || again != filterbank || !filterbank->cached) {
+        printf("%s v%u: filterbank not cached\n", block, version);
+        return false;
+    }
+#endif
+    double cached_us = time_us([&]() {
+        for (size_t f = 0; f < FRAMES; f++) {
+            mel_filterbank::apply(filterbank, spectra.get_row_ptr(f), features.get_row_ptr(f));
+        }
+    });
+
+    size_t mismatches;
+    bool ok = compare(reference, features, &mismatches);
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s v%u %5u Hz fft %4u %2u filters", block, version,
+        (unsigned)c.sampling_frequency, c.fft_length, c.num_filters);
+    printf("%-38s %6zu %8.2f %9.2f %9.2f %6.2fx   %4zu/%zu %s\n", name, filterbank->weights_size, build_us,
+        reference_us / FRAMES, cached_us / FRAMES, reference_us / cached_us,
+        mismatches, (size_t)(FRAMES * c.num_filters), ok ? "" : "FAIL");
+
+    mel_filterbank::release(filterbank);
+    mel_filterbank::clear();
+    return ok;
+}
+
+int main(void)
+{
+    const config_t configs[] = {
+        { 16000, 256, 40, 0, 0 },
+        { 16000, 512, 40, 300, 8000 },
+        { 16000, 512, 32, 80, 7600 },
+        { 8000, 256, 32, 0, 0 },
+        { 44100, 1024, 64, 20, 0 },
+    };
+
+    printf("%-38s %6s %8s %9s %9s %7s   %s\n", "", "", "build", "old", "cached", "", "not");
+    printf("%-38s %6s %8s %9s %9s %7s   %s\n", "", "weights", "us", "us/frame", "us/frame", "", "bit-exact");
+
+    bool ok = true;
+    for (const config_t &c : configs) {
+        for (uint16_t version = 1; version <= 4; version++) {
+            ok &= bench("MFE", version, c);
+        }
+        for (uint16_t version = 1; version <= 4; version++) {
+            ok &= bench("MFCC", version, c);
+        }
+    }
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host benchmark of the TFLite Micro memory planners: records the
+ * buffers AllocateTensors() plans for the test models of test_helpers.cc (and
+ * the model sources given on the command line), then plans them again with
+ * each planner and reports the planning time and the arena the plan needs.
+ *
+ *  - linear:  LinearMemoryPlanner, no reuse, for reference
+ *  - greedy:  GreedyMemoryPlanner as on the device, plan cache missed
+ *  - cached:  GreedyMemoryPlanner setting up the same model again
+ *  - best-of: GreedyMemoryPlanner::SetBestOfStrategies(), as gen_memory_plan --offline
+ *
+ * Usage:
+ *     bench_memory_planner [model sources...]
+ */
+
+#include "model_source.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/all_ops_resolver.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_interpreter.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/memory_planner/linear_memory_planner.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/test_helpers.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define HOST_ARENA_SIZE             (64 * 1024 * 1024)
+
+/* Plans are repeated for about this long to time them */
+#define BENCH_TIME_US               20000.0
+
+typedef struct {
+    int size;
+    int first_used;
+    int last_used;
+    int offline_offset;
+} buffer_requirements_t;
+
+typedef struct {
+    double plan_us;
+    size_t arena;
+} bench_result_t;
+
+/**
+ * @brief GreedyMemoryPlanner keeping a copy of the buffers added by the allocator
+ */
+class RecordingMemoryPlanner : public tflite::GreedyMemoryPlanner {
+public:
+    std::vector<buffer_requirements_t> buffers;
+
+    TfLiteStatus Init(unsigned char *scratch_buffer, int scratch_buffer_size) override
+    {
+        buffers.clear();
+        return GreedyMemoryPlanner::Init(scratch_buffer, scratch_buffer_size);
+    }
+
+    TfLiteStatus AddBuffer(int size, int first_time_used, int last_time_used) override
+    {
+        buffers.push_back({ size, first_time_used, last_time_used, tflite::kOnlinePlannedBuffer });
+        return GreedyMemoryPlanner::AddBuffer(size, first_time_used, last_time_used);
+    }
+
+    TfLiteStatus AddBuffer(int size, int first_time_used, int last_time_used, int offline_offset) override
+    {
+        // the base class records it through the overload above
+        TfLiteStatus status = GreedyMemoryPlanner::AddBuffer(size, first_time_used, last_time_used, offline_offset);
+        if (status == kTfLiteOk) {
+            buffers.back().offline_offset = offline_offset;
+        }
+        return status;
+    }
+};
+
+static uint8_t *host_arena(void)
+{
+    static std::vector<uint8_t> arena(HOST_ARENA_SIZE + 16);
+    return (uint8_t*)(((uintptr_t)arena.data() + 15) & ~(uintptr_t)15);
+}
+
+static bool record_buffers(const tflite::Model *model, const tflite::MicroOpResolver &resolver,
+    std::vector<buffer_requirements_t> &buffers)
+{
+    RecordingMemoryPlanner planner;
+    tflite::MicroAllocator *allocator = tflite::MicroAllocator::Create(host_arena(), HOST_ARENA_SIZE, &planner);
+    tflite::MicroInterpreter interpreter(model, resolver, allocator);
+
+    if (interpreter.AllocateTensors(true) != kTfLiteOk) {
+        return false;
+    }
+    buffers = planner.buffers;
+    return true;
+}
+
+/**
+ * @brief Plan the buffers, plus one empty buffer when pad is set: every other
+ * plan then differs from the one in the plan cache
+ */
+static size_t plan(tflite::MicroMemoryPlanner &planner, std::vector<uint8_t> &scratch,
+    const std::vector<buffer_requirements_t> &buffers, bool pad)
+{
+    planner.Init(scratch.data(), (int)scratch.size());
+    for (const buffer_requirements_t &b : buffers) {
+        if (b.offline_offset == tflite::kOnlinePlannedBuffer) {
+            planner.AddBuffer(b.size, b.first_used, b.last_used);
+        }
+        else {
+            planner.AddBuffer(b.size, b.first_used, b.last_used, b.offline_offset);
+        }
+    }
+    if (pad) {
+        planner.AddBuffer(0, 0, 0);
+    }
+    int offset;
+    for (int i = 0; i < planner.GetBufferCount(); i++) {
+        planner.GetOffsetForBuffer(i, &offset);
+    }
+    return planner.GetMaximumMemorySize();
+}
+
+static bench_result_t bench(tflite::GreedyMemoryPlanner &planner, const std::vector<buffer_requirements_t> &buffers,
+    bool miss_cache)
+{
+    std::vector<uint8_t> scratch((buffers.size() + 1) * tflite::GreedyMemoryPlanner::per_buffer_size());
+    bench_result_t result;
+
+    result.arena = plan(planner, scratch, buffers, false);
+
+    size_t iterations = 0;
+    double elapsed_us = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (elapsed_us < BENCH_TIME_US) {
+        for (int i = 0; i < 16; i++) {
+            plan(planner, scratch, buffers, miss_cache && i % 2 == 0);
+        }
+        iterations += 16;
+        elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+    result.plan_us = elapsed_us / iterations;
+
+    return result;
+}
+
+static void bench_model(const char *name, const tflite::Model *model, const tflite::MicroOpResolver &resolver)
+{
+    std::vector<buffer_requirements_t> buffers;
+
+    if (!record_buffers(model, resolver, buffers)) {
+        printf("%-40s AllocateTensors() failed\n", name);
+        return;
+    }
+
+    // no Init() to start over, one plan per planner
+    std::vector<uint8_t> no_scratch;
+    tflite::LinearMemoryPlanner linear;
+    size_t linear_arena = plan(linear, no_scratch, buffers, false);
+
+    tflite::GreedyMemoryPlanner planner;
+    bench_result_t greedy = bench(planner, buffers, true);
+    bench_result_t cached = bench(planner, buffers, false);
+    planner.SetBestOfStrategies(true);
+    bench_result_t best_of = bench(planner, buffers, false);
+
+    printf("%-40s %7zu %9zu %9zu %9zu %10.2f %10.2f %10.2f\n", name, buffers.size(),
+        linear_arena, greedy.arena, best_of.arena, greedy.plan_us, cached.plan_us, best_of.plan_us);
+}
+
+int main(int argc, char **argv)
+{
+    printf("%-40s %7s %9s %9s %9s %10s %10s %10s\n", "", "", "arena", "arena", "arena",
+        "plan us", "plan us", "plan us");
+    printf("%-40s %7s %9s %9s %9s %10s %10s %10s\n", "model", "buffers", "linear", "greedy", "best-of",
+        "greedy", "cached", "best-of");
+
+    // all test models are built in one flatbuffer arena in test_helpers.cc, these fit
+    static tflite::AllOpsResolver test_resolver = tflite::testing::GetOpResolver();
+    const struct {
+        const char *name;
+        const tflite::Model *(*get)();
+    } test_models[] = {
+        { "SimpleMockModel", tflite::testing::GetSimpleMockModel },
+        { "ComplexMockModel", tflite::testing::GetComplexMockModel },
+        { "ModelWith256x256Tensor", tflite::testing::GetModelWith256x256Tensor },
+        { "SimpleModelWithBranch", tflite::testing::GetSimpleModelWithBranch },
+        { "SimpleMultipleInputsModel", tflite::testing::GetSimpleMultipleInputsModel },
+        { "ModelWithUnusedInputs", tflite::testing::GetModelWithUnusedInputs },
+        { "ModelWithUnusedOperatorOutputs", tflite::testing::GetModelWithUnusedOperatorOutputs },
+        { "SimpleStatefulModel", tflite::testing::GetSimpleStatefulModel },
+        { "SimpleModelWithSubgraphsAndIf", tflite::testing::GetSimpleModelWithSubgraphsAndIf },
+        { "SimpleModelWithIfAndEmptySubgraph", tflite::testing::GetSimpleModelWithIfAndEmptySubgraph },
+        { "SimpleModelWithSubgraphsAndWhile", tflite::testing::GetSimpleModelWithSubgraphsAndWhile },
+    };
+    for (size_t i = 0; i < sizeof(test_models) / sizeof(test_models[0]); i++) {
+        bench_model(test_models[i].name, test_models[i].get(), test_resolver);
+    }
+
+    static tflite::AllOpsResolver resolver;
+    for (int i = 1; i < argc; i++) {
+        std::string content;
+        std::vector<model_source_t> models;
+        if (!read_models(argv[i], models, content)) {
+            fprintf(stderr, "bench_memory_planner: failed to read %s\n", argv[i]);
+            return 1;
+        }
+        for (const model_source_t &model : models) {
+            bench_model(model.name.empty() ? argv[i] : model.name.c_str(),
+                tflite::GetModel(model.buffer.data()), resolver);
+        }
+    }
+
+    return 0;
+}
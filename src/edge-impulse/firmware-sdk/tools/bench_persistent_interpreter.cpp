@@ -0,0 +1,357 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host benchmark of EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER: a
+ * small int8 model built in memory (FULLY_CONNECTED, SOFTMAX and a custom
+ * identity op that can be made to fail) run as an impulse
+ *
+ *  - with the interpreter kept between inferences, and released before each
+ *    one, which sets it up again as without the option: time per inference,
+ *    number of setups, and the results must be bit-identical
+ *  - Invoke() failing: the impulse returns EI_IMPULSE_TFLITE_ERROR, the
+ *    interpreter is released once (not kept, not deleted twice) and the next
+ *    inference sets it up again and gives the same result
+ *  - the setup failing (arena too small): the error is reported and the next
+ *    inference sets the interpreter up again
+ *
+ * Returns 1 on a failed check. Run it with AddressSanitizer for the error
+ * path, in both settings of the option.
+ *
+ * Usage:
+ *     bench_persistent_interpreter
+ */
+
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/kernels/kernel_util.h"
+
+/* Identity op, fails its Invoke() on demand */
+static bool fail_invoke = false;
+
+static TfLiteStatus fail_op_prepare(TfLiteContext *context, TfLiteNode *node)
+{
+    return kTfLiteOk;
+}
+
+static TfLiteStatus fail_op_eval(TfLiteContext *context, TfLiteNode *node)
+{
+    if (fail_invoke) {
+        return kTfLiteError;
+    }
+
+    const TfLiteEvalTensor *input = tflite::micro::GetEvalInput(context, node, 0);
+    TfLiteEvalTensor *output = tflite::micro::GetEvalOutput(context, node, 0);
+    memcpy(output->data.raw, input->data.raw, tflite::micro::GetTensorShape(input).FlatSize());
+    return kTfLiteOk;
+}
+
+class bench_op_resolver : public tflite::MicroMutableOpResolver<3> {
+public:
+    bench_op_resolver()
+    {
+        AddFullyConnected();
+        AddSoftmax();
+        AddCustom("BENCH_FAIL", &registration);
+    }
+
+private:
+    TfLiteRegistration registration = tflite::micro::RegisterOp(nullptr, fail_op_prepare, fail_op_eval);
+};
+
+/* Resolver of the interpreters, instead of all ops */
+#define EI_TFLITE_RESOLVER static bench_op_resolver resolver;
+
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "edge-impulse-sdk/tensorflow/lite/schema/schema_generated_full.h"
+
+#include "bench_util.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#define FEATURES                    256
+#define LABELS                      2
+#define ARENA_SIZE                  4096
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/**
+ * @brief Fully connected layer, softmax and the identity op, int8
+ */
+static std::vector<uint8_t> build_model(void)
+{
+    std::unique_ptr<tflite::ModelT> model(new tflite::ModelT());
+    model->version = TFLITE_SCHEMA_VERSION;
+    model->buffers.push_back(std::unique_ptr<tflite::BufferT>(new tflite::BufferT()));
+    model->subgraphs.push_back(std::unique_ptr<tflite::SubGraphT>(new tflite::SubGraphT()));
+    tflite::SubGraphT *subgraph = model->subgraphs[0].get();
+
+    auto add_buffer = [&](const std::vector<uint8_t> &data) {
+        std::unique_ptr<tflite::BufferT> buffer(new tflite::BufferT());
+        buffer->data = data;
+        model->buffers.push_back(std::move(buffer));
+        return (int)model->buffers.size() - 1;
+    };
+    auto add_tensor = [&](const char *name, std::vector<int> shape, tflite::TensorType type,
+        float scale, int zero_point, int buffer) {
+        std::unique_ptr<tflite::TensorT> tensor(new tflite::TensorT());
+        tensor->name = name;
+        tensor->shape = shape;
+        tensor->type = type;
+        tensor->buffer = buffer;
+        tensor->quantization.reset(new tflite::QuantizationParametersT());
+        tensor->quantization->scale.push_back(scale);
+        tensor->quantization->zero_point.push_back(zero_point);
+        subgraph->tensors.push_back(std::move(tensor));
+        return (int)subgraph->tensors.size() - 1;
+    };
+    auto add_opcode = [&](tflite::BuiltinOperator op, const char *custom_code) {
+        std::unique_ptr<tflite::OperatorCodeT> code(new tflite::OperatorCodeT());
+        code->builtin_code = op;
+        code->deprecated_builtin_code = (int8_t)op;
+        code->version = 1;
+        if (custom_code != nullptr) {
+            code->custom_code = custom_code;
+        }
+        model->operator_codes.push_back(std::move(code));
+        return (uint32_t)model->operator_codes.size() - 1;
+    };
+
+    // random weights with a scale of 1 / 64, the features are in [-1, 1)
+    std::uniform_int_distribution<int> weight(-64, 64);
+    std::vector<uint8_t> weights(LABELS * FEATURES);
+    for (uint8_t &w : weights) {
+        w = (uint8_t)(int8_t)weight(rng);
+    }
+    int input = add_tensor("input", { 1, FEATURES }, tflite::TensorType_INT8, 1.0f / 128, 0, 0);
+    int w = add_tensor("fc/w", { LABELS, FEATURES }, tflite::TensorType_INT8, 1.0f / 64, 0, add_buffer(weights));
+    int b = add_tensor("fc/b", { LABELS }, tflite::TensorType_INT32, 1.0f / (128 * 64), 0,
+        add_buffer(std::vector<uint8_t>(LABELS * 4, 0)));
+    int logits = add_tensor("logits", { 1, LABELS }, tflite::TensorType_INT8, 0.25f, 0, 0);
+    int scores = add_tensor("scores", { 1, LABELS }, tflite::TensorType_INT8, 1.0f / 256, -128, 0);
+    int output = add_tensor("output", { 1, LABELS }, tflite::TensorType_INT8, 1.0f / 256, -128, 0);
+    subgraph->inputs = { input };
+    subgraph->outputs = { output };
+
+    std::unique_ptr<tflite::OperatorT> fc(new tflite::OperatorT());
+    fc->opcode_index = add_opcode(tflite::BuiltinOperator_FULLY_CONNECTED, nullptr);
+    fc->inputs = { input, w, b };
+    fc->outputs = { logits };
+    fc->builtin_options.Set(tflite::FullyConnectedOptionsT());
+    subgraph->operators.push_back(std::move(fc));
+
+    std::unique_ptr<tflite::OperatorT> softmax(new tflite::OperatorT());
+    softmax->opcode_index = add_opcode(tflite::BuiltinOperator_SOFTMAX, nullptr);
+    softmax->inputs = { logits };
+    softmax->outputs = { scores };
+    tflite::SoftmaxOptionsT softmax_options;
+    softmax_options.beta = 1.0f;
+    softmax->builtin_options.Set(softmax_options);
+    subgraph->operators.push_back(std::move(softmax));
+
+    std::unique_ptr<tflite::OperatorT> identity(new tflite::OperatorT());
+    identity->opcode_index = add_opcode(tflite::BuiltinOperator_CUSTOM, "BENCH_FAIL");
+    identity->inputs = { scores };
+    identity->outputs = { output };
+    subgraph->operators.push_back(std::move(identity));
+
+    // no default allocator in the flatbuffers of the SDK
+    flatbuffers::DefaultAllocator allocator;
+    flatbuffers::FlatBufferBuilder fbb(1024, &allocator);
+    tflite::FinishModelBuffer(fbb, tflite::Model::Pack(fbb, model.get()));
+    return std::vector<uint8_t>(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+}
+
+/**
+ * @brief Raw features, the signal is the feature vector
+ */
+static int extract_features(signal_t *signal, matrix_t *output_matrix, void *config, float frequency)
+{
+    (void)config;
+    (void)frequency;
+    return signal->get_data(0, output_matrix->rows * output_matrix->cols, output_matrix->buffer);
+}
+
+/* Impulse of the model: a raw DSP block, the model and the classification */
+static uint8_t bench_model[8192] __attribute__((aligned(16)));
+static EI_CLASSIFIER_DSP_AXES_INDEX_TYPE bench_axes[1] = { 0 };
+static ei_model_dsp_t bench_dsp_blocks[1] = {
+    { 1, FEATURES, &extract_features, nullptr, bench_axes, 1, 1, nullptr, nullptr }
+};
+static ei_config_tflite_graph_t bench_graph_config = { 1, bench_model, 0, ARENA_SIZE };
+static const uint8_t bench_output_tensors_indices[1] = { 0 };
+static ei_learning_block_config_tflite_graph_t bench_block_config = {
+    1, 2, bench_output_tensors_indices, 1, true, false, (void*)&bench_graph_config, true
+};
+static const uint32_t bench_learning_block_inputs[1] = { 1 };
+static const ei_learning_block_t bench_learning_blocks[1] = {
+    { 2, &run_nn_inference, (void*)&bench_block_config, EI_CLASSIFIER_IMAGE_SCALING_NONE,
+      bench_learning_block_inputs, 1 }
+};
+static const ei_postprocessing_block_t bench_postprocessing_blocks[1] = {
+    { 3, EI_CLASSIFIER_MODE_CLASSIFICATION, nullptr, nullptr, &process_classification_f32,
+      nullptr, nullptr, 2 }
+};
+static const char *bench_labels[] = { "yes", "no" };
+static const ei_impulse_t bench_impulse = {
+    0, "", "", 0, "bench", 0,
+    FEATURES, FEATURES, 1, FEATURES, 0, 0, 0, 1.0f, 1.0f,
+    1, bench_dsp_blocks,
+    1, bench_learning_blocks,
+    1, bench_postprocessing_blocks,
+    1, EI_CLASSIFIER_TFLITE, EI_CLASSIFIER_SENSOR_UNKNOWN, "", FEATURES, 1,
+    EI_ANOMALY_TYPE_UNKNOWN, LABELS, bench_labels, EI_CLASSIFIER_TYPE_CLASSIFICATION, 0, nullptr
+};
+static ei_impulse_handle_t bench_handle = ei_impulse_handle_t(&bench_impulse);
+
+static std::vector<float> features(FEATURES);
+
+static int get_features(size_t offset, size_t length, float *out_ptr)
+{
+    memcpy(out_ptr, features.data() + offset, length * sizeof(float));
+    return 0;
+}
+
+static bool run(signal_t *signal, float *scores)
+{
+    ei_impulse_result_t result;
+
+    if (process_impulse(&bench_handle, signal, &result) != EI_IMPULSE_OK) {
+        return false;
+    }
+    for (size_t ix = 0; ix < LABELS; ix++) {
+        scores[ix] = result.classification[ix].value;
+    }
+    return true;
+}
+
+int main(void)
+{
+    std::vector<uint8_t> model = build_model();
+    std::uniform_real_distribution<float> feature(-1.0f, 1.0f);
+    signal_t signal;
+    float kept[LABELS], set_up[LABELS], after_failure[LABELS];
+
+    if (LABELS > EI_CLASSIFIER_LABEL_COUNT && EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 1) {
+        printf("the results of the impulse of the firmware hold %d labels, %d needed\n", EI_CLASSIFIER_LABEL_COUNT, LABELS);
+        return 1;
+    }
+    if (model.size() > sizeof(bench_model)) {
+        printf("model of %zu bytes, only %zu reserved\n", model.size(), sizeof(bench_model));
+        return 1;
+    }
+    memcpy(bench_model, model.data(), model.size());
+    bench_graph_config.model_size = model.size();
+
+    for (float &f : features) {
+        f = feature(rng);
+    }
+    signal.total_length = FEATURES;
+    signal.get_data = &get_features;
+
+    printf("EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER=%d, %d features, %d labels\n",
+        EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER, FEATURES, LABELS);
+
+    // interpreter kept between inferences (set up on every one without the option)
+    run_classifier_init(&bench_handle);
+    uint32_t setups = inference_tflite_setup_count();
+    size_t runs = 0;
+    bool ok = true;
+    double kept_us = time_us([&]() {
+        ok &= run(&signal, kept);
+        runs++;
+    });
+    check(ok, "inference with the interpreter kept");
+    uint32_t kept_setups = inference_tflite_setup_count() - setups;
+    printf("kept:     %8.2f us per inference, %u setups in %zu inferences\n", kept_us, kept_setups, runs);
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER == 1
+    check(kept_setups == 1, "one setup with the interpreter kept");
+#endif
+
+    // released before every inference: set up every time
+    setups = inference_tflite_setup_count();
+    runs = 0;
+    double set_up_us = time_us([&]() {
+        inference_tflite_release();
+        ok &= run(&signal, set_up);
+        runs++;
+    });
+    check(ok, "inference with the interpreter set up every time");
+    uint32_t set_up_setups = inference_tflite_setup_count() - setups;
+    printf("set up:   %8.2f us per inference, %u setups in %zu inferences\n", set_up_us, set_up_setups, runs);
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER == 1
+    check(set_up_setups == runs, "one setup per inference when released");
+#endif
+    check(memcmp(kept, set_up, sizeof(kept)) == 0, "kept interpreter gives bit-identical results");
+
+    // Invoke() failing: released once, set up again on the next inference
+    run(&signal, kept);
+    setups = inference_tflite_setup_count();
+    ei_impulse_result_t result;
+    fail_invoke = true;
+    check(process_impulse(&bench_handle, &signal, &result) == EI_IMPULSE_TFLITE_ERROR, "failed Invoke() is reported");
+    fail_invoke = false;
+    check(run(&signal, after_failure), "inference after a failed Invoke()");
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER == 1
+    check(inference_tflite_setup_count() - setups == 1, "interpreter set up again after a failed Invoke()");
+#endif
+    check(memcmp(kept, after_failure, sizeof(kept)) == 0, "same results after a failed Invoke()");
+    printf("failed Invoke(): EI_IMPULSE_TFLITE_ERROR, then set up again\n");
+
+    // arena too small to set the interpreter up: the error is reported and the
+    // next inference, with the arena back, sets it up again
+    inference_tflite_release();
+    bench_graph_config.arena_size = 512;
+    check(process_impulse(&bench_handle, &signal, &result) != EI_IMPULSE_OK, "failed setup is reported");
+    bench_graph_config.arena_size = ARENA_SIZE;
+    check(run(&signal, after_failure), "inference after a failed setup");
+    check(memcmp(kept, after_failure, sizeof(kept)) == 0, "same results after a failed setup");
+    printf("failed setup: reported, then set up again\n");
+
+    run_classifier_deinit(&bench_handle);
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
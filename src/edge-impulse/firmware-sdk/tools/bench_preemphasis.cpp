@@ -0,0 +1,285 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host check and benchmark of speechpy::processing::preemphasis (one
+ * pass per block) against the class it replaced (a history buffer rolled per
+ * sample), on random int16 range audio:
+ *
+ *  - blocks that follow each other, of random lengths
+ *  - the overlapping frames of the frame loop, timed, with the number of
+ *    reads of the signal
+ *  - random blocks, against y[n] = x[n] - cof * x[n - shift] directly: the
+ *    old class used a stale history when a block started within the first
+ *    shift samples of the signal, after a block that didn't end there
+ *
+ * for shift 1 to 4, with and without rescaling. Fails if a sample is not
+ * bit-exact.
+ *
+ * Usage:
+ *     bench_preemphasis
+ */
+
+#include "edge-impulse-sdk/dsp/speechpy/speechpy.hpp"
+
+#include "bench_util.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace ei;
+using namespace ei::speechpy;
+
+#define SIGNAL_LENGTH               16000
+#define FRAME_LENGTH                400
+#define FRAME_STRIDE                160
+#define BLOCKS                      200
+
+static std::vector<float> audio;
+static size_t signal_reads = 0;
+
+static int audio_get_data(size_t offset, size_t length, float *out_ptr)
+{
+    signal_reads++;
+    memcpy(out_ptr, audio.data() + offset, length * sizeof(float));
+    return 0;
+}
+
+/**
+ * @brief The preemphasis class before, history buffer rolled per sample
+ */
+class reference_preemphasis {
+public:
+    reference_preemphasis(ei_signal_t *signal, int shift, float cof, bool rescale)
+        : _signal(signal), _shift(shift), _cof(cof), _rescale(rescale)
+    {
+        _prev_buffer = (float*)ei_dsp_calloc(shift * sizeof(float), 1);
+        _end_of_signal_buffer = (float*)ei_dsp_calloc(shift * sizeof(float), 1);
+
+        if (!_prev_buffer || !_end_of_signal_buffer) return;
+
+        signal->get_data(signal->total_length - shift, shift, _end_of_signal_buffer);
+    }
+
+    int get_data(size_t offset, size_t length, float *out_buffer) {
+        int ret;
+        if (static_cast<int32_t>(offset) - _shift >= 0) {
+            ret = _signal->get_data(offset - _shift, _shift, _prev_buffer);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+
+        ret = _signal->get_data(offset, length, out_buffer);
+        if (ret != 0) {
+            return ret;
+        }
+
+        for (size_t ix = 0; ix < length; ix++) {
+            float now = out_buffer[ix];
+
+            if (offset + ix < static_cast<uint32_t>(_shift)) {
+                out_buffer[ix] = now - (_cof * _end_of_signal_buffer[offset + ix]);
+            }
+            else {
+                out_buffer[ix] = now - (_cof * _prev_buffer[0]);
+            }
+
+            if (_shift != 1) {
+                numpy::roll(_prev_buffer, _shift, -1);
+            }
+            _prev_buffer[_shift - 1] = now;
+        }
+
+        if (_rescale) {
+            matrix_t scale_matrix(length, 1, out_buffer);
+            ret = numpy::scale(&scale_matrix, 1.0f / 32768.0f);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+
+        return EIDSP_OK;
+    }
+
+    ~reference_preemphasis() {
+        ei_dsp_free(_prev_buffer, _shift * sizeof(float));
+        ei_dsp_free(_end_of_signal_buffer, _shift * sizeof(float));
+    }
+
+private:
+    ei_signal_t *_signal;
+    int _shift;
+    float _cof;
+    float *_prev_buffer;
+    float *_end_of_signal_buffer;
+    bool _rescale;
+};
+
+/**
+ * @brief y[offset .. offset + length) directly
+ */
+static void direct(size_t offset, size_t length, int shift, float cof, bool rescale, float *out)
+{
+    for (size_t ix = 0; ix < length; ix++) {
+        long n = offset + ix;
+        float prev = audio[n >= shift ? n - shift : SIGNAL_LENGTH + n - shift];
+        out[ix] = audio[n] - (cof * prev);
+        if (rescale) {
+            out[ix] = out[ix] * (1.0f / 32768.0f);
+        }
+    }
+}
+
+static size_t count_mismatches(const float *a, const float *b, size_t length)
+{
+    size_t mismatches = 0;
+    for (size_t ix = 0; ix < length; ix++) {
+        if (memcmp(&a[ix], &b[ix], sizeof(float)) != 0) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+/**
+ * @brief Run one configuration through the three access patterns, print a row
+ */
+static bool check(int shift, float cof, bool rescale)
+{
+    signal_t signal;
+    signal.total_length = SIGNAL_LENGTH;
+    signal.get_data = &audio_get_data;
+
+    std::vector<float> expected(SIGNAL_LENGTH), actual(SIGNAL_LENGTH);
+    size_t mismatches = 0, samples = 0;
+
+    // blocks that follow each other
+    {
+        reference_preemphasis reference(&signal, shift, cof, rescale);
+        class processing::preemphasis pre(&signal, shift, cof, rescale);
+        std::uniform_int_distribution<size_t> block_length(1, 700);
+        for (size_t offset = 0; offset < SIGNAL_LENGTH; ) {
+            size_t length = std::min<size_t>(block_length(rng), SIGNAL_LENGTH - offset);
+            reference.get_data(offset, length, expected.data());
+            pre.get_data(offset, length, actual.data());
+            mismatches += count_mismatches(expected.data(), actual.data(), length);
+            samples += length;
+            offset += length;
+        }
+    }
+
+    // the frames of the frame loop
+    size_t frames = (SIGNAL_LENGTH - FRAME_LENGTH) / FRAME_STRIDE + 1;
+    auto frame_loop = [&](bool old, size_t *reads) {
+        signal_reads = 0;
+        size_t mismatch_count = 0;
+        std::vector<float> frame(FRAME_LENGTH);
+        reference_preemphasis reference(&signal, shift, cof, rescale);
+        class processing::preemphasis pre(&signal, shift, cof, rescale);
+        for (size_t ix = 0; ix < frames; ix++) {
+            if (old) {
+                reference.get_data(ix * FRAME_STRIDE, FRAME_LENGTH, frame.data());
+            }
+            else {
+                pre.get_data(ix * FRAME_STRIDE, FRAME_LENGTH, frame.data());
+                direct(ix * FRAME_STRIDE, FRAME_LENGTH, shift, cof, rescale, expected.data());
+                mismatch_count += count_mismatches(expected.data(), frame.data(), FRAME_LENGTH);
+            }
+        }
+        *reads = signal_reads;
+        return mismatch_count;
+    };
+    size_t old_reads, new_reads;
+    frame_loop(false, &new_reads);
+    mismatches += frame_loop(false, &new_reads);
+    samples += frames * FRAME_LENGTH;
+    frame_loop(true, &old_reads);
+
+    // random blocks
+    {
+        class processing::preemphasis pre(&signal, shift, cof, rescale);
+        std::uniform_int_distribution<size_t> block_offset(0, SIGNAL_LENGTH - 1);
+        std::uniform_int_distribution<size_t> block_length(1, 700);
+        for (size_t ix = 0; ix < BLOCKS; ix++) {
+            // a fifth of the blocks start in the first samples
+            size_t offset = ix % 5 == 0 ? ix % (shift + 1) : block_offset(rng);
+            size_t length = std::min<size_t>(block_length(rng), SIGNAL_LENGTH - offset);
+            direct(offset, length, shift, cof, rescale, expected.data());
+            pre.get_data(offset, length, actual.data());
+            mismatches += count_mismatches(expected.data(), actual.data(), length);
+            samples += length;
+        }
+    }
+
+    size_t reads;
+    double old_us = time_us([&]() { frame_loop(true, &reads); });
+    double new_us = time_us([&]() {
+        std::vector<float> frame(FRAME_LENGTH);
+        class processing::preemphasis pre(&signal, shift, cof, rescale);
+        for (size_t ix = 0; ix < frames; ix++) {
+            pre.get_data(ix * FRAME_STRIDE, FRAME_LENGTH, frame.data());
+        }
+    });
+
+    printf("shift %d cof %.2f %-7s %6zu %6zu %9.1f %9.1f %6.2fx  %zu/%zu\n",
+        shift, cof, rescale ? "rescale" : "", old_reads, new_reads, old_us, new_us, old_us / new_us,
+        mismatches, samples);
+    return mismatches == 0;
+}
+
+int main(void)
+{
+    std::uniform_real_distribution<float> sample(-32768.0f, 32767.0f);
+    audio.resize(SIGNAL_LENGTH);
+    for (float &value : audio) {
+        value = roundf(sample(rng));
+    }
+
+    printf("%d frames of %d samples, stride %d    reads             us\n",
+        (SIGNAL_LENGTH - FRAME_LENGTH) / FRAME_STRIDE + 1, FRAME_LENGTH, FRAME_STRIDE);
+    printf("%-24s %6s %6s %9s %9s %7s  %s\n", "", "old", "new", "old", "new", "", "mismatches");
+
+    bool ok = true;
+    for (int shift = 1; shift <= 4; shift++) {
+        ok &= check(shift, 0.98f, true);
+        ok &= check(shift, 0.97f, false);
+    }
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,285 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host check and benchmark of SignalWithAxes (classifier/ei_signal_with_axes.h),
+ * which gathers the axes a DSP block selects through ei::signal_gather
+ * (dsp/ei_signal_adaptor.h), against the get_data() it replaced (one call on
+ * the original signal per sample and axis):
+ *
+ *  - random frame sizes and axis selections (any order, repeated axes),
+ *    whole windows and random reads of whole frames, against the old get_data()
+ *  - reads that start or end within a frame, against the selected samples
+ *    directly: the old get_data() rounded them down to whole frames
+ *  - frame sizes larger than a page (one call per sample)
+ *
+ * With all axes selected out of order, SignalWithAxes gathers them (it passed
+ * the original signal through before, as when they are in order).
+ *
+ * and the calls on the original signal and time per window for a few sensor
+ * configurations. Fails if a sample differs.
+ *
+ * Usage:
+ *     bench_signal_axes
+ */
+
+#include "edge-impulse-sdk/classifier/ei_signal_with_axes.h"
+
+#include "bench_util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace ei;
+
+#define CONFIGURATIONS              300
+#define READS                       20
+
+static std::vector<float> samples;
+static size_t signal_calls = 0;
+
+static int samples_get_data(size_t offset, size_t length, float *out_ptr)
+{
+    signal_calls++;
+    if (offset + length > samples.size()) {
+        return -1;
+    }
+    memcpy(out_ptr, samples.data() + offset, length * sizeof(float));
+    return 0;
+}
+
+/**
+ * @brief SignalWithAxes::get_data() before, one call per sample and axis
+ */
+static int reference_get_data(signal_t *original_signal, const EI_CLASSIFIER_DSP_AXES_INDEX_TYPE *axes,
+    size_t axes_count, size_t raw_samples_per_frame, size_t offset, size_t length, float *out_ptr)
+{
+    size_t offset_on_original_signal = offset / axes_count * raw_samples_per_frame;
+    size_t length_on_original_signal = length / axes_count * raw_samples_per_frame;
+
+    size_t out_ptr_ix = 0;
+
+    for (size_t ix = offset_on_original_signal; ix < offset_on_original_signal + length_on_original_signal; ix += raw_samples_per_frame) {
+        for (size_t axis_ix = 0; axis_ix < axes_count; axis_ix++) {
+            int r = original_signal->get_data(ix + axes[axis_ix], 1, &out_ptr[out_ptr_ix++]);
+            if (r != 0) {
+                return r;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Samples [offset, offset + length) of the selected axes directly
+ */
+static void direct(const std::vector<EI_CLASSIFIER_DSP_AXES_INDEX_TYPE> &axes, size_t raw_samples_per_frame,
+    size_t offset, size_t length, float *out_ptr)
+{
+    for (size_t ix = 0; ix < length; ix++) {
+        size_t frame = (offset + ix) / axes.size();
+        size_t axis = (offset + ix) % axes.size();
+        out_ptr[ix] = samples[frame * raw_samples_per_frame + axes[axis]];
+    }
+}
+
+static void random_samples(size_t length)
+{
+    std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+    samples.resize(length);
+    for (float &sample : samples) {
+        sample = value(rng);
+    }
+}
+
+/**
+ * @brief One random frame size and axis selection, the number of samples that differ
+ */
+static size_t check(size_t raw_samples_per_frame, size_t *compared)
+{
+    std::uniform_int_distribution<size_t> frames_count(1, 300);
+    std::uniform_int_distribution<size_t> axis(0, raw_samples_per_frame - 1);
+    std::uniform_int_distribution<size_t> axes_count(1, raw_samples_per_frame);
+
+    size_t frames = frames_count(rng);
+    random_samples(frames * raw_samples_per_frame);
+    signal_t signal;
+    signal.total_length = samples.size();
+    signal.get_data = &samples_get_data;
+
+    // any order, and now and then an axis twice
+    std::vector<EI_CLASSIFIER_DSP_AXES_INDEX_TYPE> axes;
+    size_t selected = axes_count(rng);
+    for (size_t ix = 0; ix < raw_samples_per_frame; ix++) {
+        axes.push_back(ix);
+    }
+    std::shuffle(axes.begin(), axes.end(), rng);
+    axes.resize(selected);
+    if (rng() % 4 == 0) {
+        axes.push_back(axes[axis(rng) % selected]);
+    }
+
+    ei_impulse_t impulse;
+    memset(&impulse, 0, sizeof(impulse));
+    impulse.raw_samples_per_frame = raw_samples_per_frame;
+    SignalWithAxes swa(&signal, axes.data(), axes.size(), &impulse);
+    signal_t *wrapped = swa.get_signal();
+
+    size_t mismatches = 0;
+    std::vector<float> expected(wrapped->total_length), actual(wrapped->total_length);
+    auto compare = [&](size_t length) {
+        for (size_t ix = 0; ix < length; ix++) {
+            if (memcmp(&expected[ix], &actual[ix], sizeof(float)) != 0) {
+                mismatches++;
+            }
+        }
+        *compared += length;
+    };
+
+    // the whole window, as the DSP blocks read it
+    reference_get_data(&signal, axes.data(), axes.size(), raw_samples_per_frame, 0, wrapped->total_length,
+        expected.data());
+    if (wrapped->get_data(0, wrapped->total_length, actual.data()) != 0) {
+        return wrapped->total_length;
+    }
+    compare(wrapped->total_length);
+
+    std::uniform_int_distribution<size_t> frame(0, frames - 1);
+    for (size_t ix = 0; ix < READS; ix++) {
+        // whole frames
+        size_t first = frame(rng);
+        size_t count = std::uniform_int_distribution<size_t>(1, frames - first)(rng);
+        reference_get_data(&signal, axes.data(), axes.size(), raw_samples_per_frame, first * axes.size(),
+            count * axes.size(), expected.data());
+        if (wrapped->get_data(first * axes.size(), count * axes.size(), actual.data()) != 0) {
+            return wrapped->total_length;
+        }
+        compare(count * axes.size());
+
+        // any samples
+        size_t offset = std::uniform_int_distribution<size_t>(0, wrapped->total_length - 1)(rng);
+        size_t length = std::uniform_int_distribution<size_t>(1, wrapped->total_length - offset)(rng);
+        direct(axes, raw_samples_per_frame, offset, length, expected.data());
+        if (wrapped->get_data(offset, length, actual.data()) != 0) {
+            return wrapped->total_length;
+        }
+        compare(length);
+    }
+
+    // reading past the end fails
+    if (wrapped->get_data(wrapped->total_length - 1, 2, actual.data()) == 0) {
+        mismatches++;
+    }
+
+    return mismatches;
+}
+
+typedef struct {
+    const char *name;
+    size_t raw_samples_per_frame;
+    std::vector<EI_CLASSIFIER_DSP_AXES_INDEX_TYPE> axes;
+    size_t frames;
+} sensor_t;
+
+/**
+ * @brief Calls on the original signal and time to read one window, before and now
+ */
+static void bench(const sensor_t &sensor)
+{
+    random_samples(sensor.frames * sensor.raw_samples_per_frame);
+    signal_t signal;
+    signal.total_length = samples.size();
+    signal.get_data = &samples_get_data;
+
+    ei_impulse_t impulse;
+    memset(&impulse, 0, sizeof(impulse));
+    impulse.raw_samples_per_frame = sensor.raw_samples_per_frame;
+    SignalWithAxes swa(&signal, (EI_CLASSIFIER_DSP_AXES_INDEX_TYPE *)sensor.axes.data(), sensor.axes.size(), &impulse);
+    signal_t *wrapped = swa.get_signal();
+    std::vector<float> out(wrapped->total_length);
+
+    auto old_read = [&]() {
+        reference_get_data(&signal, sensor.axes.data(), sensor.axes.size(), sensor.raw_samples_per_frame, 0,
+            wrapped->total_length, out.data());
+    };
+    auto new_read = [&]() {
+        wrapped->get_data(0, wrapped->total_length, out.data());
+    };
+
+    signal_calls = 0;
+    old_read();
+    size_t old_calls = signal_calls;
+    signal_calls = 0;
+    new_read();
+    size_t new_calls = signal_calls;
+
+    double old_us = time_us(old_read);
+    double new_us = time_us(new_read);
+
+    printf("%-36s %6zu %6zu %6zu %9.2f %9.2f %7.2fx\n", sensor.name, wrapped->total_length, old_calls, new_calls,
+        old_us, new_us, old_us / new_us);
+}
+
+int main(void)
+{
+    const sensor_t sensors[] = {
+        { "accelerometer 3 axes, 2 selected", 3, { 0, 2 }, 125 },
+        { "accelerometer 3 axes, 2 s 100 Hz", 3, { 0, 1 }, 200 },
+        { "IMU 6 axes, 3 selected, 2 s 400 Hz", 6, { 3, 4, 5 }, 800 },
+        { "9 axes, 1 selected, 1 s 1 kHz", 9, { 8 }, 1000 },
+    };
+
+    printf("%-36s %6s %6s %6s %9s %9s\n", "", "", "calls", "", "us", "");
+    printf("%-36s %6s %6s %6s %9s %9s\n", "", "values", "old", "new", "old", "new");
+    for (const sensor_t &sensor : sensors) {
+        bench(sensor);
+    }
+
+    size_t mismatches = 0, compared = 0;
+    std::uniform_int_distribution<size_t> frame_size(1, 16);
+    for (size_t ix = 0; ix < CONFIGURATIONS; ix++) {
+        mismatches += check(frame_size(rng), &compared);
+    }
+    // frames larger than a page
+    mismatches += check(EIDSP_SIGNAL_PAGE_SIZE + 7, &compared);
+    mismatches += check(EIDSP_SIGNAL_PAGE_SIZE, &compared);
+
+    printf("%d random axis selections, mismatches %zu/%zu\n", CONFIGURATIONS + 2, mismatches, compared);
+    printf("%s\n", mismatches == 0 ? "OK" : "FAILED");
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host benchmark of the frame loop of the MFE, MFCC and spectrogram
+ * blocks (speechpy/frame_engine.hpp), on synthetic audio:
+ *
+ *  - the frame loop against the code it replaced (signal and power spectrum
+ *    matrices allocated per frame, numpy::power_spectrum() with its own FFT
+ *    buffers and FFT state, then numpy::sum() for the energy): ei_malloc and
+ *    ei_calloc calls and time per window, largest difference of the power
+ *    spectra and energies
+ *  - extract_mfcc_features(), extract_mfe_features() and
+ *    extract_spectrogram_features(): allocation calls of the first window,
+ *    after ei_dsp_free_audio_blocks(), and of the next windows, and the time
+ *    per window
+ *  - the DCT of MFCC through a workspace against numpy::dct2(), which
+ *    allocates its buffers and FFT state per frame
+ *
+ * Fails if a power spectrum or an energy differs by more than the float
+ * tolerance, or if a DCT output isn't bit-exact.
+ *
+ * Usage:
+ *     bench_speechpy_frames
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_dsp.h"
+
+/* Each implementation is repeated for about this long to time it */
+#define BENCH_TIME_US               100000.0
+
+#define BENCH_COUNT_ALLOCS
+#include "bench_util.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace ei;
+using namespace ei::speechpy;
+
+#define MAX_RELATIVE_DIFF           1e-5f
+
+static std::vector<float> audio;
+
+static int get_audio(size_t offset, size_t length, float *out_ptr)
+{
+    memcpy(out_ptr, audio.data() + offset, length * sizeof(float));
+    return 0;
+}
+
+/**
+ * @brief One second of two tones in noise, in the int16 range of the audio blocks
+ */
+static void make_audio(uint32_t sampling_frequency)
+{
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 300.0f);
+    audio.resize(sampling_frequency);
+    for (size_t ix = 0; ix < audio.size(); ix++) {
+        float t = (float)ix / sampling_frequency;
+        audio[ix] = 6000.0f * sinf(2 * M_PI * 440.0f * t) + 3000.0f * sinf(2 * M_PI * 2500.0f * t * (1 + t)) +
+            noise(rng);
+    }
+}
+
+typedef struct {
+    uint32_t sampling_frequency;
+    float frame_length;
+    float frame_stride;
+    uint16_t fft_length;
+} config_t;
+
+/**
+ * @brief The frame loop of mfe_v3() and spectrogram() before the frame engine
+ */
+static int reference_frames(stack_frames_info_t *info, uint16_t fft_length, matrix_t *spectra, float *energies)
+{
+    const size_t power_spectrum_frame_size = fft_length / 2 + 1;
+
+    for (size_t ix = 0; ix < info->frame_ixs.size(); ix++) {
+        EI_DSP_MATRIX(power_spectrum_frame, 1, power_spectrum_frame_size);
+        if (!power_spectrum_frame.buffer) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+
+        EI_DSP_MATRIX(signal_frame, 1, info->frame_length);
+
+        int ret = info->signal->get_data(info->frame_ixs.at(ix), info->frame_length, signal_frame.buffer);
+        if (ret != 0) {
+            EIDSP_ERR(ret);
+        }
+
+        ret = numpy::power_spectrum(signal_frame.buffer, info->frame_length, power_spectrum_frame.buffer,
+            power_spectrum_frame_size, fft_length);
+        if (ret != 0) {
+            EIDSP_ERR(ret);
+        }
+
+        energies[ix] = numpy::sum(power_spectrum_frame.buffer, power_spectrum_frame_size);
+        memcpy(spectra->get_row_ptr(ix), power_spectrum_frame.buffer, power_spectrum_frame_size * sizeof(float));
+    }
+
+    return EIDSP_OK;
+}
+
+/**
+ * @brief The same frames through the frame engine
+ */
+static int engine_frames(stack_frames_info_t *info, uint16_t fft_length, matrix_t *spectra, float *energies)
+{
+    frame_workspace_t *workspace;
+    int ret = frame_engine::acquire(&workspace, info->frame_length, fft_length);
+    if (ret != EIDSP_OK) {
+        EIDSP_ERR(ret);
+    }
+
+    for (size_t ix = 0; ix < info->frame_ixs.size(); ix++) {
+        ret = frame_engine::read_frame(workspace, info, ix);
+        if (ret == EIDSP_OK) {
+            ret = frame_engine::power_spectrum(workspace, spectra->get_row_ptr(ix), &energies[ix]);
+        }
+        if (ret != EIDSP_OK) {
+            break;
+        }
+    }
+
+    frame_engine::release(workspace);
+    return ret;
+}
+
+static float relative_diff(float reference, float value)
+{
+    return fabsf(value - reference) / std::max(fabsf(reference), 1e-30f);
+}
+
+static bool bench_frames(const config_t &c, uint16_t version)
+{
+    make_audio(c.sampling_frequency);
+    signal_t signal;
+    signal.total_length = audio.size();
+    signal.get_data = &get_audio;
+
+    stack_frames_info_t info;
+    info.signal = &signal;
+    if (processing::stack_frames(&info, c.sampling_frequency, c.frame_length, c.frame_stride, false, version) != 0) {
+        printf("stack_frames failed\n");
+        return false;
+    }
+    const size_t frames = info.frame_ixs.size();
+    const size_t bins = c.fft_length / 2 + 1;
+
+    matrix_t reference(frames, bins), spectra(frames, bins);
+    std::vector<float> reference_energies(frames), energies(frames);
+
+    // the first window of the engine builds the workspace
+    frame_engine::clear();
+    size_t engine_cold = count_allocs([&]() { engine_frames(&info, c.fft_length, &spectra, energies.data()); });
+    size_t reference_allocs = count_allocs([&]() {
+        reference_frames(&info, c.fft_length, &reference, reference_energies.data());
+    });
+    size_t engine_allocs = count_allocs([&]() { engine_frames(&info, c.fft_length, &spectra, energies.data()); });
+
+    float max_diff = 0.0f;
+    for (size_t f = 0; f < frames; f++) {
+        for (size_t ix = 0; ix < bins; ix++) {
+            max_diff = std::max(max_diff, relative_diff(reference.get_row_ptr(f)[ix], spectra.get_row_ptr(f)[ix]));
+        }
+        max_diff = std::max(max_diff, relative_diff(reference_energies[f], energies[f]));
+    }
+    bool ok = max_diff <= MAX_RELATIVE_DIFF;
+
+    double reference_us = time_us([&]() {
+        reference_frames(&info, c.fft_length, &reference, reference_energies.data());
+    });
+    double engine_us = time_us([&]() { engine_frames(&info, c.fft_length, &spectra, energies.data()); });
+
+    char name[64];
+    snprintf(name, sizeof(name), "%5u Hz %4d samples fft %4u", (unsigned)c.sampling_frequency, info.frame_length,
+        c.fft_length);
+    printf("%-34s %6zu %8zu %6zu %6zu %9.1f %9.1f %6.2fx  %.1e %s\n", name, frames, reference_allocs,
+        engine_cold, engine_allocs, reference_us, engine_us, reference_us / engine_us, max_diff, ok ? "" : "FAIL");
+
+    frame_engine::clear();
+    return ok;
+}
+
+static bool bench_dct(size_t filters)
+{
+    const size_t frames = 100;
+    std::mt19937 rng(filters);
+    std::normal_distribution<float> log_energy(10.0f, 4.0f);
+    matrix_t reference(frames, filters), rows(frames, filters);
+    for (size_t ix = 0; ix < frames * filters; ix++) {
+        reference.buffer[ix] = log_energy(rng);
+    }
+
+    auto reference_dct = [&]() {
+        memcpy(rows.buffer, reference.buffer, frames * filters * sizeof(float));
+        numpy::dct2(&rows, DCT_NORMALIZATION_ORTHO);
+    };
+    auto engine_dct = [&]() {
+        memcpy(rows.buffer, reference.buffer, frames * filters * sizeof(float));
+        frame_workspace_t *workspace;
+        if (frame_engine::acquire(&workspace, filters, filters) != EIDSP_OK) {
+            return;
+        }
+        for (size_t f = 0; f < frames; f++) {
+            frame_engine::dct2(workspace, rows.get_row_ptr(f), DCT_NORMALIZATION_ORTHO);
+        }
+        frame_engine::release(workspace);
+    };
+
+    frame_engine::clear();
+    size_t engine_cold = count_allocs(engine_dct);
+    size_t engine_allocs = count_allocs(engine_dct);
+    matrix_t features(frames, filters);
+    memcpy(features.buffer, rows.buffer, frames * filters * sizeof(float));
+    size_t reference_allocs = count_allocs(reference_dct);
+
+    size_t mismatches = 0;
+    for (size_t ix = 0; ix < frames * filters; ix++) {
+        if (memcmp(&rows.buffer[ix], &features.buffer[ix], sizeof(float)) != 0) {
+            mismatches++;
+        }
+    }
+
+    double reference_us = time_us(reference_dct);
+    double engine_us = time_us(engine_dct);
+
+    char name[64];
+    snprintf(name, sizeof(name), "%zu filters", filters);
+    printf("%-34s %6zu %8zu %6zu %6zu %9.1f %9.1f %6.2fx  %zu/%zu %s\n", name, frames, reference_allocs,
+        engine_cold, engine_allocs, reference_us, engine_us, reference_us / engine_us, mismatches,
+        frames * filters, mismatches == 0 ? "" : "FAIL");
+
+    frame_engine::clear();
+    return mismatches == 0;
+}
+
+/**
+ * @brief First window and next windows of an audio block
+ */
+static bool bench_block(const char *block, const config_t &c, int version, void *config,
+    int (*extract_fn)(signal_t *, matrix_t *, void *, const float))
+{
+    make_audio(c.sampling_frequency);
+    signal_t signal;
+    signal.total_length = audio.size();
+    signal.get_data = &get_audio;
+
+    // the spectrogram has the most features
+    matrix_size_t size = feature::calculate_mfe_buffer_size(audio.size(), c.sampling_frequency, c.frame_length,
+        c.frame_stride, c.fft_length / 2 + 1, version);
+    matrix_t features(1, size.rows * size.cols);
+    auto run = [&]() {
+        features.rows = 1;
+        features.cols = size.rows * size.cols;
+        return extract_fn(&signal, &features, config, c.sampling_frequency);
+    };
+
+    ei_dsp_free_audio_blocks();
+    int ret = EIDSP_OK;
+    size_t cold = count_allocs([&]() { ret = run(); });
+    size_t warm = count_allocs([&]() { ret |= run(); });
+    if (ret != EIDSP_OK) {
+        printf("%s v%d failed (%d)\n", block, version, ret);
+        return false;
+    }
+    double us = time_us(run);
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s v%d %5u Hz fft %4u", block, version, (unsigned)c.sampling_frequency,
+        c.fft_length);
+    printf("%-34s %8zu %8zu %9.1f\n", name, cold, warm, us);
+
+    ei_dsp_free_audio_blocks();
+    return true;
+}
+
+int main(void)
+{
+    const config_t configs[] = {
+        { 16000, 0.025f, 0.01f, 256 },
+        { 16000, 0.032f, 0.016f, 512 },
+        { 8000, 0.025f, 0.01f, 256 },
+        { 44100, 0.02f, 0.01f, 1024 },
+    };
+
+    printf("Frame loop, one second window, allocations and us per window\n");
+    printf("%-34s %6s %8s %6s %6s %9s %9s %7s  %s\n", "", "frames", "before", "first", "after",
+        "before", "after", "", "max diff");
+
+    bool ok = true;
+    for (const config_t &c : configs) {
+        ok &= bench_frames(c, 4);
+    }
+
+    printf("\nDCT of MFCC, allocations and us per window\n");
+    printf("%-34s %6s %8s %6s %6s %9s %9s %7s  %s\n", "", "frames", "before", "first", "after",
+        "before", "after", "", "not bit-exact");
+    const size_t dct_filters[] = { 20, 32, 40, 64 };
+    for (size_t filters : dct_filters) {
+        ok &= bench_dct(filters);
+    }
+
+    printf("\nDSP blocks, one second window\n");
+    printf("%-34s %8s %8s %9s\n", "", "allocs", "allocs", "");
+    printf("%-34s %8s %8s %9s\n", "", "first", "next", "us/window");
+
+    for (const config_t &c : configs) {
+        ei_dsp_config_mfcc_t mfcc_config;
+        memset(&mfcc_config, 0, sizeof(mfcc_config));
+        mfcc_config.implementation_version = 4;
+        mfcc_config.num_cepstral = 13;
+        mfcc_config.frame_length = c.frame_length;
+        mfcc_config.frame_stride = c.frame_stride;
+        mfcc_config.num_filters = 32;
+        mfcc_config.fft_length = c.fft_length;
+        mfcc_config.win_size = 101;
+        mfcc_config.pre_cof = 0.98f;
+        mfcc_config.pre_shift = 1;
+        mfcc_config.axes = 1;
+        ok &= bench_block("MFCC", c, 4, &mfcc_config, &extract_mfcc_features);
+
+        ei_dsp_config_mfe_t mfe_config;
+        memset(&mfe_config, 0, sizeof(mfe_config));
+        mfe_config.implementation_version = 4;
+        mfe_config.frame_length = c.frame_length;
+        mfe_config.frame_stride = c.frame_stride;
+        mfe_config.num_filters = 40;
+        mfe_config.fft_length = c.fft_length;
+        mfe_config.win_size = 101;
+        mfe_config.noise_floor_db = -52;
+        mfe_config.axes = 1;
+        ok &= bench_block("MFE", c, 4, &mfe_config, &extract_mfe_features);
+
+        ei_dsp_config_spectrogram_t spectrogram_config;
+        memset(&spectrogram_config, 0, sizeof(spectrogram_config));
+        spectrogram_config.implementation_version = 3;
+        spectrogram_config.frame_length = c.frame_length;
+        spectrogram_config.frame_stride = c.frame_stride;
+        spectrogram_config.fft_length = c.fft_length;
+        spectrogram_config.noise_floor_db = -52;
+        spectrogram_config.axes = 1;
+        ok &= bench_block("Spectrogram", c, 3, &spectrogram_config, &extract_spectrogram_features);
+    }
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
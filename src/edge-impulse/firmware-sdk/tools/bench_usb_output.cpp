@@ -0,0 +1,367 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host benchmark of the serial output of AT+READBUFFER and snapshots:
+ * the readback loop of read_encode_send_sample_buffer() with each of the
+ * output paths the Apollo4 firmware had, through ei_usb.c built against the
+ * stand-ins of tools/platform-stub:
+ *
+ *  - per character: base64_encode() into ei_putchar(), which was
+ *    ei_printf("%c") formatting into a 1 KB stack buffer and one USB
+ *    transaction per character
+ *  - staged: base64_encode_write() in blocks of 64 characters into
+ *    ei_usb_write() and the TX accumulator of the task
+ *  - in place: base64_encode_span() straight into the TX accumulator
+ *    (ei_usb_write_span() and ei_usb_commit()), as the firmware does now
+ *
+ * For a 1 s, 16 kHz int16 sample and a 160x160 RGB snapshot, it prints the
+ * bytes per second encoded and sent on the host and the number of USB
+ * transactions. Fails if an output is not the base64 of the data, or if
+ * base64_encode_span() is not, with spans of any size and an output that runs
+ * out of space (the rest then goes through base64_encode_write()). Also checks
+ * that tasks with the same name write into their own TX accumulator, and that
+ * more tasks than accumulators are all buffered when each flushes in turn.
+ *
+ * Usage:
+ *     bench_usb_output
+ */
+
+#include "FreeRTOS.h"
+#include "event_groups.h"
+#include "ns_usb.h"
+#include "platform_stub.h"
+#include "peripheral/usb/ei_usb.h"
+
+#include "firmware-sdk/at_base64_lib.h"
+
+#include "bench_util.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/* Readback chunks, multiples of 3 so the base64 of the chunks is one stream */
+#define PUTCHAR_CHUNK_SIZE          513
+#define USB_CHUNK_SIZE              (513 * 2)
+
+EventGroupHandle_t common_event_group;
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* USB output */
+static std::string sent;
+static size_t transactions;
+
+static std::vector<std::string> sent_transactions;
+
+static void usb_sink(const uint8_t *data, uint32_t length)
+{
+    sent.append((const char *)data, length);
+    sent_transactions.emplace_back((const char *)data, length);
+    transactions++;
+}
+
+/**
+ * @brief ei_printf of the Ambiq porting
+ */
+static void printf_send(const char *format, ...)
+{
+    char buffer[1024] = { 0 };
+    int length;
+    va_list args;
+
+    va_start(args, format);
+    length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length > 0) {
+        ns_usb_send_data(NULL, buffer, length);
+    }
+}
+
+/**
+ * @brief ei_putchar of the Ambiq porting before the TX accumulator
+ */
+static void printf_putchar(char c)
+{
+    printf_send("%c", c);
+}
+
+static void usb_write_chars(const char *buffer, size_t length)
+{
+    ei_usb_write((const uint8_t *)buffer, length);
+}
+
+static size_t usb_reserve_chars(char **span, size_t min_length)
+{
+    return ei_usb_write_span((uint8_t **)span, min_length);
+}
+
+static void usb_commit_chars(size_t length)
+{
+    ei_usb_commit(length);
+}
+
+typedef enum {
+    OUTPUT_PER_CHARACTER,
+    OUTPUT_STAGED,
+    OUTPUT_IN_PLACE
+} output_t;
+
+/**
+ * @brief The readback loop of read_encode_send_sample_buffer(), with the
+ * sample memory in RAM
+ */
+static void readback(const std::vector<uint8_t> &memory, output_t output)
+{
+    static uint8_t buffer[USB_CHUNK_SIZE];
+    size_t chunk_size = output == OUTPUT_PER_CHARACTER ? PUTCHAR_CHUNK_SIZE : USB_CHUNK_SIZE;
+    size_t address = 0;
+    size_t length = memory.size();
+
+    while (length > 0) {
+        size_t bytes_to_read = chunk_size < length ? chunk_size : length;
+
+        memcpy(buffer, &memory[address], bytes_to_read);
+
+        switch (output) {
+        case OUTPUT_PER_CHARACTER:
+            base64_encode((char *)buffer, bytes_to_read, printf_putchar);
+            break;
+        case OUTPUT_STAGED:
+            base64_encode_write((char *)buffer, bytes_to_read, usb_write_chars);
+            break;
+        case OUTPUT_IN_PLACE: {
+            size_t encoded = base64_encode_span((char *)buffer, bytes_to_read, usb_reserve_chars, usb_commit_chars);
+            if (encoded < bytes_to_read) {
+                base64_encode_write((char *)buffer + encoded, bytes_to_read - encoded, usb_write_chars);
+            }
+            break;
+        }
+        }
+
+        address += bytes_to_read;
+        length -= bytes_to_read;
+    }
+
+    ei_usb_flush();
+}
+
+static void bench_readback(const char *name, size_t size)
+{
+    static const char *output_names[] = { "per character", "staged", "in place" };
+
+    std::vector<uint8_t> memory(size);
+    for (uint8_t &b : memory) {
+        b = (uint8_t)rng();
+    }
+    char *expected = new char[(size + 2) / 3 * 4 + 1];
+    int expected_length = base64_encode_buffer((const char *)memory.data(), size, expected, (size + 2) / 3 * 4 + 1);
+
+    printf("%s, %zu bytes\n", name, size);
+    for (int output = OUTPUT_PER_CHARACTER; output <= OUTPUT_IN_PLACE; output++) {
+        sent.clear();
+        transactions = 0;
+        readback(memory, (output_t)output);
+
+        std::string what = std::string(name) + ", " + output_names[output] + ": base64 of the data";
+        check(expected_length > 0 && sent == std::string(expected, expected_length), what.c_str());
+        size_t readback_transactions = transactions;
+
+        double us = time_us([&]() {
+            sent.clear();
+            readback(memory, (output_t)output);
+        });
+        printf("  %-16s %8.1f MB/s %8zu USB transactions of %6.1f bytes\n", output_names[output],
+            size / us, readback_transactions, (double)sent.size() / readback_transactions);
+    }
+    delete[] expected;
+}
+
+/* Output of the span encoder check */
+static char span_output[16];
+static size_t span_size;
+static size_t spans_left;
+
+static size_t test_reserve_chars(char **span, size_t min_length)
+{
+    if (spans_left == 0) {
+        return 0;
+    }
+    spans_left--;
+    *span = span_output;
+    return span_size;
+}
+
+static void test_commit_chars(size_t length)
+{
+    sent.append(span_output, length);
+}
+
+static void test_write_chars(const char *buffer, size_t length)
+{
+    sent.append(buffer, length);
+}
+
+static void check_span_encoder(void)
+{
+    std::uniform_int_distribution<size_t> spans(0, 20);
+    char expected[200];
+    uint8_t input[100];
+    size_t runs = 0;
+
+    for (size_t length = 0; length < sizeof(input); length++) {
+        for (span_size = 0; span_size <= sizeof(span_output); span_size++) {
+            for (size_t i = 0; i < length; i++) {
+                input[i] = (uint8_t)rng();
+            }
+            sent.clear();
+            spans_left = spans(rng);
+
+            size_t encoded = base64_encode_span((const char *)input, length, test_reserve_chars, test_commit_chars);
+            bool stopped_on_a_group = encoded == length || encoded % 3 == 0;
+            if (encoded < length) {
+                base64_encode_write((const char *)input + encoded, length - encoded, test_write_chars);
+            }
+
+            int expected_length = base64_encode_buffer((const char *)input, length, expected, sizeof(expected));
+            check(stopped_on_a_group, "span encoder: stops after a whole group");
+            check(sent == std::string(expected, expected_length), "span encoder: base64 of the data");
+            runs++;
+        }
+    }
+    printf("span encoder: %zu inputs of 0 to %zu bytes, spans of 0 to %zu characters\n",
+        runs, sizeof(input) - 1, sizeof(span_output));
+}
+
+/* Writer tasks of the TX accumulator check */
+#define WRITER_HALF_DONE(task)      (1 << (2 * (task)))
+#define WRITER_DONE(task)           (1 << (2 * (task) + 1))
+#define WRITER_WRITES               10
+
+typedef struct {
+    const char *name;
+    int task;
+    int other;      // waits for it to be half done before the second half, -1 for none
+    char c;
+} writer_t;
+
+static EventGroupHandle_t writer_events;
+
+static void writer_task(void *parameters)
+{
+    const writer_t *writer = (const writer_t *)parameters;
+    uint8_t line[4];
+
+    memset(line, writer->c, sizeof(line));
+    for (int i = 0; i < WRITER_WRITES; i++) {
+        if (i == WRITER_WRITES / 2 && writer->other >= 0) {
+            xEventGroupSetBits(writer_events, WRITER_HALF_DONE(writer->task));
+            xEventGroupWaitBits(writer_events, WRITER_HALF_DONE(writer->other), pdFALSE, pdTRUE, portMAX_DELAY);
+        }
+        ei_usb_write(line, sizeof(line));
+    }
+    ei_usb_flush();
+    xEventGroupSetBits(writer_events, WRITER_DONE(writer->task));
+
+    while (1) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+
+static bool transactions_of_one_char(void)
+{
+    for (const std::string &transaction : sent_transactions) {
+        if (transaction.find_first_not_of(transaction[0]) != std::string::npos) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void check_tx_slots(void)
+{
+    static writer_t pair[2] = { { "writer", 0, 1, 'a' }, { "writer", 1, 0, 'b' } };
+    static writer_t one_after_the_other[5] = {
+        { "writer 2", 2, -1, 'c' }, { "writer 3", 3, -1, 'd' }, { "writer 4", 4, -1, 'e' },
+        { "writer 5", 5, -1, 'f' }, { "writer 6", 6, -1, 'g' } };
+
+    writer_events = xEventGroupCreate();
+
+    // same name, interleaved in the middle of their lines
+    sent.clear();
+    sent_transactions.clear();
+    for (writer_t &writer : pair) {
+        xTaskCreate(writer_task, writer.name, 1024, &writer, 1, NULL);
+    }
+    xEventGroupWaitBits(writer_events, WRITER_DONE(0) | WRITER_DONE(1), pdFALSE, pdTRUE, portMAX_DELAY);
+    check(sent_transactions.size() == 2 && transactions_of_one_char(),
+        "TX accumulators: tasks of the same name buffered apart");
+
+    // more tasks than accumulators, each released on its ei_usb_flush()
+    sent_transactions.clear();
+    for (writer_t &writer : one_after_the_other) {
+        xTaskCreate(writer_task, writer.name, 1024, &writer, 1, NULL);
+        xEventGroupWaitBits(writer_events, WRITER_DONE(writer.task), pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    check(sent_transactions.size() == 5 && transactions_of_one_char(),
+        "TX accumulators: released on ei_usb_flush()");
+
+    printf("TX accumulators: %zu writer tasks, 1 USB transaction each\n",
+        sizeof(pair) / sizeof(pair[0]) + sizeof(one_after_the_other) / sizeof(one_after_the_other[0]));
+}
+
+int main(void)
+{
+    platform_stub_usb_set_sink(usb_sink);
+
+    check_span_encoder();
+    check_tx_slots();
+
+    bench_readback("AT+READBUFFER of 1 s of 16 kHz audio", 16000 * sizeof(int16_t));
+    bench_readback("snapshot of 160x160 RGB", 160 * 160 * 3);
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
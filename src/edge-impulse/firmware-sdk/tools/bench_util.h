@@ -0,0 +1,111 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Shared by the host checks and benchmarks: timing, the random
+ * generator, and (with BENCH_COUNT_ALLOCS defined before the include) a count
+ * of the heap allocations of the SDK
+ */
+
+#ifndef EI_TOOLS_BENCH_UTIL_H
+#define EI_TOOLS_BENCH_UTIL_H
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+/* Each implementation is repeated for about this long to time it, define before the include to change it */
+#ifndef BENCH_TIME_US
+#define BENCH_TIME_US               50000.0
+#endif
+
+/* Same seed on every run, so a failure can be reproduced */
+__attribute__((unused)) static std::mt19937 rng(1234);
+
+/**
+ * @brief Average time of fn() in us
+ */
+template<typename fn_t>
+static double time_us(fn_t fn)
+{
+    size_t iterations = 0;
+    double elapsed_us = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (elapsed_us < BENCH_TIME_US) {
+        fn();
+        iterations++;
+        elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsed_us / iterations;
+}
+
+#ifdef BENCH_COUNT_ALLOCS
+
+static size_t alloc_calls = 0;
+static size_t alloc_bytes = 0;
+
+/* Count the allocations of the SDK, the posix porting defines these weak */
+void *ei_malloc(size_t size)
+{
+    alloc_calls++;
+    alloc_bytes += size;
+    return malloc(size);
+}
+
+void *ei_calloc(size_t nitems, size_t size)
+{
+    alloc_calls++;
+    alloc_bytes += nitems * size;
+    return calloc(nitems, size);
+}
+
+void ei_free(void *ptr)
+{
+    free(ptr);
+}
+
+/**
+ * @brief ei_malloc and ei_calloc calls of fn()
+ */
+template<typename fn_t>
+static size_t count_allocs(fn_t fn)
+{
+    size_t calls = alloc_calls;
+    fn();
+    return alloc_calls - calls;
+}
+
+#endif // BENCH_COUNT_ALLOCS
+
+#endif // EI_TOOLS_BENCH_UTIL_H
@@ -0,0 +1,222 @@
+"""Reference implementation of the binary framed transport (see ei_binary_frame.h).
+
+Usage:
+    python3 binary_frame.py loopback [path to libei_binary_frame.so]
+    python3 binary_frame.py static [path to sample file] [device port]
+    python3 binary_frame.py readbuffer [start] [length] [output file] [device port]
+    python3 binary_frame.py snapshot [width] [height] [output file] [device port]
+"""
+import binascii
+import ctypes
+import random
+import struct
+import sys
+import time
+
+SYNC = b"\xe1\x5a"
+HEADER_SIZE = 6
+CRC_SIZE = 4
+OVERHEAD = HEADER_SIZE + CRC_SIZE
+MAX_PAYLOAD = 1024
+
+FRAME_DATA = 0x01
+FRAME_END = 0x02
+
+
+class FrameError(Exception):
+    pass
+
+
+def encode_frame(frame_type, seq, payload=b""):
+    if len(payload) > MAX_PAYLOAD:
+        raise FrameError("payload too big")
+    body = struct.pack("<BBH", frame_type, seq & 0xFF, len(payload)) + payload
+    return SYNC + body + struct.pack("<I", binascii.crc32(body))
+
+
+def encode_transfer(data):
+    frames = []
+    seq = 0
+    for offset in range(0, len(data), MAX_PAYLOAD):
+        frames.append(encode_frame(FRAME_DATA, seq, data[offset:offset + MAX_PAYLOAD]))
+        seq += 1
+    frames.append(encode_frame(FRAME_END, seq, struct.pack("<I", len(data))))
+    return b"".join(frames)
+
+
+def decode_frame(buffer):
+    """Returns (type, seq, payload, frame size) or None if more bytes are needed."""
+    if len(buffer) < HEADER_SIZE:
+        return None
+    if buffer[0:2] != SYNC:
+        raise FrameError("SYNC")
+    frame_type, seq, length = struct.unpack("<BBH", buffer[2:HEADER_SIZE])
+    if frame_type not in (FRAME_DATA, FRAME_END):
+        raise FrameError("TYPE")
+    if length > MAX_PAYLOAD:
+        raise FrameError("LENGTH")
+    if len(buffer) < length + OVERHEAD:
+        return None
+    body = buffer[2:HEADER_SIZE + length]
+    (crc,) = struct.unpack("<I", buffer[HEADER_SIZE + length:HEADER_SIZE + length + CRC_SIZE])
+    if crc != binascii.crc32(body):
+        raise FrameError("CRC")
+    return frame_type, seq, buffer[HEADER_SIZE:HEADER_SIZE + length], length + OVERHEAD
+
+
+def decode_transfer(read_f):
+    """Reads frames with read_f(n) until the END frame, returns the data."""
+    data = b""
+    expected_seq = 0
+    while True:
+        buffer = read_f(HEADER_SIZE)
+        if len(buffer) < HEADER_SIZE:
+            raise FrameError("TIMEOUT")
+        length = struct.unpack("<H", buffer[4:6])[0]
+        buffer += read_f(min(length, MAX_PAYLOAD) + CRC_SIZE)
+        frame = decode_frame(buffer)
+        if frame is None:
+            raise FrameError("TIMEOUT")
+        frame_type, seq, payload, _ = frame
+        if seq != expected_seq:
+            raise FrameError("SEQUENCE")
+        expected_seq = (expected_seq + 1) & 0xFF
+        if frame_type == FRAME_END:
+            if struct.unpack("<I", payload)[0] != len(data):
+                raise FrameError("LENGTH")
+            return data
+        data += payload
+
+
+class FrameLib:
+    """The firmware codec (ei_binary_frame.cpp) built as a host shared library:
+    g++ -shared -fPIC -o libei_binary_frame.so ../ei_binary_frame.cpp
+    """
+
+    def __init__(self, path):
+        self.lib = ctypes.CDLL(path)
+        self.lib.ei_frame_crc32.restype = ctypes.c_uint32
+        self.lib.ei_frame_crc32.argtypes = [ctypes.c_uint32, ctypes.c_char_p, ctypes.c_size_t]
+        self.lib.ei_frame_encode.restype = ctypes.c_size_t
+        self.lib.ei_frame_encode.argtypes = [ctypes.c_uint8, ctypes.c_uint8, ctypes.c_char_p,
+                                             ctypes.c_uint16, ctypes.c_char_p, ctypes.c_size_t]
+        self.lib.ei_frame_decode.restype = ctypes.c_int
+        self.lib.ei_frame_decode.argtypes = [ctypes.c_char_p, ctypes.c_size_t,
+                                             ctypes.c_void_p, ctypes.c_void_p]
+
+    def crc32(self, data):
+        return self.lib.ei_frame_crc32(0, data, len(data))
+
+    def encode(self, frame_type, seq, payload):
+        out = ctypes.create_string_buffer(len(payload) + OVERHEAD)
+        size = self.lib.ei_frame_encode(frame_type, seq, payload, len(payload), out, len(out))
+        return out.raw[:size]
+
+    def decode(self, buffer):
+        header = (ctypes.c_uint8 * 4)()
+        payload = ctypes.c_void_p()
+        return self.lib.ei_frame_decode(buffer, len(buffer), ctypes.byref(header), ctypes.byref(payload))
+
+
+def loopback(lib_path=None):
+    rnd = random.Random(1)
+    lib = FrameLib(lib_path) if lib_path else None
+    frames = 0
+
+    for _ in range(200):
+        data = bytes(rnd.getrandbits(8) for _ in range(rnd.randint(0, 5000)))
+        stream = encode_transfer(data)
+        position = [0]
+
+        def read_f(n):
+            chunk = stream[position[0]:position[0] + n]
+            position[0] += n
+            return chunk
+
+        assert decode_transfer(read_f) == data
+        frames += (len(data) + MAX_PAYLOAD - 1) // MAX_PAYLOAD + 1
+
+        # any single flipped bit has to be detected
+        frame = encode_frame(FRAME_DATA, 7, data[:MAX_PAYLOAD])
+        bit = rnd.randrange(len(frame) * 8)
+        corrupted = bytearray(frame)
+        corrupted[bit // 8] ^= 1 << (bit % 8)
+        try:
+            assert decode_frame(bytes(corrupted)) is None
+        except FrameError:
+            pass
+
+        if lib is not None:
+            payload = data[:MAX_PAYLOAD]
+            assert lib.crc32(data) == binascii.crc32(data)
+            assert lib.encode(FRAME_DATA, 7, payload) == frame
+            assert lib.decode(frame) == len(frame)
+            assert lib.decode(bytes(corrupted)) < 0
+            assert lib.decode(frame[:-1]) == -1
+
+    print("Loopback OK, {} frames{}".format(frames, ", firmware codec matches" if lib else ""))
+
+
+def serial_port(port):
+    import serial
+    return serial.Serial(port, 115200, timeout=0.5)
+
+
+def await_response(response, ser):
+    data_in = b""
+    while response.encode() not in data_in:
+        data_in = ser.readline()
+        print(data_in)
+        if data_in == b"":
+            raise FrameError("TIMEOUT")
+    return data_in.decode()
+
+
+def command(ser, cmd):
+    ser.write("{}\r".format(cmd).encode())
+    ser.readline()  # echo
+
+
+def run_static(features_file, port):
+    with open(features_file, "r") as f:
+        features = [float(num) for num in f.read().split(",")]
+    ser = serial_port(port)
+    command(ser, "AT+BINARYFRAMES=y")
+    await_response("OK", ser)
+    command(ser, "AT+RUNIMPULSESTATIC=n,{}".format(len(features)))
+    await_response("OK CHUNK", ser)
+    start = time.time()
+    ser.write(encode_transfer(struct.pack("<" + "f" * len(features), *features)))
+    await_response("TRANSFER COMPLETED", ser)
+    print("Transfer took {:.3f} s".format(time.time() - start))
+    await_response("END OUTPUT", ser)
+    ser.close()
+
+
+def run_readback(cmd, output_file, port):
+    ser = serial_port(port)
+    command(ser, "AT+BINARYFRAMES=y")
+    await_response("OK", ser)
+    command(ser, cmd)
+    data = decode_transfer(ser.read)
+    with open(output_file, "wb") as f:
+        f.write(data)
+    print("Received {} bytes".format(len(data)))
+    ser.close()
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    if sys.argv[1] == "loopback":
+        loopback(sys.argv[2] if len(sys.argv) > 2 else None)
+    elif sys.argv[1] == "static":
+        run_static(sys.argv[2], sys.argv[3])
+    elif sys.argv[1] == "readbuffer":
+        run_readback("AT+READBUFFER={},{}".format(sys.argv[2], sys.argv[3]), sys.argv[4], sys.argv[5])
+    elif sys.argv[1] == "snapshot":
+        run_readback("AT+SNAPSHOT={},{}".format(sys.argv[2], sys.argv[3]), sys.argv[4], sys.argv[5])
+    else:
+        print(__doc__)
+        sys.exit(1)
@@ -0,0 +1,461 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host tool, runs the TFLite Micro allocator over the model and reports
+ * how the tensor arena is used: arena used by AllocateTensors(), persistent
+ * (tail) vs non-persistent (head) memory and the offset, size and lifetime of
+ * every buffer of the memory plan.
+ *
+ * Built from the same TFLite Micro and CMSIS-NN sources as the firmware
+ * (ARM_MATH_DSP), the planned tensors and scratch buffers are the ones of the
+ * device. The persistent allocations hold pointers, on a 64-bit host they're
+ * larger than on the device: the arena used reported here is an upper bound,
+ * AT+ARENA? gives the figure of the device.
+ *
+ * With --offline the model sources are written again with the memory plan in
+ * the model (OfflineMemoryAllocation metadata), TFLite Micro then places the
+ * tensors at these offsets instead of planning them at boot. The offline plan
+ * is the smallest of the greedy planner's placement orders.
+ *
+ * Usage:
+ *     gen_memory_plan [--offline <output dir>] <model sources...>
+ */
+
+#include "model_source.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_interpreter.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/recording_micro_interpreter.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#if defined(EI_TFLITE_GENERATED_RESOLVER) && EI_TFLITE_GENERATED_RESOLVER == 1
+#include "ei_tflite_op_resolver.h"
+#else
+#include "edge-impulse-sdk/tensorflow/lite/micro/all_ops_resolver.h"
+#define EI_TFLITE_RESOLVER static tflite::AllOpsResolver resolver;
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* Far larger than any arena of the firmware */
+#define HOST_ARENA_SIZE             (64 * 1024 * 1024)
+
+/* See AllocationInfoBuilder::GetOfflinePlannedOffsets() */
+#define OFFLINE_PLAN_METADATA       "OfflineMemoryAllocation"
+#define OFFLINE_PLAN_VERSION        1
+
+typedef struct {
+    int size;
+    int first_used;             // allocation step: 0 subgraph inputs, n the n-th operator
+    int last_used;
+    int offline_offset;
+    int offset;
+    int tensor;                 // subgraph 0 tensor, -1 for scratch buffers
+} planned_buffer_t;
+
+typedef struct {
+    size_t arena_used;          // arena_used_bytes() after AllocateTensors(), as the firmware
+    size_t persistent;          // tail
+    size_t non_persistent;      // head: memory plan and scratch buffer handles
+    size_t planned;             // high-water mark of the memory plan
+    tflite::RecordedAllocation allocations[7];
+    std::vector<planned_buffer_t> buffers;
+} memory_plan_t;
+
+/**
+ * @brief GreedyMemoryPlanner keeping a copy of the buffers with their offsets,
+ * the planner's own copy lives in the arena and is gone after AllocateTensors()
+ */
+class RecordingMemoryPlanner : public tflite::GreedyMemoryPlanner {
+public:
+    std::vector<planned_buffer_t> buffers;
+    size_t planned = 0;
+
+    TfLiteStatus Init(unsigned char *scratch_buffer, int scratch_buffer_size) override
+    {
+        buffers.clear();
+        planned = 0;
+        return GreedyMemoryPlanner::Init(scratch_buffer, scratch_buffer_size);
+    }
+
+    TfLiteStatus AddBuffer(int size, int first_time_used, int last_time_used) override
+    {
+        buffers.push_back({ size, first_time_used, last_time_used, tflite::kOnlinePlannedBuffer, -1, -1 });
+        return GreedyMemoryPlanner::AddBuffer(size, first_time_used, last_time_used);
+    }
+
+    TfLiteStatus AddBuffer(int size, int first_time_used, int last_time_used, int offline_offset) override
+    {
+        // the base class records it through the overload above
+        TfLiteStatus status = GreedyMemoryPlanner::AddBuffer(size, first_time_used, last_time_used, offline_offset);
+        if (status == kTfLiteOk) {
+            buffers.back().offline_offset = offline_offset;
+        }
+        return status;
+    }
+
+    TfLiteStatus GetOffsetForBuffer(int buffer_index, int *offset) override
+    {
+        TfLiteStatus status = GreedyMemoryPlanner::GetOffsetForBuffer(buffer_index, offset);
+        if (status == kTfLiteOk && buffer_index < (int)buffers.size()) {
+            buffers[buffer_index].offset = *offset;
+        }
+        return status;
+    }
+
+    size_t GetMaximumMemorySize() override
+    {
+        planned = GreedyMemoryPlanner::GetMaximumMemorySize();
+        return planned;
+    }
+};
+
+static const char *allocation_names[] = {
+    "TfLiteEvalTensor data",
+    "Persistent TfLiteTensor data",
+    "Persistent quantization data",
+    "Persistent buffer data",
+    "Variable tensor data",
+    "NodeAndRegistration array",
+    "Operator data",
+};
+
+static uint8_t *host_arena(void)
+{
+    static std::vector<uint8_t> arena(HOST_ARENA_SIZE + 16);
+    // the firmware arena is ALIGN(16), same offsets
+    return (uint8_t*)(((uintptr_t)arena.data() + 15) & ~(uintptr_t)15);
+}
+
+/**
+ * @brief Persistent allocations by type and head vs tail usage, from the
+ * RecordingMicroAllocator
+ */
+static bool record_allocations(const tflite::Model *model, memory_plan_t &plan)
+{
+    EI_TFLITE_RESOLVER
+    tflite::RecordingMicroInterpreter interpreter(model, resolver, host_arena(), HOST_ARENA_SIZE);
+
+    if (interpreter.AllocateTensors(true) != kTfLiteOk) {
+        return false;
+    }
+
+    const tflite::RecordingMicroAllocator &allocator = interpreter.GetMicroAllocator();
+    for (size_t i = 0; i < sizeof(allocation_names) / sizeof(allocation_names[0]); i++) {
+        plan.allocations[i] = allocator.GetRecordedAllocation((tflite::RecordedAllocationType)i);
+    }
+    plan.non_persistent = allocator.GetSimpleMemoryAllocator()->GetNonPersistentUsedBytes();
+
+    return true;
+}
+
+/**
+ * @brief Arena used with the interpreter set up as in tflite_micro.h, the
+ * recording allocator and the planner of plan_model() take more or less tail
+ */
+static bool measure_arena(const tflite::Model *model, memory_plan_t &plan)
+{
+    EI_TFLITE_RESOLVER
+    tflite::MicroInterpreter interpreter(model, resolver, host_arena(), HOST_ARENA_SIZE);
+
+    if (interpreter.AllocateTensors(true) != kTfLiteOk) {
+        return false;
+    }
+
+    plan.arena_used = interpreter.arena_used_bytes();
+    plan.persistent = plan.arena_used - plan.non_persistent;
+
+    return true;
+}
+
+/**
+ * @brief Set up the model as the firmware does and record its memory plan.
+ * With best_of the planner keeps the smallest of its placement orders, this
+ * takes longer than planning at boot but the offline plan is made only once.
+ */
+static bool plan_model(const tflite::Model *model, memory_plan_t &plan, bool best_of)
+{
+    EI_TFLITE_RESOLVER
+    RecordingMemoryPlanner planner;
+    planner.SetBestOfStrategies(best_of);
+    uint8_t *arena = host_arena();
+    tflite::MicroAllocator *allocator = tflite::MicroAllocator::Create(arena, HOST_ARENA_SIZE, &planner);
+    tflite::MicroInterpreter interpreter(model, resolver, allocator);
+
+    if (interpreter.AllocateTensors(true) != kTfLiteOk) {
+        return false;
+    }
+
+    plan.planned = planner.planned;
+    plan.buffers = planner.buffers;
+
+    // The planner gets the tensors to allocate in tensor order, then the
+    // scratch buffers: match them up with the tensors placed at the same
+    // offset. Reading a tensor allocates it in the tail, so do it last.
+    const tflite::SubGraph *subgraph = model->subgraphs()->Get(0);
+    size_t buffer = 0;
+    for (size_t i = 0; i < subgraph->tensors()->size() && buffer < plan.buffers.size(); i++) {
+        TfLiteTensor *tensor = interpreter.tensor(i);
+        if (tensor == nullptr || tensor->data.data == nullptr) {
+            continue;
+        }
+        if ((uint8_t*)tensor->data.data == arena + plan.buffers[buffer].offset &&
+            plan.buffers[buffer].size >= (int)tensor->bytes) {
+            plan.buffers[buffer].tensor = (int)i;
+            buffer++;
+        }
+    }
+
+    return true;
+}
+
+static void print_memory_plan(const tflite::Model *model, const memory_plan_t &plan)
+{
+    const tflite::SubGraph *subgraph = model->subgraphs()->Get(0);
+    size_t tensors = 0;
+
+    for (const planned_buffer_t &buffer : plan.buffers) {
+        tensors += buffer.tensor >= 0 ? 1 : 0;
+    }
+
+    printf("  Arena used:     %8zu bytes\n", plan.arena_used);
+    printf("  Non-persistent: %8zu bytes, plan of %zu bytes: %zu tensor(s), %zu scratch buffer(s)\n",
+        plan.non_persistent, plan.planned, tensors, plan.buffers.size() - tensors);
+    printf("  Persistent:     %8zu bytes (64-bit host, less on the device)\n", plan.persistent);
+    for (size_t i = 0; i < sizeof(allocation_names) / sizeof(allocation_names[0]); i++) {
+        printf("    %-30s %8zu bytes in %zu allocation(s)\n",
+            allocation_names[i], plan.allocations[i].used_bytes, plan.allocations[i].count);
+    }
+
+    printf("  Memory plan (lifetime: 0 subgraph inputs, n the n-th operator):\n");
+    printf("    %-8s %8s %8s %9s  %s\n", "tensor", "offset", "size", "lifetime", "name");
+    for (const planned_buffer_t &buffer : plan.buffers) {
+        char lifetime[24];
+        snprintf(lifetime, sizeof(lifetime), "%d-%d", buffer.first_used, buffer.last_used);
+
+        if (buffer.tensor >= 0) {
+            const tflite::Tensor *tensor = subgraph->tensors()->Get(buffer.tensor);
+            printf("    %-8d %8d %8d %9s  %s%s\n", buffer.tensor, buffer.offset, buffer.size, lifetime,
+                tensor->name() ? tensor->name()->c_str() : "",
+                buffer.offline_offset != tflite::kOnlinePlannedBuffer ? " (offline)" : "");
+        }
+        else {
+            // tensors of the other subgraphs aren't matched up
+            printf("    %-8s %8d %8d %9s  %s\n", model->subgraphs()->size() > 1 ? "-" : "scratch",
+                buffer.offset, buffer.size, lifetime, "-");
+        }
+    }
+}
+
+/**
+ * @brief Copy of the model with the tensor offsets of the plan in its
+ * OfflineMemoryAllocation metadata: version, subgraph, tensor count, then the
+ * offset of each tensor, -1 for the ones TFLite Micro doesn't plan
+ */
+static bool add_offline_plan(const std::vector<uint8_t> &in, const memory_plan_t &plan, std::vector<uint8_t> &out)
+{
+    std::unique_ptr<tflite::ModelT> model = tflite::UnPackModel(in.data());
+
+    // only one subgraph, the firmware's TFLite Micro applies the offsets to all of them
+    if (model->subgraphs.size() != 1) {
+        return false;
+    }
+
+    const size_t tensor_count = model->subgraphs[0]->tensors.size();
+    std::vector<int32_t> offsets(3 + tensor_count, tflite::kOnlinePlannedBuffer);
+    offsets[0] = OFFLINE_PLAN_VERSION;
+    offsets[1] = 0;
+    offsets[2] = (int32_t)tensor_count;
+    for (const planned_buffer_t &buffer : plan.buffers) {
+        if (buffer.tensor >= 0) {
+            offsets[3 + buffer.tensor] = buffer.offset;
+        }
+    }
+
+    std::unique_ptr<tflite::BufferT> data(new tflite::BufferT());
+    data->data.resize(offsets.size() * sizeof(int32_t));
+    memcpy(data->data.data(), offsets.data(), data->data.size());
+
+    // replace the plan of a model that already has one
+    tflite::MetadataT *metadata = nullptr;
+    for (std::unique_ptr<tflite::MetadataT> &m : model->metadata) {
+        if (m->name == OFFLINE_PLAN_METADATA) {
+            metadata = m.get();
+        }
+    }
+    if (metadata == nullptr) {
+        model->metadata.push_back(std::unique_ptr<tflite::MetadataT>(new tflite::MetadataT()));
+        metadata = model->metadata.back().get();
+        metadata->name = OFFLINE_PLAN_METADATA;
+        metadata->buffer = (uint32_t)model->buffers.size();
+        model->buffers.push_back(std::move(data));
+    }
+    else {
+        model->buffers[metadata->buffer] = std::move(data);
+    }
+
+    // this flatbuffers has no implicit default allocator
+    flatbuffers::DefaultAllocator allocator;
+    flatbuffers::FlatBufferBuilder builder(in.size() + 1024, &allocator);
+    tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, model.get()));
+    out.assign(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+
+    return true;
+}
+
+/**
+ * @brief The model source with the initializer of a model replaced, and its
+ * <name>_len definition if the source has one
+ */
+static std::string replace_model(const std::string &content, const model_source_t &model, const std::vector<uint8_t> &buffer)
+{
+    std::string initializer = "\n";
+    char hex[8];
+
+    for (size_t i = 0; i < buffer.size(); i++) {
+        snprintf(hex, sizeof(hex), "0x%02x,", buffer[i]);
+        initializer += (i % 16 == 0) ? "  " : " ";
+        initializer += hex;
+        if (i % 16 == 15 || i == buffer.size() - 1) {
+            initializer += "\n";
+        }
+    }
+
+    std::string out = content.substr(0, model.begin) + initializer + content.substr(model.end);
+
+    const std::string len_name = model.name + "_len";
+    size_t pos = model.name.empty() ? std::string::npos : out.find(len_name);
+    while (pos != std::string::npos) {
+        size_t value = out.find_first_not_of(" \t", pos + len_name.size());
+        if (value != std::string::npos && out[value] == '=') {
+            value = out.find_first_not_of(" \t", value + 1);
+            size_t value_end = out.find_first_not_of("0123456789", value);
+            if (value_end > value) {
+                out.replace(value, value_end - value, std::to_string(buffer.size()));
+            }
+            break;
+        }
+        pos = out.find(len_name, pos + len_name.size());
+    }
+
+    return out;
+}
+
+static std::string base_name(const std::string &path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+int main(int argc, char **argv)
+{
+    std::string offline_dir;
+    int first_source = 1;
+
+    if (argc > 2 && strcmp(argv[1], "--offline") == 0) {
+        offline_dir = argv[2];
+        first_source = 3;
+    }
+    if (argc <= first_source) {
+        fprintf(stderr, "Usage: %s [--offline <output dir>] <model sources or .tflite files...>\n", argv[0]);
+        return 1;
+    }
+
+    size_t largest_arena = 0;
+
+    for (int i = first_source; i < argc; i++) {
+        std::string content;
+        std::vector<model_source_t> models;
+        if (!read_models(argv[i], models, content)) {
+            fprintf(stderr, "gen_memory_plan: failed to read %s\n", argv[i]);
+            return 1;
+        }
+
+        std::vector<std::vector<uint8_t>> offline_models(models.size());
+
+        for (size_t m = 0; m < models.size(); m++) {
+            const tflite::Model *model = tflite::GetModel(models[m].buffer.data());
+            memory_plan_t plan;
+
+            printf("%s: %s, %u subgraph(s), %u operator(s), %u tensor(s)\n",
+                base_name(argv[i]).c_str(), models[m].name.empty() ? "model" : models[m].name.c_str(),
+                model->subgraphs()->size(), model->subgraphs()->Get(0)->operators()->size(),
+                model->subgraphs()->Get(0)->tensors()->size());
+
+            if (!record_allocations(model, plan) || !measure_arena(model, plan) || !plan_model(model, plan, !offline_dir.empty())) {
+                fprintf(stderr, "gen_memory_plan: AllocateTensors() failed for %s\n", argv[i]);
+                return 1;
+            }
+            print_memory_plan(model, plan);
+            largest_arena = std::max(largest_arena, plan.arena_used);
+
+            if (!offline_dir.empty() && !add_offline_plan(models[m].buffer, plan, offline_models[m])) {
+                fprintf(stderr, "gen_memory_plan: %s has more than one subgraph, no offline plan\n", argv[i]);
+            }
+        }
+
+        if (offline_dir.empty()) {
+            continue;
+        }
+
+        // back to front, the positions of the other models stay valid
+        for (size_t m = models.size(); m-- > 0; ) {
+            if (offline_models[m].empty()) {
+                continue;
+            }
+            if (ends_with(argv[i], ".tflite")) {
+                content.assign(offline_models[m].begin(), offline_models[m].end());
+            }
+            else {
+                content = replace_model(content, models[m], offline_models[m]);
+            }
+        }
+
+        // sources without a model (e.g. EON compiled) are copied as they are
+        std::string path = offline_dir + "/" + base_name(argv[i]);
+        FILE *f = fopen(path.c_str(), "wb");
+        if (f == NULL || fwrite(content.data(), 1, content.size(), f) != content.size()) {
+            fprintf(stderr, "gen_memory_plan: failed to write %s\n", path.c_str());
+            return 1;
+        }
+        fclose(f);
+    }
+
+    // the firmware arena is aligned on 16 bytes
+    printf("Largest arena used: %zu bytes, the static arena can be sized with EI_TENSOR_ARENA_SIZE=%zu\n",
+        largest_arena, (largest_arena + 15) & ~(size_t)15);
+
+    return 0;
+}
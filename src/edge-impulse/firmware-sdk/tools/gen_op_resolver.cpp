@@ -0,0 +1,344 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host tool, generates a TFLite Micro op resolver holding only the ops
+ * used by the model, the list of kernel sources the firmware doesn't need and
+ * the number of layers (sizes the per layer profiler).
+ *
+ * The model flatbuffers are taken from the C arrays in the exported model
+ * sources (.cpp files in model/tflite-model), or from .tflite files.
+ *
+ * Usage:
+ *     gen_op_resolver <output dir> <model sources...>
+ *
+ * Writes <output dir>/ei_tflite_op_resolver.h and <output dir>/op_kernels.mk
+ */
+
+#include "model_source.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+typedef struct {
+    tflite::BuiltinOperator op;
+    const char *custom_name;    // only for BuiltinOperator_CUSTOM
+    const char *add_function;   // MicroMutableOpResolver method
+    const char *kernel;         // source in tensorflow/lite/micro/kernels
+    bool dynamic_memory;        // not available with TF_LITE_STATIC_MEMORY
+} op_kernel_t;
+
+#define BUILTIN(op, add, kernel) { tflite::BuiltinOperator_##op, nullptr, add, kernel, false }
+#define BUILTIN_DYNAMIC(op, add, kernel) { tflite::BuiltinOperator_##op, nullptr, add, kernel, true }
+#define CUSTOM(name, add, kernel) { tflite::BuiltinOperator_CUSTOM, name, add, kernel, false }
+
+/* Every op of AllOpsResolver, with the kernel source it's registered in */
+static const op_kernel_t op_kernels[] = {
+    BUILTIN(ABS, "AddAbs", "elementwise.cc"),
+    BUILTIN(ADD, "AddAdd", "add.cc"),
+    BUILTIN(ADD_N, "AddAddN", "add_n.cc"),
+    BUILTIN(ARG_MAX, "AddArgMax", "arg_min_max.cc"),
+    BUILTIN(ARG_MIN, "AddArgMin", "arg_min_max.cc"),
+    BUILTIN(ASSIGN_VARIABLE, "AddAssignVariable", "assign_variable.cc"),
+    BUILTIN(AVERAGE_POOL_2D, "AddAveragePool2D", "pooling.cc"),
+    BUILTIN(BATCH_MATMUL, "AddBatchMatMul", "batch_matmul.cc"),
+    BUILTIN(BATCH_TO_SPACE_ND, "AddBatchToSpaceNd", "batch_to_space_nd.cc"),
+    BUILTIN(BROADCAST_ARGS, "AddBroadcastArgs", "broadcast_args.cc"),
+    BUILTIN(BROADCAST_TO, "AddBroadcastTo", "broadcast_to.cc"),
+    BUILTIN(CALL_ONCE, "AddCallOnce", "call_once.cc"),
+    BUILTIN(CAST, "AddCast", "cast.cc"),
+    BUILTIN(CEIL, "AddCeil", "ceil.cc"),
+    BUILTIN(COMPLEX_ABS, "AddComplexAbs", "complex_abs.cc"),
+    BUILTIN(CONCATENATION, "AddConcatenation", "concatenation.cc"),
+    BUILTIN(CONV_2D, "AddConv2D", "conv.cc"),
+    BUILTIN(COS, "AddCos", "elementwise.cc"),
+    BUILTIN(CUMSUM, "AddCumSum", "cumsum.cc"),
+    BUILTIN(DEPTH_TO_SPACE, "AddDepthToSpace", "depth_to_space.cc"),
+    BUILTIN(DEPTHWISE_CONV_2D, "AddDepthwiseConv2D", "depthwise_conv.cc"),
+    BUILTIN(DEQUANTIZE, "AddDequantize", "dequantize.cc"),
+    BUILTIN(DIV, "AddDiv", "div.cc"),
+    BUILTIN(ELU, "AddElu", "elu.cc"),
+    BUILTIN(EQUAL, "AddEqual", "comparisons.cc"),
+    BUILTIN(EXP, "AddExp", "exp.cc"),
+    BUILTIN(EXPAND_DIMS, "AddExpandDims", "expand_dims.cc"),
+    BUILTIN(FILL, "AddFill", "fill.cc"),
+    BUILTIN(FLOOR, "AddFloor", "floor.cc"),
+    BUILTIN(FLOOR_DIV, "AddFloorDiv", "floor_div.cc"),
+    BUILTIN(FLOOR_MOD, "AddFloorMod", "floor_mod.cc"),
+    BUILTIN(FULLY_CONNECTED, "AddFullyConnected", "fully_connected.cc"),
+    BUILTIN_DYNAMIC(GATHER, "AddGather", "gather.cc"),
+    BUILTIN(GATHER_ND, "AddGatherNd", "gather_nd.cc"),
+    BUILTIN(GREATER, "AddGreater", "comparisons.cc"),
+    BUILTIN(GREATER_EQUAL, "AddGreaterEqual", "comparisons.cc"),
+    BUILTIN(HARD_SWISH, "AddHardSwish", "hard_swish.cc"),
+    BUILTIN(IMAG, "AddImag", "real.cc"),
+    BUILTIN(IF, "AddIf", "if.cc"),
+    BUILTIN(L2_NORMALIZATION, "AddL2Normalization", "l2norm.cc"),
+    BUILTIN(L2_POOL_2D, "AddL2Pool2D", "l2_pool_2d.cc"),
+    BUILTIN(LEAKY_RELU, "AddLeakyRelu", "leaky_relu.cc"),
+    BUILTIN(LESS, "AddLess", "comparisons.cc"),
+    BUILTIN(LESS_EQUAL, "AddLessEqual", "comparisons.cc"),
+    BUILTIN(LOG, "AddLog", "elementwise.cc"),
+    BUILTIN(LOGICAL_AND, "AddLogicalAnd", "logical.cc"),
+    BUILTIN(LOGICAL_NOT, "AddLogicalNot", "elementwise.cc"),
+    BUILTIN(LOGICAL_OR, "AddLogicalOr", "logical.cc"),
+    BUILTIN(LOGISTIC, "AddLogistic", "logistic.cc"),
+    BUILTIN(LOG_SOFTMAX, "AddLogSoftmax", "log_softmax.cc"),
+    BUILTIN(MAX_POOL_2D, "AddMaxPool2D", "pooling.cc"),
+    BUILTIN(MAXIMUM, "AddMaximum", "maximum_minimum.cc"),
+    BUILTIN(MEAN, "AddMean", "reduce.cc"),
+    BUILTIN(MINIMUM, "AddMinimum", "maximum_minimum.cc"),
+    BUILTIN(MIRROR_PAD, "AddMirrorPad", "mirror_pad.cc"),
+    BUILTIN(MUL, "AddMul", "mul.cc"),
+    BUILTIN(NEG, "AddNeg", "neg.cc"),
+    BUILTIN(NOT_EQUAL, "AddNotEqual", "comparisons.cc"),
+    BUILTIN(PACK, "AddPack", "pack.cc"),
+    BUILTIN(PAD, "AddPad", "pad.cc"),
+    BUILTIN(PADV2, "AddPadV2", "pad.cc"),
+    BUILTIN(PRELU, "AddPrelu", "prelu.cc"),
+    BUILTIN(QUANTIZE, "AddQuantize", "quantize.cc"),
+    BUILTIN(REAL, "AddReal", "real.cc"),
+    BUILTIN(READ_VARIABLE, "AddReadVariable", "read_variable.cc"),
+    BUILTIN(REDUCE_ANY, "AddReduceAny", "reduce.cc"),
+    BUILTIN(REDUCE_ALL, "AddReduceAll", "reduce.cc"),
+    BUILTIN(REDUCE_MAX, "AddReduceMax", "reduce.cc"),
+    BUILTIN(REDUCE_MIN, "AddReduceMin", "reduce.cc"),
+    BUILTIN(RELU, "AddRelu", "activations.cc"),
+    BUILTIN(RELU6, "AddRelu6", "activations.cc"),
+    BUILTIN(RESHAPE, "AddReshape", "reshape.cc"),
+    BUILTIN(RESIZE_BILINEAR, "AddResizeBilinear", "resize_bilinear.cc"),
+    BUILTIN(RESIZE_NEAREST_NEIGHBOR, "AddResizeNearestNeighbor", "resize_nearest_neighbor.cc"),
+    BUILTIN(RFFT2D, "AddRfft2D", "rfft2d.cc"),
+    BUILTIN(ROUND, "AddRound", "round.cc"),
+    BUILTIN(RSQRT, "AddRsqrt", "elementwise.cc"),
+    BUILTIN(SCATTER_ND, "AddScatterNd", "scatter_nd.cc"),
+    BUILTIN_DYNAMIC(SELECT, "AddSelect", "select.cc"),
+    BUILTIN_DYNAMIC(SELECT_V2, "AddSelectV2", "select.cc"),
+    BUILTIN(SHAPE, "AddShape", "shape.cc"),
+    BUILTIN(SIN, "AddSin", "elementwise.cc"),
+    BUILTIN(SLICE, "AddSlice", "slice.cc"),
+    BUILTIN(SOFTMAX, "AddSoftmax", "softmax.cc"),
+    BUILTIN(SPACE_TO_BATCH_ND, "AddSpaceToBatchNd", "space_to_batch_nd.cc"),
+    BUILTIN(SPACE_TO_DEPTH, "AddSpaceToDepth", "space_to_depth.cc"),
+    BUILTIN(SPLIT, "AddSplit", "split.cc"),
+    BUILTIN(SPLIT_V, "AddSplitV", "split_v.cc"),
+    BUILTIN(SQRT, "AddSqrt", "elementwise.cc"),
+    BUILTIN(SQUARE, "AddSquare", "elementwise.cc"),
+    BUILTIN(SQUARED_DIFFERENCE, "AddSquaredDifference", "squared_difference.cc"),
+    BUILTIN(SQUEEZE, "AddSqueeze", "squeeze.cc"),
+    BUILTIN(STRIDED_SLICE, "AddStridedSlice", "strided_slice.cc"),
+    BUILTIN(SUB, "AddSub", "sub.cc"),
+    BUILTIN(SUM, "AddSum", "reduce.cc"),
+    BUILTIN(SVDF, "AddSvdf", "svdf.cc"),
+    BUILTIN(TANH, "AddTanh", "tanh.cc"),
+    BUILTIN(TILE, "AddTile", "tile.cc"),
+    BUILTIN(TOPK_V2, "AddTopkV2", "topk_v2.cc"),
+    BUILTIN(TRANSPOSE, "AddTranspose", "transpose.cc"),
+    BUILTIN(TRANSPOSE_CONV, "AddTransposeConv", "transpose_conv.cc"),
+    BUILTIN(UNIDIRECTIONAL_SEQUENCE_LSTM, "AddUnidirectionalSequenceLstm", "unidirectional_sequence_lstm.cc"),
+    BUILTIN(UNPACK, "AddUnpack", "unpack.cc"),
+    BUILTIN(VAR_HANDLE, "AddVarHandle", "var_handle.cc"),
+    BUILTIN(WHILE, "AddWhile", "while.cc"),
+    BUILTIN(ZEROS_LIKE, "AddZerosLike", "zeros_like.cc"),
+    CUSTOM("CIRCULAR_BUFFER", "AddCircularBuffer", "circular_buffer.cc"),
+    CUSTOM("TFLite_Detection_PostProcess", "AddDetectionPostprocess", "detection_postprocess.cc"),
+    CUSTOM("ethos-u", "AddEthosU", "ethosu.cc"),
+    CUSTOM("TreeEnsembleClassifier", "AddTreeEnsembleClassifier", "tree_ensemble_classifier.cc"),
+};
+
+static const size_t op_kernels_count = sizeof(op_kernels) / sizeof(op_kernels[0]);
+
+static const op_kernel_t* find_op_kernel(const tflite::OperatorCode *op_code)
+{
+    // same as tflite::GetBuiltinCode(), older models only have the deprecated code
+    tflite::BuiltinOperator op = std::max(op_code->builtin_code(),
+        static_cast<tflite::BuiltinOperator>(op_code->deprecated_builtin_code()));
+
+    for (size_t i = 0; i < op_kernels_count; i++) {
+        if (op_kernels[i].op != op) {
+            continue;
+        }
+        if (op != tflite::BuiltinOperator_CUSTOM) {
+            return &op_kernels[i];
+        }
+        if (op_code->custom_code() && op_code->custom_code()->str() == op_kernels[i].custom_name) {
+            return &op_kernels[i];
+        }
+    }
+
+    return nullptr;
+}
+
+static void write_resolver_header(FILE *f, const std::vector<const op_kernel_t*> &ops)
+{
+    fprintf(f, "/* Generated by gen_op_resolver from the model in model/tflite-model, do not edit */\n\n");
+    fprintf(f, "#ifndef _EI_TFLITE_OP_RESOLVER_H_\n");
+    fprintf(f, "#define _EI_TFLITE_OP_RESOLVER_H_\n\n");
+    fprintf(f, "#include \"edge-impulse-sdk/tensorflow/lite/micro/micro_mutable_op_resolver.h\"\n\n");
+    fprintf(f, "#define EI_TFLITE_OP_RESOLVER_OPS %zu\n\n", ops.size());
+    fprintf(f, "static tflite::MicroMutableOpResolver<EI_TFLITE_OP_RESOLVER_OPS>& ei_tflite_op_resolver(void)\n{\n");
+    fprintf(f, "    static tflite::MicroMutableOpResolver<EI_TFLITE_OP_RESOLVER_OPS> resolver;\n");
+    fprintf(f, "    static bool resolver_ready = false;\n\n");
+    fprintf(f, "    if (!resolver_ready) {\n");
+    for (const op_kernel_t *op : ops) {
+        if (op->dynamic_memory) {
+            fprintf(f, "#ifndef TF_LITE_STATIC_MEMORY\n");
+        }
+        fprintf(f, "        resolver.%s();\n", op->add_function);
+        if (op->dynamic_memory) {
+            fprintf(f, "#endif\n");
+        }
+    }
+    fprintf(f, "        resolver_ready = true;\n");
+    fprintf(f, "    }\n\n");
+    fprintf(f, "    return resolver;\n}\n\n");
+    fprintf(f, "#define EI_TFLITE_RESOLVER tflite::MicroMutableOpResolver<EI_TFLITE_OP_RESOLVER_OPS>& resolver = ei_tflite_op_resolver();\n\n");
+    fprintf(f, "#endif // _EI_TFLITE_OP_RESOLVER_H_\n");
+}
+
+static void write_kernels_makefile(FILE *f, const std::vector<const op_kernel_t*> &ops, size_t operators)
+{
+    std::set<std::string> used, unused;
+
+    for (const op_kernel_t *op : ops) {
+        used.insert(op->kernel);
+    }
+    for (size_t i = 0; i < op_kernels_count; i++) {
+        if (used.count(op_kernels[i].kernel) == 0) {
+            unused.insert(op_kernels[i].kernel);
+        }
+    }
+
+    fprintf(f, "# Generated by gen_op_resolver from the model in model/tflite-model, do not edit\n");
+    fprintf(f, "ei_op_resolver_found := %d\n", ops.empty() ? 0 : 1);
+    fprintf(f, "ei_op_model_operators := %zu\n", operators);
+    fprintf(f, "ei_op_kernels :=");
+    for (const std::string &kernel : used) {
+        fprintf(f, " %s", kernel.c_str());
+    }
+    fprintf(f, "\nei_op_kernels_unused :=");
+    for (const std::string &kernel : unused) {
+        fprintf(f, " %s", kernel.c_str());
+    }
+    fprintf(f, "\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <output dir> <model sources or .tflite files...>\n", argv[0]);
+        return 1;
+    }
+
+    const std::string out_dir = argv[1];
+    std::vector<model_source_t> models;
+
+    for (int i = 2; i < argc; i++) {
+        std::string content;
+        if (!read_models(argv[i], models, content)) {
+            fprintf(stderr, "gen_op_resolver: failed to read %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<const op_kernel_t*> ops;
+    size_t max_operators = 0;
+
+    for (const model_source_t &model_source : models) {
+        const tflite::Model *model = tflite::GetModel(model_source.buffer.data());
+        if (!model->operator_codes()) {
+            continue;
+        }
+
+        // operators (layers) of all subgraphs, sizes the per layer profiler
+        size_t operators = 0;
+        if (model->subgraphs()) {
+            for (const tflite::SubGraph *subgraph : *model->subgraphs()) {
+                operators += subgraph->operators() ? subgraph->operators()->size() : 0;
+            }
+        }
+        max_operators = std::max(max_operators, operators);
+
+        for (const tflite::OperatorCode *op_code : *model->operator_codes()) {
+            const op_kernel_t *op = find_op_kernel(op_code);
+            if (op == nullptr) {
+                tflite::BuiltinOperator code = std::max(op_code->builtin_code(),
+                    static_cast<tflite::BuiltinOperator>(op_code->deprecated_builtin_code()));
+                fprintf(stderr, "gen_op_resolver: op %s%s%s is not supported by TFLite Micro\n",
+                    tflite::EnumNameBuiltinOperator(code),
+                    op_code->custom_code() ? " " : "",
+                    op_code->custom_code() ? op_code->custom_code()->c_str() : "");
+                return 1;
+            }
+            if (std::find(ops.begin(), ops.end(), op) == ops.end()) {
+                ops.push_back(op);
+            }
+        }
+    }
+
+    // no flatbuffer (e.g. EON compiled model), the firmware keeps the AllOpsResolver
+    if (ops.empty()) {
+        fprintf(stderr, "gen_op_resolver: no TFLite model found, keeping all kernels\n");
+    }
+    else {
+        printf("gen_op_resolver: %zu model(s), %zu layer(s), %zu op(s):", models.size(), max_operators, ops.size());
+        for (const op_kernel_t *op : ops) {
+            printf(" %s", op->add_function + 3);
+        }
+        printf("\n");
+    }
+
+    std::string header_path = out_dir + "/ei_tflite_op_resolver.h";
+    std::string makefile_path = out_dir + "/op_kernels.mk";
+
+    FILE *header = fopen(header_path.c_str(), "w");
+    FILE *makefile = fopen(makefile_path.c_str(), "w");
+    if (header == NULL || makefile == NULL) {
+        fprintf(stderr, "gen_op_resolver: failed to write to %s\n", out_dir.c_str());
+        return 1;
+    }
+
+    if (!ops.empty()) {
+        write_resolver_header(header, ops);
+    }
+    write_kernels_makefile(makefile, ops, max_operators);
+
+    fclose(header);
+    fclose(makefile);
+
+    return 0;
+}
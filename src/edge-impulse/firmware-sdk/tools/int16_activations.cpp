@@ -0,0 +1,509 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @brief Host check of models with int16 activations and int8 weights (16x8
+ * quantization, EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS): one small audio model
+ * (MFE, a fully connected layer with a ReLU, a fully connected layer and
+ * softmax) built in memory in float32, int8 and 16x8, run as impulses on
+ * synthetic audio.
+ *
+ *  - the 16x8 scores are within INT16_TOLERANCE of the float scores, and closer
+ *    to them than the int8 scores
+ *  - the 16x8 model quantizing the MFE features straight into the input tensor
+ *    gives the same scores as quantizing the float feature matrix
+ *
+ * Prints the largest and mean error of the int8 and 16x8 scores against float,
+ * returns 1 on a failed check.
+ *
+ * Usage:
+ *     int16_activations
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "edge-impulse-sdk/tensorflow/lite/schema/schema_generated_full.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#if EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS != 1
+#error "Build with EI_CLASSIFIER_TFLITE_INT16_ACTIVATIONS=1"
+#endif
+
+#define SAMPLE_RATE                 16000
+#define SAMPLE_COUNT                16000
+#define MFE_FILTERS                 40
+#define MFE_FEATURES                (99 * MFE_FILTERS)
+#define HIDDEN                      32
+#if EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 1 && EI_CLASSIFIER_LABEL_COUNT < 4
+// the results hold the labels of the impulse of the firmware
+#define LABELS                      EI_CLASSIFIER_LABEL_COUNT
+#else
+#define LABELS                      4
+#endif
+#define WINDOWS                     32
+#define ARENA_SIZE                  (48 * 1024)
+
+/* Largest difference of a 16x8 score to the float score */
+#define INT16_TOLERANCE             0.005f
+
+typedef enum {
+    MODEL_FLOAT32,
+    MODEL_INT8,
+    MODEL_INT16
+} model_type_t;
+
+typedef struct {
+    std::vector<float> w1, b1, w2, b2;
+    float hidden_max;
+    float logits_max;
+} model_weights_t;
+
+/**
+ * @brief Symmetric per tensor quantization of the weights to int8
+ */
+static std::vector<uint8_t> quantize_weights(const std::vector<float> &w, float *scale)
+{
+    float max = 0;
+    for (float v : w) {
+        max = std::max(max, std::fabs(v));
+    }
+    *scale = max / 127;
+    std::vector<uint8_t> data(w.size());
+    for (size_t ix = 0; ix < w.size(); ix++) {
+        data[ix] = (uint8_t)(int8_t)std::lround(w[ix] / *scale);
+    }
+    return data;
+}
+
+template<typename T>
+static std::vector<uint8_t> quantize_bias(const std::vector<float> &b, float scale)
+{
+    std::vector<uint8_t> data(b.size() * sizeof(T));
+    for (size_t ix = 0; ix < b.size(); ix++) {
+        T v = (T)std::llround(b[ix] / scale);
+        memcpy(&data[ix * sizeof(T)], &v, sizeof(T));
+    }
+    return data;
+}
+
+static std::vector<uint8_t> float_data(const std::vector<float> &v)
+{
+    std::vector<uint8_t> data(v.size() * sizeof(float));
+    memcpy(data.data(), v.data(), data.size());
+    return data;
+}
+
+/**
+ * @brief FULLY_CONNECTED (ReLU), FULLY_CONNECTED and SOFTMAX over the MFE
+ * features. int8: int8 activations and int32 bias, 16x8: int16 activations
+ * (zero point 0) and int64 bias, int8 weights for both.
+ */
+static std::vector<uint8_t> build_model(const model_weights_t &weights, model_type_t type)
+{
+    std::unique_ptr<tflite::ModelT> model(new tflite::ModelT());
+    model->version = TFLITE_SCHEMA_VERSION;
+    model->buffers.push_back(std::unique_ptr<tflite::BufferT>(new tflite::BufferT()));
+    model->subgraphs.push_back(std::unique_ptr<tflite::SubGraphT>(new tflite::SubGraphT()));
+    tflite::SubGraphT *subgraph = model->subgraphs[0].get();
+
+    auto add_buffer = [&](const std::vector<uint8_t> &data) {
+        std::unique_ptr<tflite::BufferT> buffer(new tflite::BufferT());
+        buffer->data = data;
+        model->buffers.push_back(std::move(buffer));
+        return (int)model->buffers.size() - 1;
+    };
+    // scale 0 for float tensors
+    auto add_tensor = [&](const char *name, std::vector<int> shape, tflite::TensorType type,
+        float scale, int zero_point, int buffer) {
+        std::unique_ptr<tflite::TensorT> tensor(new tflite::TensorT());
+        tensor->name = name;
+        tensor->shape = shape;
+        tensor->type = type;
+        tensor->buffer = buffer;
+        if (scale > 0) {
+            tensor->quantization.reset(new tflite::QuantizationParametersT());
+            tensor->quantization->scale.push_back(scale);
+            tensor->quantization->zero_point.push_back(zero_point);
+        }
+        subgraph->tensors.push_back(std::move(tensor));
+        return (int)subgraph->tensors.size() - 1;
+    };
+    auto add_opcode = [&](tflite::BuiltinOperator op) {
+        std::unique_ptr<tflite::OperatorCodeT> code(new tflite::OperatorCodeT());
+        code->builtin_code = op;
+        code->deprecated_builtin_code = (int8_t)op;
+        code->version = 1;
+        model->operator_codes.push_back(std::move(code));
+        return (uint32_t)model->operator_codes.size() - 1;
+    };
+
+    int input, w1, b1, hidden, w2, b2, logits, output;
+    if (type == MODEL_FLOAT32) {
+        const tflite::TensorType f32 = tflite::TensorType_FLOAT32;
+        input = add_tensor("input", { 1, MFE_FEATURES }, f32, 0, 0, 0);
+        w1 = add_tensor("fc1/w", { HIDDEN, MFE_FEATURES }, f32, 0, 0, add_buffer(float_data(weights.w1)));
+        b1 = add_tensor("fc1/b", { HIDDEN }, f32, 0, 0, add_buffer(float_data(weights.b1)));
+        hidden = add_tensor("hidden", { 1, HIDDEN }, f32, 0, 0, 0);
+        w2 = add_tensor("fc2/w", { LABELS, HIDDEN }, f32, 0, 0, add_buffer(float_data(weights.w2)));
+        b2 = add_tensor("fc2/b", { LABELS }, f32, 0, 0, add_buffer(float_data(weights.b2)));
+        logits = add_tensor("logits", { 1, LABELS }, f32, 0, 0, 0);
+        output = add_tensor("output", { 1, LABELS }, f32, 0, 0, 0);
+    }
+    else {
+        // the MFE features are in [0, 1]
+        const bool int16 = (type == MODEL_INT16);
+        const tflite::TensorType act = int16 ? tflite::TensorType_INT16 : tflite::TensorType_INT8;
+        const float levels = int16 ? 32767.0f : 255.0f;
+        const int zero_point = int16 ? 0 : -128;
+
+        float input_scale = 1.0f / levels;
+        float hidden_scale = weights.hidden_max / levels;
+        float logits_scale = weights.logits_max / (int16 ? 32767.0f : 127.0f);
+        float w1_scale, w2_scale;
+        std::vector<uint8_t> w1_data = quantize_weights(weights.w1, &w1_scale);
+        std::vector<uint8_t> w2_data = quantize_weights(weights.w2, &w2_scale);
+
+        input = add_tensor("input", { 1, MFE_FEATURES }, act, input_scale, zero_point, 0);
+        w1 = add_tensor("fc1/w", { HIDDEN, MFE_FEATURES }, tflite::TensorType_INT8, w1_scale, 0, add_buffer(w1_data));
+        hidden = add_tensor("hidden", { 1, HIDDEN }, act, hidden_scale, zero_point, 0);
+        w2 = add_tensor("fc2/w", { LABELS, HIDDEN }, tflite::TensorType_INT8, w2_scale, 0, add_buffer(w2_data));
+        logits = add_tensor("logits", { 1, LABELS }, act, logits_scale, 0, 0);
+        if (int16) {
+            b1 = add_tensor("fc1/b", { HIDDEN }, tflite::TensorType_INT64, input_scale * w1_scale, 0,
+                add_buffer(quantize_bias<int64_t>(weights.b1, input_scale * w1_scale)));
+            b2 = add_tensor("fc2/b", { LABELS }, tflite::TensorType_INT64, hidden_scale * w2_scale, 0,
+                add_buffer(quantize_bias<int64_t>(weights.b2, hidden_scale * w2_scale)));
+            output = add_tensor("output", { 1, LABELS }, act, 1.0f / 32768, 0, 0);
+        }
+        else {
+            b1 = add_tensor("fc1/b", { HIDDEN }, tflite::TensorType_INT32, input_scale * w1_scale, 0,
+                add_buffer(quantize_bias<int32_t>(weights.b1, input_scale * w1_scale)));
+            b2 = add_tensor("fc2/b", { LABELS }, tflite::TensorType_INT32, hidden_scale * w2_scale, 0,
+                add_buffer(quantize_bias<int32_t>(weights.b2, hidden_scale * w2_scale)));
+            output = add_tensor("output", { 1, LABELS }, act, 1.0f / 256, -128, 0);
+        }
+    }
+    subgraph->inputs = { input };
+    subgraph->outputs = { output };
+
+    uint32_t fc_opcode = add_opcode(tflite::BuiltinOperator_FULLY_CONNECTED);
+    auto add_fc = [&](int in, int w, int b, int out, tflite::ActivationFunctionType activation) {
+        std::unique_ptr<tflite::OperatorT> fc(new tflite::OperatorT());
+        fc->opcode_index = fc_opcode;
+        fc->inputs = { in, w, b };
+        fc->outputs = { out };
+        tflite::FullyConnectedOptionsT options;
+        options.fused_activation_function = activation;
+        fc->builtin_options.Set(options);
+        subgraph->operators.push_back(std::move(fc));
+    };
+    add_fc(input, w1, b1, hidden, tflite::ActivationFunctionType_RELU);
+    add_fc(hidden, w2, b2, logits, tflite::ActivationFunctionType_NONE);
+
+    std::unique_ptr<tflite::OperatorT> softmax(new tflite::OperatorT());
+    softmax->opcode_index = add_opcode(tflite::BuiltinOperator_SOFTMAX);
+    softmax->inputs = { logits };
+    softmax->outputs = { output };
+    tflite::SoftmaxOptionsT softmax_options;
+    softmax_options.beta = 1.0f;
+    softmax->builtin_options.Set(softmax_options);
+    subgraph->operators.push_back(std::move(softmax));
+
+    // no default allocator in the flatbuffers of the SDK
+    flatbuffers::DefaultAllocator allocator;
+    flatbuffers::FlatBufferBuilder fbb(1024, &allocator);
+    tflite::FinishModelBuffer(fbb, tflite::Model::Pack(fbb, model.get()));
+    return std::vector<uint8_t>(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+}
+
+static ei_dsp_config_mfe_t mfe_config = {
+    1, 4, 1, 0.02f, 0.01f, MFE_FILTERS, 256, 0, 0, 101, -52, 1
+};
+
+/**
+ * @brief Impulse of one model: the MFE block, the model and the classification
+ * post-processing. quantized selects the quantized MFE features shortcut. The
+ * model is built by main().
+ */
+#define TEST_IMPULSE(name, quantized)                                                                \
+    static EI_CLASSIFIER_DSP_AXES_INDEX_TYPE name##_axes[1] = { 0 };                                 \
+    static ei_model_dsp_t name##_dsp_blocks[1] = {                                                   \
+        { 1, MFE_FEATURES, &extract_mfe_features, (void*)&mfe_config, name##_axes, 1, 1, nullptr,    \
+          nullptr }                                                                                  \
+    };                                                                                               \
+    static ei_config_tflite_graph_t name##_graph_config = { 1, nullptr, 0, ARENA_SIZE };             \
+    static const uint8_t name##_output_tensors_indices[1] = { 0 };                                   \
+    static ei_learning_block_config_tflite_graph_t name##_block_config = {                           \
+        1, 2, name##_output_tensors_indices, 1, quantized, false, (void*)&name##_graph_config, true  \
+    };                                                                                               \
+    static const uint32_t name##_learning_block_inputs[1] = { 1 };                                   \
+    static const ei_learning_block_t name##_learning_blocks[1] = {                                   \
+        { 2, &run_nn_inference, (void*)&name##_block_config, EI_CLASSIFIER_IMAGE_SCALING_NONE,       \
+          name##_learning_block_inputs, 1 }                                                          \
+    };                                                                                               \
+    static const ei_postprocessing_block_t name##_postprocessing_blocks[1] = {                       \
+        { 3, EI_CLASSIFIER_MODE_CLASSIFICATION, nullptr, nullptr, &process_classification_f32,       \
+          nullptr, nullptr, 2 }                                                                      \
+    };                                                                                               \
+    static const ei_impulse_t name##_impulse = {                                                     \
+        0, "", "", 0, #name, 0,                                                                      \
+        MFE_FEATURES, SAMPLE_COUNT, 1, SAMPLE_COUNT, 0, 0, 0, 1000.0f / SAMPLE_RATE, SAMPLE_RATE,    \
+        1, name##_dsp_blocks,                                                                        \
+        1, name##_learning_blocks,                                                                   \
+        1, name##_postprocessing_blocks,                                                             \
+        1, EI_CLASSIFIER_TFLITE, EI_CLASSIFIER_SENSOR_MICROPHONE, "audio", SAMPLE_COUNT, 1,          \
+        EI_ANOMALY_TYPE_UNKNOWN, LABELS, labels, EI_CLASSIFIER_TYPE_CLASSIFICATION, 0, nullptr       \
+    };                                                                                               \
+    static ei_impulse_handle_t name##_handle = ei_impulse_handle_t(&name##_impulse);
+
+static const char *labels[] = { "noise", "low", "mid", "high" };
+
+TEST_IMPULSE(float32, false)
+TEST_IMPULSE(int8, true)
+TEST_IMPULSE(int16, true)
+TEST_IMPULSE(int16_matrix, false)
+
+static void load_model(ei_config_tflite_graph_t *graph_config, const std::vector<uint8_t> &model)
+{
+    graph_config->model = model.data();
+    graph_config->model_size = model.size();
+}
+
+static std::vector<float> audio(SAMPLE_COUNT);
+
+static int get_audio(size_t offset, size_t length, float *out_ptr)
+{
+    memcpy(out_ptr, audio.data() + offset, length * sizeof(float));
+    return 0;
+}
+
+/**
+ * @brief One second of noise, plus a tone of a frequency set by the class
+ * for the other classes, in the range of the microphone samples
+ */
+static void make_audio(int window, std::mt19937 &rng)
+{
+    static const float tones[] = { 0.0f, 400.0f, 1500.0f, 4000.0f };
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    const int label = window % LABELS;
+    const float frequency = tones[label] * (1.0f + 0.05f * (float)(window / LABELS));
+    const float noise_level = 300.0f + 100.0f * (float)(window % 7);
+
+    for (int ix = 0; ix < SAMPLE_COUNT; ix++) {
+        float value = noise_level * noise(rng);
+        if (label != 0) {
+            value += 4000.0f * std::sin(2.0f * (float)M_PI * frequency * (float)ix / SAMPLE_RATE);
+        }
+        audio[ix] = std::max(-32768.0f, std::min(32767.0f, std::round(value)));
+    }
+}
+
+/**
+ * @brief Random weights, with the ranges of the hidden layer and of the logits
+ * over the windows for the quantization. The logits are scaled to [-4, 4], the
+ * weights rounded to int8.
+ */
+static model_weights_t make_weights(const std::vector<std::vector<float>> &features, std::mt19937 &rng)
+{
+    model_weights_t weights;
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    weights.w1.resize(HIDDEN * MFE_FEATURES);
+    for (float &v : weights.w1) {
+        v = normal(rng) / std::sqrt((float)MFE_FEATURES);
+    }
+    weights.b1.resize(HIDDEN);
+    for (float &v : weights.b1) {
+        v = 0.1f * normal(rng);
+    }
+    weights.w2.resize(LABELS * HIDDEN);
+    for (float &v : weights.w2) {
+        v = normal(rng);
+    }
+    weights.b2.assign(LABELS, 0.0f);
+
+    weights.hidden_max = 0;
+    float logits_max = 0;
+    for (const std::vector<float> &x : features) {
+        float hidden[HIDDEN];
+        for (int h = 0; h < HIDDEN; h++) {
+            float acc = weights.b1[h];
+            for (int ix = 0; ix < MFE_FEATURES; ix++) {
+                acc += weights.w1[h * MFE_FEATURES + ix] * x[ix];
+            }
+            hidden[h] = std::max(acc, 0.0f);
+            weights.hidden_max = std::max(weights.hidden_max, hidden[h]);
+        }
+        for (int l = 0; l < LABELS; l++) {
+            float acc = 0;
+            for (int h = 0; h < HIDDEN; h++) {
+                acc += weights.w2[l * HIDDEN + h] * hidden[h];
+            }
+            logits_max = std::max(logits_max, std::fabs(acc));
+        }
+    }
+    for (float &v : weights.w2) {
+        v *= 4.0f / logits_max;
+    }
+    weights.logits_max = 4.0f;
+
+    // the float model gets the weights of the quantized models, so the errors
+    // are the ones of the activations
+    float scale;
+    for (std::vector<float> *w : { &weights.w1, &weights.w2 }) {
+        std::vector<uint8_t> data = quantize_weights(*w, &scale);
+        for (size_t ix = 0; ix < w->size(); ix++) {
+            (*w)[ix] = (float)(int8_t)data[ix] * scale;
+        }
+    }
+
+    return weights;
+}
+
+typedef struct {
+    float max;
+    double sum;
+    int agree;
+} model_error_t;
+
+static void add_error(model_error_t *error, const ei_impulse_result_t &result, const ei_impulse_result_t &reference)
+{
+    size_t best = 0, best_reference = 0;
+    for (size_t ix = 0; ix < LABELS; ix++) {
+        float diff = std::fabs(result.classification[ix].value - reference.classification[ix].value);
+        error->max = std::max(error->max, diff);
+        error->sum += diff;
+        if (result.classification[ix].value > result.classification[best].value) {
+            best = ix;
+        }
+        if (reference.classification[ix].value > reference.classification[best_reference].value) {
+            best_reference = ix;
+        }
+    }
+    error->agree += (best == best_reference);
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    std::mt19937 rng(1234);
+
+    if (LABELS < 2) {
+        printf("the results of the impulse of the firmware hold %d label, 2 needed\n", LABELS);
+        return 1;
+    }
+
+    signal_t signal;
+    signal.total_length = SAMPLE_COUNT;
+    signal.get_data = &get_audio;
+
+    // float MFE features of all windows, to calibrate the quantization
+    std::vector<std::vector<float>> features;
+    for (int window = 0; window < WINDOWS; window++) {
+        make_audio(window, rng);
+        matrix_t matrix(1, MFE_FEATURES);
+        if (extract_mfe_features(&signal, &matrix, &mfe_config, SAMPLE_RATE) != EIDSP_OK) {
+            printf("FAILED: MFE\n");
+            return 1;
+        }
+        features.push_back(std::vector<float>(matrix.buffer, matrix.buffer + MFE_FEATURES));
+    }
+    model_weights_t weights = make_weights(features, rng);
+
+    std::vector<uint8_t> float32_model = build_model(weights, MODEL_FLOAT32);
+    std::vector<uint8_t> int8_model = build_model(weights, MODEL_INT8);
+    std::vector<uint8_t> int16_model = build_model(weights, MODEL_INT16);
+    load_model(&float32_graph_config, float32_model);
+    load_model(&int8_graph_config, int8_model);
+    load_model(&int16_graph_config, int16_model);
+    load_model(&int16_matrix_graph_config, int16_model);
+
+#if (EI_CLASSIFIER_QUANTIZATION_ENABLED == 1) && (EI_CLASSIFIER_COMPILED != 1)
+    bool features_quantized = can_run_classifier_features_quantized(&int16_impulse, int16_learning_blocks[0]) == EI_IMPULSE_OK;
+#else
+    bool features_quantized = false;
+#endif
+
+    model_error_t int8_error = { 0, 0, 0 }, int16_error = { 0, 0, 0 };
+    rng.seed(1234);
+    for (int window = 0; window < WINDOWS; window++) {
+        make_audio(window, rng);
+
+        ei_impulse_result_t float32_result, int8_result, int16_result, int16_matrix_result;
+        check(process_impulse(&float32_handle, &signal, &float32_result) == EI_IMPULSE_OK, "float32 model");
+        check(process_impulse(&int8_handle, &signal, &int8_result) == EI_IMPULSE_OK, "int8 model");
+        check(process_impulse(&int16_handle, &signal, &int16_result) == EI_IMPULSE_OK, "16x8 model");
+        check(process_impulse(&int16_matrix_handle, &signal, &int16_matrix_result) == EI_IMPULSE_OK,
+            "16x8 model from the float features");
+        if (failures) {
+            break;
+        }
+
+        add_error(&int8_error, int8_result, float32_result);
+        add_error(&int16_error, int16_result, float32_result);
+        for (size_t ix = 0; ix < LABELS; ix++) {
+            check(int16_result.classification[ix].value == int16_matrix_result.classification[ix].value,
+                "quantized features match the float features");
+        }
+    }
+
+    check(int16_error.max <= INT16_TOLERANCE, "16x8 scores within the tolerance of float");
+    check(int16_error.max < int8_error.max, "16x8 scores closer to float than int8");
+
+    const int scores = WINDOWS * LABELS;
+    printf("%d windows, %d labels, quantized MFE features: %s\n", WINDOWS, LABELS, features_quantized ? "yes" : "no");
+    printf("int8: max error %.5f, mean error %.5f, top-1 %d/%d\n", int8_error.max, int8_error.sum / scores,
+        int8_error.agree, WINDOWS);
+    printf("16x8: max error %.5f, mean error %.5f, top-1 %d/%d\n", int16_error.max, int16_error.sum / scores,
+        int16_error.agree, WINDOWS);
+    printf("%s\n", failures ? "FAILED" : "OK");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,187 @@
+#ifndef _EI_CLASSIFIER_MODEL_METADATA_H_
+#define _EI_CLASSIFIER_MODEL_METADATA_H_
+
+// Stand-in for the model_metadata.h of a deployed model, for the host tools that
+// only run DSP blocks (speechpy-frames-bench, signal-axes-bench). The values
+// describe a 16 kHz audio impulse with every FFT table loaded; no model
+// variables or tflite model come with it.
+
+#include <stdint.h>
+
+#define EI_CLASSIFIER_NONE                       255
+#define EI_CLASSIFIER_UTENSOR                    1
+#define EI_CLASSIFIER_TFLITE                     2
+#define EI_CLASSIFIER_CUBEAI                     3
+#define EI_CLASSIFIER_TFLITE_FULL                4
+#define EI_CLASSIFIER_TENSAIFLOW                 5
+#define EI_CLASSIFIER_TENSORRT                   6
+#define EI_CLASSIFIER_DRPAI                      7
+#define EI_CLASSIFIER_TFLITE_TIDL                8
+#define EI_CLASSIFIER_AKIDA                      9
+#define EI_CLASSIFIER_SYNTIANT                   10
+#define EI_CLASSIFIER_ONNX_TIDL                  11
+#define EI_CLASSIFIER_MEMRYX                     12
+#define EI_CLASSIFIER_ETHOS_LINUX                13
+#define EI_CLASSIFIER_ATON                       14
+#define EI_CLASSIFIER_CEVA_NPN                   15
+#define EI_CLASSIFIER_NORDIC_AXON                16
+#define EI_CLASSIFIER_VLM_CONNECTOR              17
+
+#define EI_CLASSIFIER_SENSOR_UNKNOWN             255
+#define EI_CLASSIFIER_SENSOR_MICROPHONE          1
+#define EI_CLASSIFIER_SENSOR_ACCELEROMETER       2
+
+#define EI_CLASSIFIER_PROJECT_ID                 0
+#define EI_CLASSIFIER_PROJECT_OWNER              "host tools"
+#define EI_CLASSIFIER_PROJECT_NAME               "model stub"
+#define EI_CLASSIFIER_PROJECT_DEPLOY_VERSION     0
+#define EI_CLASSIFIER_NN_INPUT_FRAME_SIZE        3960
+#define EI_CLASSIFIER_RAW_SAMPLE_COUNT           16000
+#define EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME      1
+#define EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE       (EI_CLASSIFIER_RAW_SAMPLE_COUNT * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME)
+#define EI_CLASSIFIER_INPUT_WIDTH                0
+#define EI_CLASSIFIER_INPUT_HEIGHT               0
+#define EI_CLASSIFIER_INPUT_FRAMES               0
+#define EI_CLASSIFIER_NN_OUTPUT_COUNT            3
+#define EI_CLASSIFIER_INTERVAL_MS                0.0625
+#define EI_CLASSIFIER_LABEL_COUNT                3
+#define EI_ANOMALY_TYPE_UNKNOWN                  0
+#define EI_ANOMALY_TYPE_KMEANS                   1
+#define EI_ANOMALY_TYPE_GMM                      2
+#define EI_ANOMALY_TYPE_VISUAL_GMM               3
+#define EI_ANOMALY_TYPE_VISUAL_PATCHCORE         4
+#define EI_CLASSIFIER_HAS_ANOMALY                0
+#define EI_CLASSIFIER_SINGLE_FEATURE_INPUT       1
+#define EI_CLASSIFIER_FREQUENCY                  16000
+#define EI_CLASSIFIER_HAS_MODEL_VARIABLES        0
+#define EI_CLASSIFIER_OBJECT_DETECTION           0
+#define EI_CLASSIFIER_TFLITE_OUTPUT_DATA_TENSOR  0
+#define EI_CLASSIFIER_QUANTIZATION_ENABLED       1
+#define EI_CLASSIFIER_INFERENCING_ENGINE         EI_CLASSIFIER_TFLITE
+#define EI_CLASSIFIER_COMPILED                   0
+#define EI_CLASSIFIER_HAS_TFLITE_OPS_RESOLVER    0
+#define EI_CLASSIFIER_TFLITE_LARGEST_ARENA_SIZE  8192
+#define EI_CLASSIFIER_HAS_FFT_INFO               0
+#define EI_CLASSIFIER_LOAD_FFT_32                0
+#define EI_CLASSIFIER_LOAD_FFT_64                0
+#define EI_CLASSIFIER_LOAD_FFT_128               0
+#define EI_CLASSIFIER_LOAD_FFT_256               1
+#define EI_CLASSIFIER_LOAD_FFT_512               0
+#define EI_CLASSIFIER_LOAD_FFT_1024              0
+#define EI_CLASSIFIER_LOAD_FFT_2048              0
+#define EI_CLASSIFIER_LOAD_FFT_4096              0
+#define EI_CLASSIFIER_SENSOR                     EI_CLASSIFIER_SENSOR_MICROPHONE
+#define EI_CLASSIFIER_FUSION_AXES_STRING         "audio"
+#define EI_CLASSIFIER_CALIBRATION_ENABLED        0
+
+#ifndef EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW
+#define EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW    4
+#endif
+#define EI_CLASSIFIER_SLICE_SIZE                 (EI_CLASSIFIER_RAW_SAMPLE_COUNT / EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW)
+
+#define EI_CLASSIFIER_USE_FULL_TFLITE            0
+#define EI_CLASSIFIER_HAS_DATA_NORMALIZATION     0
+#define EI_CLASSIFIER_DSP_AXES_INDEX_TYPE        uint8_t
+
+typedef struct {
+    uint32_t blockId;
+    int implementation_version;
+    int length;
+    float frame_length;
+    float frame_stride;
+    int num_filters;
+    int fft_length;
+    int low_frequency;
+    int high_frequency;
+    int win_size;
+    int noise_floor_db;
+    int axes;
+} ei_dsp_config_mfe_t;
+
+typedef struct {
+    uint32_t blockId;
+    int implementation_version;
+    int length;
+    float frame_length;
+    float frame_stride;
+    int fft_length;
+    int noise_floor_db;
+    bool show_axes;
+    int axes;
+} ei_dsp_config_spectrogram_t;
+
+typedef struct {
+    uint32_t blockId;
+    int implementation_version;
+    int length;
+    float scale_axes;
+} ei_dsp_config_raw_t;
+
+typedef struct {
+    uint32_t blockId;
+    int implementation_version;
+    int length;
+    float scale_axes;
+    bool average;
+    bool minimum;
+    bool maximum;
+    bool rms;
+    bool stdev;
+    bool skewness;
+    bool kurtosis;
+    int moving_avg_num_windows;
+    int axes;
+} ei_dsp_config_flatten_t;
+
+typedef struct {
+    uint32_t blockId;
+    int implementation_version;
+    int length;
+    const char * channels;
+    int axes;
+} ei_dsp_config_image_t;
+
+typedef struct {
+    uint32_t blockId;
+    int implementation_version;
+    int length;
+    int num_cepstral;
+    float frame_length;
+    float frame_stride;
+    int num_filters;
+    int fft_length;
+    int win_size;
+    int low_frequency;
+    int high_frequency;
+    float pre_cof;
+    int pre_shift;
+    int axes;
+} ei_dsp_config_mfcc_t;
+
+typedef struct {
+    uint32_t blockId;
+    int implementation_version;
+    int length;
+    float scale_axes;
+    const char * filter_type;
+    float filter_cutoff;
+    int filter_order;
+    int fft_length;
+    int spectral_peaks_count;
+    float spectral_peaks_threshold;
+    const char * spectral_power_edges;
+    bool do_log;
+    bool do_fft_overlap;
+    int wavelet_level;
+    const char * wavelet;
+    bool extra_low_freq;
+    int input_decimation_ratio;
+    const char * analysis_type;
+    int axes;
+} ei_dsp_config_spectral_analysis_t;
+
+typedef struct {
+    int dummy;
+} ei_post_processing_output_t;
+
+#endif // _EI_CLASSIFIER_MODEL_METADATA_H_
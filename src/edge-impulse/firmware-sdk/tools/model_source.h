@@ -0,0 +1,188 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Shared by the host tools, finds the TFLite model flatbuffers in the
+ * exported model sources (C arrays in model/tflite-model) or .tflite files
+ */
+
+#ifndef EI_TOOLS_MODEL_SOURCE_H
+#define EI_TOOLS_MODEL_SOURCE_H
+
+#include "edge-impulse-sdk/tensorflow/lite/schema/schema_generated.h"
+#include "edge-impulse-sdk/tensorflow/lite/schema/schema_generated_full.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef struct {
+    std::vector<uint8_t> buffer;
+    std::string name;           // C array holding the model, empty for .tflite files
+    size_t begin;               // initializer in the source, after '{'
+    size_t end;                 // closing '}' of the initializer
+} model_source_t;
+
+static bool read_file(const std::string &path, std::string &out)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+static bool ends_with(const std::string &s, const char *suffix)
+{
+    size_t len = strlen(suffix);
+    return s.size() >= len && s.compare(s.size() - len, len, suffix) == 0;
+}
+
+/**
+ * @brief Parse the byte initializer starting after '{', false if it's not a
+ * plain list of 0..255 values (e.g. weights of an EON compiled model)
+ *
+ * @param close set to the closing '}'
+ */
+static bool parse_byte_array(const char *p, const char *end, std::vector<uint8_t> &out, const char **close)
+{
+    out.clear();
+
+    while (p < end) {
+        while (p < end && (isspace((unsigned char)*p) || *p == ',')) {
+            p++;
+        }
+        if (p < end && *p == '}') {
+            *close = p;
+            return out.size() > 8;
+        }
+        char *next;
+        long value = strtol(p, &next, 0);
+        if (next == p || value < 0 || value > 255) {
+            return false;
+        }
+        out.push_back((uint8_t)value);
+        p = next;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Name of the array declared before the initializer at pos,
+ * e.g. tflite_learn_5 of "const unsigned char tflite_learn_5[] ALIGN(16) = {"
+ */
+static std::string array_name(const std::string &source, size_t pos)
+{
+    size_t statement = source.find_last_of(";}", pos);
+    statement = statement == std::string::npos ? 0 : statement + 1;
+
+    size_t bracket = source.find('[', statement);
+    if (bracket == std::string::npos || bracket > pos) {
+        return "";
+    }
+    size_t name_end = source.find_last_not_of(" \t\r\n", bracket - 1);
+    size_t name_begin = name_end;
+    while (name_begin > statement &&
+        (isalnum((unsigned char)source[name_begin - 1]) || source[name_begin - 1] == '_')) {
+        name_begin--;
+    }
+
+    return source.substr(name_begin, name_end + 1 - name_begin);
+}
+
+/**
+ * @brief Append every model flatbuffer found in a C/C++ source
+ */
+static void find_models_in_source(const std::string &source, std::vector<model_source_t> &models)
+{
+    size_t pos = 0;
+    model_source_t model;
+
+    while ((pos = source.find('{', pos)) != std::string::npos) {
+        // only initializers, "= {"
+        size_t prev = source.find_last_not_of(" \t\r\n", pos - 1);
+        pos++;
+        if (prev == std::string::npos || source[prev] != '=') {
+            continue;
+        }
+        const char *close = nullptr;
+        if (!parse_byte_array(source.c_str() + pos, source.c_str() + source.size(), model.buffer, &close)) {
+            continue;
+        }
+        flatbuffers::Verifier verifier(model.buffer.data(), model.buffer.size());
+        if (tflite::ModelBufferHasIdentifier(model.buffer.data()) && tflite::VerifyModelBuffer(verifier)) {
+            model.name = array_name(source, prev);
+            model.begin = pos;
+            model.end = close - source.c_str();
+            models.push_back(model);
+            pos = model.end;
+        }
+    }
+}
+
+/**
+ * @brief Append the models of a model source or .tflite file
+ *
+ * @param content set to the file content
+ */
+static bool read_models(const std::string &path, std::vector<model_source_t> &models, std::string &content)
+{
+    if (!read_file(path, content)) {
+        return false;
+    }
+
+    if (ends_with(path, ".tflite")) {
+        model_source_t model;
+        model.buffer.assign(content.begin(), content.end());
+        model.begin = 0;
+        model.end = content.size();
+        models.push_back(model);
+    }
+    else {
+        find_models_in_source(content, models);
+    }
+
+    return true;
+}
+
+#endif // EI_TOOLS_MODEL_SOURCE_H
@@ -0,0 +1,367 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host check of the multi-impulse runtime (ei_multi_impulse.h): two
+ * small int8 models, a keyword model and a command model, built in memory as
+ * impulses next to the one of the firmware, run as a cascade sharing the
+ * tensor arena.
+ *
+ *  - the command model only runs when the keyword model scores the keyword
+ *  - the results of the command model match a run of it on its own
+ *  - every switch between the models sets the interpreter up again
+ *  - the shared arena is the largest of the registered impulses: an impulse
+ *    that doesn't fit the static arena isn't registered, without
+ *    EI_CLASSIFIER_ALLOCATION_STATIC the arena on the heap grows at
+ *    registration and the graphs are set up in it
+ *
+ * Prints the latency and memory of each impulse, returns 1 on a failed check.
+ *
+ * Usage:
+ *     multi_impulse_cascade
+ */
+
+#include "edge-impulse-sdk/classifier/ei_multi_impulse.h"
+#include "edge-impulse-sdk/tensorflow/lite/schema/schema_generated_full.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#define KEYWORD_FEATURES            32
+#define COMMAND_FEATURES            256
+#if EI_IMPULSE_RESULT_CLASSIFICATION_IS_STATICALLY_ALLOCATED == 1 && EI_CLASSIFIER_LABEL_COUNT < 4
+// the results hold the labels of the impulse of the firmware
+#define COMMAND_LABELS              EI_CLASSIFIER_LABEL_COUNT
+#else
+#define COMMAND_LABELS              4
+#endif
+#define CASCADE_WINDOWS             64
+
+/* The command model runs when the keyword scores at least this */
+#define KEYWORD_THRESHOLD           0.8f
+
+/**
+ * @brief Fully connected layer and softmax, int8. Row i of the weights is one
+ * over the features [i * span, (i + 1) * span) (all of them when span is 0),
+ * scaled by sign[i].
+ */
+static std::vector<uint8_t> build_model(int features, int labels, int span, const int *sign)
+{
+    std::unique_ptr<tflite::ModelT> model(new tflite::ModelT());
+    model->version = TFLITE_SCHEMA_VERSION;
+    model->buffers.push_back(std::unique_ptr<tflite::BufferT>(new tflite::BufferT()));
+    model->subgraphs.push_back(std::unique_ptr<tflite::SubGraphT>(new tflite::SubGraphT()));
+    tflite::SubGraphT *subgraph = model->subgraphs[0].get();
+
+    auto add_buffer = [&](const std::vector<uint8_t> &data) {
+        std::unique_ptr<tflite::BufferT> buffer(new tflite::BufferT());
+        buffer->data = data;
+        model->buffers.push_back(std::move(buffer));
+        return (int)model->buffers.size() - 1;
+    };
+    auto add_tensor = [&](const char *name, std::vector<int> shape, tflite::TensorType type,
+        float scale, int zero_point, int buffer) {
+        std::unique_ptr<tflite::TensorT> tensor(new tflite::TensorT());
+        tensor->name = name;
+        tensor->shape = shape;
+        tensor->type = type;
+        tensor->buffer = buffer;
+        tensor->quantization.reset(new tflite::QuantizationParametersT());
+        tensor->quantization->scale.push_back(scale);
+        tensor->quantization->zero_point.push_back(zero_point);
+        subgraph->tensors.push_back(std::move(tensor));
+        return (int)subgraph->tensors.size() - 1;
+    };
+    auto add_opcode = [&](tflite::BuiltinOperator op) {
+        std::unique_ptr<tflite::OperatorCodeT> code(new tflite::OperatorCodeT());
+        code->builtin_code = op;
+        code->deprecated_builtin_code = (int8_t)op;
+        code->version = 1;
+        model->operator_codes.push_back(std::move(code));
+        return (uint32_t)model->operator_codes.size() - 1;
+    };
+
+    // weights of 64 with a scale of 1 / 64, the features are in [-1, 1)
+    std::vector<uint8_t> weights(labels * features, 0);
+    for (int label = 0; label < labels; label++) {
+        for (int ix = 0; ix < features; ix++) {
+            if (span == 0 || ix / span == label) {
+                weights[label * features + ix] = (uint8_t)(int8_t)(64 * sign[label]);
+            }
+        }
+    }
+    int input = add_tensor("input", { 1, features }, tflite::TensorType_INT8, 1.0f / 128, 0, 0);
+    int w = add_tensor("fc/w", { labels, features }, tflite::TensorType_INT8, 1.0f / 64, 0, add_buffer(weights));
+    int b = add_tensor("fc/b", { labels }, tflite::TensorType_INT32, 1.0f / (128 * 64), 0,
+        add_buffer(std::vector<uint8_t>(labels * 4, 0)));
+    int logits = add_tensor("logits", { 1, labels }, tflite::TensorType_INT8, 0.25f, 0, 0);
+    int output = add_tensor("output", { 1, labels }, tflite::TensorType_INT8, 1.0f / 256, -128, 0);
+    subgraph->inputs = { input };
+    subgraph->outputs = { output };
+
+    std::unique_ptr<tflite::OperatorT> fc(new tflite::OperatorT());
+    fc->opcode_index = add_opcode(tflite::BuiltinOperator_FULLY_CONNECTED);
+    fc->inputs = { input, w, b };
+    fc->outputs = { logits };
+    fc->builtin_options.Set(tflite::FullyConnectedOptionsT());
+    subgraph->operators.push_back(std::move(fc));
+
+    std::unique_ptr<tflite::OperatorT> softmax(new tflite::OperatorT());
+    softmax->opcode_index = add_opcode(tflite::BuiltinOperator_SOFTMAX);
+    softmax->inputs = { logits };
+    softmax->outputs = { output };
+    tflite::SoftmaxOptionsT softmax_options;
+    softmax_options.beta = 1.0f;
+    softmax->builtin_options.Set(softmax_options);
+    subgraph->operators.push_back(std::move(softmax));
+
+    // no default allocator in the flatbuffers of the SDK
+    flatbuffers::DefaultAllocator allocator;
+    flatbuffers::FlatBufferBuilder fbb(1024, &allocator);
+    tflite::FinishModelBuffer(fbb, tflite::Model::Pack(fbb, model.get()));
+    return std::vector<uint8_t>(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+}
+
+/**
+ * @brief Raw features, the signal is the feature vector
+ */
+static int extract_features(signal_t *signal, matrix_t *output_matrix, void *config, float frequency)
+{
+    (void)config;
+    (void)frequency;
+    return signal->get_data(0, output_matrix->rows * output_matrix->cols, output_matrix->buffer);
+}
+
+/**
+ * @brief Impulse of one model: a raw DSP block, the model and the
+ * classification post-processing. The model is built into model[] by main().
+ */
+#define TEST_IMPULSE(name, features, labels, arena_size)                                             \
+    static uint8_t name##_model[8192] __attribute__((aligned(16)));                                  \
+    static EI_CLASSIFIER_DSP_AXES_INDEX_TYPE name##_axes[1] = { 0 };                                 \
+    static ei_model_dsp_t name##_dsp_blocks[1] = {                                                   \
+        { 1, features, &extract_features, nullptr, name##_axes, 1, 1, nullptr, nullptr }             \
+    };                                                                                               \
+    static ei_config_tflite_graph_t name##_graph_config = { 1, name##_model, 0, arena_size };        \
+    static const uint8_t name##_output_tensors_indices[1] = { 0 };                                   \
+    static ei_learning_block_config_tflite_graph_t name##_block_config = {                           \
+        1, 2, name##_output_tensors_indices, 1, true, false, (void*)&name##_graph_config, true       \
+    };                                                                                               \
+    static const uint32_t name##_learning_block_inputs[1] = { 1 };                                   \
+    static const ei_learning_block_t name##_learning_blocks[1] = {                                   \
+        { 2, &run_nn_inference, (void*)&name##_block_config, EI_CLASSIFIER_IMAGE_SCALING_NONE,       \
+          name##_learning_block_inputs, 1 }                                                          \
+    };                                                                                               \
+    static const ei_postprocessing_block_t name##_postprocessing_blocks[1] = {                       \
+        { 3, EI_CLASSIFIER_MODE_CLASSIFICATION, nullptr, nullptr, &process_classification_f32,       \
+          nullptr, nullptr, 2 }                                                                      \
+    };                                                                                               \
+    static const ei_impulse_t name##_impulse = {                                                     \
+        0, "", "", 0, #name, 0,                                                                      \
+        features, features, 1, features, 0, 0, 0, 1.0f, 1.0f,                                        \
+        1, name##_dsp_blocks,                                                                        \
+        1, name##_learning_blocks,                                                                   \
+        1, name##_postprocessing_blocks,                                                             \
+        1, EI_CLASSIFIER_TFLITE, EI_CLASSIFIER_SENSOR_UNKNOWN, "", features, 1,                      \
+        EI_ANOMALY_TYPE_UNKNOWN, labels, name##_labels, EI_CLASSIFIER_TYPE_CLASSIFICATION, 0, nullptr \
+    };                                                                                               \
+    static ei_impulse_handle_t name##_handle = ei_impulse_handle_t(&name##_impulse);
+
+static const char *keyword_labels[] = { "keyword", "noise" };
+static const char *command_labels[] = { "up", "down", "left", "right" };
+static const char **large_labels = command_labels;
+
+TEST_IMPULSE(keyword, KEYWORD_FEATURES, 2, 2048)
+TEST_IMPULSE(command, COMMAND_FEATURES, COMMAND_LABELS, 4096)
+// arena larger than the static arena, or than the heap can give
+#ifdef EI_CLASSIFIER_ALLOCATION_STATIC
+TEST_IMPULSE(large, COMMAND_FEATURES, COMMAND_LABELS, EI_TFLITE_STATIC_ARENA_SIZE + 1024)
+#else
+TEST_IMPULSE(large, COMMAND_FEATURES, COMMAND_LABELS, (size_t)1 << 46)
+#endif
+
+static void load_model(ei_config_tflite_graph_t *graph_config, uint8_t *buffer, size_t buffer_size,
+    const std::vector<uint8_t> &model)
+{
+    if (model.size() > buffer_size) {
+        printf("model of %zu bytes, only %zu reserved\n", model.size(), buffer_size);
+        exit(1);
+    }
+    memcpy(buffer, model.data(), model.size());
+    graph_config->model_size = model.size();
+}
+
+static std::vector<float> keyword_features(KEYWORD_FEATURES);
+static std::vector<float> command_features(COMMAND_FEATURES);
+
+static int get_keyword_features(size_t offset, size_t length, float *out_ptr)
+{
+    memcpy(out_ptr, keyword_features.data() + offset, length * sizeof(float));
+    return 0;
+}
+
+static int get_command_features(size_t offset, size_t length, float *out_ptr)
+{
+    memcpy(out_ptr, command_features.data() + offset, length * sizeof(float));
+    return 0;
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    static const int keyword_sign[] = { 1, -1 };
+    static const int command_sign[] = { 1, 1, 1, 1 };
+
+    if (COMMAND_LABELS < 2) {
+        printf("the results of the impulse of the firmware hold %d label, 2 needed\n", COMMAND_LABELS);
+        return 1;
+    }
+
+    load_model(&keyword_graph_config, keyword_model, sizeof(keyword_model),
+        build_model(KEYWORD_FEATURES, 2, 0, keyword_sign));
+    load_model(&command_graph_config, command_model, sizeof(command_model),
+        build_model(COMMAND_FEATURES, COMMAND_LABELS, COMMAND_FEATURES / COMMAND_LABELS, command_sign));
+
+    load_model(&large_graph_config, large_model, sizeof(large_model),
+        build_model(COMMAND_FEATURES, COMMAND_LABELS, COMMAND_FEATURES / COMMAND_LABELS, command_sign));
+
+    if (ei_multi_impulse_register(&keyword_handle) != EI_IMPULSE_OK) {
+        printf("FAILED: register\n");
+        return 1;
+    }
+#ifndef EI_CLASSIFIER_ALLOCATION_STATIC
+    check(ei_tflite_shared_arena.size == EI_TFLITE_ARENA_SIZE(&keyword_graph_config), "heap arena of the keyword model");
+#endif
+    if (ei_multi_impulse_register(&command_handle) != EI_IMPULSE_OK) {
+        printf("FAILED: register\n");
+        return 1;
+    }
+    check(ei_multi_impulse_arena_size() == EI_TFLITE_ARENA_SIZE(&command_graph_config), "shared arena is the largest arena");
+#ifndef EI_CLASSIFIER_ALLOCATION_STATIC
+    check(ei_tflite_shared_arena.size == EI_TFLITE_ARENA_SIZE(&command_graph_config), "heap arena grown to the command model");
+#endif
+
+#ifndef EI_TENSOR_ARENA_SIZE
+    // all graphs get EI_TENSOR_ARENA_SIZE when it's set
+    check(ei_multi_impulse_register(&large_handle) == EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED, "impulse that doesn't fit rejected");
+    check(ei_multi_impulse_stats(&large_handle) == nullptr, "rejected impulse not registered");
+    check(ei_multi_impulse_arena_size() == EI_TFLITE_ARENA_SIZE(&command_graph_config), "shared arena kept");
+#endif
+
+    ei_cascade_label_gate_t gate = { "keyword", KEYWORD_THRESHOLD };
+    ei_cascade_t cascade = { &keyword_handle, &command_handle, &ei_cascade_gate_label, &gate, false };
+
+    signal_t keyword_signal;
+    keyword_signal.total_length = KEYWORD_FEATURES;
+    keyword_signal.get_data = &get_keyword_features;
+    signal_t command_signal;
+    command_signal.total_length = COMMAND_FEATURES;
+    command_signal.get_data = &get_command_features;
+
+    int expected_triggers = 0, triggers = 0;
+    for (int window = 0; window < CASCADE_WINDOWS; window++) {
+        // the keyword every fourth window, the command of the window after it
+        bool heard = (window % 4 == 1);
+        int spoken = window % COMMAND_LABELS;
+        for (size_t ix = 0; ix < keyword_features.size(); ix++) {
+            keyword_features[ix] = heard ? 0.5f : -0.5f;
+        }
+        for (size_t ix = 0; ix < command_features.size(); ix++) {
+            command_features[ix] = ((int)ix / (COMMAND_FEATURES / COMMAND_LABELS) == spoken) ? 0.25f : 0.0f;
+        }
+
+        ei_impulse_result_t keyword_result, command_result;
+        bool triggered;
+        EI_IMPULSE_ERROR res = ei_multi_impulse_cascade(&cascade, &keyword_signal, &command_signal,
+            &keyword_result, &command_result, &triggered);
+        check(res == EI_IMPULSE_OK, "cascade");
+        check(triggered == heard, "command model run only on the keyword");
+        if (!triggered) {
+            continue;
+        }
+        expected_triggers++;
+        triggers++;
+
+        float values[COMMAND_LABELS];
+        size_t best = 0;
+        for (size_t ix = 0; ix < COMMAND_LABELS; ix++) {
+            values[ix] = command_result.classification[ix].value;
+            if (values[ix] > values[best]) {
+                best = ix;
+            }
+        }
+        check(best == (size_t)spoken, "command recognized");
+
+        // the same window on its own, with a fresh interpreter
+        ei_impulse_result_t alone;
+        run_classifier_deinit(&command_handle);
+        check(process_impulse(&command_handle, &command_signal, &alone) == EI_IMPULSE_OK, "command alone");
+        for (size_t ix = 0; ix < COMMAND_LABELS; ix++) {
+            check(alone.classification[ix].value == values[ix], "cascade result matches the command alone");
+        }
+    }
+
+    const ei_multi_impulse_stats_t *keyword_stats = ei_multi_impulse_stats(&keyword_handle);
+    const ei_multi_impulse_stats_t *command_stats = ei_multi_impulse_stats(&command_handle);
+    check(keyword_stats->runs == CASCADE_WINDOWS, "keyword model run on every window");
+    check((int)command_stats->runs == expected_triggers, "command model runs");
+#if EI_CLASSIFIER_TFLITE_PERSISTENT_INTERPRETER == 1
+    // set up once, then again after each command
+    check((int)keyword_stats->setups == 1 + triggers, "keyword setups");
+    check((int)command_stats->setups == triggers, "command setups");
+#endif
+    check(keyword_stats->arena_used > 0 && keyword_stats->arena_used <= keyword_stats->arena_size, "keyword arena");
+    check(command_stats->arena_used > 0 && command_stats->arena_used <= command_stats->arena_size, "command arena");
+#ifndef EI_CLASSIFIER_ALLOCATION_STATIC
+    check(inference_tflite_arena_usage().size == ei_multi_impulse_arena_size(), "graphs set up in the heap arena");
+#endif
+
+    ei_multi_impulse_print_stats();
+    ei_multi_impulse_deinit();
+
+    printf("%d windows, %d commands, %s\n", CASCADE_WINDOWS, triggers, failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,42 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+// Stand-in for the FreeRTOS headers of the firmware, for the host tools that
+// build its tasks and drivers (usb-output-bench, inference-task-test). Tasks
+// are threads, a tick is a millisecond of the host clock and every blocking
+// call is counted, see platform_stub.h.
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                         ((BaseType_t)0)
+#define pdTRUE                          ((BaseType_t)1)
+#define pdFAIL                          pdFALSE
+#define pdPASS                          pdTRUE
+
+#define portMAX_DELAY                   ((TickType_t)0xffffffffu)
+#define configTICK_RATE_HZ              1000
+#define configMAX_PRIORITIES            8
+#define pdMS_TO_TICKS(ms)               ((TickType_t)(ms))
+#define portYIELD_FROM_ISR(x)           ((void)(x))
+#define INCLUDE_xTaskGetCurrentTaskHandle   1
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+void platform_stub_enter_critical(void);
+void platform_stub_exit_critical(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#define taskENTER_CRITICAL()            platform_stub_enter_critical()
+#define taskEXIT_CRITICAL()             platform_stub_exit_critical()
+
+#endif /* FREERTOS_H */
@@ -0,0 +1,19 @@
+#ifndef NS_CORE_H
+#define NS_CORE_H
+
+// Stand-in for the neuralSPOT core header, see FreeRTOS.h
+
+#include <stdint.h>
+
+typedef struct {
+    uint16_t major;
+    uint16_t minor;
+    uint16_t revision;
+} ns_core_api_t;
+
+#define NS_STATUS_SUCCESS               0
+#define NS_TRY(func, msg)               ((void)(func))
+
+#define AM_SHARED_RW
+
+#endif /* NS_CORE_H */
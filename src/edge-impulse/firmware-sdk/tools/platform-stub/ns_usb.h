@@ -0,0 +1,54 @@
+#ifndef NS_USB_H
+#define NS_USB_H
+
+// Stand-in for the neuralSPOT USB header: ns_usb_send_data() goes to the
+// sink of platform_stub.h, see FreeRTOS.h
+
+#include "ns_core.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef void *usb_handle_t;
+
+typedef enum {
+    NS_USB_CDC_DEVICE,
+    NS_USB_HID_DEVICE,
+    NS_USB_VENDOR_DEVICE
+} ns_usb_device_type_e;
+
+typedef struct {
+    void *handle;
+    uint8_t *buffer;
+    uint32_t length;
+    uint8_t status;
+    uint8_t itf;
+} ns_usb_transaction_t;
+
+typedef void (*ns_usb_rx_cb)(ns_usb_transaction_t *);
+typedef void (*ns_usb_tx_cb)(ns_usb_transaction_t *);
+typedef void (*ns_usb_service_cb)(uint8_t);
+
+typedef struct {
+    const ns_core_api_t *api;
+    ns_usb_device_type_e deviceType;
+    uint8_t *rx_buffer;
+    uint32_t rx_bufferLength;
+    uint8_t *tx_buffer;
+    uint32_t tx_bufferLength;
+    ns_usb_rx_cb rx_cb;
+    ns_usb_tx_cb tx_cb;
+    ns_usb_service_cb service_cb;
+} ns_usb_config_t;
+
+extern const ns_core_api_t ns_usb_V1_0_0;
+
+uint32_t ns_usb_init(ns_usb_config_t *cfg, usb_handle_t *handle);
+uint32_t ns_usb_send_data(usb_handle_t handle, void *buffer, uint32_t bufsize);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* NS_USB_H */
@@ -0,0 +1,401 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host stand-ins for the FreeRTOS calls and the USB stack of the
+ * firmware, see FreeRTOS.h and platform_stub.h.
+ *
+ * A task is a thread and a tick is a millisecond of the host clock. Blocking
+ * calls wait on one condition variable for their notification or event bits,
+ * so a task blocked without timeout doesn't run at all until it is woken up,
+ * as on the device. Priorities are ignored.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+#include "ns_usb.h"
+#include "tusb.h"
+#include "platform_stub.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct tskTaskControlBlock {
+    const char *name;
+    uint32_t notified_value;
+    bool notify_pending;
+    platform_stub_task_stats_t stats;
+};
+
+struct EventGroupDef_t {
+    EventBits_t bits;
+};
+
+/* Notifications, event bits and the task list. Never destroyed: the tasks never
+ * return, they are still blocked on them when the host tool exits */
+static std::mutex &state_lock = *new std::mutex;
+static std::condition_variable &state_changed = *new std::condition_variable;
+static std::vector<tskTaskControlBlock *> &tasks = *new std::vector<tskTaskControlBlock *>;
+
+static std::recursive_mutex critical_lock;
+static const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+static tskTaskControlBlock main_task = { "main", 0, false, { 0, 0, 0 } };
+static thread_local tskTaskControlBlock *current_task = nullptr;
+
+static tskTaskControlBlock *self(void)
+{
+    return current_task != nullptr ? current_task : &main_task;
+}
+
+/**
+ * @brief Block the calling task until ready() or the timeout, counted in its
+ * stats. Called with state_lock held.
+ * @return ready()
+ */
+template<typename ready_t>
+static bool block(std::unique_lock<std::mutex> &lock, TickType_t ticks, ready_t ready)
+{
+    tskTaskControlBlock *task = self();
+    bool ok = true;
+
+    if (ready()) {
+        return true;
+    }
+    if (ticks == 0) {
+        return false;
+    }
+
+    task->stats.blocks++;
+    if (ticks == portMAX_DELAY) {
+        state_changed.wait(lock, ready);
+    }
+    else {
+        ok = state_changed.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+    }
+    task->stats.wakeups++;
+    task->stats.timeouts += !ok;
+
+    return ok;
+}
+
+void platform_stub_enter_critical(void)
+{
+    critical_lock.lock();
+}
+
+void platform_stub_exit_critical(void)
+{
+    critical_lock.unlock();
+}
+
+BaseType_t xTaskCreate(
+    TaskFunction_t pxTaskCode,
+    const char *pcName,
+    uint16_t usStackDepth,
+    void *pvParameters,
+    UBaseType_t uxPriority,
+    TaskHandle_t *pxCreatedTask)
+{
+    tskTaskControlBlock *task = new tskTaskControlBlock { pcName, 0, false, { 0, 0, 0 } };
+
+    {
+        std::lock_guard<std::mutex> lock(state_lock);
+        tasks.push_back(task);
+    }
+    if (pxCreatedTask != nullptr) {
+        *pxCreatedTask = task;
+    }
+
+    std::thread([task, pxTaskCode, pvParameters]() {
+        current_task = task;
+        pxTaskCode(pvParameters);
+    }).detach();
+
+    return pdPASS;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return taskSCHEDULER_RUNNING;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return self();
+}
+
+char *pcTaskGetName(TaskHandle_t xTaskToQuery)
+{
+    return (char *)(xTaskToQuery != nullptr ? xTaskToQuery : self())->name;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+    std::unique_lock<std::mutex> lock(state_lock);
+    block(lock, xTicksToDelay, []() { return false; });
+}
+
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction)
+{
+    std::lock_guard<std::mutex> lock(state_lock);
+
+    switch (eAction) {
+    case eSetBits:
+        xTaskToNotify->notified_value |= ulValue;
+        break;
+    case eIncrement:
+        xTaskToNotify->notified_value++;
+        break;
+    case eSetValueWithoutOverwrite:
+        if (xTaskToNotify->notify_pending) {
+            return pdFAIL;
+        }
+        xTaskToNotify->notified_value = ulValue;
+        break;
+    case eSetValueWithOverwrite:
+        xTaskToNotify->notified_value = ulValue;
+        break;
+    case eNoAction:
+        break;
+    }
+    xTaskToNotify->notify_pending = true;
+    state_changed.notify_all();
+
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(
+    TaskHandle_t xTaskToNotify,
+    uint32_t ulValue,
+    eNotifyAction eAction,
+    BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != nullptr) {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    return xTaskNotify(xTaskToNotify, ulValue, eAction);
+}
+
+BaseType_t xTaskNotifyWait(
+    uint32_t ulBitsToClearOnEntry,
+    uint32_t ulBitsToClearOnExit,
+    uint32_t *pulNotificationValue,
+    TickType_t xTicksToWait)
+{
+    std::unique_lock<std::mutex> lock(state_lock);
+    tskTaskControlBlock *task = self();
+
+    if (!task->notify_pending) {
+        task->notified_value &= ~ulBitsToClearOnEntry;
+    }
+
+    bool ok = block(lock, xTicksToWait, [task]() { return task->notify_pending; });
+
+    if (pulNotificationValue != nullptr) {
+        *pulNotificationValue = task->notified_value;
+    }
+    if (ok) {
+        task->notify_pending = false;
+        task->notified_value &= ~ulBitsToClearOnExit;
+    }
+
+    return ok ? pdTRUE : pdFALSE;
+}
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    return new EventGroupDef_t { 0 };
+}
+
+EventBits_t xEventGroupWaitBits(
+    EventGroupHandle_t xEventGroup,
+    const EventBits_t uxBitsToWaitFor,
+    const BaseType_t xClearOnExit,
+    const BaseType_t xWaitForAllBits,
+    TickType_t xTicksToWait)
+{
+    std::unique_lock<std::mutex> lock(state_lock);
+
+    bool ok = block(lock, xTicksToWait, [&]() {
+        EventBits_t set = xEventGroup->bits & uxBitsToWaitFor;
+        return xWaitForAllBits ? set == uxBitsToWaitFor : set != 0;
+    });
+    EventBits_t bits = xEventGroup->bits;
+
+    if (ok && xClearOnExit) {
+        xEventGroup->bits &= ~uxBitsToWaitFor;
+    }
+
+    return bits;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet)
+{
+    std::lock_guard<std::mutex> lock(state_lock);
+
+    xEventGroup->bits |= uxBitsToSet;
+    state_changed.notify_all();
+
+    return xEventGroup->bits;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(
+    EventGroupHandle_t xEventGroup,
+    const EventBits_t uxBitsToSet,
+    BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != nullptr) {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    xEventGroupSetBits(xEventGroup, uxBitsToSet);
+
+    return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToClear)
+{
+    std::lock_guard<std::mutex> lock(state_lock);
+    EventBits_t bits = xEventGroup->bits;
+
+    xEventGroup->bits &= ~uxBitsToClear;
+
+    return bits;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t xEventGroup)
+{
+    std::lock_guard<std::mutex> lock(state_lock);
+
+    return xEventGroup->bits;
+}
+
+platform_stub_task_stats_t platform_stub_task_stats(TaskHandle_t task)
+{
+    std::lock_guard<std::mutex> lock(state_lock);
+
+    return (task != nullptr ? task : self())->stats;
+}
+
+TaskHandle_t platform_stub_find_task(const char *name)
+{
+    std::lock_guard<std::mutex> lock(state_lock);
+
+    for (tskTaskControlBlock *task : tasks) {
+        if (strcmp(task->name, name) == 0) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+/* USB: the output goes to the sink, the input waits in the CDC FIFO */
+static platform_stub_usb_sink_f usb_sink = nullptr;
+static ns_usb_config_t usb_config;
+static std::mutex cdc_lock;
+static std::deque<uint8_t> cdc_fifo;
+
+const ns_core_api_t ns_usb_V1_0_0 = { 1, 0, 0 };
+
+uint32_t ns_usb_init(ns_usb_config_t *cfg, usb_handle_t *handle)
+{
+    usb_config = *cfg;
+    *handle = &usb_config;
+
+    return NS_STATUS_SUCCESS;
+}
+
+uint32_t ns_usb_send_data(usb_handle_t handle, void *buffer, uint32_t bufsize)
+{
+    if (usb_sink != nullptr) {
+        usb_sink((const uint8_t *)buffer, bufsize);
+    }
+    return bufsize;
+}
+
+void platform_stub_usb_set_sink(platform_stub_usb_sink_f sink)
+{
+    usb_sink = sink;
+}
+
+uint32_t tud_cdc_n_available(uint8_t itf)
+{
+    std::lock_guard<std::mutex> lock(cdc_lock);
+
+    return (uint32_t)cdc_fifo.size();
+}
+
+uint32_t tud_cdc_n_read(uint8_t itf, void *buffer, uint32_t bufsize)
+{
+    std::lock_guard<std::mutex> lock(cdc_lock);
+    uint32_t read = bufsize < cdc_fifo.size() ? bufsize : (uint32_t)cdc_fifo.size();
+
+    std::copy(cdc_fifo.begin(), cdc_fifo.begin() + read, (uint8_t *)buffer);
+    cdc_fifo.erase(cdc_fifo.begin(), cdc_fifo.begin() + read);
+
+    return read;
+}
+
+uint32_t platform_stub_cdc_receive(const uint8_t *data, uint32_t length)
+{
+    {
+        std::lock_guard<std::mutex> lock(cdc_lock);
+        uint32_t space = usb_config.rx_bufferLength - (uint32_t)cdc_fifo.size();
+
+        if (length > space) {
+            length = space;
+        }
+        cdc_fifo.insert(cdc_fifo.end(), data, data + length);
+    }
+
+    if (length > 0 && usb_config.rx_cb != nullptr) {
+        ns_usb_transaction_t transaction = { &usb_config, nullptr, length, 0, 0 };
+        usb_config.rx_cb(&transaction);
+    }
+
+    return length;
+}
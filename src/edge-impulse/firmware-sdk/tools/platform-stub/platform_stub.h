@@ -0,0 +1,87 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PLATFORM_STUB_H
+#define PLATFORM_STUB_H
+
+/*
+ * Hooks of the host stand-ins for FreeRTOS and the USB stack (platform_stub.cpp):
+ * per task counts of the blocking calls, the USB output sink and the USB input
+ * (CDC FIFO) of the host tools.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t blocks;    // blocking calls that had to wait
+    uint32_t wakeups;   // of those, the ones that returned (event or timeout)
+    uint32_t timeouts;  // of those, the ones that timed out (vTaskDelay included)
+} platform_stub_task_stats_t;
+
+typedef void (*platform_stub_usb_sink_f)(const uint8_t *data, uint32_t length);
+
+/**
+ * @brief Blocking calls of a task so far
+ * @param task NULL for the calling thread
+ */
+platform_stub_task_stats_t platform_stub_task_stats(TaskHandle_t task);
+
+/**
+ * @brief Task created with this name, NULL if there is none (yet)
+ */
+TaskHandle_t platform_stub_find_task(const char *name);
+
+/**
+ * @brief Receives every ns_usb_send_data(), NULL drops the data
+ */
+void platform_stub_usb_set_sink(platform_stub_usb_sink_f sink);
+
+/**
+ * @brief Host to device data: appended to the CDC FIFO, then the RX callback
+ * given to ns_usb_init() runs as the USB interrupt would. The FIFO holds the
+ * rx_bufferLength given to ns_usb_init(), what doesn't fit is NAKed
+ * @return number of bytes taken, the host sends the rest again later
+ */
+uint32_t platform_stub_cdc_receive(const uint8_t *data, uint32_t length);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* PLATFORM_STUB_H */
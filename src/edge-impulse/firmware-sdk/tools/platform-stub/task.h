@@ -0,0 +1,56 @@
+#ifndef TASK_H
+#define TASK_H
+
+// Stand-in for FreeRTOS task.h, see FreeRTOS.h
+
+#include "FreeRTOS.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct tskTaskControlBlock *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
+#define taskSCHEDULER_SUSPENDED         ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED       ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING           ((BaseType_t)2)
+
+BaseType_t xTaskCreate(
+    TaskFunction_t pxTaskCode,
+    const char *pcName,
+    uint16_t usStackDepth,
+    void *pvParameters,
+    UBaseType_t uxPriority,
+    TaskHandle_t *pxCreatedTask);
+BaseType_t xTaskGetSchedulerState(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+char *pcTaskGetName(TaskHandle_t xTaskToQuery);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t xTicksToDelay);
+
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction);
+BaseType_t xTaskNotifyFromISR(
+    TaskHandle_t xTaskToNotify,
+    uint32_t ulValue,
+    eNotifyAction eAction,
+    BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t xTaskNotifyWait(
+    uint32_t ulBitsToClearOnEntry,
+    uint32_t ulBitsToClearOnExit,
+    uint32_t *pulNotificationValue,
+    TickType_t xTicksToWait);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* TASK_H */
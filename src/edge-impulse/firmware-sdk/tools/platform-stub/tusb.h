@@ -0,0 +1,20 @@
+#ifndef TUSB_H
+#define TUSB_H
+
+// Stand-in for the TinyUSB CDC calls of ei_usb.c: the CDC FIFO is fed by
+// platform_stub_cdc_receive() of platform_stub.h, see FreeRTOS.h
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+uint32_t tud_cdc_n_available(uint8_t itf);
+uint32_t tud_cdc_n_read(uint8_t itf, void *buffer, uint32_t bufsize);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* TUSB_H */
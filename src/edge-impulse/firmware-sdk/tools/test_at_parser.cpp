@@ -0,0 +1,386 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host test of the AT command line handling (at-server):
+ *
+ *  - ATParser::parse, which tokenizes the line in place, gives the same type,
+ *    command and arguments as the std::string parser it replaced, on a corpus
+ *    of commands and on random lines and mutations of it (fuzz)
+ *  - lines with more than AT_MAX_ARGUMENTS arguments, or only whitespaces
+ *    (which threw in the old parser), are AT_UNKNOWN
+ *  - LineBuffer drops the characters past AT_LINE_BUFFER_SIZE and flags the
+ *    line as overflowed until it's cleared
+ *  - ATServer::handle rejects a line over AT_LINE_BUFFER_SIZE characters with
+ *    an error, without echoing the dropped characters, running the cut command
+ *    or adding it to the history; the next line runs as usual
+ *
+ * Returns 1 on a failed check.
+ *
+ * Usage:
+ *     test_at_parser [iterations]
+ */
+
+#include "firmware-sdk/at-server/ei_at_command_set.h"
+#include "firmware-sdk/at-server/ei_at_parser.h"
+#include "firmware-sdk/at-server/ei_at_server.h"
+#include "firmware-sdk/at-server/ei_line_buffer.h"
+
+#include "bench_util.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* Console of the AT server */
+static std::string console;
+
+void ei_printf(const char *format, ...)
+{
+    char line[512];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    console += line;
+}
+
+void ei_putchar(char data)
+{
+    console += data;
+}
+
+/* AT+INFO of the default commands lives with the device commands (ei_at_command_set.cpp) */
+bool at_info(void)
+{
+    return true;
+}
+
+/* The parser before it tokenized in place: std::string copies of the command and arguments */
+typedef struct {
+    ATCommandType_t type;
+    std::string command;
+    std::vector<std::string> arguments;
+} reference_result_t;
+
+static reference_result_t reference_parse(std::string input)
+{
+    reference_result_t result = { AT_UNKNOWN, "", {} };
+    std::string tmp;
+    size_t pos;
+    size_t delim1;
+    size_t delim2;
+
+    if (input.size() == 0) {
+        return result;
+    }
+
+    // trim leading whitespaces
+    input = input.substr(input.find_first_not_of(" \t"));
+
+    if (input.rfind("AT+", 0) != 0) {
+        return result;
+    }
+
+    //remove "AT+"
+    input = input.substr(3);
+
+    // trim spaces, newline and CR at the end
+    input = input.erase(input.find_last_not_of(" \r\n") + 1);
+
+    // extract command itself
+    pos = input.find_first_of("?=");
+    result.command = input.substr(0, pos);
+
+    if (pos == std::string::npos) {
+        result.type = AT_RUN;
+    }
+    else if (input.at(pos) == '=') {
+        result.type = AT_WRITE;
+    }
+    else {
+        result.type = AT_READ;
+    }
+
+    // check if command has arguments and extract them
+    if (pos != std::string::npos && input.at(pos) == '=') {
+        delim1 = pos;
+        delim2 = input.find_first_of(",", pos);
+        while (delim2 != std::string::npos) {
+            tmp = std::string(input, delim1 + 1, delim2 - delim1 - 1);
+            result.arguments.push_back(tmp);
+            delim1 = delim2;
+            delim2 = input.find_first_of(",", delim1 + 1);
+        }
+        tmp = std::string(input, delim1 + 1);
+        result.arguments.push_back(tmp);
+    }
+
+    return result;
+}
+
+static size_t compared;
+static size_t mismatches;
+
+static void compare_parsers(ATParser &parser, const std::string &input)
+{
+    char line[AT_LINE_BUFFER_SIZE + 1];
+    reference_result_t expected;
+
+    if (input.size() > AT_LINE_BUFFER_SIZE) {
+        return;
+    }
+
+    try {
+        expected = reference_parse(input);
+    }
+    catch (const std::out_of_range &) {
+        // whitespaces only, the old parser threw
+        expected = { AT_UNKNOWN, "", {} };
+    }
+    if (expected.arguments.size() > AT_MAX_ARGUMENTS) {
+        expected = { AT_UNKNOWN, "", {} };
+    }
+
+    memcpy(line, input.c_str(), input.size() + 1);
+    const ATParseResult_t &res = parser.parse(line);
+
+    bool same = res.type == expected.type;
+    if (same && res.type != AT_UNKNOWN) {
+        same = expected.command == res.command &&
+            expected.arguments.size() == res.arguments_count;
+        for (size_t ix = 0; same && ix < res.arguments_count; ix++) {
+            same = expected.arguments[ix] == res.arguments[ix];
+        }
+    }
+
+    compared++;
+    if (!same) {
+        if (mismatches++ < 5) {
+            printf("    mismatch on \"%s\"\n", input.c_str());
+        }
+    }
+}
+
+static const char *corpus[] = {
+    "AT+HELP",
+    "AT+CONFIG?",
+    "AT+DEVICEID=abcde",
+    "AT+SAMPLESETTINGS=accX,1000,16000",
+    "AT+UPLOADSETTINGS=key,host",
+    "AT+RUNIMPULSE",
+    "AT+RUNIMPULSESTATIC=1,2,3",
+    "  AT+HELP  ",
+    "\tAT+CONFIG?\r\n",
+    "AT+WIFI=,,",
+    "AT+X=",
+    "AT+=a",
+    "AT+?",
+    "AT+",
+    "AT+A=1?,2=3",
+    "AT+A?=1",
+    "AT+ A =  b , c ",
+    "AT+A=1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16",
+    "AT+A=1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17",
+    "at+help",
+    "AT",
+    "AT-HELP",
+    "ATI",
+    "",
+    " ",
+    "\t \t",
+    "HELP",
+};
+
+static void test_parser(unsigned iterations)
+{
+    ATParser parser;
+    const char alphabet[] = "AT+=?, \t\r\nabXY01";
+    std::uniform_int_distribution<int> any_char(0, sizeof(alphabet) - 2);
+    std::uniform_int_distribution<int> length(0, 40);
+    std::uniform_int_distribution<int> coin(0, 3);
+    const size_t corpus_size = sizeof(corpus) / sizeof(corpus[0]);
+    std::uniform_int_distribution<size_t> pick(0, corpus_size - 1);
+
+    for (size_t ix = 0; ix < corpus_size; ix++) {
+        compare_parsers(parser, corpus[ix]);
+    }
+
+    for (unsigned it = 0; it < iterations; it++) {
+        std::string input;
+
+        if (coin(rng) == 0) {
+            // random line, mostly starting as a command
+            input = coin(rng) ? "AT+" : "";
+            for (int n = length(rng); n > 0; n--) {
+                input += alphabet[any_char(rng)];
+            }
+        }
+        else {
+            // mutation of the corpus: replace, insert or remove characters
+            input = corpus[pick(rng)];
+            for (int n = coin(rng) + 1; n > 0; n--) {
+                size_t at = input.empty() ? 0 : rng() % (input.size() + 1);
+                switch (coin(rng)) {
+                case 0:
+                    if (at < input.size()) {
+                        input.erase(at, 1);
+                    }
+                    break;
+                case 1:
+                    if (at < input.size()) {
+                        input[at] = alphabet[any_char(rng)];
+                    }
+                    break;
+                default:
+                    input.insert(at, 1, alphabet[any_char(rng)]);
+                    break;
+                }
+            }
+        }
+
+        compare_parsers(parser, input);
+    }
+
+    // longest line the server passes to the parser, many empty arguments
+    compare_parsers(parser, "AT+A=" + std::string(AT_LINE_BUFFER_SIZE - 5, ','));
+    compare_parsers(parser, "AT+A=" + std::string(AT_LINE_BUFFER_SIZE - 5, 'x'));
+
+    printf("Parser: %zu lines, %zu mismatches against the std::string parser\n", compared, mismatches);
+    check(mismatches == 0, "parser matches the std::string parser");
+}
+
+static void test_line_buffer(void)
+{
+    LineBuffer buffer;
+
+    for (int ix = 0; ix < AT_LINE_BUFFER_SIZE; ix++) {
+        check(buffer.add('a'), "line buffer takes AT_LINE_BUFFER_SIZE characters");
+    }
+    check(buffer.is_full() && !buffer.is_overflowed(), "full line buffer is not overflowed");
+    check(!buffer.add('b'), "line buffer drops a character past AT_LINE_BUFFER_SIZE");
+    check(buffer.is_overflowed(), "line buffer is overflowed after a dropped character");
+    check(buffer.size() == AT_LINE_BUFFER_SIZE && strchr(buffer.get_string(), 'b') == nullptr,
+        "dropped character is not in the line");
+
+    // backspace makes room again, the line stays incomplete
+    buffer.do_backspace();
+    check(buffer.add('c') && buffer.is_overflowed(), "line stays overflowed until cleared");
+
+    buffer.clear();
+    check(!buffer.is_overflowed() && buffer.size() == 0, "clear resets the overflow");
+}
+
+/* Command of the server test, remembers its arguments */
+static std::vector<std::string> written;
+static unsigned write_calls;
+
+static bool write_handler(const char **argv, const int argc)
+{
+    write_calls++;
+    written.assign(argv, argv + argc);
+    return true;
+}
+
+static void send_line(ATServer *server, const std::string &line)
+{
+    for (char c : line) {
+        server->handle(c);
+    }
+    server->handle('\r');
+    server->handle('\n');
+}
+
+static void test_server(void)
+{
+    ATServer *server = ATServer::get_instance();
+    server->register_command("TEST", "Test command", nullptr, nullptr, write_handler, "ARG");
+
+    // longest line is run as usual
+    std::string longest = "AT+TEST=" + std::string(AT_LINE_BUFFER_SIZE - 8, 'x');
+    console.clear();
+    send_line(server, longest);
+    check(write_calls == 1 && written.size() == 1 && written[0].size() == AT_LINE_BUFFER_SIZE - 8,
+        "line of AT_LINE_BUFFER_SIZE characters is run");
+
+    // one character more: not run, error, dropped characters not echoed
+    std::string too_long = "AT+TEST=" + std::string(AT_LINE_BUFFER_SIZE - 8, 'y') + "zzzz";
+    console.clear();
+    send_line(server, too_long);
+    check(write_calls == 1, "line over AT_LINE_BUFFER_SIZE characters is not run");
+    check(console.find("ERR: Command too long") != std::string::npos, "line over AT_LINE_BUFFER_SIZE characters gives an error");
+    check(console.find('z') == std::string::npos, "dropped characters are not echoed");
+
+    // the overlong line is not in the history: up arrow recalls the line before it
+    console.clear();
+    server->handle('\x1b');
+    server->handle('[');
+    server->handle('A');
+    server->handle('\r');
+    check(write_calls == 2 && written.size() == 1 && written[0][0] == 'x', "line over AT_LINE_BUFFER_SIZE characters is not in the history");
+
+    // next line runs as usual
+    send_line(server, "AT+TEST=1,2");
+    check(write_calls == 3 && written.size() == 2 && written[0] == "1" && written[1] == "2",
+        "next line after an overlong one is run");
+
+    printf("Server: overlong line rejected, %u commands run\n", write_calls);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned iterations = argc > 1 ? (unsigned)atoi(argv[1]) : 200000;
+
+    test_parser(iterations);
+    test_line_buffer();
+    test_server();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,297 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host test of the single producer / single consumer audio ring
+ * (ingestion-sdk-platform/sensor/ei_audio_ring.h):
+ *
+ *  - init() rejects storage that is not a whole number of frames
+ *  - empty and full: a full ring drops and counts the next frame, an empty one
+ *    has nothing to read, and both are told apart without a wasted slot
+ *  - reads and writes wrap around the end of the storage (two spans), and the
+ *    indexes wrap around twice the capacity, over many laps
+ *  - a producer thread writing frames of a counter and a consumer thread
+ *    reading and releasing random lengths, interleaved as the DMA callback and
+ *    the inference task: every sample is read once, in order
+ *
+ * Returns 1 on a failed check.
+ *
+ * Usage:
+ *     test_audio_ring
+ */
+
+#include "ingestion-sdk-platform/sensor/ei_audio_ring.h"
+
+#include "bench_util.h"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#define FRAME_LEN                   4
+#define FRAMES                      5
+#define CAPACITY                    (FRAME_LEN * FRAMES)
+
+/* Interleaved producer and consumer */
+#define THREAD_FRAME_LEN            160
+#define THREAD_FRAMES               8
+#define THREAD_SAMPLES              (THREAD_FRAME_LEN * 25000)
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/**
+ * @brief Write one frame of a counter, false if the ring is full
+ */
+static bool write_frame(EiAudioRing<int16_t> &ring, int16_t *next, uint32_t frame_len)
+{
+    int16_t *frame = ring.write_acquire();
+    if (frame == nullptr) {
+        return false;
+    }
+    for (uint32_t i = 0; i < frame_len; i++) {
+        frame[i] = (*next)++;
+    }
+    ring.write_commit();
+    return true;
+}
+
+static void test_init(void)
+{
+    int16_t storage[CAPACITY];
+    EiAudioRing<int16_t> ring;
+
+    check(!ring.is_initialized(), "not initialized before init()");
+    check(ring.write_acquire() == nullptr, "no frame before init()");
+    check(!ring.init(nullptr, CAPACITY, FRAME_LEN), "init() without storage");
+    check(!ring.init(storage, CAPACITY, 0), "init() with empty frames");
+    check(!ring.init(storage, FRAME_LEN - 1, FRAME_LEN), "init() with storage smaller than a frame");
+    check(!ring.init(storage, CAPACITY + 1, FRAME_LEN), "init() with storage not a multiple of the frame");
+    check(ring.init(storage, CAPACITY, FRAME_LEN), "init()");
+    check(ring.is_initialized() && ring.get_capacity() == CAPACITY, "initialized");
+
+    ring.deinit();
+    check(!ring.is_initialized() && ring.write_acquire() == nullptr, "no frame after deinit()");
+}
+
+static void test_full_empty(void)
+{
+    int16_t storage[CAPACITY];
+    int16_t out[CAPACITY];
+    int16_t next = 0;
+    EiAudioRing<int16_t> ring;
+    ring.init(storage, CAPACITY, FRAME_LEN);
+
+    check(ring.available() == 0, "empty after init()");
+    check(!ring.read(0, 1, out), "nothing to read when empty");
+
+    for (int frame = 0; frame < FRAMES; frame++) {
+        check(write_frame(ring, &next, FRAME_LEN), "write until full");
+    }
+    check(ring.available() == CAPACITY, "full ring holds the whole capacity");
+    check(!write_frame(ring, &next, FRAME_LEN), "write to a full ring");
+    check(!write_frame(ring, &next, FRAME_LEN), "write to a full ring again");
+    check(ring.get_dropped_frames() == 2, "frames dropped when full");
+    check(!ring.read(1, CAPACITY, out), "read past the written samples");
+
+    check(ring.read(0, CAPACITY, out), "read a full ring");
+    bool in_order = true;
+    for (int i = 0; i < CAPACITY; i++) {
+        in_order &= out[i] == i;
+    }
+    check(in_order, "full ring content");
+
+    /* Less than a frame free is still full */
+    ring.consume(FRAME_LEN - 1);
+    check(!write_frame(ring, &next, FRAME_LEN), "write with less than a frame free");
+    ring.consume(1);
+    next = CAPACITY;
+    check(write_frame(ring, &next, FRAME_LEN), "write once a frame is free");
+
+    /* consume() and flush() never release more than was written */
+    ring.consume(2 * CAPACITY);
+    check(ring.available() == 0, "consume() clamps to the available samples");
+    check(write_frame(ring, &next, FRAME_LEN) && ring.available() == FRAME_LEN, "write after consume()");
+    ring.flush();
+    check(ring.available() == 0, "empty after flush()");
+
+    ring.reset_dropped_frames();
+    check(ring.get_dropped_frames() == 0, "dropped frames reset");
+}
+
+static void test_wraparound(void)
+{
+    int16_t storage[CAPACITY];
+    int16_t out[CAPACITY];
+    int16_t written = 0;
+    int16_t read = 0;
+    EiAudioRing<int16_t> ring;
+    ring.init(storage, CAPACITY, FRAME_LEN);
+
+    bool spans_ok = true;
+    bool content_ok = true;
+    bool wrapped = false;
+
+    /* Keep between one and four frames in the ring over many laps of the
+       storage and of the indexes, reading a length that is not a multiple of
+       the frame so every start offset is hit */
+    for (int lap = 0; lap < 1000; lap++) {
+        while (ring.available() + FRAME_LEN <= CAPACITY - FRAME_LEN) {
+            write_frame(ring, &written, FRAME_LEN);
+        }
+
+        uint32_t available = ring.available();
+        for (uint32_t offset = 0; offset < available; offset++) {
+            const int16_t *first, *second;
+            uint32_t first_len, second_len;
+            uint32_t length = available - offset;
+            if (!ring.read_span(offset, length, &first, &first_len, &second, &second_len)) {
+                spans_ok = false;
+                continue;
+            }
+            spans_ok &= first_len + second_len == length;
+            spans_ok &= first >= storage && first + first_len <= storage + CAPACITY;
+            spans_ok &= second_len == 0 ? second == nullptr : second == storage;
+            wrapped |= second_len != 0;
+            for (uint32_t i = 0; i < first_len; i++) {
+                content_ok &= first[i] == (int16_t)(read + offset + i);
+            }
+            for (uint32_t i = 0; i < second_len; i++) {
+                content_ok &= second[i] == (int16_t)(read + offset + first_len + i);
+            }
+        }
+
+        uint32_t length = 3 + lap % 7;
+        if (length > available) {
+            length = available;
+        }
+        ring.read(0, length, out);
+        for (uint32_t i = 0; i < length; i++) {
+            content_ok &= out[i] == (int16_t)(read + i);
+        }
+        ring.consume(length);
+        read += length;
+    }
+
+    check(spans_ok, "spans cover the requested range within the storage");
+    check(wrapped, "spans wrap around the end of the storage");
+    check(content_ok, "content across the wraparound");
+    check(ring.get_dropped_frames() == 0, "no frame dropped while there is room");
+}
+
+static void test_interleaved(void)
+{
+    std::vector<int16_t> storage(THREAD_FRAME_LEN * THREAD_FRAMES);
+    EiAudioRing<int16_t> ring;
+    ring.init(storage.data(), storage.size(), THREAD_FRAME_LEN);
+
+    std::atomic<bool> done(false);
+    size_t written_frames = 0;
+
+    /* Producer: the DMA callback, a frame of the counter whenever there is room */
+    std::thread producer([&]() {
+        int16_t next = 0;
+        while (written_frames * THREAD_FRAME_LEN < THREAD_SAMPLES) {
+            if (write_frame(ring, &next, THREAD_FRAME_LEN)) {
+                written_frames++;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    /* Consumer: the inference task, random lengths read in place then released */
+    std::uniform_int_distribution<uint32_t> random_length(1, THREAD_FRAME_LEN * 3);
+    uint32_t read = 0;
+    bool in_order = true;
+    bool spans_ok = true;
+    while (read < THREAD_SAMPLES) {
+        uint32_t available = ring.available();
+        if (available == 0) {
+            if (done.load(std::memory_order_acquire) && ring.available() == 0) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        uint32_t length = random_length(rng);
+        if (length > available) {
+            length = available;
+        }
+        const int16_t *first, *second;
+        uint32_t first_len, second_len;
+        if (!ring.read_span(0, length, &first, &first_len, &second, &second_len)) {
+            spans_ok = false;
+            break;
+        }
+        for (uint32_t i = 0; i < first_len; i++) {
+            in_order &= first[i] == (int16_t)(read + i);
+        }
+        for (uint32_t i = 0; i < second_len; i++) {
+            in_order &= second[i] == (int16_t)(read + first_len + i);
+        }
+        ring.consume(length);
+        read += length;
+    }
+    producer.join();
+
+    /* The producer tries again when the ring is full, every try is counted as dropped */
+    printf("%u samples in frames of %d through %d frames of storage, full %u times\n",
+        read, THREAD_FRAME_LEN, THREAD_FRAMES, ring.get_dropped_frames());
+    check(read == THREAD_SAMPLES, "consumer read every sample");
+    check(spans_ok, "consumer spans available");
+    check(in_order, "consumer read the samples in order");
+}
+
+int main(void)
+{
+    test_init();
+    test_full_empty();
+    test_wraparound();
+    test_interleaved();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,428 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host test of the firmware side of the binary framed transport
+ * (ei_binary_frame.h), the receive loop and the readback of ei_device_lib.cpp
+ * built as on the device, with the serial port, the sample memory and
+ * run_classifier() replaced by the test:
+ *
+ *  - AT+RUNIMPULSESTATIC: a window of features sent in random frame sizes
+ *    reaches run_classifier() bit for bit
+ *  - corrupted streams (sync, length, CRC, sequence, truncated, END total,
+ *    too much data) abort with "ERR <reason> <sequence>" and END OUTPUT,
+ *    before any inference
+ *  - AT+READBUFFER: frames and base64 decode back to the sample memory, and
+ *    the serial port is written in whole buffers
+ *  - a failed read of the sample memory still ends the transfer with END, its
+ *    total is the number of bytes sent
+ *
+ * Returns 1 on a failed check.
+ *
+ * Usage:
+ *     test_binary_frames
+ */
+
+#include "firmware-sdk/ei_binary_frame.h"
+#include "firmware-sdk/ei_device_lib.h"
+#include "firmware-sdk/ei_device_info_lib.h"
+#include "firmware-sdk/ei_device_memory.h"
+#include "firmware-sdk/at_base64_lib.h"
+
+#include "edge-impulse-sdk/classifier/ei_classifier_types.h"
+#include "edge-impulse-sdk/classifier/ei_signal_with_axes.h"
+
+#include "bench_util.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define FEATURES                    EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE
+#define MEMORY_BLOCK_SIZE           1024
+#define MEMORY_BLOCKS               8
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* Serial port: host to device bytes, device to host bytes and the console */
+static std::vector<uint8_t> wire;
+static size_t wire_pos;
+static std::vector<uint8_t> sent;
+static size_t single_byte_writes;
+static std::string console;
+
+size_t ei_serial_read(uint8_t *buffer, size_t length, uint32_t timeout_ms)
+{
+    size_t n = length < wire.size() - wire_pos ? length : wire.size() - wire_pos;
+
+    memcpy(buffer, wire.data() + wire_pos, n);
+    wire_pos += n;
+    return n;
+}
+
+void ei_serial_write(const uint8_t *buffer, size_t length)
+{
+    sent.insert(sent.end(), buffer, buffer + length);
+    single_byte_writes += (length == 1);
+}
+
+void ei_printf(const char *format, ...)
+{
+    char line[256];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    console += line;
+}
+
+void ei_printf_float(float f)
+{
+    ei_printf("%f", f);
+}
+
+/* Inference: keeps the features it was given */
+static std::vector<float> classified;
+static int classify_calls;
+
+extern "C" EI_IMPULSE_ERROR run_classifier(signal_t *signal, ei_impulse_result_t *result, bool debug)
+{
+    classify_calls++;
+    classified.resize(signal->total_length);
+    signal->get_data(0, signal->total_length, classified.data());
+    return EI_IMPULSE_OK;
+}
+
+static const char *categories[EI_CLASSIFIER_LABEL_COUNT] = { "noise", "unknown", "yes" };
+static ei_impulse_t impulse;
+static ei_impulse_handle_t impulse_handle(&impulse);
+ei_impulse_handle_t& ei_default_impulse = impulse_handle;
+
+/* Device with its sample memory in RAM */
+class TestDevice : public EiDeviceInfo {
+public:
+    EiDeviceRAM<MEMORY_BLOCK_SIZE, MEMORY_BLOCKS> ram;
+
+    TestDevice() : ram(0)
+    {
+        memory = &ram;
+    }
+
+    void init_device_id(void) override
+    {
+    }
+};
+
+static TestDevice device;
+
+EiDeviceInfo *EiDeviceInfo::get_device(void)
+{
+    return &device;
+}
+
+static void append_frame(std::vector<uint8_t> &out, uint8_t type, uint8_t seq, const uint8_t *payload, uint16_t length)
+{
+    size_t at = out.size();
+
+    out.resize(at + length + EI_FRAME_OVERHEAD);
+    ei_frame_encode(type, seq, payload, length, &out[at], length + EI_FRAME_OVERHEAD);
+}
+
+/**
+ * @brief DATA frames of random sizes, then END with the total
+ * @return size_t number of DATA frames
+ */
+static size_t append_transfer(std::vector<uint8_t> &out, const uint8_t *data, size_t size)
+{
+    std::uniform_int_distribution<size_t> frame_size(1, EI_FRAME_MAX_PAYLOAD);
+    uint8_t seq = 0;
+
+    for (size_t pos = 0; pos < size; seq++) {
+        size_t length = frame_size(rng);
+
+        if (length > size - pos) {
+            length = size - pos;
+        }
+        append_frame(out, EI_FRAME_DATA, seq, data + pos, (uint16_t)length);
+        pos += length;
+    }
+
+    uint8_t total[4] = { (uint8_t)size, (uint8_t)(size >> 8), (uint8_t)(size >> 16), (uint8_t)(size >> 24) };
+    append_frame(out, EI_FRAME_END, seq, total, sizeof(total));
+    return seq;
+}
+
+/**
+ * @brief Decode a device to host transfer
+ * @return true if it is DATA frames in sequence closed by one END, and nothing after
+ */
+static bool decode_transfer(const std::vector<uint8_t> &in, std::vector<uint8_t> &data, uint32_t &total)
+{
+    size_t pos = 0;
+    uint8_t seq = 0;
+
+    data.clear();
+    while (pos < in.size()) {
+        ei_frame_header_t header;
+        const uint8_t *payload;
+        int ret = ei_frame_decode(&in[pos], in.size() - pos, &header, &payload);
+
+        if (ret < 0 || header.seq != seq++) {
+            return false;
+        }
+        pos += ret;
+
+        if (header.type == EI_FRAME_END) {
+            if (header.length != 4) {
+                return false;
+            }
+            total = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) |
+                ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+            return pos == in.size();
+        }
+        data.insert(data.end(), payload, payload + header.length);
+    }
+    return false;
+}
+
+static bool run_static(const std::vector<uint8_t> &stream)
+{
+    wire = stream;
+    wire_pos = 0;
+    console.clear();
+    classify_calls = 0;
+    ei_frame_set_binary_mode(true);
+
+    return run_impulse_static_data(false, FEATURES, 512);
+}
+
+static bool console_has(const std::string &text)
+{
+    return console.find(text) != std::string::npos;
+}
+
+static bool console_ends_with(const std::string &text)
+{
+    return console.size() >= text.size() && console.compare(console.size() - text.size(), text.size(), text) == 0;
+}
+
+static void test_static_data(void)
+{
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::vector<float> features(FEATURES);
+    for (float &f : features) {
+        f = normal(rng);
+    }
+    const uint8_t *bytes = (const uint8_t *)features.data();
+    const size_t size = features.size() * sizeof(float);
+
+    for (int run = 0; run < 20; run++) {
+        std::vector<uint8_t> stream;
+        append_transfer(stream, bytes, size);
+
+        bool ok = run_static(stream);
+        check(ok, "static data: transfer accepted");
+        check(wire_pos == wire.size(), "static data: every byte read");
+        check(console_has("OK CHUNK=1024\r\n"), "static data: OK CHUNK is the frame payload");
+        check(console_has("TRANSFER COMPLETED 16000\r\n"), "static data: TRANSFER COMPLETED");
+        check(classify_calls == 1, "static data: one inference");
+        check(classified.size() == features.size() &&
+            memcmp(classified.data(), features.data(), size) == 0, "static data: features bit for bit");
+        check(console_ends_with("END OUTPUT\r\n"), "static data: END OUTPUT");
+    }
+
+    /* A short window is received, then rejected by the size check of the impulse */
+    std::vector<uint8_t> stream;
+    append_transfer(stream, bytes, size - 400);
+    run_static(stream);
+    check(console_has("TRANSFER COMPLETED 15900\r\n"), "short window: TRANSFER COMPLETED");
+    check(console_has("Expected 16000 items, but got 15900"), "short window: rejected by the impulse");
+    check(classify_calls == 0, "short window: no inference");
+    printf("static data: 20 windows of %d features in random frame sizes\n", FEATURES);
+}
+
+/**
+ * @brief Run a corrupted stream, it must be aborted before any inference
+ * with the error and the sequence number
+ */
+static void expect_error(const char *name, const std::vector<uint8_t> &stream, int status, int seq)
+{
+    char expected[64];
+    snprintf(expected, sizeof(expected), "ERR %s %d\r\n", ei_frame_status_str(status), seq);
+
+    bool ok = run_static(stream);
+    std::string what = std::string(name) + ": " + expected;
+    what.resize(what.size() - 2);
+    check(!ok, (what + " (rejected)").c_str());
+    check(console_has(expected), (what + " (reported)").c_str());
+    check(classify_calls == 0, (what + " (no inference)").c_str());
+    check(console_ends_with("END OUTPUT\r\n"), (what + " (END OUTPUT)").c_str());
+    printf("  %-28s %s", name, expected);
+}
+
+static void test_corrupted_streams(void)
+{
+    std::vector<float> features(FEATURES, 0.5f);
+    const uint8_t *bytes = (const uint8_t *)features.data();
+    const size_t size = features.size() * sizeof(float);
+    const size_t frame_size = EI_FRAME_MAX_PAYLOAD + EI_FRAME_OVERHEAD;
+
+    /* Whole frames, so the offset of the third frame is known */
+    std::vector<uint8_t> good;
+    uint8_t seq = 0;
+    for (size_t pos = 0; pos < size; pos += EI_FRAME_MAX_PAYLOAD, seq++) {
+        size_t length = size - pos < EI_FRAME_MAX_PAYLOAD ? size - pos : EI_FRAME_MAX_PAYLOAD;
+        append_frame(good, EI_FRAME_DATA, seq, bytes + pos, (uint16_t)length);
+    }
+    const uint8_t data_frames = seq;
+    std::vector<uint8_t> end_frame;
+    uint8_t total[4] = { (uint8_t)size, (uint8_t)(size >> 8), (uint8_t)(size >> 16), (uint8_t)(size >> 24) };
+    append_frame(end_frame, EI_FRAME_END, data_frames, total, sizeof(total));
+
+    printf("corrupted streams:\n");
+
+    std::vector<uint8_t> stream = good;
+    stream.insert(stream.end(), end_frame.begin(), end_frame.end());
+    stream[0] ^= 0xff;
+    expect_error("bad sync", stream, EI_FRAME_ERR_SYNC, 0);
+
+    stream = good;
+    stream.insert(stream.end(), end_frame.begin(), end_frame.end());
+    stream[2 * frame_size + EI_FRAME_HEADER_SIZE + 100] ^= 0x10;
+    expect_error("bit flip in a payload", stream, EI_FRAME_ERR_CRC, 2);
+
+    stream = good;
+    stream.insert(stream.end(), end_frame.begin(), end_frame.end());
+    stream[3 * frame_size + 5] ^= 0x04;
+    expect_error("bit flip in a length", stream, EI_FRAME_ERR_CRC, 3);
+
+    stream = good;
+    stream.insert(stream.end(), end_frame.begin(), end_frame.end());
+    stream[3 * frame_size + 4] ^= 0x01;
+    expect_error("length over the maximum", stream, EI_FRAME_ERR_LENGTH, 3);
+
+    /* Frame 3 left out */
+    stream.assign(good.begin(), good.begin() + 3 * frame_size);
+    stream.insert(stream.end(), good.begin() + 4 * frame_size, good.end());
+    stream.insert(stream.end(), end_frame.begin(), end_frame.end());
+    expect_error("lost frame", stream, EI_FRAME_ERR_SEQUENCE, 3);
+
+    stream.assign(good.begin(), good.end() - 100);
+    expect_error("truncated", stream, EI_FRAME_ERR_TIMEOUT, data_frames - 1);
+
+    stream = good;
+    expect_error("no END", stream, EI_FRAME_ERR_TIMEOUT, data_frames);
+
+    stream = good;
+    uint8_t wrong_total[4] = { (uint8_t)(size + 4), (uint8_t)((size + 4) >> 8), 0, 0 };
+    append_frame(stream, EI_FRAME_END, data_frames, wrong_total, sizeof(wrong_total));
+    expect_error("END total", stream, EI_FRAME_ERR_LENGTH, data_frames);
+
+    stream = good;
+    append_frame(stream, EI_FRAME_DATA, data_frames, bytes, 8);
+    stream.insert(stream.end(), end_frame.begin(), end_frame.end());
+    expect_error("more data than features", stream, EI_FRAME_ERR_LENGTH, data_frames);
+}
+
+static bool read_back(bool binary, size_t address, size_t length)
+{
+    sent.clear();
+    single_byte_writes = 0;
+    ei_frame_set_binary_mode(binary);
+
+    return read_encode_send_sample_buffer(address, length);
+}
+
+static void test_read_buffer(void)
+{
+    const size_t memory_size = MEMORY_BLOCK_SIZE * MEMORY_BLOCKS;
+    std::vector<uint8_t> memory(memory_size);
+    for (uint8_t &b : memory) {
+        b = (uint8_t)rng();
+    }
+    device.ram.write_sample_data(memory.data(), 0, memory_size);
+
+    std::vector<uint8_t> data;
+    uint32_t total = 0;
+    const size_t address = 100, length = 5000;
+
+    bool ok = read_back(true, address, length);
+    check(ok, "binary readback: read");
+    check(decode_transfer(sent, data, total), "binary readback: DATA frames closed by END");
+    check(total == length, "binary readback: END total");
+    check(data.size() == length && memcmp(data.data(), &memory[address], length) == 0,
+        "binary readback: data match the sample memory");
+    check(single_byte_writes == 0, "binary readback: whole buffers written");
+    printf("binary readback: %zu bytes in %zu bytes of frames\n", length, sent.size());
+
+    ok = read_back(false, address, length);
+    std::vector<unsigned char> decoded = base64_decode(std::string(sent.begin(), sent.end()));
+    check(ok, "base64 readback: read");
+    check(decoded.size() == length && memcmp(decoded.data(), &memory[address], length) == 0,
+        "base64 readback: data match the sample memory");
+    check(single_byte_writes == 0, "base64 readback: whole buffers written");
+    printf("base64 readback: %zu bytes in %zu characters\n", length, sent.size());
+
+    /* Past the end of the memory, the read that crosses it comes back short */
+    const size_t failing_address = 4000, failing_length = 8000;
+    ok = read_back(true, failing_address, failing_length);
+    check(!ok, "failed readback: reported");
+    check(decode_transfer(sent, data, total), "failed readback: still closed by END");
+    check(total == data.size() && total < failing_length, "failed readback: END total is what was sent");
+    check(memcmp(data.data(), &memory[failing_address], data.size()) == 0, "failed readback: data sent match");
+    printf("failed readback: %u of %zu bytes, then END\n", total, failing_length);
+}
+
+int main(void)
+{
+    impulse.categories = categories;
+
+    test_static_data();
+    test_corrupted_streams();
+    test_read_buffer();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,620 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host check and benchmark of the CMSIS-NN forks of TFLite Micro kernels
+ * (EI_CLASSIFIER_TFLITE_ENABLE_CMSIS_NN=1) against the reference kernels:
+ *
+ *  - TRANSPOSE_CONV int8 and 16x8: random shapes, filters, strides, padding and
+ *    zero points, through the registrations of both kernels
+ *    (reference_transpose_conv.cc builds the reference one)
+ *  - BATCH_MATMUL int8: random shapes, broadcast batches, adjoints and zero
+ *    points, a RHS zero point falling back to the reference code
+ *    (reference_batch_matmul.cc)
+ *  - UNIDIRECTIONAL_SEQUENCE_LSTM: the integer gate math of lstm_eval.cc
+ *    (lstm_internal::FullyConnected() and Mul()) against the reference_integer_ops
+ *    functions it called before
+ *
+ * Every output must match the reference bit for bit, it returns 1 otherwise.
+ * Then it times both kernels on a few layers. The CMSIS-NN kernels run their C
+ * code on the host (the DSP extension emulated), so the timings are only
+ * relative to each other.
+ *
+ * Usage:
+ *     test_cmsis_kernels
+ */
+
+#include "edge-impulse-sdk/tensorflow/lite/c/builtin_op_data.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/quantization_util.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/reference/integer_ops/mul.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/kernels/lstm_eval.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/kernels/micro_ops.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/test_helpers.h"
+
+#include "bench_kernel_runner.h"
+#include "bench_util.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace tflite {
+TfLiteRegistration Register_TRANSPOSE_CONV_REFERENCE();
+TfLiteRegistration Register_BATCH_MATMUL_REFERENCE();
+}
+
+#define TRANSPOSE_CONV_CASES        400
+#define BATCH_MATMUL_CASES          400
+#define LSTM_CASES                  400
+#define ARENA_SIZE                  (1024 * 1024)
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static int random_int(int min, int max)
+{
+    return std::uniform_int_distribution<int>(min, max)(rng);
+}
+
+static float random_float(float min, float max)
+{
+    return std::uniform_real_distribution<float>(min, max)(rng);
+}
+
+template<typename T>
+static void random_fill(std::vector<T> &values, int min, int max)
+{
+    std::uniform_int_distribution<int> value(min, max);
+    for (T &v : values) {
+        v = (T)value(rng);
+    }
+}
+
+typedef struct {
+    int input_height;
+    int input_width;
+    int input_depth;
+    int output_depth;
+    int filter_height;
+    int filter_width;
+    int stride_height;
+    int stride_width;
+    TfLitePadding padding;
+} transpose_conv_shape_t;
+
+/**
+ * @brief A quantized transpose convolution: 1 batch, int8 (int32 bias) or
+ * 16x8 (int16 input and output, int8 filter, int64 bias), filter per channel
+ */
+template<typename io_t, typename bias_t>
+struct transpose_conv_layer {
+    transpose_conv_shape_t shape;
+    int output_height;
+    int output_width;
+
+    int32_t output_shape[4];
+    std::vector<int8_t> filter;
+    std::vector<io_t> input;
+    std::vector<bias_t> bias;
+    std::vector<io_t> output;
+
+    /* Sizes first, as the TFLite Micro test helpers take them */
+    std::vector<float> filter_scales;
+    std::vector<int> filter_zero_points;
+    TfLiteAffineQuantization filter_quantization;
+
+    int output_shape_dims[2];
+    int filter_dims[5];
+    int input_dims[5];
+    int bias_dims[2];
+    int output_dims[5];
+    int inputs_array[5];
+    int outputs_array[2];
+    TfLiteTensor tensors[5];
+    TfLiteTransposeConvParams params;
+
+    transpose_conv_layer(const transpose_conv_shape_t &shape)
+        : shape(shape)
+    {
+        const bool is_16x8 = sizeof(io_t) == 2;
+        if (shape.padding == kTfLitePaddingSame) {
+            output_height = shape.input_height * shape.stride_height;
+            output_width = shape.input_width * shape.stride_width;
+        }
+        else {
+            output_height = (shape.input_height - 1) * shape.stride_height + shape.filter_height;
+            output_width = (shape.input_width - 1) * shape.stride_width + shape.filter_width;
+        }
+
+        const int accumulated = shape.filter_height * shape.filter_width * shape.input_depth;
+        const float input_scale = is_16x8 ? 1.0f / 32768 : 1.0f / 128;
+        const float filter_scale = 1.0f / 128;
+        /* Outputs mostly within range, a few saturated */
+        const float output_scale = input_scale * filter_scale * sqrtf((float)accumulated) * (is_16x8 ? 2.0f : 60.0f);
+        const int input_zero_point = is_16x8 ? 0 : random_int(-20, 20);
+        const int output_zero_point = is_16x8 ? 0 : random_int(-20, 20);
+
+        filter.resize(shape.output_depth * accumulated);
+        input.resize(shape.input_height * shape.input_width * shape.input_depth);
+        bias.resize(shape.output_depth);
+        output.resize(output_height * output_width * shape.output_depth);
+        random_fill(filter, -127, 127);
+        random_fill(input, std::numeric_limits<io_t>::min(), std::numeric_limits<io_t>::max());
+        random_fill(bias, -(1 << 14), 1 << 14);
+
+        filter_scales.resize(shape.output_depth + 1);
+        filter_zero_points.resize(shape.output_depth + 1);
+        filter_scales[0] = (float)shape.output_depth;
+        filter_zero_points[0] = shape.output_depth;
+        for (int c = 1; c <= shape.output_depth; c++) {
+            filter_scales[c] = filter_scale * random_float(0.5f, 1.5f);
+            filter_zero_points[c] = 0;
+        }
+        filter_quantization.scale = tflite::testing::FloatArrayFromFloats(filter_scales.data());
+        filter_quantization.zero_point = tflite::testing::IntArrayFromInts(filter_zero_points.data());
+        filter_quantization.quantized_dimension = 0;
+
+        output_shape[0] = 1;
+        output_shape[1] = output_height;
+        output_shape[2] = output_width;
+        output_shape[3] = shape.output_depth;
+        set_dims(output_shape_dims, 1, 4, 0, 0, 0);
+        set_dims(filter_dims, 4, shape.output_depth, shape.filter_height, shape.filter_width, shape.input_depth);
+        set_dims(input_dims, 4, 1, shape.input_height, shape.input_width, shape.input_depth);
+        set_dims(bias_dims, 1, shape.output_depth, 0, 0, 0);
+        set_dims(output_dims, 4, 1, output_height, output_width, shape.output_depth);
+
+        tensors[0] = tflite::testing::CreateTensor(output_shape, tflite::testing::IntArrayFromInts(output_shape_dims));
+        tensors[1] = tflite::testing::CreateTensor(filter.data(), tflite::testing::IntArrayFromInts(filter_dims));
+        tensors[1].quantization = { kTfLiteAffineQuantization, &filter_quantization };
+        tensors[2] = tflite::testing::CreateQuantizedTensor(input.data(), tflite::testing::IntArrayFromInts(input_dims),
+            input_scale, input_zero_point);
+        tensors[3] = tflite::testing::CreateTensor(bias.data(), tflite::testing::IntArrayFromInts(bias_dims));
+        tensors[4] = tflite::testing::CreateQuantizedTensor(output.data(), tflite::testing::IntArrayFromInts(output_dims),
+            output_scale, output_zero_point);
+
+        inputs_array[0] = 4;
+        inputs_array[1] = 0;
+        inputs_array[2] = 1;
+        inputs_array[3] = 2;
+        inputs_array[4] = 3;
+        outputs_array[0] = 1;
+        outputs_array[1] = 4;
+
+        params.padding = shape.padding;
+        params.stride_width = shape.stride_width;
+        params.stride_height = shape.stride_height;
+        params.activation = kTfLiteActNone;
+    }
+
+    static void set_dims(int *dims, int size, int d0, int d1, int d2, int d3)
+    {
+        dims[0] = size;
+        dims[1] = d0;
+        if (size > 1) {
+            dims[2] = d1;
+            dims[3] = d2;
+            dims[4] = d3;
+        }
+    }
+
+    /* Multiply-accumulates of the reference scatter, and of the stride 1
+       convolution over the upsampled input */
+    double reference_macs() const
+    {
+        return (double)shape.input_height * shape.input_width * shape.input_depth * shape.filter_height
+            * shape.filter_width * shape.output_depth;
+    }
+
+    double upsampled_macs() const
+    {
+        return (double)output_height * output_width * shape.output_depth * shape.filter_height * shape.filter_width
+            * shape.input_depth;
+    }
+};
+
+/**
+ * @brief A quantized batch matmul, int8, rank 4 with broadcast batches
+ */
+struct batch_matmul_layer {
+    int lhs_shape[4];
+    int rhs_shape[4];
+    int out_shape[4];
+    bool adj_x;
+    bool adj_y;
+
+    std::vector<int8_t> lhs;
+    std::vector<int8_t> rhs;
+    std::vector<int8_t> output;
+
+    int lhs_dims[5];
+    int rhs_dims[5];
+    int output_dims[5];
+    int inputs_array[3];
+    int outputs_array[2];
+    TfLiteTensor tensors[3];
+    TfLiteBatchMatMulParams params;
+
+    batch_matmul_layer(const int *lhs_batches, const int *rhs_batches, int rows, int depth, int cols, bool adj_x,
+        bool adj_y, int rhs_zero_point)
+        : adj_x(adj_x),
+          adj_y(adj_y)
+    {
+        for (int i = 0; i < 2; i++) {
+            lhs_shape[i] = lhs_batches[i];
+            rhs_shape[i] = rhs_batches[i];
+            out_shape[i] = lhs_batches[i] > rhs_batches[i] ? lhs_batches[i] : rhs_batches[i];
+        }
+        lhs_shape[2] = adj_x ? depth : rows;
+        lhs_shape[3] = adj_x ? rows : depth;
+        rhs_shape[2] = adj_y ? cols : depth;
+        rhs_shape[3] = adj_y ? depth : cols;
+        out_shape[2] = rows;
+        out_shape[3] = cols;
+
+        lhs.resize(lhs_shape[0] * lhs_shape[1] * rows * depth);
+        rhs.resize(rhs_shape[0] * rhs_shape[1] * depth * cols);
+        output.resize(out_shape[0] * out_shape[1] * rows * cols);
+        random_fill(lhs, -128, 127);
+        random_fill(rhs, -128, 127);
+
+        set_dims(lhs_dims, lhs_shape);
+        set_dims(rhs_dims, rhs_shape);
+        set_dims(output_dims, out_shape);
+
+        const float lhs_scale = 1.0f / 128;
+        const float rhs_scale = 1.0f / 128;
+        const float output_scale = lhs_scale * rhs_scale * sqrtf((float)depth) * 60.0f;
+        tensors[0] = tflite::testing::CreateQuantizedTensor(lhs.data(), tflite::testing::IntArrayFromInts(lhs_dims),
+            lhs_scale, random_int(-20, 20));
+        tensors[1] = tflite::testing::CreateQuantizedTensor(rhs.data(), tflite::testing::IntArrayFromInts(rhs_dims),
+            rhs_scale, rhs_zero_point);
+        tensors[2] = tflite::testing::CreateQuantizedTensor(output.data(),
+            tflite::testing::IntArrayFromInts(output_dims), output_scale, random_int(-20, 20));
+
+        inputs_array[0] = 2;
+        inputs_array[1] = 0;
+        inputs_array[2] = 1;
+        outputs_array[0] = 1;
+        outputs_array[1] = 2;
+
+        params.adj_x = adj_x;
+        params.adj_y = adj_y;
+        params.asymmetric_quantize_inputs = false;
+    }
+
+    static void set_dims(int *dims, const int *shape)
+    {
+        dims[0] = 4;
+        for (int i = 0; i < 4; i++) {
+            dims[i + 1] = shape[i];
+        }
+    }
+};
+
+/**
+ * @brief Runs the layer through a registration, false if Prepare or Invoke fails
+ */
+template<typename layer_t, typename out_t>
+static bool run_layer(const TfLiteRegistration &registration, layer_t &layer, std::vector<out_t> &out,
+    double *us = nullptr)
+{
+    /* Prepare may point the dims of the tensors into the arena of the runner */
+    std::vector<TfLiteTensor> tensors(layer.tensors, layer.tensors + sizeof(layer.tensors) / sizeof(layer.tensors[0]));
+    BenchKernelRunner runner(registration, tensors.data(), tensors.size(),
+        tflite::testing::IntArrayFromInts(layer.inputs_array), tflite::testing::IntArrayFromInts(layer.outputs_array),
+        &layer.params, ARENA_SIZE);
+    if (runner.InitAndPrepare() != kTfLiteOk || runner.Invoke() != kTfLiteOk) {
+        return false;
+    }
+    out = layer.output;
+    if (us) {
+        *us = time_us([&]() { runner.Invoke(); });
+    }
+    return true;
+}
+
+static transpose_conv_shape_t random_transpose_conv_shape(void)
+{
+    transpose_conv_shape_t shape;
+    shape.input_height = random_int(1, 9);
+    shape.input_width = random_int(1, 9);
+    shape.input_depth = random_int(1, 20);
+    shape.output_depth = random_int(2, 20);
+    shape.filter_height = random_int(1, 5);
+    shape.filter_width = random_int(1, 5);
+    shape.stride_height = random_int(1, 3);
+    shape.stride_width = random_int(1, 3);
+    shape.padding = random_int(0, 1) ? kTfLitePaddingSame : kTfLitePaddingValid;
+    return shape;
+}
+
+template<typename io_t, typename bias_t>
+static size_t check_transpose_conv(size_t *compared)
+{
+    size_t mismatches = 0;
+    for (int i = 0; i < TRANSPOSE_CONV_CASES; i++) {
+        transpose_conv_layer<io_t, bias_t> layer(random_transpose_conv_shape());
+        std::vector<io_t> reference, cmsis;
+        if (!run_layer(tflite::Register_TRANSPOSE_CONV_REFERENCE(), layer, reference)
+            || !run_layer(tflite::Register_TRANSPOSE_CONV(), layer, cmsis)) {
+            mismatches++;
+            continue;
+        }
+        for (size_t ix = 0; ix < reference.size(); ix++) {
+            mismatches += reference[ix] != cmsis[ix];
+        }
+        *compared += reference.size();
+    }
+    return mismatches;
+}
+
+static size_t check_batch_matmul(size_t *compared)
+{
+    size_t mismatches = 0;
+    for (int i = 0; i < BATCH_MATMUL_CASES; i++) {
+        int lhs_batches[2], rhs_batches[2];
+        for (int b = 0; b < 2; b++) {
+            int batch = random_int(1, 3);
+            int broadcast = random_int(0, 2);
+            lhs_batches[b] = broadcast == 1 ? 1 : batch;
+            rhs_batches[b] = broadcast == 2 ? 1 : batch;
+        }
+        /* One case in four with a RHS zero point, run by the reference code */
+        batch_matmul_layer layer(lhs_batches, rhs_batches, random_int(1, 24), random_int(1, 40), random_int(1, 24),
+            random_int(0, 1), random_int(0, 1), random_int(0, 3) == 0 ? random_int(-10, 10) : 0);
+        std::vector<int8_t> reference, cmsis;
+        if (!run_layer(tflite::Register_BATCH_MATMUL_REFERENCE(), layer, reference)
+            || !run_layer(tflite::Register_BATCH_MATMUL(), layer, cmsis)) {
+            mismatches++;
+            continue;
+        }
+        for (size_t ix = 0; ix < reference.size(); ix++) {
+            mismatches += reference[ix] != cmsis[ix];
+        }
+        *compared += reference.size();
+    }
+    return mismatches;
+}
+
+/**
+ * @brief A gate of the integer LSTM: input times weights plus bias, to int16
+ */
+template<typename input_t, typename bias_t>
+struct lstm_gate {
+    int batches;
+    int depth;
+    int cells;
+    std::vector<input_t> input;
+    std::vector<int8_t> weights;
+    std::vector<bias_t> bias;
+    tflite::FullyConnectedParams params;
+
+    lstm_gate(int batches, int depth, int cells)
+        : batches(batches),
+          depth(depth),
+          cells(cells),
+          input(batches * depth),
+          weights(cells * depth),
+          bias(cells)
+    {
+        random_fill(input, std::numeric_limits<input_t>::min(), std::numeric_limits<input_t>::max());
+        random_fill(weights, -127, 127);
+        random_fill(bias, -(1 << 16), 1 << 16);
+
+        /* int8 input with a zero point, int16 input symmetric, as the kernel quantizes them */
+        params.input_offset = sizeof(input_t) == 1 ? random_int(-128, 127) : 0;
+        params.weights_offset = 0;
+        params.output_offset = 0;
+        tflite::QuantizeMultiplier(random_float(1e-4f, sizeof(input_t) == 1 ? 0.5f : 2e-3f), &params.output_multiplier,
+            &params.output_shift);
+        params.quantized_activation_min = std::numeric_limits<int16_t>::min();
+        params.quantized_activation_max = std::numeric_limits<int16_t>::max();
+    }
+
+    void run(bool reference, std::vector<int16_t> &out) const
+    {
+        const int input_shape[] = { batches, depth };
+        const int weights_shape[] = { cells, depth };
+        const int output_shape[] = { batches, cells };
+        out.resize(batches * cells);
+        if (reference) {
+            tflite::reference_integer_ops::FullyConnected(params, tflite::RuntimeShape(2, input_shape), input.data(),
+                tflite::RuntimeShape(2, weights_shape), weights.data(), tflite::RuntimeShape(1, &cells), bias.data(),
+                tflite::RuntimeShape(2, output_shape), out.data());
+        }
+        else {
+            tflite::lstm_internal::FullyConnected(params, tflite::RuntimeShape(2, input_shape), input.data(),
+                tflite::RuntimeShape(2, weights_shape), weights.data(), tflite::RuntimeShape(1, &cells), bias.data(),
+                tflite::RuntimeShape(2, output_shape), out.data());
+        }
+    }
+};
+
+/**
+ * @brief The element wise product of the LSTM (gates and cell state), int16
+ */
+struct lstm_mul {
+    int size;
+    std::vector<int16_t> input1;
+    std::vector<int16_t> input2;
+    tflite::ArithmeticParams params;
+
+    lstm_mul(int size)
+        : size(size),
+          input1(size),
+          input2(size)
+    {
+        random_fill(input1, -32768, 32767);
+        random_fill(input2, -32768, 32767);
+        params.input1_offset = 0;
+        params.input2_offset = 0;
+        params.output_offset = 0;
+        tflite::QuantizeMultiplier(random_float(1.0f / 65536, 1.0f / 16384), &params.output_multiplier, &params.output_shift);
+        /* Full range, or clamped as a gate with a smaller cell state */
+        params.quantized_activation_min = random_int(0, 1) ? -32768 : -random_int(1, 32767);
+        params.quantized_activation_max = random_int(0, 1) ? 32767 : random_int(0, 32767);
+    }
+
+    void run(bool reference, std::vector<int16_t> &out) const
+    {
+        out.resize(size);
+        if (reference) {
+            tflite::reference_integer_ops::MulElementwise(size, params, input1.data(), input2.data(), out.data());
+        }
+        else {
+            tflite::lstm_internal::Mul(tflite::RuntimeShape(1, &size), params, input1.data(), input2.data(),
+                out.data());
+        }
+    }
+};
+
+template<typename op_t>
+static size_t compare(const op_t &op, size_t *compared)
+{
+    std::vector<int16_t> reference, cmsis;
+    op.run(true, reference);
+    op.run(false, cmsis);
+    size_t mismatches = 0;
+    for (size_t ix = 0; ix < reference.size(); ix++) {
+        mismatches += reference[ix] != cmsis[ix];
+    }
+    *compared += reference.size();
+    return mismatches;
+}
+
+static size_t check_lstm(size_t *compared)
+{
+    size_t mismatches = 0;
+    for (int i = 0; i < LSTM_CASES; i++) {
+        int batches = random_int(1, 4);
+        int depth = random_int(1, 70);
+        int cells = random_int(1, 40);
+        mismatches += compare(lstm_gate<int8_t, int32_t>(batches, depth, cells), compared);
+        mismatches += compare(lstm_gate<int16_t, int64_t>(batches, cells, cells), compared);
+        mismatches += compare(lstm_mul(batches * cells), compared);
+    }
+    return mismatches;
+}
+
+template<typename io_t, typename bias_t>
+static void bench_transpose_conv(const char *name, const transpose_conv_shape_t &shape)
+{
+    transpose_conv_layer<io_t, bias_t> layer(shape);
+    std::vector<io_t> reference, cmsis;
+    double reference_us = 0, cmsis_us = 0;
+    bool ok = run_layer(tflite::Register_TRANSPOSE_CONV_REFERENCE(), layer, reference, &reference_us)
+        && run_layer(tflite::Register_TRANSPOSE_CONV(), layer, cmsis, &cmsis_us);
+    check(ok && reference == cmsis, name);
+    printf("%-44s %5.2fx %10.1f %10.1f %6.2fx\n", name, layer.upsampled_macs() / layer.reference_macs(),
+        reference_us, cmsis_us, reference_us / cmsis_us);
+}
+
+static void bench_batch_matmul(const char *name, const int *batches, int rows, int depth, int cols, bool adj_y)
+{
+    batch_matmul_layer layer(batches, batches, rows, depth, cols, false, adj_y, 0);
+    std::vector<int8_t> reference, cmsis;
+    double reference_us = 0, cmsis_us = 0;
+    bool ok = run_layer(tflite::Register_BATCH_MATMUL_REFERENCE(), layer, reference, &reference_us)
+        && run_layer(tflite::Register_BATCH_MATMUL(), layer, cmsis, &cmsis_us);
+    check(ok && reference == cmsis, name);
+    printf("%-44s %6s %10.1f %10.1f %6.2fx\n", name, "", reference_us, cmsis_us, reference_us / cmsis_us);
+}
+
+template<typename op_t>
+static void bench_lstm(const char *name, const op_t &op)
+{
+    std::vector<int16_t> reference, cmsis;
+    double reference_us = time_us([&]() { op.run(true, reference); });
+    double cmsis_us = time_us([&]() { op.run(false, cmsis); });
+    check(reference == cmsis, name);
+    printf("%-44s %6s %10.1f %10.1f %6.2fx\n", name, "", reference_us, cmsis_us, reference_us / cmsis_us);
+}
+
+int main(void)
+{
+    size_t compared = 0, mismatches = 0;
+    mismatches = check_transpose_conv<int8_t, int32_t>(&compared);
+    printf("TRANSPOSE_CONV int8: %d random layers, mismatches %zu/%zu\n", TRANSPOSE_CONV_CASES, mismatches, compared);
+    check(mismatches == 0, "TRANSPOSE_CONV int8 bit exact");
+
+    compared = 0;
+    mismatches = check_transpose_conv<int16_t, int64_t>(&compared);
+    printf("TRANSPOSE_CONV 16x8: %d random layers, mismatches %zu/%zu\n", TRANSPOSE_CONV_CASES, mismatches, compared);
+    check(mismatches == 0, "TRANSPOSE_CONV 16x8 bit exact");
+
+    compared = 0;
+    mismatches = check_batch_matmul(&compared);
+    printf("BATCH_MATMUL int8: %d random layers, mismatches %zu/%zu\n", BATCH_MATMUL_CASES, mismatches, compared);
+    check(mismatches == 0, "BATCH_MATMUL int8 bit exact");
+
+    compared = 0;
+    mismatches = check_lstm(&compared);
+    printf("LSTM gates: %d random gates and products, mismatches %zu/%zu\n", LSTM_CASES, mismatches, compared);
+    check(mismatches == 0, "LSTM gates bit exact");
+
+    printf("\n%-44s %6s %10s %10s\n", "", "MACs", "reference", "CMSIS-NN");
+    bench_transpose_conv<int8_t, int32_t>("TRANSPOSE_CONV int8 16x16x16 to 16x16x16 s1",
+        { 16, 16, 16, 16, 3, 3, 1, 1, kTfLitePaddingSame });
+    bench_transpose_conv<int8_t, int32_t>("TRANSPOSE_CONV int8 8x8x32 to 16x16x16 s2",
+        { 8, 8, 32, 16, 3, 3, 2, 2, kTfLitePaddingSame });
+    bench_transpose_conv<int8_t, int32_t>("TRANSPOSE_CONV int8 16x16x16 to 32x32x8 s2",
+        { 16, 16, 16, 8, 3, 3, 2, 2, kTfLitePaddingSame });
+    bench_transpose_conv<int8_t, int32_t>("TRANSPOSE_CONV int8 16x16x16 to 32x32x8 s2 k2",
+        { 16, 16, 16, 8, 2, 2, 2, 2, kTfLitePaddingSame });
+    bench_transpose_conv<int16_t, int64_t>("TRANSPOSE_CONV 16x8 8x8x32 to 16x16x16 s2",
+        { 8, 8, 32, 16, 3, 3, 2, 2, kTfLitePaddingSame });
+
+    const int one_batch[] = { 1, 1 };
+    const int heads[] = { 1, 4 };
+    bench_batch_matmul("BATCH_MATMUL 64x64 by 64x64", one_batch, 64, 64, 64, false);
+    bench_batch_matmul("BATCH_MATMUL 4 heads 32x16 by 16x32 (adj_y)", heads, 32, 16, 32, true);
+
+    bench_lstm("LSTM gate 64 inputs to 128 cells, int8", lstm_gate<int8_t, int32_t>(1, 64, 128));
+    bench_lstm("LSTM gate 128 cells to 128 cells, int16", lstm_gate<int16_t, int64_t>(1, 128, 128));
+    bench_lstm("LSTM product of 128 cells", lstm_mul(128));
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
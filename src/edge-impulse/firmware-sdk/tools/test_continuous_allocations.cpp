@@ -0,0 +1,265 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @brief Host test of the heap traffic of run_classifier_continuous(), on the
+ * impulse of the firmware, built as on the device (static tensor arena,
+ * persistent interpreter) with EI_CLASSIFIER_COUNT_ALLOCATIONS=1:
+ *
+ *  - run_classifier_init() allocates the workspace, the slices reuse it and
+ *    the first one doesn't allocate it
+ *  - once the window is full, every slice makes the same ei_malloc() and
+ *    ei_calloc() calls (run_classifier_continuous_allocations()) and frees
+ *    all of them: the DSP and the copy of the model outputs, nothing grows
+ *  - run_classifier_init() again starts over with the same scores
+ *  - when an allocation of the workspace fails in run_classifier_init(), the
+ *    slices return EI_IMPULSE_ALLOC_FAILED without allocating it, and run after
+ *    run_classifier_init() again
+ *
+ * Prints the allocations of every slice of the first windows, returns 1 on a
+ * failed check.
+ *
+ * Usage:
+ *     test_continuous_allocations
+ */
+
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include "bench_util.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#if EI_CLASSIFIER_COUNT_ALLOCATIONS != 1
+#error "Build with EI_CLASSIFIER_COUNT_ALLOCATIONS=1"
+#endif
+
+/* Slices run in a test, the steady state starts after two windows */
+#define SLICES                      (4 * EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW)
+#define WARMUP_SLICES               (2 * EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW)
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* The posix porting is built without EI_CLASSIFIER_COUNT_ALLOCATIONS, the
+   count and the allocator that increments it are here */
+uint32_t ei_allocation_count = 0;
+
+/* Allocation that fails, counted from the next one, -1 for none */
+static int fail_allocation = -1;
+static uint32_t free_count = 0;
+
+/* As the posix porting, but failing on demand */
+void *ei_malloc(size_t size)
+{
+    EI_COUNT_ALLOCATION();
+    if (fail_allocation >= 0 && fail_allocation-- == 0) {
+        return nullptr;
+    }
+    return malloc(size);
+}
+
+void *ei_calloc(size_t nitems, size_t size)
+{
+    EI_COUNT_ALLOCATION();
+    if (fail_allocation >= 0 && fail_allocation-- == 0) {
+        return nullptr;
+    }
+    return calloc(nitems, size);
+}
+
+void ei_free(void *ptr)
+{
+    if (ptr) {
+        free_count++;
+    }
+    free(ptr);
+}
+
+static std::vector<float> audio;
+static size_t slice_offset;
+
+static int get_slice_data(size_t offset, size_t length, float *out_ptr)
+{
+    for (size_t ix = 0; ix < length; ix++) {
+        out_ptr[ix] = audio[(slice_offset + offset + ix) % audio.size()];
+    }
+    return 0;
+}
+
+/**
+ * @brief Run slice number slice of the audio, the allocations of the slice in allocations
+ */
+static EI_IMPULSE_ERROR run_slice(size_t slice, ei_impulse_result_t *result, uint32_t *allocations)
+{
+    signal_t signal;
+    signal.total_length = EI_CLASSIFIER_SLICE_SIZE;
+    signal.get_data = &get_slice_data;
+    slice_offset = slice * EI_CLASSIFIER_SLICE_SIZE;
+
+    uint32_t before = run_classifier_continuous_allocations();
+    EI_IMPULSE_ERROR res = run_classifier_continuous(&signal, result, false);
+    *allocations = run_classifier_continuous_allocations() - before;
+    return res;
+}
+
+static float score_sum(const ei_impulse_result_t &result)
+{
+    float sum = 0;
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        sum += result.classification[ix].value * (ix + 1);
+    }
+    return sum;
+}
+
+/**
+ * @brief Run SLICES slices, print their allocations, and return the scores of the last one
+ */
+static float run_slices(bool print)
+{
+    ei_impulse_result_t result;
+    uint32_t allocations;
+    uint32_t slice_allocations = 0;
+    bool ok = true;
+    bool same_allocations = true;
+    bool all_freed = true;
+    bool same_workspace = true;
+
+    run_classifier_init();
+    const ei_impulse_workspace *workspace = ei_default_impulse.workspace;
+    check(workspace != nullptr, "workspace allocated by run_classifier_init()");
+
+    if (print) {
+        printf("slice  allocations\n");
+    }
+    ok &= run_slice(0, &result, &allocations) == EI_IMPULSE_OK;
+    check(ei_default_impulse.workspace == workspace, "workspace not allocated again by the first slice");
+    if (print) {
+        printf("%5u  %11u\n", 0, (unsigned)allocations);
+    }
+
+    for (size_t slice = 1; slice < SLICES; slice++) {
+        uint32_t frees = free_count;
+        ok &= run_slice(slice, &result, &allocations) == EI_IMPULSE_OK;
+        if (print && slice <= WARMUP_SLICES) {
+            printf("%5u  %11u\n", (unsigned)slice, (unsigned)allocations);
+        }
+        if (slice == WARMUP_SLICES) {
+            slice_allocations = allocations;
+        }
+        if (slice >= WARMUP_SLICES) {
+            same_allocations &= allocations == slice_allocations;
+            all_freed &= free_count - frees == allocations;
+        }
+        same_workspace &= ei_default_impulse.workspace == workspace;
+    }
+    if (print) {
+        printf("slices %u to %u: %u allocations each, all freed in the slice\n",
+            WARMUP_SLICES, SLICES - 1, (unsigned)slice_allocations);
+    }
+    check(ok, "slices run");
+    check(same_workspace, "workspace reused by the next slices");
+    check(same_allocations, "same allocations in every slice once the window is full");
+    check(all_freed, "every allocation of a slice freed in the slice");
+
+    run_classifier_deinit();
+    return score_sum(result);
+}
+
+/**
+ * @brief Fail each allocation of the workspace in turn: the slices return
+ * EI_IMPULSE_ALLOC_FAILED without allocating it, until run_classifier_init()
+ */
+static void test_failed_workspace(void)
+{
+    ei_impulse_result_t result;
+    uint32_t allocations;
+
+    run_classifier_init();
+    uint32_t before = run_classifier_continuous_allocations();
+    check(ei_impulse_workspace_init(&ei_default_impulse) == EI_IMPULSE_OK, "workspace allocated");
+    int workspace_allocations = (int)(run_classifier_continuous_allocations() - before);
+    run_classifier_deinit();
+
+    bool failed = true;
+    bool recovered = true;
+    for (int failing = 0; failing < workspace_allocations; failing++) {
+        // the workspace is the first allocation of run_classifier_init()
+        fail_allocation = failing;
+        run_classifier_init();
+        failed &= fail_allocation == -1 && ei_default_impulse.workspace == nullptr;
+        fail_allocation = -1;
+
+        for (size_t slice = 0; slice < 2; slice++) {
+            failed &= run_slice(slice, &result, &allocations) == EI_IMPULSE_ALLOC_FAILED;
+            failed &= allocations == 0 && ei_default_impulse.workspace == nullptr;
+        }
+
+        run_classifier_init();
+        for (size_t slice = 0; slice <= EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW; slice++) {
+            recovered &= run_slice(slice, &result, &allocations) == EI_IMPULSE_OK;
+        }
+        run_classifier_deinit();
+    }
+    printf("workspace: each of %d allocations failed in turn\n", workspace_allocations);
+    check(failed, "slices without a workspace return EI_IMPULSE_ALLOC_FAILED and don't allocate it");
+    check(recovered, "slices after run_classifier_init() again run");
+}
+
+int main(void)
+{
+    /* A chirp, so the windows differ */
+    audio.resize(EI_CLASSIFIER_RAW_SAMPLE_COUNT * 2);
+    std::normal_distribution<float> noise(0.0f, 200.0f);
+    for (size_t ix = 0; ix < audio.size(); ix++) {
+        float t = (float)ix / EI_CLASSIFIER_FREQUENCY;
+        audio[ix] = 8000.0f * sinf(2 * (float)M_PI * (200.0f + 400.0f * t) * t) + noise(rng);
+    }
+
+    float first = run_slices(true);
+    float again = run_slices(false);
+    check(first == again, "same scores after run_classifier_init()");
+
+    test_failed_workspace();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
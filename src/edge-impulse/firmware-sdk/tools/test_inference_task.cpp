@@ -0,0 +1,254 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host test of the inference task (src/inference_task.cpp), built
+ * against the FreeRTOS stand-ins of tools/platform-stub, with the impulse
+ * replaced by one that waits for slices like ei_mic_run_inference(). The
+ * event source is a fake audio DMA interrupt, a thread that fires every
+ * tick (1 ms), keeps firing while inference is stopped and notifies the task
+ * with INFERENCE_EVENT_SLICE_READY every SLICE_TICKS interrupts while it runs:
+ *
+ *  - started, the task runs one inference per slice and blocks in between
+ *  - stopped, it blocks on its notification and stays blocked: no wakeups,
+ *    no calls of ei_run_impulse() while the interrupt keeps firing
+ *  - stopped while waiting for a slice, the wait ends at once
+ *  - started again, it wakes up and runs again
+ *
+ * Returns 1 on a failed check.
+ *
+ * Usage:
+ *     test_inference_task
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "platform_stub.h"
+#include "inference_task.h"
+#include "inference/ei_run_impulse.h"
+#include "peripheral/usb/ei_usb.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <thread>
+
+/* Interrupts per slice, and ticks the test lets go by while stopped */
+#define SLICE_TICKS                 4
+#define STOPPED_TICKS               300
+/* Same wait as ei_mic_run_inference() */
+#define SLICE_WAIT_MS               1000
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* Impulse: the inference task runs it while is_inference_running() */
+static std::atomic<bool> running(false);
+static std::atomic<uint32_t> run_calls(0);
+static std::atomic<uint32_t> inferences(0);
+
+bool is_inference_running(void)
+{
+    return running;
+}
+
+void ei_start_impulse(bool continuous, bool debug, bool use_max_uart_speed)
+{
+    running = true;
+    inference_task_start();
+}
+
+void ei_stop_impulse(void)
+{
+    running = false;
+    inference_task_notify(INFERENCE_EVENT_STOP);
+}
+
+/* one inference per slice, returns early when stopped while waiting */
+void ei_run_impulse(void)
+{
+    run_calls++;
+
+    while (true) {
+        uint32_t events = inference_task_wait(SLICE_WAIT_MS);
+
+        if (!running) {
+            return;
+        }
+        if (events & INFERENCE_EVENT_SLICE_READY) {
+            break;
+        }
+    }
+
+    inferences++;
+}
+
+void ei_usb_flush(void)
+{
+}
+
+void ei_printf(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+/* Audio DMA interrupt, one per tick */
+static std::atomic<bool> dma_enabled(true);
+static std::atomic<uint32_t> interrupts(0);
+
+static void dma_interrupt(void)
+{
+    while (dma_enabled) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        uint32_t n = ++interrupts;
+
+        if (running && (n % SLICE_TICKS) == 0) {
+            inference_task_notify_from_isr(INFERENCE_EVENT_SLICE_READY);
+        }
+    }
+}
+
+static bool wait_for(std::function<bool(void)> done, uint32_t timeout_ms = 2000)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+static bool is_blocked(TaskHandle_t task)
+{
+    platform_stub_task_stats_t stats = platform_stub_task_stats(task);
+
+    return stats.blocks == stats.wakeups + 1;
+}
+
+static void print_stats(const char *phase, uint32_t ticks, uint32_t calls, uint32_t runs,
+    const platform_stub_task_stats_t &from, const platform_stub_task_stats_t &to)
+{
+    printf("%-9s %5u interrupts %5u ei_run_impulse() %5u inferences %5u wakeups\n",
+        phase, ticks, calls, runs, to.wakeups - from.wakeups);
+}
+
+int main(int argc, char **argv)
+{
+    std::thread dma(dma_interrupt);
+    TaskHandle_t task;
+    platform_stub_task_stats_t before, after;
+    uint32_t ticks, calls, runs;
+
+    // started: one inference per slice
+    ei_start_impulse(true, false);
+    task = platform_stub_find_task("Inference task");
+    check(task != NULL, "inference task is created");
+    if (task == NULL) {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    before = platform_stub_task_stats(task);
+    ticks = interrupts;
+    check(wait_for([]() { return inferences >= 25; }), "started task runs inferences");
+    after = platform_stub_task_stats(task);
+    print_stats("running", interrupts - ticks, run_calls, inferences, before, after);
+    check(after.wakeups - before.wakeups <= 2 * (uint32_t)inferences + 2, "running task wakes up once per slice");
+
+    // stopped: blocked on its notification while the interrupt keeps firing
+    ei_stop_impulse();
+    check(wait_for([task]() { return !running && is_blocked(task); }), "stopped task blocks");
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    before = platform_stub_task_stats(task);
+    calls = run_calls;
+    runs = inferences;
+    ticks = interrupts;
+    check(wait_for([ticks]() { return interrupts - ticks >= STOPPED_TICKS; }), "interrupt fires while stopped");
+    after = platform_stub_task_stats(task);
+    print_stats("stopped", interrupts - ticks, run_calls - calls, inferences - runs, before, after);
+    check(after.wakeups == before.wakeups, "no wakeups while stopped");
+    check(after.timeouts == before.timeouts, "no timed out waits while stopped");
+    check(run_calls == calls && inferences == runs, "no ei_run_impulse() while stopped");
+    check(is_blocked(task), "task still blocked while stopped");
+
+    // stopped while waiting for a slice: the slice wait ends at once
+    dma_enabled = false;
+    dma.join();
+    calls = run_calls;
+    running = true;
+    inference_task_notify(INFERENCE_EVENT_START);
+    check(wait_for([calls, task]() { return run_calls > calls && is_blocked(task); }), "task waits for a slice");
+    before = platform_stub_task_stats(task);
+    auto stop_time = std::chrono::steady_clock::now();
+    ei_stop_impulse();
+    check(wait_for([task, before]() {
+            return platform_stub_task_stats(task).blocks > before.blocks && is_blocked(task);
+        }, SLICE_WAIT_MS / 2), "stop ends the wait for a slice");
+    auto stop_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - stop_time).count();
+    printf("stop while waiting for a slice: blocked again after %lld ms\n", (long long)stop_ms);
+
+    // started again: runs again
+    dma_enabled = true;
+    dma = std::thread(dma_interrupt);
+    runs = inferences;
+    ei_start_impulse(true, false);
+    check(wait_for([runs]() { return inferences >= runs + 10; }), "restarted task runs inferences");
+    ei_stop_impulse();
+    check(wait_for([task]() { return is_blocked(task); }), "stopped again task blocks");
+
+    dma_enabled = false;
+    dma.join();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,234 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host test of the per layer profiler (EiLayerProfiler), on a fake tick
+ * source instead of the DWT and cache monitor counters:
+ *
+ *  - each event is attributed to the next layer of the inference, the cycles
+ *    and cache misses between BeginEvent and EndEvent are summed per layer,
+ *    with the worst case cycles
+ *  - the counters are correct across a wrap of the 32 bit hardware counters
+ *  - events past the table are dropped and counted, EndEvent ignores them
+ *  - an inference is only counted when Invoke() succeeded (end_inference),
+ *    a failed one leaves the count as it was
+ *  - reset() clears the table and the counts
+ *
+ * Returns 1 on a failed check.
+ *
+ * Usage:
+ *     test_layer_profiler
+ */
+
+#include "firmware-sdk/ei_layer_profiler.h"
+
+#include <cstdio>
+#include <cstring>
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* Fake tick source, advanced by the test between BeginEvent and EndEvent */
+static ei_layer_counters_t fake_counters;
+
+static void read_fake_counters(ei_layer_counters_t *counters)
+{
+    *counters = fake_counters;
+}
+
+static void advance(uint32_t cycles, uint32_t icache_misses, uint32_t dcache_misses)
+{
+    fake_counters.cycles += cycles;
+    fake_counters.icache_misses += icache_misses;
+    fake_counters.dcache_misses += dcache_misses;
+}
+
+/**
+ * @brief One operator of the interpreter, taking the given counts
+ */
+static uint32_t run_layer(EiLayerProfiler *profiler, const char *tag,
+    uint32_t cycles, uint32_t icache_misses, uint32_t dcache_misses)
+{
+    uint32_t handle = profiler->BeginEvent(tag);
+    advance(cycles, icache_misses, dcache_misses);
+    profiler->EndEvent(handle);
+    // time between the layers isn't attributed to any of them
+    advance(1000, 10, 10);
+    return handle;
+}
+
+static void test_aggregation(void)
+{
+    ei_layer_profile_t layers[4];
+    EiLayerProfiler profiler(layers, 4, &read_fake_counters);
+
+    fake_counters = { 0, 0, 0 };
+
+    // two inferences of a 3 layer model
+    profiler.start_inference();
+    run_layer(&profiler, "CONV_2D", 5000, 40, 100);
+    run_layer(&profiler, "FULLY_CONNECTED", 2000, 10, 50);
+    run_layer(&profiler, "SOFTMAX", 100, 1, 2);
+    profiler.end_inference();
+
+    profiler.start_inference();
+    run_layer(&profiler, "CONV_2D", 7000, 60, 300);
+    run_layer(&profiler, "FULLY_CONNECTED", 2000, 10, 50);
+    run_layer(&profiler, "SOFTMAX", 300, 3, 4);
+    profiler.end_inference();
+
+    check(profiler.get_inferences() == 2, "two inferences counted");
+    check(profiler.get_layer_count() == 3, "three layers");
+    check(profiler.get_dropped_events() == 0, "no dropped events");
+    check(profiler.get_layer(3) == nullptr, "no layer past the model");
+
+    const ei_layer_profile_t *conv = profiler.get_layer(0);
+    check(conv != nullptr && strcmp(conv->tag, "CONV_2D") == 0, "layer 0 tag");
+    check(conv != nullptr && conv->runs == 2, "layer 0 runs");
+    check(conv != nullptr && conv->cycles == 12000, "layer 0 cycles summed");
+    check(conv != nullptr && conv->cycles_max == 7000, "layer 0 worst case cycles");
+    check(conv != nullptr && conv->icache_misses == 100, "layer 0 instruction cache misses");
+    check(conv != nullptr && conv->dcache_misses == 400, "layer 0 data cache misses");
+
+    const ei_layer_profile_t *softmax = profiler.get_layer(2);
+    check(softmax != nullptr && strcmp(softmax->tag, "SOFTMAX") == 0, "layer 2 tag");
+    check(softmax != nullptr && softmax->cycles == 400 && softmax->cycles_max == 300, "layer 2 cycles");
+    check(softmax != nullptr && softmax->icache_misses == 4 && softmax->dcache_misses == 6, "layer 2 cache misses");
+
+    profiler.print_csv();
+
+    profiler.reset();
+    check(profiler.get_inferences() == 0, "reset clears the inferences");
+    check(profiler.get_layer_count() == 0, "reset clears the layers");
+    check(layers[0].runs == 0 && layers[0].cycles == 0, "reset clears the table");
+}
+
+static void test_wrap(void)
+{
+    ei_layer_profile_t layers[2];
+    EiLayerProfiler profiler(layers, 2, &read_fake_counters);
+
+    // all counters wrap during the layer
+    fake_counters = { UINT32_MAX - 99, UINT32_MAX - 4, UINT32_MAX };
+
+    profiler.start_inference();
+    run_layer(&profiler, "CONV_2D", 300, 10, 20);
+    profiler.end_inference();
+
+    const ei_layer_profile_t *layer = profiler.get_layer(0);
+    check(layer != nullptr && layer->cycles == 300 && layer->cycles_max == 300, "cycles across a wrap");
+    check(layer != nullptr && layer->icache_misses == 10, "instruction cache misses across a wrap");
+    check(layer != nullptr && layer->dcache_misses == 20, "data cache misses across a wrap");
+
+    // sums over inferences are wider than the counters
+    for (int i = 0; i < 3; i++) {
+        profiler.start_inference();
+        run_layer(&profiler, "CONV_2D", 0x80000000u, 0, 0);
+        profiler.end_inference();
+    }
+    check(layer != nullptr && layer->cycles == 300 + 3 * 0x80000000ull, "cycles summed past 32 bits");
+    check(layer != nullptr && layer->cycles_max == 0x80000000u, "worst case cycles of a long layer");
+}
+
+static void test_dropped(void)
+{
+    ei_layer_profile_t layers[2];
+    EiLayerProfiler profiler(layers, 2, &read_fake_counters);
+
+    fake_counters = { 0, 0, 0 };
+
+    // 3 layers, the table holds 2
+    for (int i = 0; i < 2; i++) {
+        profiler.start_inference();
+        run_layer(&profiler, "CONV_2D", 100, 0, 0);
+        run_layer(&profiler, "FULLY_CONNECTED", 200, 0, 0);
+        uint32_t handle = run_layer(&profiler, "SOFTMAX", 300, 0, 0);
+        check(handle >= 2, "event past the table gets a handle out of it");
+        profiler.end_inference();
+    }
+
+    check(profiler.get_dropped_events() == 2, "events past the table counted as dropped");
+    check(profiler.get_layer_count() == 2, "layers of the table only");
+    check(profiler.get_inferences() == 2, "inferences with dropped events counted");
+    check(layers[1].cycles == 400, "dropped events not attributed to the last layer");
+}
+
+static void test_failed_invoke(void)
+{
+    ei_layer_profile_t layers[4];
+    EiLayerProfiler profiler(layers, 4, &read_fake_counters);
+
+    fake_counters = { 0, 0, 0 };
+
+    profiler.start_inference();
+    run_layer(&profiler, "CONV_2D", 100, 0, 0);
+    run_layer(&profiler, "SOFTMAX", 10, 0, 0);
+    profiler.end_inference();
+
+    // Invoke() fails in the second layer: no end_inference()
+    profiler.start_inference();
+    run_layer(&profiler, "CONV_2D", 100, 0, 0);
+    run_layer(&profiler, "SOFTMAX", 10, 0, 0);
+    check(profiler.get_inferences() == 1, "failed Invoke() not counted as an inference");
+
+    // a setup without Invoke() (e.g. AllocateTensors() failed) isn't counted either
+    profiler.start_inference();
+    check(profiler.get_inferences() == 1, "setup without Invoke() not counted as an inference");
+
+    // the next inference starts at layer 0 again
+    profiler.start_inference();
+    run_layer(&profiler, "CONV_2D", 100, 0, 0);
+    run_layer(&profiler, "SOFTMAX", 10, 0, 0);
+    profiler.end_inference();
+    check(profiler.get_inferences() == 2, "inference after a failed Invoke() counted");
+    check(profiler.get_layer_count() == 2, "inference after a failed Invoke() starts at layer 0");
+}
+
+int main(void)
+{
+    test_aggregation();
+    test_wrap();
+    test_dropped();
+    test_failed_invoke();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,367 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @brief Host test of the data acquisition format of the firmware: the HMAC
+ * SHA256 signer (ingestion-sdk-c/sensor_aq_mbedtls_hs256.cpp) and the CBOR
+ * written by sensor_aq_add_data_batch() (firmware-sdk/sensor-aq):
+ *
+ *  - the test cases of RFC 4231, data fed whole and split at every offset
+ *    (cases 6 and 7 sign with SHA256 of their 131 byte key, the signer takes
+ *    keys of up to 32 characters, RFC 2104 gives the same HMAC)
+ *  - messages around the SHA256 padding boundaries, against Python hmac
+ *  - a stream of one and of two interleaved axes, written in batches that
+ *    cross the flushes of the CBOR buffer, decoded back with QCBOR: header,
+ *    sensors and every value, and the signature against the HMAC of the file
+ *    with the signature zeroed, as the ingestion service checks it
+ *  - a batch that is not a whole number of intervals is rejected
+ *
+ * Returns 1 on a failed check.
+ *
+ * Usage:
+ *     test_sensor_aq
+ */
+
+#include "firmware-sdk/sensor-aq/sensor_aq.h"
+#include "ingestion-sdk-c/sensor_aq_mbedtls_hs256.h"
+
+#include "bench_util.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define HMAC_SIZE                   32
+#define HMAC_KEY                    "edge impulse"
+#define AQ_BUFFER_SIZE              1024
+#define INTERVAL_MS                 0.0625f
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static std::vector<uint8_t> from_hex(const char *hex)
+{
+    std::vector<uint8_t> bytes;
+    for (size_t ix = 0; hex[ix] && hex[ix + 1]; ix += 2) {
+        bytes.push_back((uint8_t)std::stoul(std::string(hex + ix, 2), nullptr, 16));
+    }
+    return bytes;
+}
+
+static std::string to_hex(const uint8_t *bytes, size_t size)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (size_t ix = 0; ix < size; ix++) {
+        hex += digits[bytes[ix] >> 4];
+        hex += digits[bytes[ix] & 0xf];
+    }
+    return hex;
+}
+
+/**
+ * @brief HMAC of data through the signing context, updated in the chunks
+ * data[0, split) and data[split, size)
+ */
+static std::string hmac(const std::string &key, const uint8_t *data, size_t size, size_t split)
+{
+    sensor_aq_signing_ctx_t signing_ctx;
+    sensor_aq_mbedtls_hs256_ctx_t hs_ctx;
+    uint8_t digest[HMAC_SIZE];
+
+    sensor_aq_init_mbedtls_hs256_context(&signing_ctx, &hs_ctx, key.c_str());
+    signing_ctx.init(&signing_ctx);
+    signing_ctx.update(&signing_ctx, data, split);
+    signing_ctx.update(&signing_ctx, data + split, size - split);
+    signing_ctx.finish(&signing_ctx, digest);
+
+    return to_hex(digest, sizeof(digest));
+}
+
+/**
+ * @brief Check the HMAC of data against expected (a prefix of the HMAC when
+ * shorter), for the whole data and split at every offset
+ */
+static void check_hmac(const std::string &key, const std::vector<uint8_t> &data, const char *expected, const char *what)
+{
+    bool ok = true;
+    for (size_t split = 0; split <= data.size(); split++) {
+        ok &= hmac(key, data.data(), data.size(), split).compare(0, strlen(expected), expected) == 0;
+    }
+    check(ok, what);
+}
+
+static void test_rfc4231(void)
+{
+    const std::string key_aa_hashed = std::string((const char *)from_hex(
+        "45ad4b37c6e2fc0a2cfcc1b5da524132ec707615c2cae1dbbc43c97aa521db81").data(), HMAC_SIZE);
+    std::vector<uint8_t> key_4;
+    for (uint8_t value = 0x01; value <= 0x19; value++) {
+        key_4.push_back(value);
+    }
+    const char *data_6 = "Test Using Larger Than Block-Size Key - Hash Key First";
+    const char *data_7 = "This is a test using a larger than block-size key and a larger than block-size data. "
+        "The key needs to be hashed before being used by the HMAC algorithm.";
+
+    check_hmac(std::string(20, '\x0b'), std::vector<uint8_t>({ 'H', 'i', ' ', 'T', 'h', 'e', 'r', 'e' }),
+        "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7", "RFC 4231 test case 1");
+    const char *data_2 = "what do ya want for nothing?";
+    check_hmac("Jefe", std::vector<uint8_t>(data_2, data_2 + strlen(data_2)),
+        "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843", "RFC 4231 test case 2");
+    check_hmac(std::string(20, '\xaa'), std::vector<uint8_t>(50, 0xdd),
+        "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe", "RFC 4231 test case 3");
+    check_hmac(std::string(key_4.begin(), key_4.end()), std::vector<uint8_t>(50, 0xcd),
+        "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b", "RFC 4231 test case 4");
+    const char *data_5 = "Test With Truncation";
+    check_hmac(std::string(20, '\x0c'), std::vector<uint8_t>(data_5, data_5 + strlen(data_5)),
+        "a3b6167473100ee06e0c796c2955552b", "RFC 4231 test case 5");
+    check_hmac(key_aa_hashed, std::vector<uint8_t>(data_6, data_6 + strlen(data_6)),
+        "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54", "RFC 4231 test case 6");
+    check_hmac(key_aa_hashed, std::vector<uint8_t>(data_7, data_7 + strlen(data_7)),
+        "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2", "RFC 4231 test case 7");
+}
+
+static void test_padding_boundaries(void)
+{
+    /* HMAC-SHA256 of (7 * i + 1) & 0xff, i < length, with HMAC_KEY, from Python hmac */
+    const struct {
+        size_t length;
+        const char *expected;
+    } cases[] = {
+        { 0, "743d927f56c84a869458a763f4ff4ea83e12aaed1fb3e4380b51dfaa08fc4e54" },
+        { 55, "406581d2b65fd9ca6cb388e5b8e2be9f55737c697e38de20af467ea87e62a9bd" },
+        { 56, "b16661ed7dd05c5ee5aeffa2a96bcf2bfec24eb6aa855188df0908c5d1dfd46d" },
+        { 63, "079ae2fa6d370c01c06039a2841cd9f97d87df37c26099c7a38e5f799969b4cc" },
+        { 64, "e900014c9ce9979f5d66058badd21d77e8cc2a9ff2eec015eab80cb45d56db24" },
+        { 65, "f749e56db5c2c39254a1421eedea4a74b2fafaa1c6fa949efc3133f26e326046" },
+        { 119, "c87627a63c408a506bf43984b23b03e12c3f919a8c28b6aee74c7120ecd07dae" },
+        { 120, "b5a4eb5f53ed4c080d58486f4a154f542f581a41c081b9015469645335fa43fc" },
+        { 1000, "f43c735da9c5018101ff0e6b548aba2b5e5b85d974af5a9b4ad64331e383811e" },
+    };
+
+    for (const auto &c : cases) {
+        std::vector<uint8_t> data(c.length);
+        for (size_t ix = 0; ix < c.length; ix++) {
+            data[ix] = (uint8_t)(7 * ix + 1);
+        }
+        char what[64];
+        snprintf(what, sizeof(what), "HMAC of %u bytes", (unsigned)c.length);
+        check_hmac(HMAC_KEY, data, c.expected, what);
+    }
+}
+
+/**
+ * @brief Next item of the decoder, checks its type and (for items of a map) its label
+ */
+static bool next_item(QCBORDecodeContext *decode_ctx, QCBORItem *item, uint8_t type, const char *label = nullptr)
+{
+    if (QCBORDecode_GetNext(decode_ctx, item) != QCBOR_SUCCESS || item->uDataType != type) {
+        return false;
+    }
+    if (label == nullptr) {
+        return true;
+    }
+    return item->uLabelType == QCBOR_TYPE_TEXT_STRING &&
+        item->label.string.len == strlen(label) &&
+        memcmp(item->label.string.ptr, label, item->label.string.len) == 0;
+}
+
+static bool is_text(const QCBORItem &item, const char *text)
+{
+    return item.val.string.len == strlen(text) && memcmp(item.val.string.ptr, text, item.val.string.len) == 0;
+}
+
+/**
+ * @brief Write values (interleaved per interval) with sensor_aq_add_data_batch()
+ * in batches of random length, decode the file and check it
+ */
+static void test_stream(size_t axis_count, size_t intervals)
+{
+    static const char *axis_names[] = { "audio", "audio2" };
+    char what[96];
+
+    std::vector<int16_t> values(axis_count * intervals);
+    std::uniform_int_distribution<int> random_value(INT16_MIN, INT16_MAX);
+    for (auto &value : values) {
+        value = (int16_t)random_value(rng);
+    }
+    /* Both ends of the range, and values on either side of the CBOR integer sizes */
+    const int16_t edges[] = { INT16_MIN, INT16_MAX, 0, -1, 23, 24, -24, -25, 255, 256, -256, -257 };
+    memcpy(values.data(), edges, std::min(sizeof(edges), values.size() * sizeof(int16_t)));
+
+    uint8_t aq_buffer[AQ_BUFFER_SIZE];
+    sensor_aq_signing_ctx_t signing_ctx;
+    sensor_aq_mbedtls_hs256_ctx_t hs_ctx;
+    sensor_aq_ctx ctx = { { aq_buffer, AQ_BUFFER_SIZE }, &signing_ctx, &fwrite, &fseek, NULL };
+    sensor_aq_payload_info payload = { "00:11:22:33:44:55", "HOST_TEST", INTERVAL_MS, { { "audio", "wav" } } };
+    if (axis_count > 1) {
+        payload.sensors[1] = { "audio2", "wav" };
+    }
+
+    FILE *stream = tmpfile();
+    sensor_aq_init_mbedtls_hs256_context(&signing_ctx, &hs_ctx, HMAC_KEY);
+    bool written = sensor_aq_init(&ctx, &payload, stream, false) == AQ_OK;
+
+    /* Batches of up to a few hundred intervals, as the DMA buffers of the microphone */
+    std::uniform_int_distribution<size_t> random_batch(1, 300);
+    size_t batches = 0;
+    for (size_t ix = 0; ix < intervals && written; batches++) {
+        size_t batch = std::min(random_batch(rng), intervals - ix);
+        written &= sensor_aq_add_data_batch(&ctx, values.data() + ix * axis_count, batch * axis_count) == AQ_OK;
+        ix += batch;
+    }
+    written &= sensor_aq_finish(&ctx) == AQ_OK;
+
+    /* sensor_aq_finish() leaves the position after the signature it patched */
+    std::vector<uint8_t> file;
+    fseek(stream, 0, SEEK_END);
+    file.resize(ftell(stream));
+    rewind(stream);
+    written &= fread(file.data(), 1, file.size(), stream) == file.size();
+    fclose(stream);
+
+    snprintf(what, sizeof(what), "%u axes: stream written", (unsigned)axis_count);
+    check(written, what);
+    if (!written) {
+        return;
+    }
+
+    QCBORDecodeContext decode_ctx;
+    QCBORItem item;
+    QCBORDecode_Init(&decode_ctx, { file.data(), file.size() }, QCBOR_DECODE_MODE_NORMAL);
+
+    bool header_ok = next_item(&decode_ctx, &item, QCBOR_TYPE_MAP);
+    header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_MAP, "protected");
+    header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_TEXT_STRING, "ver") && is_text(item, "v1");
+    header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_TEXT_STRING, "alg") && is_text(item, "HS256");
+
+    header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_TEXT_STRING, "signature") &&
+        item.val.string.len == 2 * HMAC_SIZE;
+    size_t signature_index = (const uint8_t *)item.val.string.ptr - file.data();
+    std::string signature((const char *)item.val.string.ptr, item.val.string.len);
+
+    header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_MAP, "payload");
+    header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_TEXT_STRING, "device_name") && is_text(item, payload.device_name);
+    header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_TEXT_STRING, "device_type") && is_text(item, payload.device_type);
+    header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_DOUBLE, "interval_ms") && item.val.dfnum == INTERVAL_MS;
+    header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_ARRAY, "sensors") && item.val.uCount == axis_count;
+    for (size_t axis = 0; axis < axis_count && header_ok; axis++) {
+        header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_MAP) && item.val.uCount == 2;
+        header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_TEXT_STRING, "name") && is_text(item, axis_names[axis]);
+        header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_TEXT_STRING, "units") && is_text(item, "wav");
+    }
+    header_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_ARRAY, "values");
+    uint8_t values_level = item.uNestingLevel;
+
+    snprintf(what, sizeof(what), "%u axes: header decoded", (unsigned)axis_count);
+    check(header_ok, what);
+    if (!header_ok) {
+        return;
+    }
+
+    /* One integer per interval for one axis, an array of the axes otherwise */
+    size_t decoded = 0;
+    bool values_ok = true;
+    QCBORError decode_err;
+    while ((decode_err = QCBORDecode_GetNext(&decode_ctx, &item)) == QCBOR_SUCCESS && values_ok) {
+        values_ok &= item.uNestingLevel == values_level + 1;
+        if (axis_count > 1) {
+            values_ok &= item.uDataType == QCBOR_TYPE_ARRAY && item.val.uCount == axis_count;
+            for (size_t axis = 0; axis < axis_count && values_ok; axis++) {
+                values_ok &= next_item(&decode_ctx, &item, QCBOR_TYPE_INT64) &&
+                    decoded < values.size() && item.val.int64 == values[decoded];
+                decoded++;
+            }
+        }
+        else {
+            values_ok &= item.uDataType == QCBOR_TYPE_INT64 &&
+                decoded < values.size() && item.val.int64 == values[decoded];
+            decoded++;
+        }
+    }
+    /* The break of the values array is the last byte of the file, the QCBOR of
+       the SDK consumes it and then reports the end of the input */
+    values_ok &= decode_err == QCBOR_ERR_HIT_END && file.back() == 0xff;
+
+    snprintf(what, sizeof(what), "%u axes: %u values decoded in order", (unsigned)axis_count, (unsigned)values.size());
+    check(values_ok && decoded == values.size(), what);
+
+    /* The signature is the HMAC of the file with the signature set to '0' */
+    std::vector<uint8_t> unsigned_file(file);
+    memset(unsigned_file.data() + signature_index, '0', 2 * HMAC_SIZE);
+    snprintf(what, sizeof(what), "%u axes: signature is the HMAC of the file", (unsigned)axis_count);
+    check(hmac(HMAC_KEY, unsigned_file.data(), unsigned_file.size(), 0) == signature, what);
+
+    printf("%u axes: %u intervals in %u batches, %u bytes of CBOR\n",
+        (unsigned)axis_count, (unsigned)intervals, (unsigned)batches, (unsigned)file.size());
+}
+
+static void test_partial_interval(void)
+{
+    uint8_t aq_buffer[AQ_BUFFER_SIZE];
+    sensor_aq_signing_ctx_t signing_ctx;
+    sensor_aq_mbedtls_hs256_ctx_t hs_ctx;
+    sensor_aq_ctx ctx = { { aq_buffer, AQ_BUFFER_SIZE }, &signing_ctx, &fwrite, &fseek, NULL };
+    sensor_aq_payload_info payload = { "00:11:22:33:44:55", "HOST_TEST", INTERVAL_MS,
+        { { "audio", "wav" }, { "audio2", "wav" } } };
+    int16_t values[3] = { 1, 2, 3 };
+
+    FILE *stream = tmpfile();
+    sensor_aq_init_mbedtls_hs256_context(&signing_ctx, &hs_ctx, HMAC_KEY);
+    bool ok = sensor_aq_init(&ctx, &payload, stream, false) == AQ_OK;
+    ok &= sensor_aq_add_data_batch(&ctx, values, 3) == AQ_VALUES_SIZE_DOES_NOT_MATCH_AXIS_COUNT;
+    ok &= sensor_aq_add_data_batch(&ctx, values, 2) == AQ_OK;
+    fclose(stream);
+
+    check(ok, "batch of 1.5 intervals of two axes rejected");
+}
+
+int main(void)
+{
+    test_rfc4231();
+    test_padding_boundaries();
+    test_stream(1, 16000);
+    test_stream(2, 16000);
+    test_partial_interval();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,314 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Host test of the USB RX path: the single producer / single consumer
+ * ring of ei_usb_rx_ring.h, and ei_usb.c built against the stand-ins of
+ * tools/platform-stub, where the USB interrupt and the USB task fill the ring
+ * from the CDC FIFO and ei_usb_read() empties it:
+ *
+ *  - the ring only takes power of two sizes
+ *  - overflow: a write into a full ring takes what fits, counts the rest in
+ *    overflows and leaves the data in the ring intact
+ *  - wraparound: random writes and reads across the end of the storage and
+ *    across the 2^32 wrap of the head and tail counters, on one thread, then
+ *    with the producer (the interrupt) and the consumer (the task) on their
+ *    own threads
+ *  - ei_usb.c: 1 MB of every byte value sent by a host thread in random
+ *    packet sizes, read back with ei_usb_read() by a task that stops reading
+ *    at times, so the ring and the CDC FIFO fill up and the host is NAKed.
+ *    No byte may be lost, duplicated or reordered
+ *
+ * Returns 1 on a failed check.
+ *
+ * Usage:
+ *     test_usb_rx_ring
+ */
+
+#include "FreeRTOS.h"
+#include "event_groups.h"
+#include "platform_stub.h"
+#include "peripheral/usb/ei_usb.h"
+#include "peripheral/usb/ei_usb_rx_ring.h"
+
+#include "bench_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#define RING_SIZE                   256
+/* Head and tail start this close to 2^32 */
+#define COUNTER_START               (0xffffffffu - 1000u)
+#define THREADED_BYTES              (4 * 1024 * 1024)
+#define USB_BYTES                   (1024 * 1024)
+
+EventGroupHandle_t common_event_group;
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* Byte n of every stream, all byte values and not periodic in the ring size */
+static uint8_t stream_byte(uint32_t n)
+{
+    n *= 2654435761u;
+    return (uint8_t)(n >> 24);
+}
+
+static void test_init(void)
+{
+    ei_usb_rx_ring_t ring;
+    uint8_t storage[RING_SIZE];
+
+    check(!ei_usb_rx_ring_init(&ring, storage, 0), "ring of size 0 is rejected");
+    check(!ei_usb_rx_ring_init(&ring, storage, 100), "ring of size 100 is rejected");
+    check(!ei_usb_rx_ring_init(&ring, NULL, RING_SIZE), "ring without storage is rejected");
+    check(ei_usb_rx_ring_init(&ring, storage, RING_SIZE), "ring of a power of two");
+}
+
+static void test_overflow(void)
+{
+    ei_usb_rx_ring_t ring;
+    uint8_t storage[RING_SIZE];
+    uint8_t data[RING_SIZE + 100];
+    uint8_t out[RING_SIZE + 100];
+
+    for (uint32_t ix = 0; ix < sizeof(data); ix++) {
+        data[ix] = stream_byte(ix);
+    }
+
+    ei_usb_rx_ring_init(&ring, storage, RING_SIZE);
+    ring.head = ring.tail = COUNTER_START;
+
+    check(ei_usb_rx_ring_write(&ring, data, 10) == 10, "write into an empty ring");
+    check(ei_usb_rx_ring_write(&ring, &data[10], RING_SIZE) == RING_SIZE - 10, "write takes what fits");
+    check(ring.overflows == 10, "overflowed bytes are counted");
+    check(ei_usb_rx_ring_free(&ring) == 0 && ei_usb_rx_ring_used(&ring) == RING_SIZE, "ring is full");
+
+    uint8_t *span;
+    check(ei_usb_rx_ring_write_span(&ring, &span) == 0, "no span in a full ring");
+    check(ei_usb_rx_ring_write(&ring, &data[RING_SIZE], 100) == 0 && ring.overflows == 110,
+        "write into a full ring takes nothing");
+
+    check(ei_usb_rx_ring_read(&ring, out, sizeof(out)) == RING_SIZE, "read a full ring");
+    check(memcmp(out, data, RING_SIZE) == 0, "full ring data intact after overflows");
+    check(ei_usb_rx_ring_used(&ring) == 0 && ei_usb_rx_ring_read(&ring, out, 1) == 0, "ring is empty");
+}
+
+static void test_wraparound(void)
+{
+    ei_usb_rx_ring_t ring;
+    uint8_t storage[RING_SIZE];
+    uint8_t chunk[RING_SIZE];
+    uint32_t written = 0;
+    uint32_t read = 0;
+    bool same = true;
+    std::uniform_int_distribution<uint32_t> length(0, RING_SIZE);
+
+    ei_usb_rx_ring_init(&ring, storage, RING_SIZE);
+    ring.head = ring.tail = COUNTER_START;
+
+    while (read < 64 * RING_SIZE) {
+        uint32_t n = length(rng);
+        for (uint32_t ix = 0; ix < n; ix++) {
+            chunk[ix] = stream_byte(written + ix);
+        }
+        written += ei_usb_rx_ring_write(&ring, chunk, n);
+        ring.overflows = 0;
+
+        n = ei_usb_rx_ring_read(&ring, chunk, length(rng));
+        for (uint32_t ix = 0; ix < n; ix++) {
+            same &= chunk[ix] == stream_byte(read + ix);
+        }
+        read += n;
+    }
+
+    check(same, "data intact across the end of the storage and the counter wrap");
+    check(ring.head < COUNTER_START && ring.tail < COUNTER_START, "head and tail wrapped around 2^32");
+    printf("one thread: %u bytes through a %u byte ring, counters wrapped at 2^32\n", read, RING_SIZE);
+}
+
+static void test_threads(void)
+{
+    ei_usb_rx_ring_t ring;
+    uint8_t storage[RING_SIZE];
+    std::atomic<uint32_t> full_spans(0);
+
+    ei_usb_rx_ring_init(&ring, storage, RING_SIZE);
+    ring.head = ring.tail = COUNTER_START;
+
+    // interrupt: writes straight into the ring, random lengths, waits when full
+    std::thread producer([&ring, &full_spans]() {
+        std::mt19937 producer_rng(5678);
+        std::uniform_int_distribution<uint32_t> length(1, 64);
+        uint32_t written = 0;
+
+        while (written < THREADED_BYTES) {
+            uint8_t *span;
+            uint32_t n = ei_usb_rx_ring_write_span(&ring, &span);
+
+            if (n == 0) {
+                full_spans++;
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t want = length(producer_rng);
+            if (n > want) {
+                n = want;
+            }
+            if (n > THREADED_BYTES - written) {
+                n = THREADED_BYTES - written;
+            }
+            for (uint32_t ix = 0; ix < n; ix++) {
+                span[ix] = stream_byte(written + ix);
+            }
+            ei_usb_rx_ring_commit(&ring, n);
+            written += n;
+        }
+    });
+
+    // task: reads random lengths
+    std::uniform_int_distribution<uint32_t> length(1, RING_SIZE);
+    uint8_t chunk[RING_SIZE];
+    uint32_t read = 0;
+    bool same = true;
+
+    while (read < THREADED_BYTES) {
+        uint32_t n = ei_usb_rx_ring_read(&ring, chunk, length(rng));
+        for (uint32_t ix = 0; ix < n; ix++) {
+            same &= chunk[ix] == stream_byte(read + ix);
+        }
+        read += n;
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    check(same, "data intact between the interrupt and task threads");
+    check(ring.overflows == 0, "no overflows when the producer waits");
+    printf("two threads: %u bytes, ring full %u times\n", read, (uint32_t)full_spans);
+}
+
+static void test_usb(void)
+{
+    std::atomic<uint32_t> naks(0);
+    std::atomic<bool> sending(true);
+
+    common_event_group = xEventGroupCreate();
+    check(ei_usb_init() == pdPASS, "ei_usb_init");
+
+    // host: random packet sizes, NAKed packets are sent again
+    std::thread host([&naks, &sending]() {
+        std::mt19937 host_rng(91011);
+        std::uniform_int_distribution<uint32_t> length(1, 512);
+        std::vector<uint8_t> packet;
+        uint32_t sent = 0;
+
+        while (sent < USB_BYTES) {
+            uint32_t n = length(host_rng);
+            if (n > USB_BYTES - sent) {
+                n = USB_BYTES - sent;
+            }
+            packet.resize(n);
+            for (uint32_t ix = 0; ix < n; ix++) {
+                packet[ix] = stream_byte(sent + ix);
+            }
+
+            uint32_t taken = platform_stub_cdc_receive(packet.data(), n);
+            if (taken < n) {
+                naks++;
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            sent += taken;
+        }
+        sending = false;
+    });
+
+    // task: bulk reads, with pauses so the ring and the FIFO fill up
+    std::uniform_int_distribution<uint32_t> length(1, 2048);
+    std::uniform_int_distribution<int> pause(0, 49);
+    std::vector<uint8_t> chunk(2048);
+    uint32_t read = 0;
+    bool same = true;
+    bool timed_out = false;
+
+    while (read < USB_BYTES) {
+        uint32_t want = length(rng);
+        if (want > USB_BYTES - read) {
+            want = USB_BYTES - read;
+        }
+        uint32_t n = ei_usb_read(chunk.data(), want, 1000);
+        for (uint32_t ix = 0; ix < n; ix++) {
+            same &= chunk[ix] == stream_byte(read + ix);
+        }
+        read += n;
+        if (n < want) {
+            timed_out = true;
+            break;
+        }
+        if (pause(rng) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    host.join();
+
+    check(!timed_out, "ei_usb_read gets every byte sent");
+    check(same, "ei_usb_read data intact");
+    check(ei_usb_read(chunk.data(), 1, 0) == 0, "nothing more to read");
+    check(naks > 0, "host was NAKed while the ring was full");
+    printf("ei_usb.c: %u bytes in random packets, host NAKed %u times\n", read, (uint32_t)naks);
+}
+
+int main(int argc, char **argv)
+{
+    test_init();
+    test_overflow();
+    test_wraparound();
+    test_threads();
+    test_usb();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -72,7 +72,10 @@ void ei_run_impulse(void)
         break;
         case INFERENCE_WAITING:
         {
-            if (ei_read_timer_ms() < (last_inference_ts + 2000)) {
+            uint64_t now = ei_read_timer_ms();
+            if (now < (last_inference_ts + 2000)) {
+                // block until the delay expires (or we get stopped)
+                inference_task_wait((uint32_t)(last_inference_ts + 2000 - now));
                 return;
             }
             ei_printf("Recording\n");            
@@ -82,7 +85,9 @@ void ei_run_impulse(void)
         }
         case INFERENCE_SAMPLING:
         {
-            ei_mic_run_inference();
+            if (ei_mic_run_inference() == false) {
+                return;
+            }
 
             state = INFERENCE_DATA_READY;
             if (continuous_mode == false) {
@@ -116,6 +121,9 @@ void ei_run_impulse(void)
     else {
         ei_error = run_classifier(&signal, &result, debug_mode);
     }
+    // hand the slice back to the audio ring, it's no longer needed
+    ei_microphone_inference_slice_done();
+
     if (ei_error != EI_IMPULSE_OK) {
         ei_printf("Failed to run impulse (%d)", ei_error);
         return;
@@ -124,6 +132,9 @@ void ei_run_impulse(void)
     if (continuous_mode == true) {
         if (++print_results >= (EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW >> 1)) {
             ei_print_results(&ei_default_impulse, &result);
+            if (debug_mode && ei_microphone_inference_dropped_frames() > 0) {
+                ei_printf("WARN: %lu audio frames dropped\n", ei_microphone_inference_dropped_frames());
+            }
             print_results = 0;
         }
     }
@@ -204,6 +215,7 @@ void ei_stop_impulse(void)
     if (state != INFERENCE_STOPPED) {
 
         ei_microphone_inference_end();
+        inference_task_notify(INFERENCE_EVENT_STOP);
 
         ei_printf("Inferencing stopped by user\r\n");
 
@@ -34,7 +34,7 @@
 /* Include ----------------------------------------------------------------- */
 #include "model-parameters/model_metadata.h"
 #if defined(EI_CLASSIFIER_SENSOR) && (EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_CAMERA)
-#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier_image.h"
 #include "edge-impulse-sdk/classifier/ei_print_results.h"
 #include "edge-impulse-sdk/dsp/image/image.hpp"
 #include "firmware-sdk/ei_camera_interface.h"
@@ -70,6 +70,10 @@ static bool crop_required = false;
 static uint32_t inference_delay;
 static int ei_camera_get_data(size_t offset, size_t length, float *out_ptr);
 
+static ei_camera_pipeline_stats_t pipeline_stats;
+static uint64_t first_frame_us;
+static void update_pipeline_stats(EiAmbiqCamera *camera, ei_impulse_result_t *result);
+
 /**
  * @brief 
  * 
@@ -118,6 +122,10 @@ void ei_start_impulse(bool continuous, bool debug, bool use_max_uart_speed)
     ei_printf("\tFrame size: %d\n", EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
     ei_printf("\tNo. of classes: %d\n", sizeof(ei_classifier_inferencing_categories) / sizeof(ei_classifier_inferencing_categories[0]));
 
+    memset(&pipeline_stats, 0, sizeof(pipeline_stats));
+    // with the delay between single shots there's nothing to overlap
+    pipeline_stats.pipelined = continuous_mode && (EI_CAMERA_PIPELINE == 1);
+
     if (continuous_mode == true) {
         inference_delay = 0;
         state = INFERENCE_DATA_READY;
@@ -157,6 +165,7 @@ void ei_stop_impulse(void)
     }
 
     state = INFERENCE_STOPPED;
+    inference_task_notify(INFERENCE_EVENT_STOP);
 
         run_classifier_deinit();
     }
@@ -170,10 +179,15 @@ void ei_run_impulse(void)
             // nothing to do
             return;
         case INFERENCE_WAITING:
-            if(ei_read_timer_ms() < (last_inference_ts + inference_delay)) {
+        {
+            uint64_t now = ei_read_timer_ms();
+            if(now < (last_inference_ts + inference_delay)) {
+                // block until the delay expires (or we get stopped)
+                inference_task_wait((uint32_t)(last_inference_ts + inference_delay - now));
                 return;
             }
             state = INFERENCE_DATA_READY;
+        }
             break;
         case INFERENCE_SAMPLING:
         case INFERENCE_DATA_READY:
@@ -197,8 +211,15 @@ void ei_run_impulse(void)
 
     ei_printf("Taking photo...\n");
 
-    bool isOK = camera->ei_camera_capture_rgb888_packed_big_endian(snapshot_buf, snapshot_buf_size);
+    bool isOK;
+    if (pipeline_stats.pipelined) {
+        isOK = camera->capture_rgb888_pipelined(snapshot_buf, snapshot_buf_size);
+    }
+    else {
+        isOK = camera->ei_camera_capture_rgb888_packed_big_endian(snapshot_buf, snapshot_buf_size);
+    }
     if (!isOK) {
+        ei_free(snapshot_buf);
         return;
     }
 
@@ -247,9 +268,16 @@ void ei_run_impulse(void)
     }
 
     // run the impulse: DSP, neural network and the Anomaly algorithm
+    // straight on the RGB888 frame, quantized models skip the float signal
     ei_impulse_result_t result = { 0 };
 
-    EI_IMPULSE_ERROR ei_error = run_classifier(&signal, &result, false);
+    ei::image_signal_t image;
+    image.buffer = snapshot_buf;
+    image.width = EI_CLASSIFIER_INPUT_WIDTH;
+    image.height = EI_CLASSIFIER_INPUT_HEIGHT;
+    image.channels = 3;
+
+    EI_IMPULSE_ERROR ei_error = run_classifier_image(&image, &result, false);
     if (ei_error != EI_IMPULSE_OK) {
         ei_printf("ERR: Failed to run impulse (%d)\n", ei_error);
         ei_free(snapshot_buf);
@@ -257,6 +285,8 @@ void ei_run_impulse(void)
     }
     ei_free(snapshot_buf);
 
+    update_pipeline_stats(camera, &result);
+
     ei_print_results(&ei_default_impulse, &result);
 
     if (debug_mode) {
@@ -269,6 +299,11 @@ void ei_run_impulse(void)
         last_inference_ts = ei_read_timer_ms();
         state = INFERENCE_WAITING;
     }
+
+    // stopped while classifying, don't leave a frame in flight
+    if (state == INFERENCE_STOPPED && camera->is_pipeline_running()) {
+        camera->stop_pipeline();
+    }
 }
 
 /**
@@ -282,6 +317,46 @@ bool is_inference_running(void)
     return (state != INFERENCE_STOPPED);
 }
 
+/**
+ * @brief Copy the timing of the camera inference loop
+ *
+ * @param stats
+ * @return false if no frame was classified yet
+ */
+bool ei_get_camera_pipeline_stats(ei_camera_pipeline_stats_t *stats)
+{
+    *stats = pipeline_stats;
+
+    return (pipeline_stats.frames > 0);
+}
+
+/**
+ * @brief Record the stage latencies of the frame just classified
+ *
+ * @param camera
+ * @param result
+ */
+static void update_pipeline_stats(EiAmbiqCamera *camera, ei_impulse_result_t *result)
+{
+    const ei_camera_frame_timing_t &timing = camera->get_last_frame_timing();
+    uint64_t now = ei_read_timer_us();
+
+    if (pipeline_stats.frames == 0) {
+        first_frame_us = now;
+    }
+    else {
+        pipeline_stats.fps = (float)pipeline_stats.frames * 1000000.0f / (float)(now - first_frame_us);
+    }
+    pipeline_stats.frames++;
+
+    pipeline_stats.capture_us = (uint32_t)(timing.taken_us - timing.shutter_us);
+    pipeline_stats.transfer_us = (uint32_t)(timing.dma_done_us - timing.dma_start_us);
+    pipeline_stats.decode_us = timing.decode_us;
+    pipeline_stats.dsp_us = (uint32_t)result->timing.dsp_us;
+    pipeline_stats.classification_us = (uint32_t)result->timing.classification_us;
+    pipeline_stats.latency_us = (uint32_t)(now - timing.shutter_us);
+}
+
 /**
  *
  * @param offset
@@ -43,4 +43,32 @@ extern void ei_run_impulse(void);
 extern void ei_stop_impulse(void);
 extern bool is_inference_running(void);
 
+/**
+ * @brief Timing of the camera inference loop, latencies are of the last frame
+ */
+typedef struct {
+    bool pipelined;             // capture of the next frame overlaps with inference
+    uint32_t frames;
+    float fps;                  // end to end, averaged since the impulse was started
+    uint32_t capture_us;        // shutter to frame ready in the camera
+    uint32_t transfer_us;       // SPI DMA
+    uint32_t decode_us;         // JPEG decode and RGB888 conversion
+    uint32_t dsp_us;
+    uint32_t classification_us;
+    uint32_t latency_us;        // shutter to result
+} ei_camera_pipeline_stats_t;
+
+extern bool ei_get_camera_pipeline_stats(ei_camera_pipeline_stats_t *stats);
+
+/**
+ * @brief Use of the TFLite tensor arena, measured after AllocateTensors()
+ */
+typedef struct {
+    uint32_t size;              // static arena, or the one allocated for the graph
+    uint32_t used;              // used by the graph set up last
+    uint32_t peak;              // highest use since boot
+} ei_arena_stats_t;
+
+extern bool ei_get_arena_stats(ei_arena_stats_t *stats);
+
 #endif /* EI_RUN_IMPULSE_H */
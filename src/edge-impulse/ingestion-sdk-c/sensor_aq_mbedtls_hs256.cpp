@@ -31,37 +31,182 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
-
 /**
  * HMAC SHA256 implementation using Mbed TLS
+ * Mbed TLS is not available on this target, so SHA256 is implemented below.
  */
 
 #include <string.h>
-#include "firmware-sdk/sensor-aq/sensor_aq.h"
+#include "sensor_aq_mbedtls_hs256.h"
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
 
-typedef struct {
-    char hmac_key[33];
-} sensor_aq_mbedtls_hs256_ctx_t;
+#define SHA256_BLOCK_SIZE   64
+#define SHA256_DIGEST_SIZE  32
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t ror32(uint32_t x, uint32_t n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+static void sha256_transform(sensor_aq_sha256_ctx_t *sha, const uint8_t *data)
+{
+    uint32_t w[64];
+
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)data[i * 4] << 24) | ((uint32_t)data[i * 4 + 1] << 16) |
+               ((uint32_t)data[i * 4 + 2] << 8) | (uint32_t)data[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ror32(w[i - 15], 7) ^ ror32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ror32(w[i - 2], 17) ^ ror32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = sha->state[0], b = sha->state[1], c = sha->state[2], d = sha->state[3];
+    uint32_t e = sha->state[4], f = sha->state[5], g = sha->state[6], h = sha->state[7];
+
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (ror32(e, 6) ^ ror32(e, 11) ^ ror32(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        uint32_t t2 = (ror32(a, 2) ^ ror32(a, 13) ^ ror32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    sha->state[0] += a;
+    sha->state[1] += b;
+    sha->state[2] += c;
+    sha->state[3] += d;
+    sha->state[4] += e;
+    sha->state[5] += f;
+    sha->state[6] += g;
+    sha->state[7] += h;
+}
+
+static void sha256_starts(sensor_aq_sha256_ctx_t *sha)
+{
+    static const uint32_t sha256_init[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    memcpy(sha->state, sha256_init, sizeof(sha->state));
+    sha->total_len = 0;
+    sha->block_len = 0;
+}
+
+static void sha256_update(sensor_aq_sha256_ctx_t *sha, const uint8_t *data, size_t len)
+{
+    sha->total_len += len;
+
+    if (sha->block_len > 0) {
+        size_t fill = SHA256_BLOCK_SIZE - sha->block_len;
+        if (len < fill) {
+            memcpy(sha->block + sha->block_len, data, len);
+            sha->block_len += len;
+            return;
+        }
+        memcpy(sha->block + sha->block_len, data, fill);
+        sha256_transform(sha, sha->block);
+        data += fill;
+        len -= fill;
+        sha->block_len = 0;
+    }
+
+    // hash straight from the input, only the tail is buffered
+    while (len >= SHA256_BLOCK_SIZE) {
+        sha256_transform(sha, data);
+        data += SHA256_BLOCK_SIZE;
+        len -= SHA256_BLOCK_SIZE;
+    }
+
+    memcpy(sha->block, data, len);
+    sha->block_len = len;
+}
+
+static void sha256_finish(sensor_aq_sha256_ctx_t *sha, uint8_t *digest)
+{
+    uint64_t bit_len = sha->total_len * 8;
+
+    sha->block[sha->block_len++] = 0x80;
+    if (sha->block_len > SHA256_BLOCK_SIZE - 8) {
+        memset(sha->block + sha->block_len, 0, SHA256_BLOCK_SIZE - sha->block_len);
+        sha256_transform(sha, sha->block);
+        sha->block_len = 0;
+    }
+    memset(sha->block + sha->block_len, 0, SHA256_BLOCK_SIZE - 8 - sha->block_len);
+    for (int i = 0; i < 8; i++) {
+        sha->block[SHA256_BLOCK_SIZE - 1 - i] = (uint8_t)(bit_len >> (8 * i));
+    }
+    sha256_transform(sha, sha->block);
+
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (uint8_t)(sha->state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(sha->state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(sha->state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)sha->state[i];
+    }
+}
+
+/**
+ * @brief Hash the HMAC key padded to a block, XORed with ipad (0x36) or opad (0x5c)
+ */
+static void hmac_hash_key_pad(sensor_aq_mbedtls_hs256_ctx_t *hs_ctx, uint8_t pad)
+{
+    uint8_t key_block[SHA256_BLOCK_SIZE];
+    size_t key_len = strlen(hs_ctx->hmac_key);
+
+    memset(key_block, pad, sizeof(key_block));
+    for (size_t ix = 0; ix < key_len; ix++) {
+        key_block[ix] ^= (uint8_t)hs_ctx->hmac_key[ix];
+    }
+
+    sha256_update(&hs_ctx->sha, key_block, sizeof(key_block));
+}
 
 static int sensor_aq_mbedtls_hs256_init(sensor_aq_signing_ctx_t *aq_ctx) {
     sensor_aq_mbedtls_hs256_ctx_t *hs_ctx = (sensor_aq_mbedtls_hs256_ctx_t*)aq_ctx->ctx;
 
-    /* Signature disabled, return zero */
+    sha256_starts(&hs_ctx->sha);
+    hmac_hash_key_pad(hs_ctx, 0x36);
+
     return 0;
 }
 
 static int sensor_aq_mbedtls_hs256_update(sensor_aq_signing_ctx_t *aq_ctx, const uint8_t *buffer, size_t buffer_size) {
     sensor_aq_mbedtls_hs256_ctx_t *hs_ctx = (sensor_aq_mbedtls_hs256_ctx_t*)aq_ctx->ctx;
 
-    /* Signature disabled, return zero */
+    sha256_update(&hs_ctx->sha, buffer, buffer_size);
+
     return 0;
 }
 
 static int sensor_aq_mbedtls_hs256_finish(sensor_aq_signing_ctx_t *aq_ctx, uint8_t *buffer) {
     sensor_aq_mbedtls_hs256_ctx_t *hs_ctx = (sensor_aq_mbedtls_hs256_ctx_t*)aq_ctx->ctx;
+    uint8_t inner[SHA256_DIGEST_SIZE];
+
+    sha256_finish(&hs_ctx->sha, inner);
+
+    sha256_starts(&hs_ctx->sha);
+    hmac_hash_key_pad(hs_ctx, 0x5c);
+    sha256_update(&hs_ctx->sha, inner, sizeof(inner));
+    sha256_finish(&hs_ctx->sha, buffer);
 
-    /* Signature disabled, return zero */
     return 0;
 }
 
@@ -73,7 +218,7 @@ static int sensor_aq_mbedtls_hs256_finish(sensor_aq_signing_ctx_t *aq_ctx, uint8
  * @param hmac_key The secret key - **NOTE: this is limited to 32 characters, the rest will be truncated**
  */
 void sensor_aq_init_mbedtls_hs256_context(sensor_aq_signing_ctx_t *aq_ctx, sensor_aq_mbedtls_hs256_ctx_t *hs_ctx, const char *hmac_key) {
-    memcpy(hs_ctx->hmac_key, hmac_key, 32);
+    strncpy(hs_ctx->hmac_key, hmac_key, 32);
     hs_ctx->hmac_key[32] = 0;
 
     if (strlen(hmac_key) > 32) {
@@ -81,8 +226,8 @@ void sensor_aq_init_mbedtls_hs256_context(sensor_aq_signing_ctx_t *aq_ctx, senso
     }
 
     aq_ctx->alg = "HS256"; // JWS algorithm
-    aq_ctx->signature_length = 32;
-    aq_ctx->ctx = (void*)NULL;
+    aq_ctx->signature_length = SHA256_DIGEST_SIZE;
+    aq_ctx->ctx = (void*)hs_ctx;
     aq_ctx->init = &sensor_aq_mbedtls_hs256_init;
     aq_ctx->set_protected = NULL;
     aq_ctx->update = &sensor_aq_mbedtls_hs256_update;
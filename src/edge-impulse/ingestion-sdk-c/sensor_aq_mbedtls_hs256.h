@@ -40,8 +40,19 @@
  */
 #include "firmware-sdk/sensor-aq/sensor_aq.h"
 
+/**
+ * @brief Running SHA256 state, Mbed TLS is not part of this build
+ */
+typedef struct {
+    uint32_t state[8];
+    uint64_t total_len;
+    uint8_t block[64];
+    size_t block_len;
+} sensor_aq_sha256_ctx_t;
+
 typedef struct {
     char hmac_key[33];
+    sensor_aq_sha256_ctx_t sha;
 } sensor_aq_mbedtls_hs256_ctx_t;
 
 /**
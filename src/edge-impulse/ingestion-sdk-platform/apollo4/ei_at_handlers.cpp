@@ -36,9 +36,16 @@
 #include "firmware-sdk/at-server/ei_at_command_set.h"
 #include "firmware-sdk/ei_device_lib.h"
 #include "firmware-sdk/ei_image_lib.h"
+#include "firmware-sdk/ei_binary_frame.h"
 #include "model-parameters/model_metadata.h"
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
 #include "inference/ei_run_impulse.h"
+#if defined(EI_CLASSIFIER_LAYER_PROFILER) && (EI_CLASSIFIER_LAYER_PROFILER == 1)
+#include "firmware-sdk/ei_layer_profiler.h"
+#endif
+
+/* Size of the base64 chunks of RUNIMPULSESTATIC, must be a multiple of 4 */
+#define STATIC_DATA_CHUNK_SIZE      1024
 
 EiAmbiqApollo4 *pei_device;
 
@@ -63,6 +70,9 @@ static bool at_run_impulse_debug(const char **argv, const int argc);
 static bool at_run_nn_normal(void);
 static bool at_run_nn_normal_cont(void);
 static bool at_run_impulse_debug(const char **argv, const int argc);
+static bool at_run_impulse_static_data(const char **argv, const int argc);
+static bool at_get_binary_frames(void);
+static bool at_set_binary_frames(const char **argv, const int argc);
 
 static bool at_get_mgmt_settings(void);
 static bool at_set_mgmt_settings(const char **argv, const int argc);
@@ -70,6 +80,16 @@ static bool at_set_mgmt_settings(const char **argv, const int argc);
 static bool at_get_snapshot(void);
 static bool at_take_snapshot(const char **argv, const int argc);
 static bool at_snapshot_stream(const char **argv, const int argc);
+#if defined(EI_CLASSIFIER_SENSOR) && (EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_CAMERA)
+static bool at_get_camera_stats(void);
+#endif
+#if defined(EI_CLASSIFIER_LAYER_PROFILER) && (EI_CLASSIFIER_LAYER_PROFILER == 1)
+static bool at_get_layer_profile(void);
+static bool at_reset_layer_profile(void);
+#endif
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+static bool at_get_arena(void);
+#endif
 
 static inline bool check_args_num(const int &required, const int &received);
 
@@ -92,6 +112,8 @@ ATServer *ei_at_init(EiAmbiqApollo4 *ei_device)
     at->register_command(AT_RUNIMPULSE, AT_RUNIMPULSE_HELP_TEXT, at_run_nn_normal, nullptr, nullptr, nullptr);
     at->register_command(AT_RUNIMPULSEDEBUG, AT_RUNIMPULSEDEBUG_HELP_TEXT, nullptr, nullptr, at_run_impulse_debug, AT_RUNIMPULSEDEBUG_ARGS);
     at->register_command(AT_RUNIMPULSECONT, AT_RUNIMPULSECONT_HELP_TEXT, at_run_nn_normal_cont, nullptr, nullptr, nullptr);
+    at->register_command(AT_RUNIMPULSESTATIC, AT_RUNIMPULSESTATIC_HELP_TEXT, nullptr, nullptr, at_run_impulse_static_data, AT_RUNIMPULSESTATIC_ARGS);
+    at->register_command(AT_BINARYFRAMES, AT_BINARYFRAMES_HELP_TEXT, nullptr, at_get_binary_frames, at_set_binary_frames, AT_BINARYFRAMES_ARGS);
     at->register_command(AT_READBUFFER, AT_READBUFFER_HELP_TEXT, nullptr, nullptr, at_read_buffer, AT_READBUFFER_ARGS);
     at->register_command(AT_MGMTSETTINGS, AT_MGMTSETTINGS_HELP_TEXT, nullptr, at_get_mgmt_settings, at_set_mgmt_settings, AT_MGMTSETTINGS_ARGS);
     at->register_command(AT_UPLOADSETTINGS, AT_UPLOADSETTINGS_HELP_TEXT, nullptr, at_get_upload_settings, at_set_upload_settings, AT_UPLOADSETTINGS_ARGS);
@@ -99,6 +121,15 @@ ATServer *ei_at_init(EiAmbiqApollo4 *ei_device)
     at->register_command(AT_UPLOADHOST, AT_UPLOADHOST_HELP_TEXT, nullptr, at_get_upload_host, at_set_upload_host, AT_UPLOADHOST_ARGS);
     at->register_command(AT_SNAPSHOT, AT_SNAPSHOT_HELP_TEXT, nullptr, at_get_snapshot, at_take_snapshot, AT_SNAPSHOT_ARGS);
     at->register_command(AT_SNAPSHOTSTREAM, AT_SNAPSHOTSTREAM_HELP_TEXT, nullptr, nullptr, at_snapshot_stream, AT_SNAPSHOTSTREAM_ARGS);
+#if defined(EI_CLASSIFIER_SENSOR) && (EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_CAMERA)
+    at->register_command(AT_CAMERASTATS, AT_CAMERASTATS_HELP_TEXT, nullptr, at_get_camera_stats, nullptr, nullptr);
+#endif
+#if defined(EI_CLASSIFIER_LAYER_PROFILER) && (EI_CLASSIFIER_LAYER_PROFILER == 1)
+    at->register_command(AT_LAYERPROFILE, AT_LAYERPROFILE_HELP_TEXT, at_reset_layer_profile, at_get_layer_profile, nullptr, nullptr);
+#endif
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+    at->register_command(AT_ARENA, AT_ARENA_HELP_TEXT, nullptr, at_get_arena, nullptr, nullptr);
+#endif
     
     return at;
 }
@@ -282,6 +313,61 @@ static bool at_run_nn_normal_cont(void)
     return (is_inference_running());
 }
 
+/**
+ * @brief Handler for RUNIMPULSESTATIC
+ *
+ * @param argv
+ * @param argc
+ * @return
+ */
+static bool at_run_impulse_static_data(const char **argv, const int argc)
+{
+    if (argc < 2) {
+        ei_printf("Missing argument! Required: " AT_RUNIMPULSESTATIC_ARGS "\r\n");
+        return true;
+    }
+
+    bool debug = (argv[0][0] == 'y');
+    size_t length = (size_t)atoi(argv[1]);
+
+    run_impulse_static_data(debug, length, STATIC_DATA_CHUNK_SIZE);
+
+    return true;
+}
+
+/**
+ * @brief Handler for BINARYFRAMES?
+ *
+ * @return
+ */
+static bool at_get_binary_frames(void)
+{
+    ei_printf("Enabled:     %d\r\n", ei_frame_is_binary_mode() ? 1 : 0);
+    ei_printf("Version:     %d\r\n", EI_FRAME_VERSION);
+    ei_printf("Max payload: %d\r\n", EI_FRAME_MAX_PAYLOAD);
+
+    return true;
+}
+
+/**
+ * @brief Handler for BINARYFRAMES=
+ *
+ * @param argv
+ * @param argc
+ * @return
+ */
+static bool at_set_binary_frames(const char **argv, const int argc)
+{
+    if (check_args_num(1, argc) == false) {
+        return true;
+    }
+
+    ei_frame_set_binary_mode(argv[0][0] == 'y');
+    ei_printf("OK\r\n");
+
+    return true;
+}
+
 /**
  *
  * @param argv
@@ -665,6 +751,96 @@ static bool at_snapshot_stream(const char **argv, const int argc)
     return true;
 }
 
+#if defined(EI_CLASSIFIER_SENSOR) && (EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_CAMERA)
+/**
+ * @brief Handler for CAMERASTATS?
+ *
+ * @return
+ */
+static bool at_get_camera_stats(void)
+{
+    ei_camera_pipeline_stats_t stats;
+
+    if (ei_get_camera_pipeline_stats(&stats) == false) {
+        ei_printf("No frames classified yet, run the impulse first\r\n");
+        return true;
+    }
+
+    ei_printf("Pipelined:      %d\r\n", stats.pipelined ? 1 : 0);
+    ei_printf("Frames:         %lu\r\n", stats.frames);
+    ei_printf("FPS:            ");
+    ei_printf_float(stats.fps);
+    ei_printf("\r\n");
+    ei_printf("Capture:        %lu us\r\n", stats.capture_us);
+    ei_printf("Transfer:       %lu us\r\n", stats.transfer_us);
+    ei_printf("Decode:         %lu us\r\n", stats.decode_us);
+    ei_printf("DSP:            %lu us\r\n", stats.dsp_us);
+    ei_printf("Classification: %lu us\r\n", stats.classification_us);
+    ei_printf("Latency:        %lu us\r\n", stats.latency_us);
+
+    return true;
+}
+#endif
+
+#if defined(EI_CLASSIFIER_LAYER_PROFILER) && (EI_CLASSIFIER_LAYER_PROFILER == 1)
+/**
+ * @brief Handler for LAYERPROFILE?, one CSV row per layer with the
+ * counters averaged over the inferences since the last reset
+ *
+ * @return
+ */
+static bool at_get_layer_profile(void)
+{
+    EiLayerProfiler *profiler = ei_layer_profiler_get();
+
+    if (profiler->get_layer_count() == 0) {
+        ei_printf("No layers profiled yet, run the impulse first\r\n");
+        return true;
+    }
+
+    profiler->print_csv();
+
+    return true;
+}
+
+/**
+ * @brief Handler for LAYERPROFILE
+ *
+ * @return
+ */
+static bool at_reset_layer_profile(void)
+{
+    ei_layer_profiler_get()->reset();
+    ei_printf("OK\r\n");
+
+    return true;
+}
+#endif
+
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
+/**
+ * @brief Handler for ARENA?, free is what EI_TENSOR_ARENA_SIZE can reclaim
+ *
+ * @return
+ */
+static bool at_get_arena(void)
+{
+    ei_arena_stats_t stats;
+
+    if (!ei_get_arena_stats(&stats)) {
+        ei_printf("Arena not allocated yet, run the impulse first\r\n");
+        return true;
+    }
+
+    ei_printf("Arena: %lu bytes\r\n", stats.size);
+    ei_printf("Used:  %lu bytes\r\n", stats.used);
+    ei_printf("Peak:  %lu bytes\r\n", stats.peak);
+    ei_printf("Free:  %lu bytes\r\n", stats.size > stats.peak ? stats.size - stats.peak : 0);
+
+    return true;
+}
+#endif
+
 /**
  *
  * @param required
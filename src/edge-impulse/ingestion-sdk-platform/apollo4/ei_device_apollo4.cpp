@@ -36,9 +36,44 @@
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
 #include "edge-impulse-sdk/dsp/ei_utils.h"
 #include "ingestion-sdk-platform/sensor/ei_mic.h"
+#include "firmware-sdk/at_base64_lib.h"
+#include "firmware-sdk/ei_device_lib.h"
+#include "firmware-sdk/ei_binary_frame.h"
+#include "peripheral/usb/ei_usb.h"
 #include "hal/am_hal_global.h"
 #include "am_util_id.h"
 
+/**
+ * @brief Read data from the serial port. Overrides the weak firmware-sdk
+ * version, data are copied out of the USB RX ring in bulk instead of
+ * polling ei_getchar one byte at a time.
+ *
+ * @param buffer
+ * @param length number of bytes to read
+ * @param timeout_ms how long to wait for all of the data
+ * @return size_t number of bytes read, less than length on timeout
+ */
+size_t ei_serial_read(uint8_t *buffer, size_t length, uint32_t timeout_ms)
+{
+    return ei_usb_read(buffer, length, timeout_ms);
+}
+
+/**
+ * @brief Write data to the serial port. Overrides the weak firmware-sdk
+ * version, data go to the buffered USB writer in one call.
+ *
+ * @param buffer
+ * @param length number of bytes to write
+ */
+void ei_serial_write(const uint8_t *buffer, size_t length)
+{
+    ei_usb_write(buffer, length);
+}
+
+static void usb_write_chars(const char *buffer, size_t length);
+static size_t usb_reserve_chars(char **span, size_t min_length);
+static void usb_commit_chars(size_t length);
+
 EiAmbiqApollo4::EiAmbiqApollo4(EiDeviceMemory* mem)
 {
     EiDeviceInfo::memory = mem;
@@ -142,3 +177,82 @@ EiDeviceInfo* EiDeviceInfo::get_device(void)
 
     return &dev;
 }
+
+/**
+ * @brief Helper function for sending a data from memory over the
+ * serial port. Overrides the weak firmware-sdk version, data are encoded
+ * into base64 straight into the USB TX accumulator (or sent as binary
+ * frames through the buffered USB sink) instead of one ei_putchar per
+ * character.
+ *
+ * @param address address of samples
+ * @param length number of samples (bytes)
+ * @return true if everything went fine
+ * @return false if some error occured (error during samples read)
+ */
+bool read_encode_send_sample_buffer(size_t address, size_t length)
+{
+    EiDeviceMemory *memory = EiDeviceInfo::get_device()->get_memory();
+    // we are encoding data into base64, so it needs to be divisible by 3
+    static uint8_t buffer[513 * 2];
+    bool ret = true;
+    bool binary = ei_frame_is_binary_mode();
+    ei_frame_writer_t writer;
+
+    if (binary) {
+        ei_frame_writer_begin(&writer, usb_write_chars);
+    }
+
+    while (length > 0) {
+        // one full frame per read in binary mode
+        size_t bytes_to_read = binary ? EI_FRAME_MAX_PAYLOAD : sizeof(buffer);
+
+        if (bytes_to_read > length) {
+            bytes_to_read = length;
+        }
+
+        if (memory->read_sample_data(buffer, address, bytes_to_read) != bytes_to_read) {
+            ret = false;
+            break;
+        }
+
+        if (binary) {
+            ei_frame_writer_data(&writer, buffer, bytes_to_read);
+        }
+        else {
+            size_t encoded = base64_encode_span((char *)buffer, bytes_to_read, usb_reserve_chars, usb_commit_chars);
+
+            // no accumulator for this task
+            if (encoded < bytes_to_read) {
+                base64_encode_write((char *)buffer + encoded, bytes_to_read - encoded, usb_write_chars);
+            }
+        }
+
+        address += bytes_to_read;
+        length -= bytes_to_read;
+    }
+
+    // sent on errors too, the host sees a total short of the length it asked for
+    if (binary) {
+        ei_frame_writer_end(&writer);
+    }
+
+    ei_usb_flush();
+
+    return ret;
+}
+
+static void usb_write_chars(const char *buffer, size_t length)
+{
+    ei_usb_write((const uint8_t *)buffer, length);
+}
+
+static size_t usb_reserve_chars(char **span, size_t min_length)
+{
+    return ei_usb_write_span((uint8_t **)span, min_length);
+}
+
+static void usb_commit_chars(size_t length)
+{
+    ei_usb_commit(length);
+}
@@ -0,0 +1,78 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/* Includes ---------------------------------------------------------------- */
+#include "firmware-sdk/ei_layer_profiler.h"
+
+#if defined(EI_CLASSIFIER_LAYER_PROFILER) && (EI_CLASSIFIER_LAYER_PROFILER == 1)
+#include "ns_perf_profile.h"
+
+static ei_layer_profile_t layer_table[EI_LAYER_PROFILER_MAX_LAYERS];
+
+/**
+ * @brief DWT cycle counter and cache monitor, a miss is a tag lookup
+ * that didn't hit
+ */
+static void read_counters(ei_layer_counters_t *counters)
+{
+    ns_perf_counters_t perf;
+    ns_cache_dump_t cache;
+
+    ns_capture_perf_profiler(&perf);
+    ns_capture_cache_stats(&cache);
+
+    counters->cycles = perf.cyccnt;
+    counters->icache_misses = cache.itaglookup - cache.ihitslookup;
+    counters->dcache_misses = cache.dtaglookup - cache.dhitslookup;
+}
+
+EiLayerProfiler *ei_layer_profiler_get(void)
+{
+    static EiLayerProfiler *profiler = nullptr;
+
+    if (profiler == nullptr) {
+        static EiLayerProfiler layer_profiler(layer_table, EI_LAYER_PROFILER_MAX_LAYERS, read_counters);
+        ns_cache_config_t cache_config = { .enable = true };
+
+        ns_cache_profiler_init(&cache_config);
+        ns_init_perf_profiler();
+        ns_reset_perf_counters();
+        ns_start_perf_profiler();
+
+        profiler = &layer_profiler;
+    }
+
+    return profiler;
+}
+
+#endif
@@ -0,0 +1,271 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _EI_AUDIO_RING_H_
+#define _EI_AUDIO_RING_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Lock-free single producer / single consumer ring of audio samples.
+ *
+ * The producer (audio DMA callback) writes whole frames straight into the
+ * ring storage via write_acquire()/write_commit(), the consumer (inference)
+ * reads slices in place through read()/read_span() and releases them with
+ * consume(). Indexes run over [0, 2 * capacity) so that a full ring can be
+ * told apart from an empty one without a wasted slot and without the
+ * counters ever overflowing.
+ *
+ * @tparam T sample type
+ */
+template <typename T>
+class EiAudioRing {
+public:
+    EiAudioRing()
+        : storage(nullptr)
+        , capacity(0)
+        , frame_len(0)
+        , head(0)
+        , tail(0)
+        , dropped(0) {};
+
+    /**
+     * @brief Attach storage to the ring
+     *
+     * @param buffer storage, at least capacity samples
+     * @param capacity ring size in samples, must be a multiple of frame_len
+     * @param frame_len number of samples written by the producer at once
+     * @return false if the geometry is invalid
+     */
+    bool init(T *buffer, uint32_t capacity, uint32_t frame_len)
+    {
+        if (buffer == nullptr || frame_len == 0 || capacity < frame_len || (capacity % frame_len) != 0) {
+            return false;
+        }
+
+        this->storage = buffer;
+        this->capacity = capacity;
+        this->frame_len = frame_len;
+        this->head.store(0, std::memory_order_relaxed);
+        this->tail.store(0, std::memory_order_relaxed);
+        this->dropped.store(0, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    void deinit(void)
+    {
+        this->storage = nullptr;
+        this->capacity = 0;
+    }
+
+    bool is_initialized(void) const
+    {
+        return this->storage != nullptr;
+    }
+
+    /**
+     * @brief Producer side: get the next frame slot.
+     *
+     * @return pointer to frame_len contiguous samples or nullptr if the ring is full
+     * (the frame is then counted as dropped)
+     */
+    T *write_acquire(void)
+    {
+        if (this->storage == nullptr) {
+            return nullptr;
+        }
+
+        uint32_t h = this->head.load(std::memory_order_relaxed);
+        uint32_t t = this->tail.load(std::memory_order_acquire);
+
+        if (this->distance(h, t) + this->frame_len > this->capacity) {
+            this->dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        return &this->storage[this->wrap(h)];
+    }
+
+    /**
+     * @brief Producer side: publish the frame obtained with write_acquire()
+     */
+    void write_commit(void)
+    {
+        uint32_t h = this->head.load(std::memory_order_relaxed);
+        this->head.store(this->advance(h, this->frame_len), std::memory_order_release);
+    }
+
+    /**
+     * @brief Consumer side: number of samples ready to be read
+     */
+    uint32_t available(void) const
+    {
+        uint32_t h = this->head.load(std::memory_order_acquire);
+        uint32_t t = this->tail.load(std::memory_order_relaxed);
+
+        return this->distance(h, t);
+    }
+
+    /**
+     * @brief Consumer side: view on the unread data
+     *
+     * Returns at most two contiguous spans (the second one is non empty only
+     * if the requested range wraps around the end of the storage).
+     *
+     * @param offset offset from the oldest unread sample
+     * @param length number of samples, offset + length must be <= available()
+     * @param first first span
+     * @param first_len length of the first span
+     * @param second second span
+     * @param second_len length of the second span
+     * @return false if the requested range is not available
+     */
+    bool read_span(
+        uint32_t offset,
+        uint32_t length,
+        const T **first,
+        uint32_t *first_len,
+        const T **second,
+        uint32_t *second_len) const
+    {
+        if (offset + length > this->available()) {
+            return false;
+        }
+
+        uint32_t start = this->wrap(this->advance(this->tail.load(std::memory_order_relaxed), offset));
+        uint32_t to_end = this->capacity - start;
+
+        *first = &this->storage[start];
+        if (length <= to_end) {
+            *first_len = length;
+            *second = nullptr;
+            *second_len = 0;
+        }
+        else {
+            *first_len = to_end;
+            *second = &this->storage[0];
+            *second_len = length - to_end;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Consumer side: copy out unread samples without releasing them
+     */
+    bool read(uint32_t offset, uint32_t length, T *out) const
+    {
+        const T *first, *second;
+        uint32_t first_len, second_len;
+
+        if (!this->read_span(offset, length, &first, &first_len, &second, &second_len)) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < first_len; i++) {
+            out[i] = first[i];
+        }
+        for (uint32_t i = 0; i < second_len; i++) {
+            out[first_len + i] = second[i];
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Consumer side: release samples back to the producer
+     */
+    void consume(uint32_t length)
+    {
+        uint32_t avail = this->available();
+        if (length > avail) {
+            length = avail;
+        }
+
+        uint32_t t = this->tail.load(std::memory_order_relaxed);
+        this->tail.store(this->advance(t, length), std::memory_order_release);
+    }
+
+    /**
+     * @brief Consumer side: drop everything that was written so far
+     */
+    void flush(void)
+    {
+        this->tail.store(this->head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    uint32_t get_dropped_frames(void) const
+    {
+        return this->dropped.load(std::memory_order_relaxed);
+    }
+
+    void reset_dropped_frames(void)
+    {
+        this->dropped.store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t get_capacity(void) const
+    {
+        return this->capacity;
+    }
+
+private:
+    T *storage;
+    uint32_t capacity;
+    uint32_t frame_len;
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> dropped;
+
+    uint32_t wrap(uint32_t idx) const
+    {
+        return (idx >= this->capacity) ? (idx - this->capacity) : idx;
+    }
+
+    uint32_t advance(uint32_t idx, uint32_t n) const
+    {
+        idx += n;
+        return (idx >= 2 * this->capacity) ? (idx - 2 * this->capacity) : idx;
+    }
+
+    uint32_t distance(uint32_t h, uint32_t t) const
+    {
+        return (h >= t) ? (h - t) : (h + 2 * this->capacity - t);
+    }
+};
+
+#endif /* _EI_AUDIO_RING_H_ */
@@ -38,12 +38,19 @@
 #include "ns_core.h"
 #include "ns_camera.h"
 #include "ArducamCamera.h"
+#include "common_events.h"
+#include "timers.h"
 
 extern ArducamCamera camera; // Arducam driver assumes this is a global, so :shrug:
 
 void picture_dma_complete(ns_camera_config_t *cfg);
 void picture_taken_complete(ns_camera_config_t *cfg);
 static bool RBG565ToRGB888(uint8_t *src_buf, uint8_t *dst_buf, uint32_t src_len);
+static bool wait_for_camera_event(EventBits_t event, uint32_t timeout_ms);
+static void press_shutter_button(uint8_t img_modex_index, uint8_t slot);
+static void start_dma_deferred(void *pvParameter1, uint32_t ulParameter2);
+
+#define CAMERA_EVENT_TIMEOUT_MS     1000
 
 ei_device_snapshot_resolutions_t EiAmbiqCamera::resolutions[] = {
         {96, 96},
@@ -54,22 +61,31 @@ ei_device_snapshot_resolutions_t EiAmbiqCamera::resolutions[] = {
 #define JPG_MODE
 
 #if defined (JPG_MODE)
-AM_SHARED_RW static uint8_t jpgBuffer[JPG_BUFF_SIZE] __attribute__((aligned(16)));
-static uint32_t start_jpg_dma(void);
+#define FRAME_BUFF_SIZE JPG_BUFF_SIZE
+static uint32_t start_jpg_dma(uint8_t slot);
 static void press_jpg_shutter_button(uint8_t img_modex_index);
+AM_SHARED_RW static uint8_t rgbBuffer[RGB_BUFF_SIZE] __attribute__((aligned(16)));
 #else
+#define FRAME_BUFF_SIZE RGB_BUFF_SIZE
 static void press_rgb_shutter_button(uint8_t img_modex_index);
-static uint32_t start_rgb_dma(void);
+static uint32_t start_rgb_dma(uint8_t slot);
 #endif
 
-AM_SHARED_RW static uint8_t rgbBuffer[RGB_BUFF_SIZE] __attribute__((aligned(16)));
+// raw frames as they come from the camera (JPEG or RGB565)
+AM_SHARED_RW static uint8_t frameBuffer[CAMERA_FRAME_SLOTS][FRAME_BUFF_SIZE] __attribute__((aligned(16)));
 AM_SHARED_RW static uint8_t snapshot_buffer[RGB888_BUFF_SIZE] __attribute__((aligned(16)));
 
 static uint32_t bufferOffset = 0;
 
-volatile bool dmaComplete = false; // ISR-land
-volatile bool pictureTaken = false;
-volatile uint32_t buffer_length = 0;
+/* Capture pipeline state, shared with the camera callbacks */
+static volatile uint32_t frame_length[CAMERA_FRAME_SLOTS];
+static volatile uint8_t fill_slot = 0;          // slot the camera is writing to
+static volatile bool pipeline_armed = false;    // start the DMA as soon as the picture is taken
+static volatile bool dma_in_flight = false;
+static volatile uint64_t ts_shutter_us;
+static volatile uint64_t ts_taken_us;
+static volatile uint64_t ts_dma_start_us;
+static volatile uint64_t ts_dma_done_us;
 
 ns_camera_config_t camera_config = {
     .api = &ns_camera_V1_0_0,
@@ -91,7 +107,9 @@ EiAmbiqCamera::EiAmbiqCamera() :
     camera_found(false),
     tried_init(false),
     width(96),
-    height(96)
+    height(96),
+    pipeline_running(false),
+    last_frame_timing()
 {
 }
 
@@ -191,47 +209,129 @@ bool EiAmbiqCamera::ei_camera_capture_rgb888_packed_big_endian(
     uint8_t *image,
     uint32_t image_size)
 {
-    pictureTaken = false;
-    dmaComplete = false;
+    if (this->pipeline_running) {
+        this->stop_pipeline();
+    }
+
+    xEventGroupClearBits(common_event_group, EVENT_CAMERA_PICTURE_TAKEN | EVENT_CAMERA_DMA_COMPLETE);
 
     memset(image, 0, image_size);
-    memset(rgbBuffer, 0, RGB_BUFF_SIZE);
-#ifdef JPG_MODE
-    memset(jpgBuffer, 0, JPG_BUFF_SIZE);
+    fill_slot = 0;
 
-    press_jpg_shutter_button(this->img_mode_index);
+    press_shutter_button(this->img_mode_index, 0);
 
-    do {
-        __WFI();
-    } while (!pictureTaken);
+    if (wait_for_camera_event(EVENT_CAMERA_PICTURE_TAKEN, CAMERA_EVENT_TIMEOUT_MS) == false) {
+        return false;
+    }
 
-    buffer_length = start_jpg_dma();
+    start_dma_deferred(nullptr, 0);
 
-    do {
-        __WFI();
-    } while (!dmaComplete);
+    if (wait_for_camera_event(EVENT_CAMERA_DMA_COMPLETE, CAMERA_EVENT_TIMEOUT_MS) == false) {
+        return false;
+    }
 
-    buffer_length = ns_chop_off_trailing_zeros(jpgBuffer, buffer_length);
+    this->last_frame_timing.shutter_us = ts_shutter_us;
+    this->last_frame_timing.taken_us = ts_taken_us;
+    this->last_frame_timing.dma_start_us = ts_dma_start_us;
+    this->last_frame_timing.dma_done_us = ts_dma_done_us;
 
-    uint32_t scaling_factor[] = {3, 2, 2};
+    return this->decode_frame(0, image);
+}
+
+/**
+ * @brief Pipelined version of ei_camera_capture_rgb888_packed_big_endian.
+ * Returns the frame captured during the previous call and triggers the next
+ * one right away, so capture and SPI transfer of frame N+1 run while frame N
+ * is decoded and classified. The first call primes the pipeline.
+ *
+ * @param image RGB888 output buffer
+ * @param image_size
+ * @return false on camera timeout, the pipeline is stopped and restarted on the next call
+ */
+bool EiAmbiqCamera::capture_rgb888_pipelined(uint8_t *image, uint32_t image_size)
+{
+#if EI_CAMERA_PIPELINE == 1
+    if (this->pipeline_running == false) {
+        xEventGroupClearBits(common_event_group, EVENT_CAMERA_PICTURE_TAKEN | EVENT_CAMERA_DMA_COMPLETE);
+        fill_slot = 0;
+        pipeline_armed = true;
+        this->pipeline_running = true;
+        press_shutter_button(this->img_mode_index, fill_slot);
+    }
 
-    camera_decode_image(jpgBuffer, buffer_length, rgbBuffer, this->width, this->height, scaling_factor[this->img_mode_index]);
+    // the frame in flight has to be taken and transferred
+    if (wait_for_camera_event(EVENT_CAMERA_DMA_COMPLETE, 2 * CAMERA_EVENT_TIMEOUT_MS) == false) {
+        this->stop_pipeline();
+        return false;
+    }
+
+    uint8_t ready_slot = fill_slot;
+
+    this->last_frame_timing.shutter_us = ts_shutter_us;
+    this->last_frame_timing.taken_us = ts_taken_us;
+    this->last_frame_timing.dma_start_us = ts_dma_start_us;
+    this->last_frame_timing.dma_done_us = ts_dma_done_us;
+
+    // kick off the next frame into the other slot, the DMA is started from
+    // picture_taken_complete so it overlaps with decoding and inference.
+    // Nothing waits for PICTURE_TAKEN when pipelined, reset it before the
+    // trigger so it doesn't stay set in common_event_group from frame to frame
+    // (DMA_COMPLETE is cleared on exit of the wait)
+    xEventGroupClearBits(common_event_group, EVENT_CAMERA_PICTURE_TAKEN);
+    fill_slot = (ready_slot + 1) % CAMERA_FRAME_SLOTS;
+    press_shutter_button(this->img_mode_index, fill_slot);
+
+    memset(image, 0, image_size);
+
+    return this->decode_frame(ready_slot, image);
 #else
-    pictureTaken = false;
-    press_rgb_shutter_button(this->img_mode_index);
+    // no second slot to capture into while this frame is decoded
+    return this->ei_camera_capture_rgb888_packed_big_endian(image, image_size);
+#endif
+}
+
+/**
+ * @brief Stop the capture pipeline, waits for a transfer in flight so
+ * the frame slots are not written afterwards
+ */
+void EiAmbiqCamera::stop_pipeline(void)
+{
+    pipeline_armed = false;
+
+    if (dma_in_flight) {
+        wait_for_camera_event(EVENT_CAMERA_DMA_COMPLETE, CAMERA_EVENT_TIMEOUT_MS);
+        dma_in_flight = false;
+    }
+
+    xEventGroupClearBits(common_event_group, EVENT_CAMERA_PICTURE_TAKEN | EVENT_CAMERA_DMA_COMPLETE);
+    this->pipeline_running = false;
+}
 
-    do {
-        __WFI();
-    } while (!pictureTaken);
+/**
+ * @brief Decode a raw frame slot into the RGB888 image
+ *
+ * @param slot
+ * @param image
+ * @return true
+ * @return false
+ */
+bool EiAmbiqCamera::decode_frame(uint8_t slot, uint8_t *image)
+{
+    uint64_t start_us = ei_read_timer_us();
+    uint8_t *rgb565 = frameBuffer[slot];
 
-    buffer_length = start_rgb_dma();
-    do {
-        __WFI();
-    } while (!dmaComplete);
+#ifdef JPG_MODE
+    uint32_t scaling_factor[] = {3, 2, 2};
+    uint32_t length = ns_chop_off_trailing_zeros(frameBuffer[slot], frame_length[slot]);
 
+    memset(rgbBuffer, 0, RGB_BUFF_SIZE);
+    camera_decode_image(frameBuffer[slot], length, rgbBuffer, this->width, this->height, scaling_factor[this->img_mode_index]);
+    rgb565 = rgbBuffer;
 #endif
 
-    RBG565ToRGB888(rgbBuffer, image, (this->width * this->height * 2));
+    RBG565ToRGB888(rgb565, image, (this->width * this->height * 2));
+
+    this->last_frame_timing.decode_us = (uint32_t)(ei_read_timer_us() - start_us);
 
     return true;
 }
@@ -292,6 +392,51 @@ EiCamera* EiCamera::get_camera(void)
     return &cam;
 }
 
+/**
+ * @brief Trigger a capture, the frame will be transferred into the given slot
+ *
+ * @param img_modex_index
+ * @param slot
+ */
+static void press_shutter_button(uint8_t img_modex_index, uint8_t slot)
+{
+    fill_slot = slot;
+    ts_shutter_us = ei_read_timer_us();
+#if defined (JPG_MODE)
+    memset(frameBuffer[slot], 0, FRAME_BUFF_SIZE);
+    press_jpg_shutter_button(img_modex_index);
+#else
+    press_rgb_shutter_button(img_modex_index);
+#endif
+}
+
+/**
+ * @brief Start the SPI DMA of the picture into the fill slot. Called directly
+ * for single captures, or from the timer service task when pipelined
+ * (picture_taken_complete runs in interrupt context).
+ *
+ * @param pvParameter1 unused
+ * @param ulParameter2 1 when called by the pipeline
+ */
+static void start_dma_deferred(void *pvParameter1, uint32_t ulParameter2)
+{
+    (void)pvParameter1;
+    uint8_t slot = fill_slot;
+
+    if (ulParameter2 == 1 && pipeline_armed == false) {
+        // pipeline got stopped in the meantime
+        return;
+    }
+
+    dma_in_flight = true;
+    ts_dma_start_us = ei_read_timer_us();
+#if defined (JPG_MODE)
+    frame_length[slot] = start_jpg_dma(slot);
+#else
+    frame_length[slot] = start_rgb_dma(slot);
+#endif
+}
+
 #if defined (JPG_MODE)
 
 static void press_jpg_shutter_button(uint8_t img_modex_index) 
@@ -303,14 +448,14 @@ static void press_jpg_shutter_button(uint8_t img_modex_index)
 /**
  * @brief 
  * 
- * @param bufferId 
+ * @param slot
  * @return uint32_t 
  */
-static uint32_t start_jpg_dma(void)
+static uint32_t start_jpg_dma(uint8_t slot)
 {
     uint32_t camLength = 0;
 
-    camLength = ns_start_dma_read(&camera_config, jpgBuffer, &bufferOffset, JPG_BUFF_SIZE);
+    camLength = ns_start_dma_read(&camera_config, frameBuffer[slot], &bufferOffset, JPG_BUFF_SIZE);
 
     bufferOffset = 1;
 
@@ -335,11 +480,12 @@ static void press_rgb_shutter_button(uint8_t img_modex_index)
 /**
  * @brief 
  * 
+ * @param slot
  * @return uint32_t 
  */
-static uint32_t start_rgb_dma(void) 
+static uint32_t start_rgb_dma(uint8_t slot) 
 {
-    uint32_t camLength = ns_start_dma_read(&camera_config, rgbBuffer, &bufferOffset, RGB_BUFF_SIZE);
+    uint32_t camLength = ns_start_dma_read(&camera_config, frameBuffer[slot], &bufferOffset, RGB_BUFF_SIZE);
     return camLength;
 }
 
@@ -351,8 +497,13 @@ static uint32_t start_rgb_dma(void)
  * @param cfg 
  */
 void picture_dma_complete(ns_camera_config_t *cfg) 
-{    
-    dmaComplete = true;    
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    ts_dma_done_us = ei_read_timer_us();
+    dma_in_flight = false;
+    xEventGroupSetBitsFromISR(common_event_group, EVENT_CAMERA_DMA_COMPLETE, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 /**
@@ -362,7 +513,41 @@ void picture_dma_complete(ns_camera_config_t *cfg)
  */
 void picture_taken_complete(ns_camera_config_t *cfg) 
 {
-    pictureTaken = true;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    ts_taken_us = ei_read_timer_us();
+
+    if (pipeline_armed) {
+        // the DMA setup talks to the camera over SPI, so it can't be done here
+        if (xTimerPendFunctionCallFromISR(start_dma_deferred, nullptr, 1, &xHigherPriorityTaskWoken) != pdPASS) {
+            pipeline_armed = false;
+        }
+    }
+    xEventGroupSetBitsFromISR(common_event_group, EVENT_CAMERA_PICTURE_TAKEN, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief Block the calling task until the camera ISR signals the event
+ *
+ * @param event
+ * @param timeout_ms
+ * @return false on timeout
+ */
+static bool wait_for_camera_event(EventBits_t event, uint32_t timeout_ms)
+{
+    EventBits_t bits = xEventGroupWaitBits(common_event_group,
+                                           event,      //  uxBitsToWaitFor
+                                           pdTRUE,     //  xClearOnExit
+                                           pdFALSE,    //  xWaitForAllBits
+                                           pdMS_TO_TICKS(timeout_ms));
+
+    if ((bits & event) == 0) {
+        ei_printf("ERR: camera timeout\r\n");
+        return false;
+    }
+
+    return true;
 }
 
 /**
@@ -63,6 +63,30 @@
 #define JPG_CH_SIZE (JPG_WIDTH * JPG_HEIGHT)
 #define JPG_BUFF_SIZE (JPG_CH_SIZE)
 
+// With EI_CAMERA_PIPELINE=1 continuous inference pipelines the capture: one
+// frame slot is filled by the camera while the other one is decoded and
+// classified. Otherwise a single slot and every frame is captured serially
+#ifndef EI_CAMERA_PIPELINE
+#define EI_CAMERA_PIPELINE 0
+#endif
+
+#if EI_CAMERA_PIPELINE == 1
+#define CAMERA_FRAME_SLOTS 2
+#else
+#define CAMERA_FRAME_SLOTS 1
+#endif
+
+/**
+ * @brief Timestamps (ei_read_timer_us) of the last frame handed out by the camera
+ */
+typedef struct {
+    uint64_t shutter_us;    // shutter pressed
+    uint64_t taken_us;      // frame ready in the camera FIFO
+    uint64_t dma_start_us;  // SPI DMA started
+    uint64_t dma_done_us;   // SPI DMA completed
+    uint32_t decode_us;     // duration of JPEG decode and RGB888 conversion
+} ei_camera_frame_timing_t;
+
 class EiAmbiqCamera : public EiCamera
 {
 private:
@@ -72,6 +96,9 @@ private:
     uint16_t width;
     uint16_t height;
     uint8_t img_mode_index;
+    bool pipeline_running;
+    ei_camera_frame_timing_t last_frame_timing;
+    bool decode_frame(uint8_t slot, uint8_t *image);
 public:
     EiAmbiqCamera();
     bool is_camera_present(void) {return camera_found;};
@@ -87,6 +114,11 @@ public:
         uint32_t image_size) override;
 
     bool get_fb_ptr(uint8_t** fb_ptr) override;
+
+    bool capture_rgb888_pipelined(uint8_t *image, uint32_t image_size);
+    void stop_pipeline(void);
+    bool is_pipeline_running(void) { return pipeline_running; };
+    const ei_camera_frame_timing_t& get_last_frame_timing(void) { return last_frame_timing; };
 };
 
 #endif
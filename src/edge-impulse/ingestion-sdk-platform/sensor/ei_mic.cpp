@@ -33,6 +33,7 @@
  */
 
 #include "ei_mic.h"
+#include "ei_audio_ring.h"
 #include "ns_audio.h"
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
 #include "edge-impulse-sdk/dsp/numpy.hpp"
@@ -41,34 +42,45 @@
 #include "model-parameters/model_metadata.h"
 #include "ingestion-sdk-c/sensor_aq_mbedtls_hs256.h"
 #include "hal/am_hal_global.h"
+#include "inference_task.h"
 
 /* Edge Impulse */
 static bool create_header(sensor_aq_payload_info *payload);
 static size_t ei_write(const void*, size_t size, size_t count, EI_SENSOR_AQ_STREAM*);
 static int ei_seek(EI_SENSOR_AQ_STREAM*, long int offset, int origin);
 static bool ei_microphone_sample_start(void);
+static bool ei_mic_stream_flush(void);
 static void ingestion_callback(void *buffer, uint32_t n_bytes);
-static void write_value_to_cbor_buffer(uint8_t *buf, int16_t value);
 
 /** Status and control struct for inferencing struct */
 typedef struct {
-    int16_t *buffers[2];
-    uint8_t buf_select;
-    uint8_t buf_ready;
-    uint32_t buf_count;
-    uint32_t n_samples;
+    int16_t *storage;
+    EiAudioRing<int16_t> ring;
+    uint32_t slice_len;     // samples (all channels) handed to the classifier at once
 } inference_t;
 
 static uint8_t n_audio_channels = 2;
 const uint32_t sampling_rate = 16000;
-static uint32_t cbor_current_sample;
 
 static inference_t inference;
-static uint32_t headerOffset;
 static uint32_t samples_required;
 static uint32_t current_sample;
 
+/* CBOR output is staged here and written to the sample memory a block at a time */
+#define EI_MIC_STREAM_BLOCK_SIZE    2048
+
+/** Sample memory stream the sensor-aq writer is hooked up to */
+typedef struct {
+    uint32_t block_address;     // sample memory address of staging[0]
+    uint32_t fill;              // bytes pending in staging
+    uint32_t length;            // end of the written data
+    bool error;
+} ei_mic_stream_t;
+
 AM_SHARED_RW static unsigned char ei_mic_ctx_buffer[1024];
+AM_SHARED_RW static uint8_t ei_mic_stream_staging[EI_MIC_STREAM_BLOCK_SIZE];
+static ei_mic_stream_t ei_mic_stream_state;
+static EI_SENSOR_AQ_STREAM ei_mic_stream;
 static sensor_aq_signing_ctx_t ei_mic_signing_ctx;
 static sensor_aq_mbedtls_hs256_ctx_t ei_mic_hs_ctx;
 static sensor_aq_ctx ei_mic_ctx = {
@@ -85,9 +97,11 @@ static sensor_aq_ctx ei_mic_ctx = {
 #define NUM_CHANNELS 1
 #define SAMPLE_RATE 16000
 #define AUIO_SAMPLE_BUFFER_NUMBER   (SAMPLE_RATE / 10)
+#define EI_MIC_SLICE_WAIT_MS        1000
 
 bool volatile static g_audioRecording = false;
 bool volatile static g_audioReady = false;
+bool volatile static g_inferenceRunning = false;
 
 void audio_frame_callback(ns_audio_config_t *config, uint16_t bytesCollected);
 
@@ -122,8 +136,17 @@ ns_audio_config_t audio_config = {
  */
 int ei_microphone_audio_signal_get_data(size_t offset, size_t length, float *out_ptr)
 {
-    ei::numpy::int16_to_float(&inference.buffers[inference.buf_select ^ 1][offset], out_ptr, length);
-    inference.buf_ready = 0;
+    const int16_t *first, *second;
+    uint32_t first_len, second_len;
+
+    if (!inference.ring.read_span(offset, length, &first, &first_len, &second, &second_len)) {
+        return -1;
+    }
+
+    ei::numpy::int16_to_float(first, out_ptr, first_len);
+    if (second_len) {
+        ei::numpy::int16_to_float(second, out_ptr + first_len, second_len);
+    }
 
     return 0;
 }
@@ -191,6 +214,18 @@ static bool ei_microphone_sample_start(void)
         payload.sensors[1] = { "audio2", "wav"};
     }
 
+    samples_required = (uint32_t)((dev->get_sample_length_ms()) / dev->get_sample_interval_ms());
+
+    /* Worst case every sample takes 3 bytes of CBOR, plus an array header per interval */
+    uint32_t bytes_per_interval = (n_audio_channels > 1) ? (1 + 3 * n_audio_channels) : 3;
+    uint32_t available_bytes = mem->get_available_sample_bytes() - sizeof(ei_mic_ctx_buffer);
+    if ((uint64_t)samples_required * bytes_per_interval > available_bytes) {
+        ei_printf("ERR: Sample length is too long. Maximum allowed is %lums at %luHz.\r\n",
+            (uint32_t)((available_bytes / bytes_per_interval) * dev->get_sample_interval_ms()),
+            sampling_rate);
+        return false;
+    }
+
     ei_printf("Sampling settings:\n");
     ei_printf("\tInterval: %.5f ms.\n", dev->get_sample_interval_ms());
     ei_printf("\tLength: %lu ms.\n", dev->get_sample_length_ms());
@@ -198,15 +233,7 @@ static bool ei_microphone_sample_start(void)
     ei_printf("\tHMAC Key: %s\n", dev->get_sample_hmac_key().c_str());
     ei_printf("\tFile name: /fs/%s\n", dev->get_sample_label().c_str());
 
-    samples_required = (uint32_t)((dev->get_sample_length_ms()) / dev->get_sample_interval_ms());
-
-    /* Round to even number of samples for word align flash write */
-    if(samples_required & 1) {
-        samples_required++;
-    }
-
     current_sample = 0;
-    cbor_current_sample = 0;
 
     ei_printf("Starting in 2000 ms... (or until all flash was erased)\n");
     ei_sleep(2000); // no need to erase
@@ -233,7 +260,7 @@ static bool ei_microphone_sample_start(void)
     ei_printf("Sampling...\r\n");
     dev->set_state(eiStateSampling);
 
-    while (current_sample < samples_required) {
+    while (current_sample < samples_required && ei_mic_stream_state.error == false) {
         __WFI();
         ei_mic_thread(&ingestion_callback);
     }
@@ -246,20 +273,21 @@ static bool ei_microphone_sample_start(void)
 
     dev->set_state(eiStateIdle);
 
-    /* Write end of cbor + dummy */
-    const uint8_t end_of_cbor[] = {0xff, 0xff, 0xff, 0xff};
-    mem->write_sample_data((uint8_t*)end_of_cbor, headerOffset + cbor_current_sample, 4);
+    if (ei_mic_stream_state.error) {
+        ei_printf("ERR: Failed to write sample data\n");
+        return false;
+    }
 
-    int ctx_err =
-        ei_mic_ctx.signature_ctx->finish(ei_mic_ctx.signature_ctx, ei_mic_ctx.hash_buffer.buffer);
-    if (ctx_err != 0) {
+    /* Close the values array and patch the signature into the header */
+    int ctx_err = sensor_aq_finish(&ei_mic_ctx);
+    if (ctx_err != AQ_OK || ei_mic_stream_flush() == false) {
         ei_printf("Failed to finish signature (%d)\n", ctx_err);
         return false;
     }
 
     ei_printf("Done sampling, total bytes collected: %lu\n", (current_sample * 2));
     ei_printf("[1/1] Uploading file to Edge Impulse...\n");
-    ei_printf("Not uploading file, not connected to WiFi. Used buffer, from=0, to=%lu.\n", (cbor_current_sample + 1 + headerOffset));
+    ei_printf("Not uploading file, not connected to WiFi. Used buffer, from=0, to=%lu.\n", ei_mic_stream_state.length);
     ei_printf("OK\n");
 
     return true;
@@ -272,8 +300,24 @@ static bool ei_microphone_sample_start(void)
  * @param bytesCollected 
  */
 void audio_frame_callback(ns_audio_config_t *config, uint16_t bytesCollected) {
-    
-    if (g_audioRecording) {
+
+    if (g_inferenceRunning) {
+        // write straight into the inference ring, no intermediate copy
+        int16_t *frame = inference.ring.write_acquire();
+        if (frame != NULL) {
+            ns_audio_getPCM_v2(config, frame);
+            inference.ring.write_commit();
+        }
+        g_audioReady = true;
+
+        // only signal when a slice just became complete
+        uint32_t available = inference.ring.available();
+        if (frame != NULL && available >= inference.slice_len
+            && (available - AUIO_SAMPLE_BUFFER_NUMBER * NUM_CHANNELS) < inference.slice_len) {
+            inference_task_notify_from_isr(INFERENCE_EVENT_SLICE_READY);
+        }
+    }
+    else if (g_audioRecording) {
         ns_audio_getPCM_v2(config, &(g_in16AudioDataBuffer[g_bufsel][0]));
         g_bufsel ^= 1;
         g_audioReady = true;        
@@ -311,23 +355,26 @@ bool ei_microphone_inference_start(uint32_t n_samples, uint8_t n_channels_infere
 
     n_audio_channels = n_channels_inference;
 
-    inference.buffers[0] = (int16_t *)ei_malloc(n_samples * sizeof(microphone_sample_t)  * n_audio_channels);
-    if (inference.buffers[0] == NULL) {
-        ei_printf("Can't allocate first audio buffer\r\n");
+    /* Room for two slices, rounded up to whole DMA frames so that the
+     * producer always has a contiguous slot to write into */
+    const uint32_t frame_len = AUIO_SAMPLE_BUFFER_NUMBER * NUM_CHANNELS;
+    const uint32_t slice_len = n_samples * n_audio_channels;
+    const uint32_t capacity = ((2 * slice_len + frame_len - 1) / frame_len) * frame_len;
+
+    inference.storage = (int16_t *)ei_malloc(capacity * sizeof(microphone_sample_t));
+    if (inference.storage == NULL) {
+        ei_printf("Can't allocate audio buffer\r\n");
         return false;
     }
 
-    inference.buffers[1] = (int16_t *)ei_malloc(n_samples * sizeof(microphone_sample_t)  * n_audio_channels);
-    if (inference.buffers[1] == NULL) {
-        ei_free(inference.buffers[0]);
-        ei_printf("Can't allocate second audio buffer\r\n");
+    if (inference.ring.init(inference.storage, capacity, frame_len) == false) {
+        ei_free(inference.storage);
+        inference.storage = NULL;
+        ei_printf("Invalid audio buffer configuration\r\n");
         return false;
     }
 
-    inference.buf_select = 0;
-    inference.buf_count = 0;
-    inference.n_samples = n_samples;    // this represents the number of samples per channel
-    inference.buf_ready = 0;
+    inference.slice_len = slice_len;    // this represents the number of samples of all channels
 
     audio_config.eAudioSource = NS_AUDIO_SOURCE_AUDADC;
     if(ns_start_audio(&audio_config)) {
@@ -345,7 +392,7 @@ bool ei_microphone_inference_start(uint32_t n_samples, uint8_t n_channels_infere
  */
 bool ei_microphone_inference_is_recording(void)
 {
-    return (inference.buf_ready == 0);
+    return (inference.ring.available() < inference.slice_len);
 }
 
 /**
@@ -354,8 +401,27 @@ bool ei_microphone_inference_is_recording(void)
  */
 void ei_microphone_inference_reset_buffers(void)
 {
-    inference.buf_ready = 0;
-    inference.buf_count = 0;
+    inference.ring.flush();
+    inference.ring.reset_dropped_frames();
+}
+
+/**
+ * @brief Release the slice that was just classified back to the audio DMA
+ *
+ */
+void ei_microphone_inference_slice_done(void)
+{
+    inference.ring.consume(inference.slice_len);
+}
+
+/**
+ * @brief Number of DMA frames dropped because the ring was full
+ *
+ * @return uint32_t
+ */
+uint32_t ei_microphone_inference_dropped_frames(void)
+{
+    return inference.ring.get_dropped_frames();
 }
 
 /**
@@ -366,48 +432,40 @@ void ei_microphone_inference_reset_buffers(void)
  */
 bool ei_microphone_inference_end(void)
 {
+    g_inferenceRunning = false;
+
     if(ns_end_audio(&audio_config)) {
         ei_printf("Failed to end audio\r\n");
     }
 
-    ei_free(inference.buffers[0]);
-    ei_free(inference.buffers[1]);
+    inference.ring.deinit();
+    ei_free(inference.storage);
+    inference.storage = NULL;
 
     return true; 
 }
 
-void ei_mic_run_inference(void)
-{
-    g_audioReady = false;
-    g_audioRecording = true;
-    
-    do {
-        __WFI();
-        ei_mic_thread(&ei_mic_inference_samples_callback);
-    }while(ei_microphone_inference_is_recording() == true);
-    g_audioRecording = false;
-}
-
 /**
- * @brief 
- * 
- * @param buffer 
- * @param sample_count 
+ * @brief Wait until a full slice is available in the ring.
+ * Audio keeps flowing into the ring while the previous slice is classified,
+ * the calling (inference) task is blocked until the DMA callback signals a slice.
+ *
+ * @return false if inference was stopped while waiting
  */
-void ei_mic_inference_samples_callback(void *buffer, uint32_t sample_count)
+bool ei_mic_run_inference(void)
 {
-    int16_t *samples = (int16_t *)buffer;
-
-    for (uint32_t i = 0; i < (sample_count >> 1); i++) {
-        inference.buffers[inference.buf_select][inference.buf_count++] = samples[i];
+    g_audioReady = false;
+    g_inferenceRunning = true;
 
-        if (inference.buf_count >= (inference.n_samples * n_audio_channels)) {  // n_samples is per channel
+    while (ei_microphone_inference_is_recording() == true) {
+        inference_task_wait(EI_MIC_SLICE_WAIT_MS);
 
-            inference.buf_select ^= 1;
-            inference.buf_count = 0;
-            inference.buf_ready = 1;
+        if (g_inferenceRunning == false) {
+            return false;
         }
-    }   
+    }
+
+    return true;
 }
 
 /**
@@ -421,138 +479,126 @@ static bool create_header(sensor_aq_payload_info *payload)
 {
     int ret;
     EiDeviceInfo *dev = EiDeviceInfo::get_device();
-    EiDeviceMemory *mem = dev->get_memory();
 
     sensor_aq_init_mbedtls_hs256_context(&ei_mic_signing_ctx, &ei_mic_hs_ctx, dev->get_sample_hmac_key().c_str());
 
-    ret = sensor_aq_init(&ei_mic_ctx, payload, NULL, true);
+    memset(&ei_mic_stream_state, 0, sizeof(ei_mic_stream_state));
 
-    if (ret != AQ_OK) {
+    // the header goes through ei_write like the samples, so it is signed as well
+    ret = sensor_aq_init(&ei_mic_ctx, payload, &ei_mic_stream, false);
+
+    if (ret != AQ_OK || ei_mic_stream_state.error) {
         ei_printf("sensor_aq_init failed (%d)\n", ret);
         return false;
     }
 
-    // then we're gonna find the last byte that is not 0x00 in the CBOR buffer.
-    // That should give us the whole header
-    size_t end_of_header_ix = 0;
-    for (size_t ix = ei_mic_ctx.cbor_buffer.len - 1; ix != 0; ix--) {
-        if (((uint8_t *)ei_mic_ctx.cbor_buffer.ptr)[ix] != 0x0) {
-            end_of_header_ix = ix;
-            break;
-        }
-    }
+    return true;
+}
 
-    if (end_of_header_ix == 0) {
-        ei_printf("Failed to find end of header\n");
-        return false;
+/**
+ * @brief Write the staged bytes to the sample memory
+ *
+ * @return false if the sample memory is full
+ */
+static bool ei_mic_stream_flush(void)
+{
+    EiDeviceMemory *mem = EiDeviceInfo::get_device()->get_memory();
+    ei_mic_stream_t *stream = &ei_mic_stream_state;
+
+    if (stream->fill == 0) {
+        return true;
     }
 
-    // Write to blockdevice
-    ret = mem->write_sample_data((uint8_t*)ei_mic_ctx.cbor_buffer.ptr, 0, end_of_header_ix);
-    if ((size_t)ret != end_of_header_ix) {
-        ei_printf("Failed to write to header blockdevice (%d)\n", ret);
+    if (mem->write_sample_data(ei_mic_stream_staging, stream->block_address, stream->fill) != stream->fill) {
+        stream->error = true;
         return false;
     }
 
-    headerOffset = end_of_header_ix;
+    stream->block_address += stream->fill;
+    stream->fill = 0;
 
     return true;
 }
 
 /**
- * @brief 
- * 
- * @param buffer 
- * @param size 
- * @param count 
- * @param stream 
- * @return size_t 
+ * @brief sensor-aq output, collects the CBOR stream in the staging buffer
+ * and flushes it to the sample memory in EI_MIC_STREAM_BLOCK_SIZE writes
+ *
+ * @param buffer
+ * @param size
+ * @param count
+ * @param stream
+ * @return size_t number of items written
  */
 static size_t ei_write(const void* buffer, size_t size, size_t count, EI_SENSOR_AQ_STREAM* stream)
 {
-    (void)buffer;
-    (void)size;
     (void)stream;
+    ei_mic_stream_t *state = &ei_mic_stream_state;
+    const uint8_t *data = (const uint8_t *)buffer;
+    size_t bytes_left = size * count;
+
+    while (bytes_left > 0) {
+        size_t chunk = EI_MIC_STREAM_BLOCK_SIZE - state->fill;
+        if (chunk > bytes_left) {
+            chunk = bytes_left;
+        }
+
+        memcpy(&ei_mic_stream_staging[state->fill], data, chunk);
+        state->fill += chunk;
+        data += chunk;
+        bytes_left -= chunk;
+
+        if (state->fill == EI_MIC_STREAM_BLOCK_SIZE && ei_mic_stream_flush() == false) {
+            return 0;
+        }
+    }
+
+    uint32_t end = state->block_address + state->fill;
+    if (end > state->length) {
+        state->length = end;
+    }
 
     return count;
 }
 
 /**
- * @brief 
- * 
- * @param stream 
- * @param offset 
- * @param origin 
- * @return int 
+ * @brief Move the write position, used by sensor_aq_finish to patch the
+ * signature into the header. Only SEEK_SET is needed.
+ *
+ * @param stream
+ * @param offset
+ * @param origin
+ * @return int 0 on success
  */
 static int ei_seek(EI_SENSOR_AQ_STREAM* stream, long int offset, int origin)
 {
     (void)stream;
-    (void)offset;
-    (void)origin;
+
+    if (origin != SEEK_SET || offset < 0 || ei_mic_stream_flush() == false) {
+        return -1;
+    }
+
+    ei_mic_stream_state.block_address = (uint32_t)offset;
 
     return 0;
 }
 
 /**
- * @brief 
- * 
- * @param buffer 
- * @param n_bytes 
+ * @brief Encode an audio block into the sample file
+ *
+ * @param buffer interleaved int16 samples
+ * @param n_bytes
  */
 static void ingestion_callback(void *buffer, uint32_t n_bytes)
 {
-    EiDeviceMemory *mem = EiDeviceInfo::get_device()->get_memory();
-    int16_t *sbuffer = (int16_t *)buffer;
-    uint32_t sbuf_ptr = 0;
-    uint32_t n_samples = (n_bytes >> 1);
-
-    /* Calculate the cbor buffer length: header + 3 bytes per audio channel */
-    uint32_t cbor_length = n_samples + ((n_samples + n_bytes) * n_audio_channels);    
-    uint8_t *cbor_buf = (uint8_t *)ei_malloc(cbor_length);
+    uint32_t n_values = (n_bytes >> 1);
 
-    if (cbor_buf == NULL) {
-        ei_printf("ERR: memory allocation error\r\n");
+    int ret = sensor_aq_add_data_batch(&ei_mic_ctx, (int16_t *)buffer, n_values);
+    if (ret != AQ_OK) {
+        ei_printf("ERR: sensor_aq_add_data_batch failed (%d)\r\n", ret);
+        ei_mic_stream_state.error = true;
         return;
     }
 
-    for (uint32_t i = 0; i < n_samples; i++) {
-        uint32_t cval_ptr = i * ((n_audio_channels * 3) + 1);
-
-        cbor_buf[cval_ptr] = 0x80 + n_audio_channels;
-        for (uint8_t y = 0; y < n_audio_channels; y++) {
-            write_value_to_cbor_buffer(&cbor_buf[cval_ptr + 1 + (3 * y)], sbuffer[sbuf_ptr + y]);
-        }
-        sbuf_ptr += n_audio_channels;
-    }
-
-    mem->write_sample_data((uint8_t*)cbor_buf, headerOffset + cbor_current_sample, cbor_length);
-
-    ei_free(cbor_buf);
-
-    cbor_current_sample += cbor_length;
-    current_sample += n_samples;
-
-}
-
-/**
- * @brief Convert to CBOR int16 format and write to buf
- */
-static void write_value_to_cbor_buffer(uint8_t *buf, int16_t value)
-{
-    uint8_t datatype;
-    uint16_t sample;
-
-    if(value < 0) {
-        datatype = 0x39;
-        /* Convert from 2's complement */
-        sample = (uint16_t)~value + 1;
-    }
-    else {
-        datatype = 0x19;
-        sample = value;
-    }
-    buf[0] = datatype;
-    buf[1] = sample >> 8;
-    buf[2] = sample & 0xFF;    
+    current_sample += n_values / n_audio_channels;
 }
@@ -49,8 +49,9 @@ extern bool ei_microphone_inference_start(uint32_t n_samples, uint8_t n_channels
 extern bool ei_microphone_inference_end(void);
 extern bool ei_microphone_inference_is_recording(void);
 extern void ei_microphone_inference_reset_buffers(void);
-extern void ei_mic_inference_samples_callback(void *buffer, uint32_t sample_count);
-extern void ei_mic_run_inference(void);
+extern void ei_microphone_inference_slice_done(void);
+extern uint32_t ei_microphone_inference_dropped_frames(void);
+extern bool ei_mic_run_inference(void);
 
 extern void ei_mic_thread(void (*callback)(void *buffer, uint32_t n_bytes));
 
@@ -118,11 +118,12 @@ static void ei_main_task(void *pvParameters)
                                         portMAX_DELAY);
 
         if (event_bit & EVENT_RX_READY) {
-            char data = ei_get_serial_byte(is_inference_running());
+            uint8_t data;
 
             in_rx_loop = false;
 
-            while ((uint8_t)data != 0xFF) {
+            // one byte at a time, AT handlers may read the following data themselves
+            while (ei_usb_read(&data, 1, 0) == 1) {
                 if ((is_inference_running() == true) && (data == 'b') && (in_rx_loop == false)) {
                     ei_stop_impulse();
                     at->print_prompt();
@@ -130,9 +131,11 @@ static void ei_main_task(void *pvParameters)
                 }
 
                 in_rx_loop = true;
-                at->handle(data);
-                data = ei_get_serial_byte(is_inference_running());
+                at->handle((char)data);
             }
+
+            // echo and command output accumulated while handling the batch
+            ei_usb_flush();
         }
 
 
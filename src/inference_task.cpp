@@ -35,6 +35,7 @@
 #include "task.h"
 #include "inference_task.h"
 #include "inference/ei_run_impulse.h"
+#include "peripheral/usb/ei_usb.h"
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
 
 // Inference task parameters
@@ -43,21 +44,72 @@
 static TaskHandle_t inference_task_handle = NULL;
 static void inference_task(void *pvParameters);
 
+/**
+ * @brief Create the inference task (once) and wake it up
+ *
+ */
 void inference_task_start(void)
 {
     /* Only init once */
+    if (inference_task_handle == NULL) {
+        if (xTaskCreate(inference_task,
+            (const char*) "Inference task",
+            INFRENCE_TASK_STACK_SIZE_BYTE / 4, // in words
+            NULL, //pvParameters
+            INFRENCE_TASK_PRIORITY, //uxPriority
+            &inference_task_handle) != pdPASS) {
+            ei_printf("Failed to create Inference task\r\n");
+            return;
+        }
+    }
+
+    inference_task_notify(INFERENCE_EVENT_START);
+}
+
+/**
+ * @brief Wake up the inference task
+ *
+ * @param events INFERENCE_EVENT_ bits
+ */
+void inference_task_notify(uint32_t events)
+{
+    if (inference_task_handle != NULL) {
+        xTaskNotify(inference_task_handle, events, eSetBits);
+    }
+}
+
+/**
+ * @brief Wake up the inference task, ISR version
+ *
+ * @param events INFERENCE_EVENT_ bits
+ */
+void inference_task_notify_from_isr(uint32_t events)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
     if (inference_task_handle != NULL) {
-        return;
+        xTaskNotifyFromISR(inference_task_handle, events, eSetBits, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     }
+}
 
-    if (xTaskCreate(inference_task,
-        (const char*) "Inference task",
-        INFRENCE_TASK_STACK_SIZE_BYTE / 4, // in words
-        NULL, //pvParameters
-        INFRENCE_TASK_PRIORITY, //uxPriority
-        &inference_task_handle) != pdPASS) {
-        ei_printf("Failed to create Display task\r\n");
+/**
+ * @brief Block the inference task until it's notified or the timeout expires.
+ * Notifications are only wake ups, callers have to re-check their condition.
+ *
+ * @param timeout_ms INFERENCE_WAIT_FOREVER to block without timeout
+ * @return uint32_t received INFERENCE_EVENT_ bits, 0 on timeout
+ */
+uint32_t inference_task_wait(uint32_t timeout_ms)
+{
+    uint32_t events = 0;
+    TickType_t ticks = (timeout_ms == INFERENCE_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+
+    if (xTaskNotifyWait(0, 0xFFFFFFFFu, &events, ticks) != pdTRUE) {
+        return 0;
     }
+
+    return events;
 }
 
 /**
@@ -70,11 +122,13 @@ void inference_task(void *pvParameters)
     (void)pvParameters;
 
     while(1) {
-        while(is_inference_running() == true) {
-            ei_run_impulse();
+        if (is_inference_running() == false) {
+            /* sleep until started again */
+            inference_task_wait(INFERENCE_WAIT_FOREVER);
+            continue;
         }
-    }
 
-    /* Unblock other tasks */
-    vTaskDelay(10);
+        ei_run_impulse();
+        ei_usb_flush();
+    }
 }
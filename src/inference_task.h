@@ -35,6 +35,18 @@
 #ifndef _INFERENCE_TASK_H_
 #define _INFERENCE_TASK_H_
 
+#include <stdint.h>
+
+/* Notification bits used to wake up the inference task */
+#define INFERENCE_EVENT_START           (1 << 0)
+#define INFERENCE_EVENT_STOP            (1 << 1)
+#define INFERENCE_EVENT_SLICE_READY     (1 << 2)
+
+#define INFERENCE_WAIT_FOREVER          (0xFFFFFFFFu)
+
 extern void inference_task_start(void);
+extern void inference_task_notify(uint32_t events);
+extern void inference_task_notify_from_isr(uint32_t events);
+extern uint32_t inference_task_wait(uint32_t timeout_ms);
 
 #endif
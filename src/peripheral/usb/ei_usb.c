@@ -40,11 +40,13 @@
 
 #include <stdint.h>
 #include "ei_usb.h"
+#include "ei_usb_rx_ring.h"
 #include "stdbool.h"
 #include <string.h>
 
 #include "ns_core.h"
 #include "ns_usb.h"
+#include "tusb.h"
 
 static EventGroupHandle_t usb_event_group;
 
@@ -54,22 +56,46 @@ static EventGroupHandle_t usb_event_group;
 static TaskHandle_t usb_task_handle;
 static void usb_task(void *pvParameters);
 
-#define USB_EVENT_RX_READY  (1 << 0)
+#define USB_EVENT_RX_READY  (1 << 0)   // CDC FIFO got new data (from ISR)
 #define USB_EVENT_TX_DONE   (1 << 1)
+#define USB_EVENT_RX_DATA   (1 << 2)   // new data in the RX ring, for ei_usb_read
+#define USB_EVENT_RX_SPACE  (1 << 3)   // reader freed space in a full RX ring
+
+/* RX ring between the USB task and the reader, must be a power of two */
+#define EI_USB_RX_RING_SIZE             4096
+/* How often a stalled (ring full) USB task retries draining the CDC FIFO */
+#define EI_USB_RX_STALL_RETRY_MS        10
 
 #define MY_RX_BUFSIZE 4096
 #define MY_TX_BUFSIZE 4096
 
-AM_SHARED_RW static uint8_t my_rx_ff_buf[MY_RX_BUFSIZE] = {0xFF};
+/* Per-task TX accumulators, see ei_usb_write. A task holds one from its
+ * first buffered write until its ei_usb_flush, a task without one sends
+ * unbuffered */
+#define EI_USB_TX_SLOTS                 3
+#define EI_USB_TX_ACC_SIZE              512
+#define EI_USB_TX_HIGH_WATERMARK        448     // flush as soon as the accumulator reaches this level
+#define EI_USB_TX_BYPASS_SIZE           128     // smaller writes are accumulated, bigger ones to an empty accumulator are sent as is
+
+typedef struct {
+    TaskHandle_t owner;
+    uint32_t fill;
+    uint8_t buffer[EI_USB_TX_ACC_SIZE];
+} ei_usb_tx_slot_t;
+
+static ei_usb_tx_slot_t tx_slots[EI_USB_TX_SLOTS];
+
+/* storage of the TinyUSB CDC FIFOs */
+AM_SHARED_RW static uint8_t my_rx_ff_buf[MY_RX_BUFSIZE];
 AM_SHARED_RW static uint8_t my_tx_ff_buf[MY_TX_BUFSIZE];
 
-/* Counter to update g_temp_buffer index */
-static uint32_t g_rx_index = 0;
-/* Index of data sent to at hanlder */
-static uint32_t g_uart_rx_read_index = 0;
+static uint8_t rx_ring_buffer[EI_USB_RX_RING_SIZE];
+static ei_usb_rx_ring_t rx_ring;
+/* set by the USB task when the ring is full and data is left in the CDC FIFO,
+ * cleared by the reader once it freed space (atomic, both tasks write it) */
+static bool rx_stalled = false;
 
 static bool _usb_is_init = false;
-static bool _is_clear = false;
 static usb_handle_t usb_handle;
 
 // callbacks
@@ -78,6 +104,9 @@ static void ei_usb_tx_cb(ns_usb_transaction_t *pTransaction);
 static void ei_usb_service_cb(uint8_t service);
 
 static void usb_local_read(void);
+static uint32_t usb_drain_rx_fifo(void);
+static ei_usb_tx_slot_t* usb_get_tx_slot(void);
+static void usb_flush_slot(ei_usb_tx_slot_t *slot);
 
 static ns_usb_config_t usb_cdc_config = {
     .api = &ns_usb_V1_0_0,
@@ -100,6 +129,7 @@ int ei_usb_init(void)
     BaseType_t retval;
 
     usb_event_group = xEventGroupCreate();
+    ei_usb_rx_ring_init(&rx_ring, rx_ring_buffer, sizeof(rx_ring_buffer));
     NS_TRY(ns_usb_init(&usb_cdc_config, &usb_handle), "USB Init Failed\n");
 
     /* create a task to send data via usb */
@@ -124,7 +154,6 @@ static void usb_task(void *pvParameters)
 
     while (1) {
         usb_local_read();
-        vTaskDelay(1);
     }
 }
 
@@ -140,13 +169,20 @@ bool usb_is_init(void)
 }
 
 /**
- * @brief 
- * 
- * @param buffer 
- * @param length 
+ * @brief Send data right away. Anything the calling task has accumulated
+ * is sent first, so the output order is preserved.
+ *
+ * @param buffer
+ * @param length
  */
 void ei_usb_send(uint8_t *buffer, uint32_t length)
 {
+    ei_usb_tx_slot_t *slot = usb_get_tx_slot();
+
+    if (slot != NULL) {
+        usb_flush_slot(slot);
+    }
+
     ns_usb_send_data(usb_handle, buffer, length);
 
 #if 0
@@ -159,32 +195,254 @@ void ei_usb_send(uint8_t *buffer, uint32_t length)
 }
 
 /**
- * @brief Handles blockin read
+ * @brief Buffered write. Data is accumulated per task and sent once the
+ * high watermark is reached or on ei_usb_flush / ei_usb_send.
+ * Falls back to unbuffered send outside of a task context.
+ *
+ * @param buffer
+ * @param length
  */
-static void usb_local_read(void)
+void ei_usb_write(const uint8_t *buffer, uint32_t length)
 {
-    uint32_t read = 0;
-    EventBits_t event_bit;
+    ei_usb_tx_slot_t *slot = usb_get_tx_slot();
 
-    event_bit = xEventGroupWaitBits(usb_event_group, 
-                                    USB_EVENT_RX_READY,    //  uxBitsToWaitFor 
-                                    pdTRUE,                 //  xClearOnExit
-                                    pdFALSE,                //  xWaitForAllBits
-                                    portMAX_DELAY);
+    if (slot == NULL) {
+        ns_usb_send_data(usb_handle, (void *)buffer, length);
+        return;
+    }
+
+    /* big chunk and nothing pending, no point in copying it */
+    if (slot->fill == 0 && length >= EI_USB_TX_BYPASS_SIZE) {
+        ns_usb_send_data(usb_handle, (void *)buffer, length);
+        return;
+    }
+
+    while (length > 0) {
+        uint32_t to_copy = EI_USB_TX_ACC_SIZE - slot->fill;
 
-    if (event_bit & USB_EVENT_RX_READY) {
-        while(my_rx_ff_buf[g_rx_index] != 0x00){ 
-            g_rx_index++;
+        if (to_copy > length) {
+            to_copy = length;
         }
-        _is_clear = false;
 
+        memcpy(&slot->buffer[slot->fill], buffer, to_copy);
+        slot->fill += to_copy;
+        buffer += to_copy;
+        length -= to_copy;
 
+        if (slot->fill >= EI_USB_TX_HIGH_WATERMARK) {
+            usb_flush_slot(slot);
+        }
+    }
+}
+
+/**
+ * @brief Free space in the TX accumulator of the calling task, to write into
+ * in place and hand back with ei_usb_commit. The accumulator is flushed
+ * first if less than min_length bytes are free.
+ *
+ * @param span set to the free space
+ * @param min_length
+ * @return uint32_t number of free bytes, 0 outside of a task context (use
+ * ei_usb_write then)
+ */
+uint32_t ei_usb_write_span(uint8_t **span, uint32_t min_length)
+{
+    ei_usb_tx_slot_t *slot = usb_get_tx_slot();
+
+    if (slot == NULL || min_length > EI_USB_TX_ACC_SIZE) {
+        return 0;
+    }
+
+    if (EI_USB_TX_ACC_SIZE - slot->fill < min_length) {
+        usb_flush_slot(slot);
+    }
+
+    *span = &slot->buffer[slot->fill];
+
+    return EI_USB_TX_ACC_SIZE - slot->fill;
+}
+
+/**
+ * @brief Add bytes written into the span of ei_usb_write_span to the
+ * accumulator, flushed once the high watermark is reached
+ *
+ * @param length
+ */
+void ei_usb_commit(uint32_t length)
+{
+    ei_usb_tx_slot_t *slot = usb_get_tx_slot();
+
+    if (slot == NULL) {
+        return;
+    }
+
+    slot->fill += length;
+
+    if (slot->fill >= EI_USB_TX_HIGH_WATERMARK) {
+        usb_flush_slot(slot);
+    }
+}
+
+/**
+ * @brief Buffered single character write
+ *
+ * @param c
+ */
+void ei_usb_putc(char c)
+{
+    ei_usb_tx_slot_t *slot = usb_get_tx_slot();
+
+    if (slot == NULL) {
+        ns_usb_send_data(usb_handle, &c, 1);
+        return;
+    }
+
+    slot->buffer[slot->fill++] = (uint8_t)c;
+
+    if (slot->fill >= EI_USB_TX_HIGH_WATERMARK) {
+        usb_flush_slot(slot);
+    }
+}
+
+/**
+ * @brief Send everything the calling task has accumulated and release its
+ * TX accumulator for other tasks
+ *
+ */
+void ei_usb_flush(void)
+{
+    ei_usb_tx_slot_t *slot = usb_get_tx_slot();
+
+    if (slot != NULL) {
+        usb_flush_slot(slot);
+        slot->owner = NULL;
+    }
+}
+
+#if (INCLUDE_xTaskGetCurrentTaskHandle == 0) && (configUSE_MUTEXES == 0)
+/**
+ * @brief The prebuilt FreeRTOS is configured without xTaskGetCurrentTaskHandle,
+ * the handle of a task is its TCB
+ *
+ * @return TaskHandle_t
+ */
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    extern TaskHandle_t volatile pxCurrentTCB;
+
+    return pxCurrentTCB;
+}
+#endif
+
+/**
+ * @brief Find (or claim) the TX accumulator of the calling task
+ *
+ * @return ei_usb_tx_slot_t* NULL if called before the scheduler started or if all slots are taken
+ */
+static ei_usb_tx_slot_t* usb_get_tx_slot(void)
+{
+    TaskHandle_t owner;
+    ei_usb_tx_slot_t *slot = NULL;
+
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return NULL;
+    }
+
+    owner = xTaskGetCurrentTaskHandle();
+
+    for (uint8_t i = 0; i < EI_USB_TX_SLOTS; i++) {
+        if (tx_slots[i].owner == owner) {
+            return &tx_slots[i];
+        }
+    }
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < EI_USB_TX_SLOTS; i++) {
+        if (tx_slots[i].owner == NULL) {
+            tx_slots[i].owner = owner;
+            tx_slots[i].fill = 0;
+            slot = &tx_slots[i];
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return slot;
+}
+
+/**
+ * @brief
+ *
+ * @param slot
+ */
+static void usb_flush_slot(ei_usb_tx_slot_t *slot)
+{
+    if (slot->fill > 0) {
+        ns_usb_send_data(usb_handle, slot->buffer, slot->fill);
+        slot->fill = 0;
+    }
+}
+
+/**
+ * @brief Wait for new data in the CDC FIFO (or for space in the RX ring
+ * after a stall) and move it into the RX ring
+ */
+static void usb_local_read(void)
+{
+    uint32_t received;
+    TickType_t timeout = __atomic_load_n(&rx_stalled, __ATOMIC_ACQUIRE) ? pdMS_TO_TICKS(EI_USB_RX_STALL_RETRY_MS) : portMAX_DELAY;
+
+    xEventGroupWaitBits(usb_event_group,
+                        USB_EVENT_RX_READY | USB_EVENT_RX_SPACE,    //  uxBitsToWaitFor
+                        pdTRUE,                 //  xClearOnExit
+                        pdFALSE,                //  xWaitForAllBits
+                        timeout);
+
+    received = usb_drain_rx_fifo();
+
+    if (received > 0) {
+        xEventGroupSetBits(usb_event_group, USB_EVENT_RX_DATA);
         xEventGroupSetBits(
                         common_event_group,      /* The event group being updated. */
                         EVENT_RX_READY);      /* The bits being set. */
     }
 }
 
+/**
+ * @brief Read everything available in the CDC FIFO straight into the RX ring.
+ * Whatever doesn't fit stays in the FIFO (and the host is NAKed once the FIFO
+ * is full too), so no data is lost.
+ *
+ * @return uint32_t number of bytes moved into the ring
+ */
+static uint32_t usb_drain_rx_fifo(void)
+{
+    uint32_t total = 0;
+    uint32_t space;
+    uint32_t read;
+    uint8_t *span;
+
+    __atomic_store_n(&rx_stalled, false, __ATOMIC_RELEASE);
+
+    while (tud_cdc_n_available(0) > 0) {
+        space = ei_usb_rx_ring_write_span(&rx_ring, &span);
+        if (space == 0) {
+            __atomic_store_n(&rx_stalled, true, __ATOMIC_RELEASE);
+            break;
+        }
+
+        read = tud_cdc_n_read(0, span, space);
+        if (read == 0) {
+            break;
+        }
+
+        ei_usb_rx_ring_commit(&rx_ring, read);
+        total += read;
+    }
+
+    return total;
+}
+
 /**
  * @brief 
  * 
@@ -234,24 +492,63 @@ static void ei_usb_service_cb(uint8_t service)
 }
 
 /**
- * @brief Returns char from uart rx buffer
+ * @brief Read received data. Must be called from a single task only
+ * (the RX ring has a single consumer).
  *
- * @param is_inference_running If inference is running, we need to check for a single 'b'
- * @return
+ * @param buffer
+ * @param length number of bytes to read
+ * @param timeout_ms how long to wait for length bytes, 0 returns right away
+ * with whatever is available
+ * @return uint32_t number of bytes read
  */
-char ei_get_serial_byte(uint8_t is_inference_running)
+uint32_t ei_usb_read(uint8_t *buffer, uint32_t length, uint32_t timeout_ms)
 {
-    char to_send = -1;
+    uint32_t received = 0;
+    TickType_t start = xTaskGetTickCount();
+    TickType_t elapsed;
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
 
-    if (g_uart_rx_read_index < g_rx_index) {
-        to_send = my_rx_ff_buf[g_uart_rx_read_index];    // get one
+    while (1) {
+        received += ei_usb_rx_ring_read(&rx_ring, &buffer[received], length - received);
 
-        g_uart_rx_read_index = (g_uart_rx_read_index + 1)%MY_RX_BUFSIZE;  // increment and wrap
+        if (__atomic_exchange_n(&rx_stalled, false, __ATOMIC_ACQ_REL)) {
+            xEventGroupSetBits(usb_event_group, USB_EVENT_RX_SPACE);
+        }
+
+        if (received == length || timeout == 0) {
+            break;
+        }
+
+        elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            break;
+        }
+
+        xEventGroupWaitBits(usb_event_group,
+                            USB_EVENT_RX_DATA,     //  uxBitsToWaitFor
+                            pdTRUE,                 //  xClearOnExit
+                            pdFALSE,                //  xWaitForAllBits
+                            timeout - elapsed);
     }
-    else if ((g_uart_rx_read_index == g_rx_index) && (_is_clear == false)) {  // when equal and different from zero
-        memset(my_rx_ff_buf, 0x00, sizeof(my_rx_ff_buf));   // no reset, just clear everything
-        _is_clear = true;
+
+    return received;
+}
+
+/**
+ * @brief Returns char from usb rx buffer
+ *
+ * @param is_inference_running not used
+ * @return 0xFF if there is no data
+ */
+char ei_get_serial_byte(uint8_t is_inference_running)
+{
+    uint8_t c;
+
+    (void)is_inference_running;
+
+    if (ei_usb_read(&c, 1, 0) == 0) {
+        return (char)0xFF;
     }
 
-    return to_send;
+    return (char)c;
 }
@@ -43,6 +43,12 @@ extern "C" {
 
 extern int ei_usb_init(void);
 extern void ei_usb_send(uint8_t *buffer, uint32_t length);
+extern void ei_usb_write(const uint8_t *buffer, uint32_t length);
+extern uint32_t ei_usb_write_span(uint8_t **span, uint32_t min_length);
+extern void ei_usb_commit(uint32_t length);
+extern void ei_usb_putc(char c);
+extern void ei_usb_flush(void);
+extern uint32_t ei_usb_read(uint8_t *buffer, uint32_t length, uint32_t timeout_ms);
 extern char ei_get_serial_byte(uint8_t is_inference_running);
 
 #if defined(__cplusplus)
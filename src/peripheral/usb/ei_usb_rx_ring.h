@@ -0,0 +1,203 @@
+/* The Clear BSD License
+ *
+ * Copyright (c) 2025 EdgeImpulse Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ *   * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ *   * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _EI_USB_RX_RING_H_
+#define _EI_USB_RX_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Single producer / single consumer byte ring for the USB RX path.
+ *
+ * The producer (USB task draining the CDC FIFO) writes straight into the
+ * ring storage through ei_usb_rx_ring_write_span()/ei_usb_rx_ring_commit(),
+ * the consumer copies data out with ei_usb_rx_ring_read(). Head and tail are
+ * free running counters, the size must be a power of two so the counters can
+ * wrap around at 2^32 and still be masked into the storage. Only the
+ * producer writes head and only the consumer writes tail, no locking needed.
+ * No platform dependencies, so the ring can be exercised on the host.
+ */
+typedef struct {
+    uint8_t *buffer;
+    uint32_t size;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t overflows;
+} ei_usb_rx_ring_t;
+
+static inline uint32_t ei_usb_rx_ring_load(const uint32_t *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+}
+
+static inline void ei_usb_rx_ring_store(uint32_t *counter, uint32_t value)
+{
+    __atomic_store_n(counter, value, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Attach storage to the ring
+ *
+ * @param ring
+ * @param buffer storage, size bytes
+ * @param size power of two
+ * @return false if the size is invalid
+ */
+static inline bool ei_usb_rx_ring_init(ei_usb_rx_ring_t *ring, uint8_t *buffer, uint32_t size)
+{
+    if (buffer == NULL || size == 0 || (size & (size - 1)) != 0) {
+        return false;
+    }
+
+    ring->buffer = buffer;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overflows = 0;
+
+    return true;
+}
+
+/**
+ * @brief Number of bytes ready to be read (consumer side)
+ */
+static inline uint32_t ei_usb_rx_ring_used(ei_usb_rx_ring_t *ring)
+{
+    return ei_usb_rx_ring_load(&ring->head) - ring->tail;
+}
+
+/**
+ * @brief Number of bytes that can be written (producer side)
+ */
+static inline uint32_t ei_usb_rx_ring_free(ei_usb_rx_ring_t *ring)
+{
+    return ring->size - (ring->head - ei_usb_rx_ring_load(&ring->tail));
+}
+
+/**
+ * @brief Producer side: get the contiguous free space at the head
+ *
+ * @param ring
+ * @param span set to the first free byte
+ * @return uint32_t number of contiguous free bytes, 0 if the ring is full
+ */
+static inline uint32_t ei_usb_rx_ring_write_span(ei_usb_rx_ring_t *ring, uint8_t **span)
+{
+    uint32_t free_bytes = ei_usb_rx_ring_free(ring);
+    uint32_t offset = ring->head & (ring->size - 1);
+    uint32_t to_end = ring->size - offset;
+
+    *span = &ring->buffer[offset];
+
+    return (free_bytes < to_end) ? free_bytes : to_end;
+}
+
+/**
+ * @brief Producer side: publish length bytes written into the span
+ * obtained with ei_usb_rx_ring_write_span()
+ */
+static inline void ei_usb_rx_ring_commit(ei_usb_rx_ring_t *ring, uint32_t length)
+{
+    ei_usb_rx_ring_store(&ring->head, ring->head + length);
+}
+
+/**
+ * @brief Producer side: copy data into the ring
+ *
+ * @return uint32_t number of bytes written, anything that doesn't fit is
+ * dropped and counted in overflows
+ */
+static inline uint32_t ei_usb_rx_ring_write(ei_usb_rx_ring_t *ring, const uint8_t *data, uint32_t length)
+{
+    uint32_t written = 0;
+    uint8_t *span;
+
+    while (written < length) {
+        uint32_t chunk = ei_usb_rx_ring_write_span(ring, &span);
+
+        if (chunk == 0) {
+            ring->overflows += length - written;
+            break;
+        }
+        if (chunk > length - written) {
+            chunk = length - written;
+        }
+
+        memcpy(span, &data[written], chunk);
+        ei_usb_rx_ring_commit(ring, chunk);
+        written += chunk;
+    }
+
+    return written;
+}
+
+/**
+ * @brief Consumer side: copy up to length bytes out of the ring
+ *
+ * @return uint32_t number of bytes read
+ */
+static inline uint32_t ei_usb_rx_ring_read(ei_usb_rx_ring_t *ring, uint8_t *data, uint32_t length)
+{
+    uint32_t used = ei_usb_rx_ring_used(ring);
+    uint32_t offset = ring->tail & (ring->size - 1);
+    uint32_t first;
+
+    if (length > used) {
+        length = used;
+    }
+
+    first = ring->size - offset;
+    if (first > length) {
+        first = length;
+    }
+
+    memcpy(data, &ring->buffer[offset], first);
+    memcpy(&data[first], ring->buffer, length - first);
+
+    ei_usb_rx_ring_store(&ring->tail, ring->tail + length);
+
+    return length;
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _EI_USB_RX_RING_H_ */